@@ -27,8 +27,14 @@ bool FullTextManagerQt::loadDictionariesFromEnv() {
     const QString env = qEnvironmentVariable("UNIDICT_DICTS");
     if (env.isEmpty()) return false;
     const auto paths = split_env_paths(env);
+    std::vector<std::string> files;
+    files.reserve(paths.size());
+    for (const auto& p : paths) files.push_back(p.toUtf8().constData());
     bool ok = false;
-    for (const auto& p : paths) ok |= mgr_->add_dictionary(p.toUtf8().constData());
+    for (const auto& r : mgr_->add_dictionaries(files)) {
+        if (r.ok) ok = true;
+        else qWarning("FullTextManagerQt: failed to load %s: %s", r.path.c_str(), r.error.c_str());
+    }
     mgr_->build_index();
     return ok;
 }
@@ -85,6 +91,29 @@ bool FullTextManagerQt::upgrade(const QString& inPath, const QString& outPath) {
     return mgr_->save_fulltext_index(std::string(outPath.toUtf8().constData()));
 }
 
+bool FullTextManagerQt::startBuild() {
+    if (mgr_->fulltext_state() == FullTextStateStd::Ready) return false;
+    // Callbacks run on the build thread; queue them to this object's thread. mgr_ is
+    // destroyed (cancelling and joining the build) before this QObject goes away.
+    mgr_->start_fulltext_build([this](const FullTextBuildProgressStd& p) {
+        using Phase = FullTextBuildProgressStd::Phase;
+        if (p.phase == Phase::Done || p.phase == Phase::Cancelled) {
+            const bool ok = p.phase == Phase::Done;
+            QMetaObject::invokeMethod(this, [this, ok]() { emit buildFinished(ok); }, Qt::QueuedConnection);
+            return;
+        }
+        const QString phase = p.phase == Phase::Collecting ? QStringLiteral("collecting") : QStringLiteral("indexing");
+        const qulonglong done = p.done, total = p.total;
+        QMetaObject::invokeMethod(this, [this, phase, done, total]() { emit buildProgress(phase, done, total); },
+                                  Qt::QueuedConnection);
+    });
+    return true;
+}
+
+void FullTextManagerQt::cancelBuild() { mgr_->cancel_fulltext_build(); }
+
+bool FullTextManagerQt::isBuilding() const { return mgr_->fulltext_state() == FullTextStateStd::Building; }
+
 QString FullTextManagerQt::currentSignature() const {
     return QString::fromUtf8(mgr_->fulltext_signature().c_str());
 }
@@ -100,6 +129,7 @@ QVariantMap FullTextManagerQt::currentStats() const {
     m["compressed_bytes"] = (qulonglong)s.compressed_bytes;
     m["pairs_decompressed"] = (qulonglong)s.pairs_decompressed;
     m["avg_df"] = s.avg_df;
+    m["building"] = isBuilding();
     m["signature"] = currentSignature();
     return m;
 }
@@ -114,7 +144,7 @@ QString FullTextManagerQt::verifyIndexMatch(const QString& path) const {
     if (ft.version() == 1 || ft.signature().empty()) {
         return {};
     }
-    const std::string cur = mgr_->fulltext_signature();
+    const std::string cur = mgr_->fulltext_signature(true);
     if (ft.signature() == cur) {
         return {};
     }
@@ -127,7 +157,7 @@ QVariantMap FullTextManagerQt::verifyIndexDetailed(const QString& path) const {
     out["version"] = 0;
     out["match"] = false;
     out["fileSignature"] = "";
-    out["currentSignature"] = QString::fromUtf8(mgr_->fulltext_signature().c_str());
+    out["currentSignature"] = QString::fromUtf8(mgr_->fulltext_signature(true).c_str());
     out["fileSigPrefix"] = "";
     out["currentSigPrefix"] = "";
     out["error"] = "";
@@ -40,6 +40,16 @@ public:
     // verifyResult should be the returned map from verifyIndexDetailed.
     // Returns true on success.
     Q_INVOKABLE bool exportSourceDiff(const QVariantMap& verifyResult, const QString& outPath) const;
+    // Build the in-memory index in the background; progress arrives through
+    // buildProgress()/buildFinished(). Returns false if an index is already present.
+    Q_INVOKABLE bool startBuild();
+    Q_INVOKABLE void cancelBuild();
+    Q_INVOKABLE bool isBuilding() const;
+
+signals:
+    // phase is "collecting" (fetching definitions) or "indexing"
+    void buildProgress(const QString& phase, qulonglong done, qulonglong total);
+    void buildFinished(bool ok);
 
 private:
     std::unique_ptr<UnidictCoreStd::DictionaryManagerStd> mgr_;
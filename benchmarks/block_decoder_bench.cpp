@@ -0,0 +1,149 @@
+// Throughput of the MDict block decoders (BlockDecoderStd backends).
+// Builds a dictionary-like corpus, cuts it into blocks the size MDict writers
+// use, encodes each block per type and times BlockDecoderStd::decode through
+// every backend, with and without checksum verification.
+//
+//   block_decoder_bench [--mb <corpus MiB, default 32>] [--block-kb <default 64>] [--rounds <default 5>]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "std/block_decoder_std.h"
+
+using namespace UnidictCoreStd;
+
+namespace {
+
+// zlib through the streaming inflate() API, as the parsers decoded before the
+// one-shot backends; kept here as the baseline.
+class ZlibStreamBackend : public BlockDecoderStd::Backend {
+public:
+    const char* name() const override { return "zlib-stream"; }
+    bool decompress(const unsigned char* in, size_t in_len, unsigned char* out, size_t out_cap, size_t* produced) const override {
+        z_stream strm{};
+        strm.next_in = const_cast<Bytef*>(in);
+        strm.avail_in = (uInt)in_len;
+        if (inflateInit(&strm) != Z_OK) return false;
+        strm.next_out = out;
+        strm.avail_out = (uInt)out_cap;
+        const int rc = inflate(&strm, Z_FINISH);
+        inflateEnd(&strm);
+        if (rc != Z_STREAM_END) return false;
+        const size_t got = out_cap - strm.avail_out;
+        if (produced) *produced = got;
+        return produced || got == out_cap;
+    }
+};
+
+// Headwords and HTML definitions from a small vocabulary, so it compresses
+// like a real dictionary (about 3-4x with zlib).
+std::string make_corpus(size_t bytes) {
+    static const char* kWords[] = {"the", "of", "a", "to", "in", "noun", "verb", "adjective", "meaning", "example",
+                                   "used", "with", "which", "person", "thing", "state", "act", "quality", "form", "see",
+                                   "especially", "something", "someone", "informal", "formal", "plural", "past", "tense"};
+    const size_t nwords = sizeof(kWords) / sizeof(kWords[0]);
+    uint32_t seed = 12345;
+    auto next = [&]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+    std::string out;
+    out.reserve(bytes + 256);
+    while (out.size() < bytes) {
+        std::string head;
+        for (int i = 0; i < 6 + (int)(next() % 5); ++i) head.push_back((char)('a' + next() % 26));
+        out += "<div class=\"entry\"><b>" + head + "</b> <i>" + kWords[5 + next() % 3] + "</i><ol>";
+        for (int s = 0; s < 1 + (int)(next() % 3); ++s) {
+            out += "<li>";
+            for (int w = 0; w < 8 + (int)(next() % 12); ++w) { out += kWords[next() % nwords]; out += ' '; }
+            out += "</li>";
+        }
+        out += "</ol></div>";
+        out.push_back('\0');
+    }
+    out.resize(bytes);
+    return out;
+}
+
+struct Encoded {
+    std::vector<std::string> blocks;
+    std::vector<size_t> sizes;
+    size_t comp_bytes = 0;
+};
+
+Encoded encode_all(const std::string& corpus, size_t block, uint32_t type) {
+    Encoded e;
+    for (size_t off = 0; off < corpus.size(); off += block) {
+        const size_t n = std::min(block, corpus.size() - off);
+        e.blocks.push_back(BlockDecoderStd::encode(type, std::string_view(corpus).substr(off, n)));
+        e.sizes.push_back(n);
+        e.comp_bytes += e.blocks.back().size();
+    }
+    return e;
+}
+
+// Best of rounds, in decoded MiB/s; -1 on a decoding error.
+double run(const Encoded& e, size_t total, int rounds) {
+    std::string out;
+    double best = 0;
+    for (int r = 0; r < rounds; ++r) {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t b = 0; b < e.blocks.size(); ++b) {
+            const auto& blk = e.blocks[b];
+            if (!BlockDecoderStd::decode(reinterpret_cast<const unsigned char*>(blk.data()), blk.size(), e.sizes[b], out)) return -1;
+        }
+        const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        best = std::max(best, (double)total / (1024.0 * 1024.0) / s);
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t mb = 32, block_kb = 64;
+    int rounds = 5;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--mb") == 0) mb = (size_t)std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--block-kb") == 0) block_kb = (size_t)std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--rounds") == 0) rounds = std::atoi(argv[i + 1]);
+    }
+    if (mb == 0 || block_kb == 0 || rounds <= 0) {
+        std::fprintf(stderr, "usage: %s [--mb N] [--block-kb N] [--rounds N]\n", argv[0]);
+        return 2;
+    }
+    const std::string corpus = make_corpus(mb << 20);
+    const size_t block = block_kb << 10;
+    std::printf("corpus %zu MiB, %zu KiB blocks, best of %d\n\n", mb, block_kb, rounds);
+    std::printf("%-12s %-7s %8s %12s\n", "backend", "verify", "ratio", "MiB/s");
+
+    const ZlibStreamBackend zlib_stream;
+    struct Case { uint32_t type; const BlockDecoderStd::Backend* backend; };
+    std::vector<Case> cases{{BlockDecoderStd::Stored, &BlockDecoderStd::stored()},
+                            {BlockDecoderStd::Zlib, &zlib_stream},
+                            {BlockDecoderStd::Zlib, &BlockDecoderStd::zlib()}};
+    if (BlockDecoderStd::libdeflate()) cases.push_back({BlockDecoderStd::Zlib, BlockDecoderStd::libdeflate()});
+    cases.push_back({BlockDecoderStd::Lzo, &BlockDecoderStd::lzo()});
+
+    int status = 0;
+    for (const auto& c : cases) {
+        const Encoded e = encode_all(corpus, block, c.type);
+        BlockDecoderStd::set_backend(c.type, c.backend);
+        // zlib streams carry their own checksum, so verification only matters for the others
+        for (bool verify : {true, false}) {
+            if (c.type == BlockDecoderStd::Zlib && !verify) continue;
+            BlockDecoderStd::set_verify_checksums(verify);
+            const double mibs = run(e, corpus.size(), rounds);
+            if (mibs < 0) status = 1;
+            std::printf("%-12s %-7s %8.2f %12.1f\n", c.backend->name(), verify ? "on" : "off",
+                        (double)corpus.size() / (double)e.comp_bytes, mibs);
+        }
+        BlockDecoderStd::set_backend(c.type, nullptr);
+    }
+    BlockDecoderStd::set_verify_checksums(true);
+    return status;
+}
@@ -44,7 +44,12 @@ static void usage() {
     std::cout << "  -d, --dict <path>        Add dictionary file (support .mdx, .ifo, .json)\n";
     std::cout << "  -m, --mode <mode>        Search mode: exact, prefix, fuzzy, wildcard, regex, fulltext\n";
     std::cout << "  -p, --pattern <pattern>  Search pattern (for wildcard/regex/fulltext)\n";
+    std::cout << "                           fulltext accepts AND/OR/NOT, -term, \"phrase\", prefix*, dict:Name\n";
     std::cout << "  --mdict-password <pw>    Password for encrypted MDict (.mdx/.mdd)\n";
+    std::cout << "  --load-threads <n>       Parse dictionaries on n threads (default: all cores)\n";
+    std::cout << "  --load-report            Print per-dictionary load timings to stderr\n";
+    std::cout << "  --snapshots              Reuse load snapshots in <cache>/snapshots (written on first load)\n";
+    std::cout << "  --lazy                   Register dictionaries from their headers; parse on first lookup\n";
     std::cout << "  --help                    Show this help message\n\n";
 
     std::cout << "Dictionary Management:\n";
@@ -133,6 +138,7 @@ int main(int argc, char** argv) {
     std::string ft_verify_path;
     std::string ft_compat = "auto"; // strict|auto|loose
     std::string mdict_password;
+    int load_threads = 0; bool load_report = false; bool use_snapshots = false; bool lazy_load = false;
 
     for (int i = 1; i < argc; ++i) {
         std::string a = argv[i];
@@ -178,6 +184,10 @@ int main(int argc, char** argv) {
         else if (a == "--fulltext-index-stats" || a == "--ft-index-stats") { take(ft_stats_path); }
         else if (a == "--ft-index-verify") { take(ft_verify_path); }
         else if (a == "--mdict-password") { take(mdict_password); }
+        else if (a == "--load-threads") { std::string n; take(n); load_threads = std::max(0, std::atoi(n.c_str())); }
+        else if (a == "--load-report") { load_report = true; }
+        else if (a == "--snapshots") { use_snapshots = true; }
+        else if (a == "--lazy") { lazy_load = true; }
         else if (a == "--help" || a == "-h") { usage(); return 0; }
         else if (!a.empty() && a[0] == '-') { std::cerr << "Unknown option: " << a << "\n"; std::cerr << "Use --help for usage information.\n"; return 2; }
         else { word = a; }
@@ -226,8 +236,19 @@ int main(int argc, char** argv) {
     // Load dictionaries through std manager
     DictionaryManagerStd mgr;
 
-    for (const auto& p : dict_paths) mgr.add_dictionary(p);
-    mgr.build_index();
+    if (use_snapshots) mgr.set_load_snapshots(true);
+    if (lazy_load) {
+        for (const auto& p : dict_paths) {
+            if (!mgr.register_dictionary(p)) std::cerr << "Failed to register " << p << "\n";
+        }
+    } else {
+        for (const auto& r : mgr.add_dictionaries(dict_paths, load_threads)) {
+            if (!r.ok) std::cerr << "Failed to load " << r.path << ": " << r.error << "\n";
+            else if (load_report) std::cerr << "Loaded " << r.name << " (" << r.word_count << " words) in " << r.millis << " ms from " << r.path
+                                     << (r.from_snapshot ? " (snapshot)" : "") << "\n";
+        }
+        mgr.build_index();
+    }
 
     // Upgrade operation (single-file): requires dicts to sign the new index
     if (!ft_up_in.empty() && !ft_up_out.empty()) {
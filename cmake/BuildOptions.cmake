@@ -54,6 +54,7 @@ option(UNIDICT_ENABLE_TSAN "启用ThreadSanitizer" OFF)
 # 依赖管理
 option(UNIDICT_ENABLE_EXTERNAL_QT "使用系统Qt" ON)
 option(UNIDICT_ENABLE_EXTERNAL_ZLIB "使用系统zlib" ON)
+option(UNIDICT_ENABLE_LIBDEFLATE "找到libdeflate时用它解压MDict块" ON)
 
 # ==============================================================================
 # 组件构建选项
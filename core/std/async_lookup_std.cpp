@@ -0,0 +1,112 @@
+#include "async_lookup_std.h"
+
+namespace UnidictCoreStd {
+
+AsyncLookupStd::AsyncLookupStd(const DictionaryManagerStd& mgr, std::shared_ptr<ThreadPoolStd> pool)
+    : mgr_(mgr), pool_(pool ? std::move(pool) : std::make_shared<ThreadPoolStd>()) {}
+
+AsyncLookupStd::~AsyncLookupStd() {
+    // Tasks reference this object; a shared pool may run them after we are gone
+    std::unique_lock<std::mutex> lk(mu_);
+    stopping_ = true;
+    idle_cv_.wait(lk, [this]() { return tasks_ == 0; });
+}
+
+template <typename R>
+std::shared_future<R> AsyncLookupStd::submit(std::string key, std::function<R()> work, CancelTokenStd token,
+                                             std::function<void(const R&)> done) {
+    std::shared_ptr<Flight<R>> flight;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        ++stats_.submitted;
+        auto it = flights_.find(key);
+        if (it != flights_.end()) {
+            flight = std::static_pointer_cast<Flight<R>>(it->second);
+            flight->waiters.push_back({token, std::move(done)});
+            ++stats_.coalesced;
+            return flight->future;
+        }
+        flight = std::make_shared<Flight<R>>();
+        flight->future = flight->promise.get_future().share();
+        flight->waiters.push_back({token, std::move(done)});
+        flights_[key] = flight;
+        ++tasks_;
+    }
+    auto task = [this, key, flight, work = std::move(work)]() {
+        // Retires the task however it ends; the pool thread must not see an exception
+        struct Retire {
+            AsyncLookupStd* self;
+            ~Retire() {
+                std::lock_guard<std::mutex> lk(self->mu_);
+                if (--self->tasks_ == 0) self->idle_cv_.notify_all();
+            }
+        } retire{this};
+        bool run = false;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            if (!stopping_) {
+                for (const auto& w : flight->waiters) {
+                    if (!w.first.cancelled()) { run = true; break; }
+                }
+            }
+            // Nobody wants it: retire the key now so new requests start afresh
+            if (!run) { flights_.erase(key); ++stats_.skipped; }
+        }
+        R result{};
+        if (run) {
+            try { result = work(); } catch (...) { result = R{}; }
+        }
+        std::vector<std::pair<CancelTokenStd, std::function<void(const R&)>>> waiters;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            if (run) { flights_.erase(key); ++stats_.executed; }
+            waiters.swap(flight->waiters);
+        }
+        flight->promise.set_value(result);
+        for (const auto& w : waiters) {
+            if (!w.second || w.first.cancelled()) continue;
+            try { w.second(result); } catch (...) {} // one failing callback must not starve the rest
+        }
+    };
+    if (!pool_->submit(std::move(task))) {
+        std::lock_guard<std::mutex> lk(mu_);
+        flights_.erase(key);
+        ++stats_.rejected;
+        --tasks_;
+        flight->waiters.clear();
+        flight->promise.set_value(R{});
+        if (tasks_ == 0) idle_cv_.notify_all();
+    }
+    return flight->future;
+}
+
+std::shared_future<AsyncLookupStd::Entries> AsyncLookupStd::submit_lookup(const std::string& word, CancelTokenStd token,
+                                                                          std::function<void(const Entries&)> done) {
+    return submit<Entries>("L|" + word, [this, word]() { return mgr_.search_all(word); }, std::move(token), std::move(done));
+}
+
+std::shared_future<AsyncLookupStd::Words> AsyncLookupStd::submit_prefix(const std::string& prefix, int max_results,
+                                                                        CancelTokenStd token, std::function<void(const Words&)> done) {
+    return submit<Words>("P|" + std::to_string(max_results) + "|" + prefix,
+                         [this, prefix, max_results]() { return mgr_.prefix_search(prefix, max_results); },
+                         std::move(token), std::move(done));
+}
+
+std::shared_future<AsyncLookupStd::Entries> AsyncLookupStd::submit_fulltext(const std::string& query, int max_results,
+                                                                            CancelTokenStd token, std::function<void(const Entries&)> done) {
+    return submit<Entries>("F|" + std::to_string(max_results) + "|" + query,
+                           [this, query, max_results]() { return mgr_.full_text_search(query, max_results); },
+                           std::move(token), std::move(done));
+}
+
+AsyncLookupStd::Stats AsyncLookupStd::stats() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return stats_;
+}
+
+size_t AsyncLookupStd::in_flight() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return flights_.size();
+}
+
+} // namespace UnidictCoreStd
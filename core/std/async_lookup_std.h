@@ -0,0 +1,97 @@
+// Asynchronous facade over DictionaryManagerStd (std-only).
+// Queries run on a ThreadPoolStd and hand back shared futures and/or call a
+// completion callback. Identical queries still queued or running are coalesced:
+// later requests join the first one instead of running again, so a burst of the
+// same type-ahead prefix costs one lookup.
+
+#ifndef UNIDICT_ASYNC_LOOKUP_STD_H
+#define UNIDICT_ASYNC_LOOKUP_STD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dictionary_manager_std.h"
+#include "thread_pool_std.h"
+
+namespace UnidictCoreStd {
+
+// Per-request cancellation flag; copies share it.
+class CancelTokenStd {
+public:
+    CancelTokenStd() : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+    void cancel() const { flag_->store(true); }
+    bool cancelled() const { return flag_->load(); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+class AsyncLookupStd {
+public:
+    using Entries = std::vector<DictEntryStd>;
+    using Words = std::vector<std::string>;
+
+    // mgr must outlive this object. Without a pool one is created with a thread per
+    // core; a shared pool may serve several facades.
+    explicit AsyncLookupStd(const DictionaryManagerStd& mgr, std::shared_ptr<ThreadPoolStd> pool = nullptr);
+    // Queued requests are dropped (their futures yield empty results); running ones finish.
+    ~AsyncLookupStd();
+    AsyncLookupStd(const AsyncLookupStd&) = delete;
+    AsyncLookupStd& operator=(const AsyncLookupStd&) = delete;
+
+    // search_all(word), prefix_search(prefix, max_results), full_text_search(query, max_results).
+    // done runs on a pool thread unless the request was cancelled. A request cancelled
+    // before its query starts is skipped when no other request shares it; its future
+    // then yields an empty result. A query that already started is not interrupted.
+    // If the pool refuses the work (queue full) the future is ready at once, empty.
+    std::shared_future<Entries> submit_lookup(const std::string& word, CancelTokenStd token = {},
+                                              std::function<void(const Entries&)> done = {});
+    std::shared_future<Words> submit_prefix(const std::string& prefix, int max_results = 10, CancelTokenStd token = {},
+                                            std::function<void(const Words&)> done = {});
+    std::shared_future<Entries> submit_fulltext(const std::string& query, int max_results = 10, CancelTokenStd token = {},
+                                                std::function<void(const Entries&)> done = {});
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t coalesced = 0; // joined an identical request in flight
+        uint64_t executed = 0;  // queries actually run
+        uint64_t skipped = 0;   // dropped because every requester cancelled
+        uint64_t rejected = 0;  // refused by a full pool queue
+    };
+    Stats stats() const;
+    // Distinct queries queued or running.
+    size_t in_flight() const;
+
+private:
+    template <typename R>
+    struct Flight {
+        std::promise<R> promise;
+        std::shared_future<R> future;
+        std::vector<std::pair<CancelTokenStd, std::function<void(const R&)>>> waiters;
+    };
+    template <typename R>
+    std::shared_future<R> submit(std::string key, std::function<R()> work, CancelTokenStd token,
+                                 std::function<void(const R&)> done);
+
+    const DictionaryManagerStd& mgr_;
+    std::shared_ptr<ThreadPoolStd> pool_;
+    mutable std::mutex mu_;
+    std::condition_variable idle_cv_;
+    // Keyed by kind and arguments; the kind fixes the Flight<R> type behind the pointer
+    std::unordered_map<std::string, std::shared_ptr<void>> flights_;
+    size_t tasks_ = 0; // submitted to the pool and not finished
+    bool stopping_ = false;
+    Stats stats_;
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_ASYNC_LOOKUP_STD_H
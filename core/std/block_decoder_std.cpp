@@ -0,0 +1,350 @@
+#include "block_decoder_std.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <zlib.h>
+
+#ifdef UNIDICT_HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
+namespace UnidictCoreStd {
+
+namespace {
+
+uint32_t be32(const unsigned char* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+uint32_t le32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool finish(size_t got, size_t out_cap, size_t* produced) {
+    if (produced) { *produced = got; return true; }
+    return got == out_cap;
+}
+
+class StoredBackend : public BlockDecoderStd::Backend {
+public:
+    const char* name() const override { return "stored"; }
+    bool decompress(const unsigned char* in, size_t in_len, unsigned char* out, size_t out_cap, size_t* produced) const override {
+        if (in_len > out_cap) return false;
+        if (in_len) std::memcpy(out, in, in_len);
+        return finish(in_len, out_cap, produced);
+    }
+};
+
+class ZlibBackend : public BlockDecoderStd::Backend {
+public:
+    const char* name() const override { return "zlib"; }
+    bool decompress(const unsigned char* in, size_t in_len, unsigned char* out, size_t out_cap, size_t* produced) const override {
+        if (in_len > UINT32_MAX || out_cap > UINT32_MAX) return false;
+        uLongf got = (uLongf)out_cap;
+        uLong used = (uLong)in_len;
+        // Trailing bytes after the stream are ignored
+        if (uncompress2(out, &got, in, &used) != Z_OK) return false;
+        return finish(got, out_cap, produced);
+    }
+};
+
+#ifdef UNIDICT_HAVE_LIBDEFLATE
+class LibdeflateBackend : public BlockDecoderStd::Backend {
+public:
+    const char* name() const override { return "libdeflate"; }
+    bool decompress(const unsigned char* in, size_t in_len, unsigned char* out, size_t out_cap, size_t* produced) const override {
+        // A decompressor is not thread-safe; keep one per thread
+        thread_local std::unique_ptr<libdeflate_decompressor, void (*)(libdeflate_decompressor*)> d(
+            libdeflate_alloc_decompressor(), &libdeflate_free_decompressor);
+        if (!d) return false;
+        size_t used = 0, got = 0;
+        if (libdeflate_zlib_decompress_ex(d.get(), in, in_len, out, out_cap, &used, &got) != LIBDEFLATE_SUCCESS) return false;
+        return finish(got, out_cap, produced);
+    }
+};
+#endif
+
+// LZO1X, as decoded by lzo1x_decompress_safe: every read and copy is bounds-checked.
+class LzoBackend : public BlockDecoderStd::Backend {
+public:
+    const char* name() const override { return "lzo"; }
+    bool decompress(const unsigned char* in, size_t in_len, unsigned char* out, size_t out_cap, size_t* produced) const override {
+        const unsigned char* ip = in;
+        const unsigned char* const ip_end = in + in_len;
+        unsigned char* op = out;
+        unsigned char* const op_end = out + out_cap;
+        auto have = [&](size_t n) { return (size_t)(ip_end - ip) >= n; };
+        auto literals = [&](size_t n) {
+            if (!have(n) || (size_t)(op_end - op) < n) return false;
+            std::memcpy(op, ip, n);
+            op += n; ip += n;
+            return true;
+        };
+        // A match may overlap its own output: copy in steps no longer than dist
+        auto match = [&](size_t dist, size_t n) {
+            if (dist == 0 || dist > (size_t)(op - out) || (size_t)(op_end - op) < n) return false;
+            const unsigned char* m = op - dist;
+            if (dist >= n) {
+                std::memcpy(op, m, n);
+                op += n;
+            } else if (dist >= 8) {
+                for (; n >= 8; n -= 8, op += 8, m += 8) std::memcpy(op, m, 8);
+                while (n--) *op++ = *m++;
+            } else {
+                while (n--) *op++ = *m++;
+            }
+            return true;
+        };
+        // Run length past base: a zero byte per 255, then the remainder
+        auto extended = [&](size_t base, size_t& len) {
+            size_t n = 0;
+            while (have(1) && *ip == 0) {
+                n += 255; ++ip;
+                if (n > out_cap) return false;
+            }
+            if (!have(1)) return false;
+            len = n + base + *ip++;
+            return true;
+        };
+
+        enum { Loop, FirstLiteralRun, Match, MatchNext } state = Loop;
+        size_t t = 0;
+        if (!have(1)) return false;
+        if (*ip > 17) {
+            t = *ip++ - 17;
+            if (t < 4) {
+                state = MatchNext;
+            } else {
+                if (!literals(t)) return false;
+                state = FirstLiteralRun;
+            }
+        }
+        for (;;) {
+            switch (state) {
+            case Loop:
+                if (!have(1)) return false;
+                t = *ip++;
+                if (t >= 16) { state = Match; break; }
+                if (t == 0 && !extended(15, t)) return false;
+                if (!literals(t + 3)) return false;
+                state = FirstLiteralRun;
+                break;
+            case FirstLiteralRun:
+                if (!have(1)) return false;
+                t = *ip++;
+                if (t >= 16) { state = Match; break; }
+                // Three bytes from 2 KiB or more back
+                if (!have(1)) return false;
+                if (!match(1 + 0x0800 + (t >> 2) + ((size_t)*ip++ << 2), 3)) return false;
+                t = ip[-2] & 3;
+                state = t ? MatchNext : Loop;
+                break;
+            case Match: {
+                size_t dist = 0, len = 0;
+                if (t >= 64) { // M2: length 3-8, up to 2 KiB back
+                    if (!have(1)) return false;
+                    dist = 1 + ((t >> 2) & 7) + ((size_t)*ip++ << 3);
+                    len = (t >> 5) + 1;
+                } else if (t >= 32) { // M3: up to 16 KiB back
+                    len = t & 31;
+                    if (len == 0 && !extended(31, len)) return false;
+                    if (!have(2)) return false;
+                    dist = 1 + (ip[0] >> 2) + ((size_t)ip[1] << 6);
+                    ip += 2;
+                    len += 2;
+                } else if (t >= 16) { // M4: up to 48 KiB back; distance 0 ends the stream
+                    const size_t high = (t & 8) << 11;
+                    len = t & 7;
+                    if (len == 0 && !extended(7, len)) return false;
+                    if (!have(2)) return false;
+                    const size_t d = high + (ip[0] >> 2) + ((size_t)ip[1] << 6);
+                    ip += 2;
+                    if (d == 0) return finish((size_t)(op - out), out_cap, produced);
+                    dist = d + 0x4000;
+                    len += 2;
+                } else { // M1: two bytes, up to 1 KiB back
+                    if (!have(1)) return false;
+                    dist = 1 + (t >> 2) + ((size_t)*ip++ << 2);
+                    len = 2;
+                }
+                if (!match(dist, len)) return false;
+                t = ip[-2] & 3;
+                state = t ? MatchNext : Loop;
+                break;
+            }
+            case MatchNext:
+                if (!literals(t)) return false;
+                if (!have(1)) return false;
+                t = *ip++;
+                state = Match;
+                break;
+            }
+        }
+    }
+};
+
+const StoredBackend kStored;
+const ZlibBackend kZlib;
+const LzoBackend kLzo;
+#ifdef UNIDICT_HAVE_LIBDEFLATE
+const LibdeflateBackend kLibdeflate;
+#endif
+
+std::atomic<const BlockDecoderStd::Backend*> g_backends[3] = {nullptr, nullptr, nullptr};
+std::atomic<int> g_verify{-1}; // -1: not read from the environment yet
+
+// Greedy LZO1X encoder: a 3-byte hash finds the last occurrence, matches are
+// extended as far as they go and written as M2/M3/M4.
+std::string lzo_compress(const unsigned char* in, size_t n) {
+    constexpr size_t kNone = (size_t)-1;
+    constexpr size_t kMaxDist = 0xBFFF;
+    std::string out;
+    std::vector<size_t> table(1u << 14, kNone);
+    size_t state_pos = kNone; // byte of the last match carrying the count of 1-3 literals after it
+    size_t lit = 0;
+    auto put = [&](size_t b) { out.push_back((char)(unsigned char)b); };
+    auto put_extended = [&](size_t m) { // m >= 1
+        while (m > 255) { put(0); m -= 255; }
+        put(m);
+    };
+    auto flush = [&](size_t end) {
+        const size_t count = end - lit;
+        if (count == 0) return;
+        if (out.empty() && count <= 238) put(17 + count);
+        else if (count <= 3) out[state_pos] = (char)((unsigned char)out[state_pos] | count);
+        else if (count - 3 <= 15) put(count - 3);
+        else { put(0); put_extended(count - 3 - 15); }
+        out.append(reinterpret_cast<const char*>(in) + lit, count);
+    };
+    size_t i = 0;
+    while (i + 3 <= n) {
+        const uint32_t h = (((uint32_t)in[i] << 16 | (uint32_t)in[i + 1] << 8 | in[i + 2]) * 2654435761u) >> 18;
+        const size_t cand = table[h];
+        table[h] = i;
+        if (cand == kNone || i - cand > kMaxDist || std::memcmp(in + cand, in + i, 3) != 0) { ++i; continue; }
+        size_t len = 3;
+        while (i + len < n && in[cand + len] == in[i + len]) ++len;
+        const size_t dist = i - cand;
+        flush(i);
+        if (len <= 8 && dist <= 0x0800) {
+            state_pos = out.size();
+            put(((len - 1) << 5) | (((dist - 1) & 7) << 2));
+            put((dist - 1) >> 3);
+        } else if (dist <= 0x4000) {
+            if (len - 2 <= 31) put(32 | (len - 2));
+            else { put(32); put_extended(len - 2 - 31); }
+            state_pos = out.size();
+            put(((dist - 1) & 63) << 2);
+            put((dist - 1) >> 6);
+        } else {
+            const size_t d = dist - 0x4000;
+            const size_t high = (d >> 11) & 8;
+            if (len - 2 <= 7) put(16 | high | (len - 2));
+            else { put(16 | high); put_extended(len - 2 - 7); }
+            state_pos = out.size();
+            put((d & 63) << 2);
+            put((d >> 6) & 0xFF);
+        }
+        i += len;
+        lit = i;
+    }
+    flush(n);
+    put(0x11); put(0); put(0); // end of stream: M4 with distance 0
+    return out;
+}
+
+} // namespace
+
+const BlockDecoderStd::Backend& BlockDecoderStd::stored() { return kStored; }
+const BlockDecoderStd::Backend& BlockDecoderStd::zlib() { return kZlib; }
+const BlockDecoderStd::Backend& BlockDecoderStd::lzo() { return kLzo; }
+
+const BlockDecoderStd::Backend* BlockDecoderStd::libdeflate() {
+#ifdef UNIDICT_HAVE_LIBDEFLATE
+    return &kLibdeflate;
+#else
+    return nullptr;
+#endif
+}
+
+const BlockDecoderStd::Backend* BlockDecoderStd::backend(uint32_t type) {
+    if (type > Zlib) return nullptr;
+    if (const Backend* b = g_backends[type].load()) return b;
+    switch (type) {
+    case Stored: return &kStored;
+    case Lzo: return &kLzo;
+    default: return libdeflate() ? libdeflate() : &kZlib;
+    }
+}
+
+void BlockDecoderStd::set_backend(uint32_t type, const Backend* backend) {
+    if (type <= Zlib) g_backends[type].store(backend);
+}
+
+void BlockDecoderStd::set_verify_checksums(bool on) { g_verify.store(on ? 1 : 0); }
+
+bool BlockDecoderStd::verify_checksums() {
+    int v = g_verify.load();
+    if (v < 0) {
+        const char* env = std::getenv("UNIDICT_MDICT_VERIFY");
+        v = (env && std::strcmp(env, "0") == 0) ? 0 : 1;
+        int expected = -1;
+        g_verify.compare_exchange_strong(expected, v);
+        v = g_verify.load();
+    }
+    return v == 1;
+}
+
+bool BlockDecoderStd::decode(const unsigned char* block, size_t block_len, size_t decomp_size, std::string& out) {
+    if (block_len < 8) return false;
+    const uint32_t type = le32(block);
+    const Backend* b = backend(type);
+    if (!b) return false;
+    out.resize(decomp_size);
+    if (!b->decompress(block + 8, block_len - 8, reinterpret_cast<unsigned char*>(out.data()), decomp_size)) return false;
+    if (type != Zlib && verify_checksums()) {
+        const uint32_t sum = (uint32_t)adler32(adler32(0, nullptr, 0), reinterpret_cast<const Bytef*>(out.data()), (uInt)out.size());
+        if (sum != be32(block + 4)) return false;
+    }
+    return true;
+}
+
+bool BlockDecoderStd::inflate(const unsigned char* in, size_t in_len, size_t max_out, std::string& out) {
+    const Backend* b = backend(Zlib);
+    // One-shot needs room for the whole result: grow until it fits or max_out is reached
+    size_t cap = in_len * 4 < 64 * 1024 ? 64 * 1024 : in_len * 4;
+    for (;;) {
+        if (cap > max_out) cap = max_out;
+        out.resize(cap);
+        size_t got = 0;
+        if (b->decompress(in, in_len, reinterpret_cast<unsigned char*>(out.data()), cap, &got)) {
+            out.resize(got);
+            return true;
+        }
+        if (cap == max_out) { out.clear(); return false; }
+        cap *= 2;
+    }
+}
+
+std::string BlockDecoderStd::encode(uint32_t type, std::string_view data) {
+    std::string out(8, '\0');
+    for (int i = 0; i < 4; ++i) out[i] = (char)((type >> (8 * i)) & 0xFF);
+    const uint32_t sum = (uint32_t)adler32(adler32(0, nullptr, 0), reinterpret_cast<const Bytef*>(data.data()), (uInt)data.size());
+    for (int i = 0; i < 4; ++i) out[4 + i] = (char)((sum >> (8 * (3 - i))) & 0xFF);
+    if (type == Lzo) {
+        out += lzo_compress(reinterpret_cast<const unsigned char*>(data.data()), data.size());
+    } else if (type == Zlib) {
+        uLongf n = compressBound((uLong)data.size());
+        std::string z(n, '\0');
+        compress2(reinterpret_cast<Bytef*>(z.data()), &n, reinterpret_cast<const Bytef*>(data.data()), (uLong)data.size(), 6);
+        z.resize(n);
+        out += z;
+    } else {
+        out += data;
+    }
+    return out;
+}
+
+} // namespace UnidictCoreStd
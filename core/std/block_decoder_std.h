@@ -0,0 +1,62 @@
+// Decoders for the compressed blocks of MDict files (std-only).
+// A block is u32 type (LE: 0 stored, 1 LZO, 2 zlib), u32 Adler-32 of the
+// decoded data (BE), then the payload; its decoded size is known from the
+// block tables, so every backend decodes in one shot into a buffer of that
+// size. zlib goes through libdeflate when the build found it, through zlib's
+// one-shot uncompress otherwise; LZO1X is decoded by a built-in decoder.
+// Backends can be replaced per type (set_backend), e.g. to plug in a faster
+// or instrumented implementation.
+
+#ifndef UNIDICT_BLOCK_DECODER_STD_H
+#define UNIDICT_BLOCK_DECODER_STD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace UnidictCoreStd {
+
+class BlockDecoderStd {
+public:
+    enum Type : uint32_t { Stored = 0, Lzo = 1, Zlib = 2 };
+
+    class Backend {
+    public:
+        virtual ~Backend() = default;
+        virtual const char* name() const = 0;
+        // Decode in into out[0, out_cap). With produced, a shorter result is
+        // accepted and its size stored there; without, it must fill out_cap.
+        virtual bool decompress(const unsigned char* in, size_t in_len, unsigned char* out, size_t out_cap,
+                                size_t* produced = nullptr) const = 0;
+    };
+
+    // Built-in backends. libdeflate() is null unless the build found libdeflate.
+    static const Backend& stored();
+    static const Backend& zlib();
+    static const Backend* libdeflate();
+    static const Backend& lzo();
+
+    // Backend used for a block type (null if unknown). set_backend(type, nullptr)
+    // restores the built-in one; the backend must outlive its use.
+    static const Backend* backend(uint32_t type);
+    static void set_backend(uint32_t type, const Backend* backend);
+
+    // Check the block's Adler-32 after decoding (default on; UNIDICT_MDICT_VERIFY=0
+    // turns it off). zlib blocks are always covered by the stream's own checksum.
+    static void set_verify_checksums(bool on);
+    static bool verify_checksums();
+
+    // Decode a whole block of decomp_size bytes into out.
+    static bool decode(const unsigned char* block, size_t block_len, size_t decomp_size, std::string& out);
+    // Inflate a zlib stream of unknown decoded size, up to max_out bytes.
+    static bool inflate(const unsigned char* in, size_t in_len, size_t max_out, std::string& out);
+
+    // Build a block of the given type (zlib level 6, greedy LZO1X), for writing
+    // fixtures and benchmarks.
+    static std::string encode(uint32_t type, std::string_view data);
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_BLOCK_DECODER_STD_H
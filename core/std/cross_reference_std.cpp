@@ -7,6 +7,7 @@
 #include <ctime>
 #include <fstream>
 #include <cstring>
+#include <iomanip>
 
 namespace UnidictCoreStd {
 
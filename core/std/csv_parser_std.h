@@ -5,6 +5,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "headword_view_std.h"
+
 namespace UnidictCoreStd {
 
 // CSV/TSV parser for simple tab or comma-separated dictionary files
@@ -23,6 +25,8 @@ public:
     std::string lookup(const std::string& word) const;
     std::vector<std::string> find_similar(const std::string& word, int max_results) const;
     std::vector<std::string> all_words() const;
+    // Non-owning view of the same list; valid while the parser is alive and not reloaded.
+    HeadwordViewStd headwords() const { return HeadwordViewStd(words_); }
 
 private:
     char detect_separator(const std::string& line) const;
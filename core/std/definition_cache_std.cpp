@@ -0,0 +1,245 @@
+#include "definition_cache_std.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace UnidictCoreStd {
+
+namespace {
+
+// Per-entry bookkeeping on top of key and value bytes (list node, map slot).
+constexpr size_t kEntryOverhead = 96;
+// Average entry size assumed when sizing the frequency sketch.
+constexpr size_t kTypicalEntry = 256;
+
+uint64_t mix(uint64_t h) {
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace
+
+void DefinitionCacheStd::Sketch::reset(size_t expected_entries) {
+    size_t width = 64;
+    while (width < expected_entries && width < (size_t(1) << 22)) width <<= 1;
+    table.assign(width, 0);
+    mask = width - 1;
+    additions = 0;
+    sample = width * 10;
+}
+
+unsigned DefinitionCacheStd::Sketch::estimate(uint64_t h) const {
+    unsigned m = 15;
+    for (uint64_t i = 0; i < 4; ++i) m = std::min<unsigned>(m, table[mix(h + i * 0x9e3779b97f4a7c15ULL) & mask]);
+    return m;
+}
+
+void DefinitionCacheStd::Sketch::increment(uint64_t h) {
+    // Conservative update: only the counters at the current minimum grow
+    const unsigned m = estimate(h);
+    if (m >= 15) return;
+    for (uint64_t i = 0; i < 4; ++i) {
+        uint8_t& c = table[mix(h + i * 0x9e3779b97f4a7c15ULL) & mask];
+        if (c == m) ++c;
+    }
+    if (++additions >= sample) {
+        for (auto& c : table) c >>= 1;
+        additions /= 2;
+    }
+}
+
+DefinitionCacheStd::DefinitionCacheStd(size_t capacity_bytes, size_t shards) {
+    shards_.reserve(shards ? shards : 1);
+    for (size_t i = 0; i < (shards ? shards : 1); ++i) shards_.emplace_back(new Shard());
+    set_capacity(capacity_bytes);
+}
+
+std::string DefinitionCacheStd::make_key(uint64_t dict, std::string_view word) {
+    std::string k;
+    k.reserve(8 + word.size());
+    for (int i = 0; i < 8; ++i) k.push_back((char)((dict >> (8 * i)) & 0xFF));
+    k.append(word.data(), word.size());
+    return k;
+}
+
+void DefinitionCacheStd::configure(Shard& s, size_t capacity) {
+    s.capacity = capacity;
+    s.window_capacity = capacity / 100; // 1% window, as in W-TinyLFU
+    s.protected_capacity = (capacity - s.window_capacity) * 8 / 10;
+    s.sketch.reset(capacity / kTypicalEntry);
+}
+
+void DefinitionCacheStd::move_to(Shard& s, List::iterator it, Segment seg) {
+    s.bytes[it->seg] -= it->cost;
+    s.bytes[seg] += it->cost;
+    s.lists[seg].splice(s.lists[seg].begin(), s.lists[it->seg], it);
+    it->seg = seg;
+}
+
+void DefinitionCacheStd::erase(Shard& s, List::iterator it) {
+    s.bytes[it->seg] -= it->cost;
+    s.map.erase(std::string_view(it->key));
+    s.lists[it->seg].erase(it);
+}
+
+void DefinitionCacheStd::evict(Shard& s) {
+    const size_t main_capacity = s.capacity - s.window_capacity;
+    auto main_bytes = [&s]() { return s.bytes[Probation] + s.bytes[Protected]; };
+    while (s.bytes[Window] > s.window_capacity && !s.lists[Window].empty()) {
+        auto cand = std::prev(s.lists[Window].end());
+        if (cand->cost > main_capacity) { erase(s, cand); ++s.rejections; continue; }
+        if (main_bytes() + cand->cost > main_capacity) {
+            // Compare against the entry that would go first; ties favour the resident
+            List& from = s.lists[Probation].empty() ? s.lists[Protected] : s.lists[Probation];
+            const auto victim = std::prev(from.end());
+            if (s.sketch.estimate(cand->hash) <= s.sketch.estimate(victim->hash)) {
+                erase(s, cand);
+                ++s.rejections;
+                continue;
+            }
+        }
+        move_to(s, cand, Probation);
+        ++s.admissions;
+        while (main_bytes() > main_capacity) {
+            List& from = s.lists[Probation].size() > 1 ? s.lists[Probation] : s.lists[Protected];
+            if (from.empty()) break;
+            erase(s, std::prev(from.end()));
+            ++s.evictions;
+        }
+    }
+    while (s.bytes[Protected] > s.protected_capacity && !s.lists[Protected].empty())
+        move_to(s, std::prev(s.lists[Protected].end()), Probation);
+    // Only reachable when shrinking: the main area may still be over budget
+    while (main_bytes() > main_capacity) {
+        List& from = s.lists[Probation].empty() ? s.lists[Protected] : s.lists[Probation];
+        if (from.empty()) break;
+        erase(s, std::prev(from.end()));
+        ++s.evictions;
+    }
+}
+
+bool DefinitionCacheStd::get(uint64_t dict, std::string_view word, std::string* out) {
+    if (capacity_.load(std::memory_order_relaxed) == 0) return false;
+    const std::string key = make_key(dict, word);
+    const uint64_t h = std::hash<std::string_view>()(key);
+    Shard& s = shard_for(h);
+    std::lock_guard<std::mutex> lk(s.mu);
+    s.sketch.increment(h);
+    auto f = s.map.find(std::string_view(key));
+    if (f == s.map.end()) { ++s.misses; return false; }
+    ++s.hits;
+    auto it = f->second;
+    if (it->seg == Window) {
+        move_to(s, it, Window);
+    } else {
+        // A second hit in the main area makes the entry protected
+        move_to(s, it, Protected);
+        evict(s);
+    }
+    if (out) *out = it->value;
+    return true;
+}
+
+void DefinitionCacheStd::put(uint64_t dict, std::string_view word, const std::string& definition) {
+    if (capacity_.load(std::memory_order_relaxed) == 0) return;
+    std::string key = make_key(dict, word);
+    const uint64_t h = std::hash<std::string_view>()(key);
+    const size_t cost = key.size() + definition.size() + kEntryOverhead;
+    Shard& s = shard_for(h);
+    std::lock_guard<std::mutex> lk(s.mu);
+    if (cost > s.capacity) return; // would never fit
+    auto f = s.map.find(std::string_view(key));
+    if (f != s.map.end()) {
+        auto it = f->second;
+        s.bytes[it->seg] -= it->cost;
+        it->value = definition;
+        it->cost = cost;
+        s.bytes[it->seg] += cost;
+        evict(s);
+        return;
+    }
+    Node n;
+    n.key = std::move(key);
+    n.value = definition;
+    n.dict = dict;
+    n.hash = h;
+    n.cost = cost;
+    s.lists[Window].push_front(std::move(n));
+    auto it = s.lists[Window].begin();
+    s.bytes[Window] += cost;
+    s.map.emplace(std::string_view(it->key), it);
+    evict(s);
+}
+
+size_t DefinitionCacheStd::invalidate_dictionary(uint64_t dict) {
+    size_t n = 0;
+    for (auto& sp : shards_) {
+        Shard& s = *sp;
+        std::lock_guard<std::mutex> lk(s.mu);
+        for (auto& l : s.lists) {
+            for (auto it = l.begin(); it != l.end();) {
+                auto next = std::next(it);
+                if (it->dict == dict) { erase(s, it); ++n; }
+                it = next;
+            }
+        }
+    }
+    return n;
+}
+
+void DefinitionCacheStd::clear() {
+    for (auto& sp : shards_) {
+        Shard& s = *sp;
+        std::lock_guard<std::mutex> lk(s.mu);
+        s.map.clear();
+        for (int i = 0; i < 3; ++i) { s.lists[i].clear(); s.bytes[i] = 0; }
+        s.sketch.reset(s.capacity / kTypicalEntry);
+    }
+}
+
+void DefinitionCacheStd::set_capacity(size_t capacity_bytes) {
+    capacity_ = capacity_bytes;
+    const size_t per_shard = capacity_bytes / shards_.size();
+    for (auto& sp : shards_) {
+        Shard& s = *sp;
+        std::lock_guard<std::mutex> lk(s.mu);
+        configure(s, per_shard);
+        if (per_shard == 0) {
+            s.map.clear();
+            for (int i = 0; i < 3; ++i) { s.lists[i].clear(); s.bytes[i] = 0; }
+        } else {
+            evict(s);
+        }
+    }
+}
+
+DefinitionCacheStd::Stats DefinitionCacheStd::stats() const {
+    Stats st;
+    st.capacity_bytes = capacity_;
+    for (const auto& sp : shards_) {
+        Shard& s = *sp;
+        std::lock_guard<std::mutex> lk(s.mu);
+        st.hits += s.hits;
+        st.misses += s.misses;
+        st.admissions += s.admissions;
+        st.rejections += s.rejections;
+        st.evictions += s.evictions;
+        st.entries += s.map.size();
+        st.bytes += s.bytes[Window] + s.bytes[Probation] + s.bytes[Protected];
+    }
+    const uint64_t total = st.hits + st.misses;
+    st.hit_rate = total ? (double)st.hits / (double)total : 0.0;
+    return st;
+}
+
+void DefinitionCacheStd::reset_stats() {
+    for (auto& sp : shards_) {
+        Shard& s = *sp;
+        std::lock_guard<std::mutex> lk(s.mu);
+        s.hits = s.misses = s.admissions = s.rejections = s.evictions = 0;
+    }
+}
+
+} // namespace UnidictCoreStd
@@ -0,0 +1,109 @@
+// Sharded, byte-bounded cache of dictionary definitions (std-only, thread-safe).
+// Entries are keyed by (dictionary id, headword). Admission follows W-TinyLFU:
+// new entries land in a small LRU window, and an entry leaving the window only
+// enters the main segmented LRU when a count-min sketch of recent accesses says
+// it is used more often than the entry it would evict. A one-off pass over many
+// words (full-text results, word lists) therefore cannot flush the hot words.
+
+#ifndef UNIDICT_DEFINITION_CACHE_STD_H
+#define UNIDICT_DEFINITION_CACHE_STD_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace UnidictCoreStd {
+
+class DefinitionCacheStd {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t admissions = 0;  // window entries promoted into the main area
+        uint64_t rejections = 0;  // window entries dropped by the frequency filter
+        uint64_t evictions = 0;   // main-area entries evicted for admitted ones
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t capacity_bytes = 0;
+        double hit_rate = 0.0;    // hits / (hits + misses)
+    };
+
+    // capacity_bytes is split evenly across shards; 0 disables the cache.
+    explicit DefinitionCacheStd(size_t capacity_bytes = 16u * 1024u * 1024u, size_t shards = 16);
+    DefinitionCacheStd(const DefinitionCacheStd&) = delete;
+    DefinitionCacheStd& operator=(const DefinitionCacheStd&) = delete;
+
+    // Copies the cached definition into *out; false on a miss (or when disabled).
+    bool get(uint64_t dict, std::string_view word, std::string* out);
+    void put(uint64_t dict, std::string_view word, const std::string& definition);
+    // Drop every entry of one dictionary (reloaded or removed).
+    size_t invalidate_dictionary(uint64_t dict);
+    void clear();
+
+    // Resize; shrinking evicts at once and 0 disables (and empties) the cache.
+    void set_capacity(size_t capacity_bytes);
+    size_t capacity() const { return capacity_; }
+    Stats stats() const;
+    void reset_stats();
+
+private:
+    enum Segment : uint8_t { Window = 0, Probation = 1, Protected = 2 };
+    struct Node {
+        std::string key; // 8-byte dictionary id followed by the headword
+        std::string value;
+        uint64_t dict = 0;
+        uint64_t hash = 0;
+        size_t cost = 0;
+        Segment seg = Window;
+    };
+    using List = std::list<Node>;
+
+    // Count-min sketch with four 4-bit-range counters per key, halved every
+    // sample_ increments so that old popularity fades.
+    struct Sketch {
+        std::vector<uint8_t> table;
+        size_t mask = 0;
+        size_t additions = 0;
+        size_t sample = 0;
+        void reset(size_t expected_entries);
+        unsigned estimate(uint64_t h) const;
+        void increment(uint64_t h);
+    };
+
+    struct Shard {
+        std::mutex mu;
+        List lists[3];
+        size_t bytes[3] = {0, 0, 0};
+        // Views into Node::key; list nodes never move, even when spliced
+        std::unordered_map<std::string_view, List::iterator> map;
+        Sketch sketch;
+        size_t capacity = 0;
+        size_t window_capacity = 0;
+        size_t protected_capacity = 0;
+        uint64_t hits = 0, misses = 0, admissions = 0, rejections = 0, evictions = 0;
+    };
+
+    static std::string make_key(uint64_t dict, std::string_view word);
+    Shard& shard_for(uint64_t hash) { return *shards_[(hash >> 32) % shards_.size()]; }
+    void configure(Shard& s, size_t capacity);
+    // Move it to the front of list seg (caller holds the shard lock).
+    static void move_to(Shard& s, List::iterator it, Segment seg);
+    static void erase(Shard& s, List::iterator it);
+    // Rebalance after an insert or a resize: overflow of the window competes for
+    // the main area, overflow of the protected segment is demoted to probation.
+    static void evict(Shard& s);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<size_t> capacity_{0};
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_DEFINITION_CACHE_STD_H
@@ -0,0 +1,293 @@
+#include "dict_snapshot_std.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace UnidictCoreStd {
+
+namespace {
+
+constexpr char kMagic[8] = {'U','D','S','N','A','P','2','\0'};
+constexpr uint32_t kEndianTag = 0x01020304u;
+
+// Fixed header; every section offset is 8-byte aligned and relative to file start.
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t endian;
+    uint32_t kind;
+    uint64_t count;
+    uint64_t file_size;
+    uint64_t fp_off, fp_len;
+    uint64_t name_off, name_len;
+    uint64_t desc_off, desc_len;
+    uint64_t path_off, path_len;
+    uint64_t syn_off, syn_len;  // StarDict .syn path (empty if none)
+    uint64_t word_offs;     // u64[count + 1] into the word blob
+    uint64_t word_blob;
+    uint64_t sorted;        // u32[count], indices ordered by headword bytes
+    uint64_t lower_sorted;  // u32[count], ordered case-insensitively (DSL/CSV only, else 0)
+    uint64_t val_offs;      // u64[count + 1] into the value blob (non-StarDict)
+    uint64_t val_blob;
+    uint64_t loc_off;       // u64[count] (StarDict)
+    uint64_t loc_size;      // u32[count] (StarDict)
+};
+
+inline uint64_t align8(uint64_t v) { return (v + 7) & ~uint64_t(7); }
+
+inline uint64_t fnv1a64(const std::string& s) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : s) { h ^= c; h *= 1099511628211ULL; }
+    return h;
+}
+
+int ci_compare(std::string_view a, std::string_view b) {
+    const size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; ++i) {
+        int ca = std::tolower((unsigned char)a[i]), cb = std::tolower((unsigned char)b[i]);
+        if (ca != cb) return ca < cb ? -1 : 1;
+    }
+    if (a.size() == b.size()) return 0;
+    return a.size() < b.size() ? -1 : 1;
+}
+
+bool case_insensitive_kind(DictSnapshotStd::Kind k) {
+    return k == DictSnapshotStd::Kind::Dsl || k == DictSnapshotStd::Kind::Csv;
+}
+
+} // namespace
+
+std::string DictSnapshotStd::fingerprint(const std::vector<std::string>& src_paths) {
+    std::string fp = "v1;";
+    for (const auto& p : src_paths) {
+        std::error_code ec;
+        fs::path abs = fs::absolute(p, ec);
+        fp += (ec ? p : abs.string());
+        auto sz = fs::file_size(p, ec);
+        if (ec) { fp += "|missing;"; continue; }
+        auto ts = fs::last_write_time(p, ec).time_since_epoch().count();
+        fp += '|' + std::to_string((unsigned long long)sz) + '|' + std::to_string((long long)ts) + ';';
+    }
+    return fp;
+}
+
+std::string DictSnapshotStd::snapshot_path(const std::string& dir, const std::string& source_path) {
+    std::error_code ec;
+    fs::path abs = fs::absolute(source_path, ec);
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)fnv1a64(ec ? source_path : abs.string()));
+    return (fs::path(dir) / (std::string("snap_") + hex + ".bin")).string();
+}
+
+bool DictSnapshotStd::write(const std::string& file, const std::string& fp, const Data& d) {
+    const uint64_t n = d.words.size();
+    const bool stardict = d.kind == Kind::StarDict;
+    if (stardict ? d.locations.size() != n : d.values.size() != n) return false;
+
+    SnapshotHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.endian = kEndianTag;
+    h.kind = (uint32_t)d.kind;
+    h.count = n;
+    uint64_t pos = align8(sizeof(SnapshotHeader));
+    auto place = [&](uint64_t bytes) { uint64_t at = pos; pos = align8(pos + bytes); return at; };
+    h.fp_off = place(h.fp_len = fp.size());
+    h.name_off = place(h.name_len = d.name.size());
+    h.desc_off = place(h.desc_len = d.description.size());
+    h.path_off = place(h.path_len = d.data_path.size());
+    h.syn_off = place(h.syn_len = d.syn_path.size());
+    uint64_t word_bytes = 0;
+    for (const auto& w : d.words) word_bytes += w.size();
+    h.word_offs = place((n + 1) * 8);
+    h.word_blob = place(word_bytes);
+    h.sorted = place(n * 4);
+    if (case_insensitive_kind(d.kind)) h.lower_sorted = place(n * 4);
+    if (stardict) {
+        h.loc_off = place(n * 8);
+        h.loc_size = place(n * 4);
+    } else {
+        uint64_t val_bytes = 0;
+        for (const auto& v : d.values) val_bytes += v.size();
+        h.val_offs = place((n + 1) * 8);
+        h.val_blob = place(val_bytes);
+    }
+    h.file_size = pos;
+
+    std::vector<uint32_t> sorted(n), lower;
+    std::iota(sorted.begin(), sorted.end(), 0u);
+    std::stable_sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b){ return d.words[a] < d.words[b]; });
+    if (h.lower_sorted) {
+        lower = sorted;
+        std::stable_sort(lower.begin(), lower.end(), [&](uint32_t a, uint32_t b){ return ci_compare(d.words[a], d.words[b]) < 0; });
+    }
+
+    // Per-thread temp name: the same dictionary may be loaded by two workers at once
+    const std::string tmp = file + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        uint64_t at = 0;
+        auto pad_to = [&](uint64_t off) { static const char z[8] = {0}; while (at < off) { uint64_t k = std::min<uint64_t>(8, off - at); out.write(z, (std::streamsize)k); at += k; } };
+        auto put = [&](uint64_t off, const void* p, uint64_t len) { pad_to(off); if (len) out.write((const char*)p, (std::streamsize)len); at += len; };
+        put(0, &h, sizeof(h));
+        put(h.fp_off, fp.data(), fp.size());
+        put(h.name_off, d.name.data(), d.name.size());
+        put(h.desc_off, d.description.data(), d.description.size());
+        put(h.path_off, d.data_path.data(), d.data_path.size());
+        put(h.syn_off, d.syn_path.data(), d.syn_path.size());
+        pad_to(h.word_offs);
+        uint64_t acc = 0;
+        for (const auto& w : d.words) { put(at, &acc, 8); acc += w.size(); }
+        put(at, &acc, 8);
+        pad_to(h.word_blob);
+        for (const auto& w : d.words) put(at, w.data(), w.size());
+        put(h.sorted, sorted.data(), n * 4);
+        if (h.lower_sorted) put(h.lower_sorted, lower.data(), n * 4);
+        if (stardict) {
+            pad_to(h.loc_off);
+            for (const auto& l : d.locations) put(at, &l.first, 8);
+            pad_to(h.loc_size);
+            for (const auto& l : d.locations) put(at, &l.second, 4);
+        } else {
+            pad_to(h.val_offs);
+            acc = 0;
+            for (const auto& v : d.values) { put(at, &acc, 8); acc += v.size(); }
+            put(at, &acc, 8);
+            pad_to(h.val_blob);
+            for (const auto& v : d.values) put(at, v.data(), v.size());
+        }
+        pad_to(h.file_size);
+        out.flush();
+        if (!out) { out.close(); std::error_code ec; fs::remove(tmp, ec); return false; }
+    }
+    std::error_code ec;
+    fs::rename(tmp, file, ec);
+    if (ec) { fs::remove(file, ec); ec.clear(); fs::rename(tmp, file, ec); }
+    if (ec) { fs::remove(tmp, ec); return false; }
+    return true;
+}
+
+bool DictSnapshotStd::attach(const std::string& file, const std::string& fp, bool private_copy) {
+    *this = DictSnapshotStd();
+    MappedFileStd mf;
+    if (!mf.open(file) || mf.size() < sizeof(SnapshotHeader)) return false;
+    SnapshotHeader h;
+    std::memcpy(&h, mf.data(), sizeof(h));
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.endian != kEndianTag) return false;
+    if (h.kind < (uint32_t)Kind::Json || h.kind > (uint32_t)Kind::Csv) return false;
+    if (h.file_size != mf.size() || h.count > 0xFFFFFFFFull) return false;
+    const uint64_t size = mf.size(), n = h.count;
+    auto in_bounds = [&](uint64_t off, uint64_t len) { return off % 8 == 0 && off <= size && len <= size - off; };
+    const bool stardict = (Kind)h.kind == Kind::StarDict;
+    if (!in_bounds(h.fp_off, h.fp_len) || !in_bounds(h.name_off, h.name_len) || !in_bounds(h.desc_off, h.desc_len) ||
+        !in_bounds(h.path_off, h.path_len) || !in_bounds(h.syn_off, h.syn_len) || !in_bounds(h.word_offs, (n + 1) * 8) || !in_bounds(h.sorted, n * 4))
+        return false;
+    if (h.lower_sorted && !in_bounds(h.lower_sorted, n * 4)) return false;
+    if (stardict ? (!in_bounds(h.loc_off, n * 8) || !in_bounds(h.loc_size, n * 4)) : !in_bounds(h.val_offs, (n + 1) * 8))
+        return false;
+    const char* base = mf.data();
+    if (std::string_view(base + h.fp_off, h.fp_len) != fp) return false; // stale
+
+    // Structural checks (one pass, no allocation) so lookups can trust the tables
+    auto offs_ok = [&](const uint64_t* offs, uint64_t blob) {
+        if (offs[0] != 0) return false;
+        for (uint64_t i = 0; i < n; ++i) if (offs[i + 1] < offs[i]) return false;
+        return blob <= size && offs[n] <= size - blob;
+    };
+    const uint64_t* wo = reinterpret_cast<const uint64_t*>(base + h.word_offs);
+    if (!offs_ok(wo, h.word_blob)) return false;
+    const uint32_t* so = reinterpret_cast<const uint32_t*>(base + h.sorted);
+    for (uint64_t i = 0; i < n; ++i) if (so[i] >= n) return false;
+    const uint32_t* lo = h.lower_sorted ? reinterpret_cast<const uint32_t*>(base + h.lower_sorted) : nullptr;
+    if (lo) for (uint64_t i = 0; i < n; ++i) if (lo[i] >= n) return false;
+
+    if (stardict) {
+        std::string data_path(base + h.path_off, h.path_len);
+        const bool dz = data_path.size() > 3 && data_path.compare(data_path.size() - 3, 3, ".dz") == 0;
+        if (dz) {
+            data_dz_ = std::make_unique<DictzipReaderStd>();
+            if (!data_dz_->open(data_path) || !data_dz_->random_access()) { data_dz_.reset(); return false; }
+        } else if (!data_file_.open(data_path, private_copy)) {
+            return false; // e.g. decompressed .dict.dz pruned from cache
+        } else {
+            data_file_.advise(MappedFileStd::Access::Random);
+        }
+        // The fingerprint covers the .syn, so it is the one the snapshot was made from
+        if (h.syn_len && !syn_.open(std::string(base + h.syn_off, h.syn_len), (size_t)n, private_copy)) return false;
+        loc_off_ = reinterpret_cast<const uint64_t*>(base + h.loc_off);
+        loc_size_ = reinterpret_cast<const uint32_t*>(base + h.loc_size);
+    } else {
+        val_offs_ = reinterpret_cast<const uint64_t*>(base + h.val_offs);
+        if (!offs_ok(val_offs_, h.val_blob)) { data_file_.close(); return false; }
+        val_blob_ = base + h.val_blob;
+    }
+    kind_ = (Kind)h.kind;
+    name_.assign(base + h.name_off, h.name_len);
+    description_.assign(base + h.desc_off, h.desc_len);
+    count_ = (size_t)n;
+    word_offs_ = wo;
+    word_blob_ = base + h.word_blob;
+    sorted_ = so;
+    lower_sorted_ = lo;
+    file_ = std::move(mf); // mapping address is unchanged by the move
+    return true;
+}
+
+std::string_view DictSnapshotStd::word(size_t i) const {
+    if (i >= count_) return {};
+    return std::string_view(word_blob_ + word_offs_[i], (size_t)(word_offs_[i + 1] - word_offs_[i]));
+}
+
+HeadwordViewStd DictSnapshotStd::headwords() const {
+    return HeadwordViewStd(this, count_, [](const void* self, size_t i) {
+        return static_cast<const DictSnapshotStd*>(self)->word(i);
+    });
+}
+
+std::string_view DictSnapshotStd::value(size_t i) const {
+    if (kind_ == Kind::StarDict) {
+        const uint64_t off = loc_off_[i];
+        const uint32_t sz = loc_size_[i];
+        if (off > data_file_.size() || sz > data_file_.size() - off) return {};
+        return std::string_view(data_file_.data() + off, sz);
+    }
+    return std::string_view(val_blob_ + val_offs_[i], (size_t)(val_offs_[i + 1] - val_offs_[i]));
+}
+
+bool DictSnapshotStd::find(std::string_view w, size_t& index) const {
+    if (!sorted_) return false;
+    const uint32_t* first = sorted_;
+    const uint32_t* last = sorted_ + count_;
+    auto it = std::lower_bound(first, last, w, [this](uint32_t i, std::string_view key){ return word(i) < key; });
+    if (it != last && word(*it) == w) { index = *it; return true; }
+    if (!lower_sorted_) return false;
+    first = lower_sorted_; last = lower_sorted_ + count_;
+    it = std::lower_bound(first, last, w, [this](uint32_t i, std::string_view key){ return ci_compare(word(i), key) < 0; });
+    if (it != last && ci_compare(word(*it), w) == 0) { index = *it; return true; }
+    return false;
+}
+
+std::string DictSnapshotStd::lookup(const std::string& w) const {
+    size_t i = 0;
+    if (!find(w, i)) {
+        uint32_t e = 0;
+        if (kind_ != Kind::StarDict || !syn_.find(w, e)) return {};
+        i = e;
+    }
+    if (kind_ == Kind::StarDict && data_dz_) {
+        std::string out;
+        if (!data_dz_->read(loc_off_[i], loc_size_[i], out)) return {};
+        return out;
+    }
+    return std::string(value(i));
+}
+
+} // namespace UnidictCoreStd
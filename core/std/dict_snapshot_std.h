@@ -0,0 +1,91 @@
+// Binary load snapshot of a parsed dictionary (std-only).
+// Stores the headword list (in load order), a sorted permutation for binary
+// search and either definition texts or StarDict (offset, size) pairs (plus the
+// path of a StarDict .syn, mapped again on attach), laid out
+// so a warm start maps the file and serves lookups without reparsing sources.
+// Snapshots carry a fingerprint of their source files (path/size/mtime) and
+// are ignored once any of them changes.
+
+#ifndef UNIDICT_DICT_SNAPSHOT_STD_H
+#define UNIDICT_DICT_SNAPSHOT_STD_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "dictzip_reader_std.h"
+#include "headword_view_std.h"
+#include "mapped_file_std.h"
+#include "stardict_synonyms_std.h"
+
+namespace UnidictCoreStd {
+
+class DictSnapshotStd {
+public:
+    enum class Kind : uint32_t { Json = 1, StarDict = 2, Mdict = 3, Dsl = 4, Csv = 5 };
+
+    // Contents captured from a freshly parsed dictionary.
+    struct Data {
+        Kind kind = Kind::Json;
+        std::string name;
+        std::string description;
+        HeadwordViewStd words;                                  // load order
+        std::vector<std::string> values;                        // definition per word (all kinds but StarDict)
+        std::vector<std::pair<uint64_t, uint32_t>> locations;   // StarDict: (offset, size) per word
+        std::string data_path;                                  // StarDict: file the locations refer to
+        std::string syn_path;                                   // StarDict: .syn, if any
+    };
+
+    // Fingerprint of the source files (path, size, mtime) a snapshot is valid for.
+    static std::string fingerprint(const std::vector<std::string>& src_paths);
+    // Snapshot file for a source path inside dir (one file per source path).
+    static std::string snapshot_path(const std::string& dir, const std::string& source_path);
+    // Write atomically (temp file + rename). Returns false on I/O errors.
+    static bool write(const std::string& file, const std::string& fingerprint, const Data& data);
+
+    // Map a snapshot; fails if it is missing, corrupt, or made for another fingerprint.
+    // private_copy reads the StarDict .dict and .syn it refers to into memory
+    // instead of mapping them (see MappedFileStd::open).
+    bool attach(const std::string& file, const std::string& fingerprint, bool private_copy = false);
+
+    Kind kind() const { return kind_; }
+    const std::string& name() const { return name_; }
+    const std::string& description() const { return description_; }
+    size_t word_count() const { return count_; }
+    std::string_view word(size_t i) const;
+    // Headwords straight from the mapping, valid while this snapshot is alive.
+    HeadwordViewStd headwords() const;
+    // StarDict synonyms (empty for other kinds or without a .syn).
+    HeadwordViewStd synonyms() const { return syn_.words(); }
+    // Exact headword lookup (DSL/CSV snapshots fall back to a case-insensitive match,
+    // like their parsers; StarDict ones to synonyms). Empty if not found.
+    std::string lookup(const std::string& word) const;
+
+private:
+    bool find(std::string_view w, size_t& index) const;
+    std::string_view value(size_t i) const;
+
+    MappedFileStd file_;
+    MappedFileStd data_file_; // StarDict definitions
+    std::unique_ptr<DictzipReaderStd> data_dz_; // StarDict definitions read in place from a .dict.dz
+    StarDictSynonymsStd syn_;
+    Kind kind_ = Kind::Json;
+    std::string name_;
+    std::string description_;
+    size_t count_ = 0;
+    const uint64_t* word_offs_ = nullptr;
+    const char* word_blob_ = nullptr;
+    const uint32_t* sorted_ = nullptr;
+    const uint32_t* lower_sorted_ = nullptr;
+    const uint64_t* val_offs_ = nullptr;
+    const char* val_blob_ = nullptr;
+    const uint64_t* loc_off_ = nullptr;
+    const uint32_t* loc_size_ = nullptr;
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_DICT_SNAPSHOT_STD_H
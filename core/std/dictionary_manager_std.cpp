@@ -1,8 +1,14 @@
 #include "dictionary_manager_std.h"
+#include "fulltext_query_std.h"
+#include "path_utils_std.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
 #include <filesystem>
 #include <sstream>
+#include <thread>
 
 namespace fs = std::filesystem;
 
@@ -10,7 +16,16 @@ namespace UnidictCoreStd {
 
 static inline std::string lcase(std::string s) { for (auto& c : s) c = (char)tolower((unsigned char)c); return s; }
 
+// Format extension, looking through a compressed .dsl.dz.
+static std::string format_ext(const std::string& path) {
+    const fs::path p(path);
+    const std::string ext = lcase(p.extension().string());
+    if (ext == ".dz" && lcase(p.stem().extension().string()) == ".dsl") return ".dsl";
+    return ext;
+}
+
 std::string DictionaryManagerStd::Holder::lookup(const std::string& w) const {
+    if (snapshot) return snapshot->lookup(w);
     if (json) return json->lookup(w);
     if (stardict) return stardict->lookup(w);
     if (mdict) return mdict->lookup(w);
@@ -19,34 +34,119 @@ std::string DictionaryManagerStd::Holder::lookup(const std::string& w) const {
     return {};
 }
 
+std::vector<std::string> DictionaryManagerStd::Holder::lookup_batch(const std::vector<std::string>& ws) const {
+    // StarDict and MDict read definitions from disk; the other formats answer from memory
+    if (stardict && !snapshot) return stardict->lookup_batch(ws);
+    if (mdict && !snapshot) return mdict->lookup_batch(ws);
+    std::vector<std::string> out;
+    out.reserve(ws.size());
+    for (const auto& w : ws) out.push_back(lookup(w));
+    return out;
+}
+
+bool DictionaryManagerStd::Holder::maps_sources() const {
+    if (private_copy) return false;
+    // Snapshots of other formats map only their own file in the cache
+    return stardict || mdict || (snapshot && snapshot->kind() == DictSnapshotStd::Kind::StarDict);
+}
+
 DictionaryManagerStd::DictionaryManagerStd() = default;
 
+DictionaryManagerStd::DictionaryManagerStd(std::shared_ptr<DictionaryRegistryStd> registry) : registry_(std::move(registry)) {}
+
+DictionaryManagerStd::~DictionaryManagerStd() {
+    stop_watching();
+    cancel_fulltext_build();
+    join_warmup();
+}
+
 bool DictionaryManagerStd::add_dictionary(const std::string& path) {
-    auto ext = lcase(fs::path(path).extension().string());
+    LoadOptions opts;
+    { auto lk = lock_shared(); opts = load_options(); }
     Holder h;
-    h.src_paths.push_back(path);
-    if (ext == ".json") {
-        auto p = std::make_shared<JsonParserStd>();
-        if (!p->load_dictionary(path)) return false;
-        h.json = p; h.name = p->name(); h.words = p->all_words();
-    } else if (ext == ".ifo") {
-        auto p = std::make_shared<StarDictParserStd>();
-        if (!p->load_dictionary(path)) return false;
-        h.stardict = p; h.name = p->dictionary_name(); h.words = p->all_words();
+    if (!load_holder(path, h, opts, nullptr, nullptr, registry_.get())) return false;
+    auto lk = lock_exclusive();
+    insert_holder(std::move(h));
+    return true;
+}
+
+std::vector<DictLoadReportStd> DictionaryManagerStd::add_dictionaries(const std::vector<std::string>& paths, int threads) {
+    LoadOptions opts;
+    { auto lk = lock_shared(); opts = load_options(); }
+    std::vector<DictLoadReportStd> reports;
+    std::vector<Holder> holders;
+    load_batch(paths, holders, reports, threads, opts, registry_.get());
+    // Register in input order so names, signature and index match a sequential load
+    auto lk = lock_exclusive();
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (reports[i].ok) insert_holder(std::move(holders[i]));
+    }
+    return reports;
+}
+
+void DictionaryManagerStd::load_batch(const std::vector<std::string>& paths, std::vector<Holder>& holders,
+                                      std::vector<DictLoadReportStd>& reports, int threads, const LoadOptions& opts,
+                                      DictionaryRegistryStd* registry) {
+    const size_t n = paths.size();
+    reports.assign(n, DictLoadReportStd{});
+    holders.clear(); holders.resize(n);
+    if (n == 0) return;
+    if (threads <= 0) {
+        unsigned int hc = std::thread::hardware_concurrency();
+        threads = (hc == 0) ? 1 : (int)hc;
+    }
+    if ((size_t)threads > n) threads = (int)n;
+
+    // Parse on workers; each claims the next unparsed path
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+            auto& r = reports[i];
+            r.path = paths[i];
+            const auto t0 = std::chrono::steady_clock::now();
+            try {
+                r.ok = load_holder(paths[i], holders[i], opts, &r.from_snapshot, &r.error, registry);
+            } catch (const std::exception& e) {
+                r.ok = false; r.error = e.what();
+            }
+            r.millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            if (r.ok) { r.name = holders[i].name; r.word_count = holders[i].words.size(); }
+        }
+    };
+    std::vector<std::thread> pool; pool.reserve(threads > 1 ? threads - 1 : 0);
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+}
+
+void DictionaryManagerStd::set_load_snapshots(bool enabled, const std::string& dir) {
+    auto lk = lock_exclusive();
+    if (!enabled) { snapshot_dir_.clear(); return; }
+    snapshot_dir_ = dir.empty() ? (fs::path(PathUtilsStd::cache_dir()) / "snapshots").string() : dir;
+}
+
+bool DictionaryManagerStd::load_snapshots_enabled() const {
+    auto lk = lock_shared();
+    return !snapshot_dir_.empty();
+}
+
+std::vector<std::string> DictionaryManagerStd::source_paths(const std::string& path) {
+    std::vector<std::string> out{path};
+    const auto ext = lcase(fs::path(path).extension().string());
+    if (ext == ".ifo") {
         // Companion files: .idx and .dict/.dict.dz next to .ifo
         fs::path base = fs::path(path);
         base.replace_extension("");
         fs::path idx = base; idx += ".idx";
         fs::path dict = base; dict += ".dict";
         fs::path dz = base; dz += ".dict.dz";
+        fs::path syn = base; syn += ".syn";
         std::error_code ec;
-        if (fs::exists(idx, ec)) h.src_paths.push_back(idx.string());
-        if (fs::exists(dict, ec)) h.src_paths.push_back(dict.string());
-        else if (fs::exists(dz, ec)) h.src_paths.push_back(dz.string());
+        if (fs::exists(idx, ec)) out.push_back(idx.string());
+        if (fs::exists(dict, ec)) out.push_back(dict.string());
+        else if (fs::exists(dz, ec)) out.push_back(dz.string());
+        if (fs::exists(syn, ec)) out.push_back(syn.string());
     } else if (ext == ".mdx") {
-        auto p = std::make_shared<MdictParserStd>();
-        if (!p->load_dictionary(path)) return false;
-        h.mdict = p; h.name = p->dictionary_name(); h.words = p->all_words();
         // Companion files: any .mdd with same stem
         fs::path mdx(path);
         fs::path dir = mdx.parent_path();
@@ -56,55 +156,614 @@ bool DictionaryManagerStd::add_dictionary(const std::string& path) {
             if (!de.is_regular_file()) continue;
             fs::path q = de.path();
             if (lcase(q.extension().string()) == ".mdd" && q.stem().string() == stem) {
-                h.src_paths.push_back(q.string());
+                out.push_back(q.string());
             }
         }
-    } else if (ext == ".dsl") {
+    }
+    return out;
+}
+
+bool DictionaryManagerStd::load_holder(const std::string& path, Holder& h, const LoadOptions& opts,
+                                       bool* from_snapshot, std::string* error, DictionaryRegistryStd* registry) {
+    h.private_copy = opts.private_copy;
+    if (!registry) return parse_holder(path, h, opts, from_snapshot, error);
+    if (from_snapshot) *from_snapshot = false;
+    std::error_code ec;
+    if (!fs::exists(path, ec)) { if (error) *error = "file not found"; return false; }
+    // Same file under another spelling of its path is the same entry
+    const fs::path canon = fs::weakly_canonical(fs::path(path), ec);
+    const std::string file = ec ? path : canon.string();
+    // A private copy is a separate entry from a mapping of the same files
+    const std::string key = file + (opts.private_copy ? "\n(private copy)" : "");
+    bool reused = false;
+    auto e = registry->acquire(key, DictSnapshotStd::fingerprint(source_paths(file)),
+                               [&](SharedDictionaryStd& out, std::string* err) {
+        Holder p;
+        if (!parse_holder(path, p, opts, &out.from_snapshot, err)) return false;
+        out.json = p.json; out.stardict = p.stardict; out.mdict = p.mdict;
+        out.dsl = p.dsl; out.csv = p.csv; out.snapshot = p.snapshot;
+        out.name = p.name; out.fingerprint = p.fingerprint; out.words = p.words; out.aliases = p.aliases;
+        return true;
+    }, &reused, error);
+    if (!e) return false;
+    h.json = e->json; h.stardict = e->stardict; h.mdict = e->mdict;
+    h.dsl = e->dsl; h.csv = e->csv; h.snapshot = e->snapshot;
+    h.name = e->name; h.words = e->words; h.aliases = e->aliases;
+    // Bound to the caller's spelling of the path, as reload checks recompute it from there
+    h.path = path;
+    h.src_paths = source_paths(path);
+    h.fingerprint = DictSnapshotStd::fingerprint(h.src_paths);
+    h.shared = std::move(e);
+    if (from_snapshot) *from_snapshot = !reused && h.shared->from_snapshot;
+    return true;
+}
+
+bool DictionaryManagerStd::parse_holder(const std::string& path, Holder& h, const LoadOptions& opts,
+                                        bool* from_snapshot, std::string* error) {
+    const std::string& snapshot_dir = opts.snapshot_dir;
+    auto fail = [&](const std::string& e) { if (error) *error = e; return false; };
+    if (from_snapshot) *from_snapshot = false;
+    std::error_code fec;
+    if (!fs::exists(path, fec)) return fail("file not found");
+    auto ext = format_ext(path);
+    DictSnapshotStd::Kind kind;
+    if (ext == ".json") kind = DictSnapshotStd::Kind::Json;
+    else if (ext == ".ifo") kind = DictSnapshotStd::Kind::StarDict;
+    else if (ext == ".mdx") kind = DictSnapshotStd::Kind::Mdict;
+    else if (ext == ".dsl") kind = DictSnapshotStd::Kind::Dsl;
+    else if (ext == ".csv" || ext == ".tsv" || ext == ".txt") kind = DictSnapshotStd::Kind::Csv;
+    else return fail("unsupported format: " + ext);
+
+    h.path = path;
+    h.src_paths = source_paths(path);
+    // Taken before parsing, so a source changed mid-parse is picked up by the next
+    // reload_changed_dictionaries() and leaves a snapshot that will be rejected.
+    h.fingerprint = DictSnapshotStd::fingerprint(h.src_paths);
+    const std::string& fingerprint = h.fingerprint;
+
+    // Warm start
+    std::string snap_file;
+    if (!snapshot_dir.empty()) {
+        snap_file = DictSnapshotStd::snapshot_path(snapshot_dir, path);
+        auto snap = std::make_shared<DictSnapshotStd>();
+        if (snap->attach(snap_file, fingerprint, opts.private_copy) && snap->kind() == kind) {
+            h.snapshot = snap; h.name = snap->name(); h.words = snap->headwords(); h.aliases = snap->synonyms();
+            if (from_snapshot) *from_snapshot = true;
+            return true;
+        }
+    }
+
+    DictSnapshotStd::Data data;
+    data.kind = kind;
+    auto capture = [&](const auto& p) {
+        data.values.reserve(h.words.size());
+        for (std::string_view w : h.words) data.values.push_back(p->lookup(std::string(w)));
+    };
+    bool snapshot_ok = !snap_file.empty();
+    if (kind == DictSnapshotStd::Kind::Json) {
+        auto p = std::make_shared<JsonParserStd>();
+        if (!p->load_dictionary(path)) return fail("failed to parse");
+        h.json = p; h.name = p->name(); h.words = p->headwords();
+        data.description = p->description();
+        if (snapshot_ok) capture(p);
+    } else if (kind == DictSnapshotStd::Kind::StarDict) {
+        auto p = std::make_shared<StarDictParserStd>();
+        p->set_private_copy(opts.private_copy);
+        if (!p->load_dictionary(path)) return fail("failed to parse");
+        h.stardict = p; h.name = p->dictionary_name(); h.words = p->headwords(); h.aliases = p->synonyms();
+        data.description = p->dictionary_description();
+        data.data_path = p->data_path();
+        data.syn_path = p->syn_path();
+        if (snapshot_ok) {
+            data.locations.reserve(h.words.size());
+            for (std::string_view w : h.words) {
+                uint64_t off = 0; uint32_t sz = 0;
+                p->entry_location(std::string(w), off, sz);
+                data.locations.emplace_back(off, sz);
+            }
+        }
+    } else if (kind == DictSnapshotStd::Kind::Mdict) {
+        auto p = std::make_shared<MdictParserStd>();
+        p->set_private_copy(opts.private_copy);
+        if (!p->load_dictionary(path)) return fail("failed to parse");
+        h.mdict = p; h.name = p->dictionary_name(); h.words = p->headwords();
+        data.description = p->dictionary_description();
+        // Decryption depends on the environment and rendered entries link to
+        // extracted resources, so neither kind is safe to replay from a snapshot.
+        snapshot_ok = snapshot_ok && !p->is_encrypted() && !p->has_resources() && h.src_paths.size() == 1;
+        if (snapshot_ok) capture(p);
+    } else if (kind == DictSnapshotStd::Kind::Dsl) {
         auto p = std::make_shared<DslParserStd>();
-        if (!p->load_dictionary(path)) return false;
-        h.dsl = p; h.name = p->dictionary_name(); h.words = p->all_words();
-    } else if (ext == ".csv" || ext == ".tsv" || ext == ".txt") {
+        if (!p->load_dictionary(path)) return fail("failed to parse");
+        h.dsl = p; h.name = p->dictionary_name(); h.words = p->headwords();
+        data.description = p->dictionary_description();
+        if (snapshot_ok) capture(p);
+    } else {
         auto p = std::make_shared<CsvParserStd>();
-        if (!p->load_dictionary(path)) return false;
-        h.csv = p; h.name = p->dictionary_name(); h.words = p->all_words();
+        if (!p->load_dictionary(path)) return fail("failed to parse");
+        h.csv = p; h.name = p->dictionary_name(); h.words = p->headwords();
+        data.description = p->dictionary_description();
+        if (snapshot_ok) capture(p);
+    }
+    if (snapshot_ok && PathUtilsStd::ensure_dir(snapshot_dir)) {
+        data.name = h.name;
+        data.words = h.words;
+        DictSnapshotStd::write(snap_file, fingerprint, data); // best effort; next load reparses on failure
+    }
+    return true;
+}
+
+void DictionaryManagerStd::index_add(const Holder& h) const {
+    if (h.shared) { index_.add_segment(h.shared->segment, h.name); return; }
+    index_.add_words(h.words, h.name);
+    index_.add_words(h.aliases, h.name);
+}
+
+void DictionaryManagerStd::index_remove(const Holder& h) const {
+    // After load_index() the words are plain entries again
+    if (h.shared && index_.remove_segment(h.shared->segment.get(), h.name)) return;
+    index_.remove_words(h.words, h.name);
+    index_.remove_words(h.aliases, h.name);
+}
+
+void DictionaryManagerStd::insert_holder(Holder&& h) {
+    index_add(h);
+    invalidate_signature();
+    set_fulltext_index(nullptr);
+    h.id = next_holder_id_++;
+    holders_by_name_[h.name].push_back(dicts_.size());
+    dicts_.push_back(std::move(h));
+}
+
+bool DictionaryManagerStd::register_dictionary(const std::string& path) {
+    std::error_code ec;
+    if (!fs::exists(path, ec)) return false;
+    Holder h;
+    const auto ext = format_ext(path);
+    if (ext == ".json") {
+        if (!JsonParserStd::read_header(path, h.name, h.meta_description)) return false;
+    } else if (ext == ".ifo") {
+        StarDictHeaderStd hdr;
+        if (!StarDictParserStd::read_header(path, hdr)) return false;
+        h.name = hdr.book_name.empty() ? std::string("StarDict") : hdr.book_name;
+        h.meta_word_count = hdr.word_count;
+        h.meta_description = hdr.description;
+    } else if (ext == ".mdx") {
+        if (!MdictParserStd::read_header(path, h.name, h.meta_description)) return false;
+    } else if (ext == ".dsl") {
+        if (!DslParserStd::read_header(path, h.name)) return false;
+    } else if (ext == ".csv" || ext == ".tsv" || ext == ".txt") {
+        h.name = fs::path(path).stem().string();
+        if (h.name.empty()) h.name = "CSV Dictionary";
     } else {
         return false;
     }
-    for (const auto& w : h.words) index_.add_word(w, h.name);
-    ft_index_.reset();
+    h.pending = true;
+    h.path = path;
+    h.src_paths = source_paths(path);
+    auto lk = lock_exclusive();
+    h.id = next_holder_id_++;
+    set_fulltext_index(nullptr);
+    invalidate_signature();
+    holders_by_name_[h.name].push_back(dicts_.size());
     dicts_.push_back(std::move(h));
     return true;
 }
 
+bool DictionaryManagerStd::is_dictionary_active(const std::string& dict_name) const {
+    auto lk = lock_shared();
+    const Holder* d = find_dictionary(dict_name);
+    return d && !d->pending;
+}
+
+size_t DictionaryManagerStd::pending_dictionary_count() const {
+    auto lk = lock_shared();
+    size_t n = 0;
+    for (const auto& d : dicts_) if (d.pending) ++n;
+    return n;
+}
+
+void DictionaryManagerStd::ensure_active(bool include_disabled) const {
+    adopt_warmed();
+    std::vector<size_t> which;
+    for (size_t i = 0; i < dicts_.size(); ++i) {
+        if (dicts_[i].pending && (include_disabled || dicts_[i].enabled)) which.push_back(i);
+    }
+    if (!which.empty()) activate_indices(which, 0, nullptr);
+}
+
+bool DictionaryManagerStd::needs_activation(bool include_disabled) const {
+    if (warmup_) {
+        std::lock_guard<std::mutex> lk(warmup_->mu);
+        if (!warmup_->ready.empty()) return true;
+    }
+    for (const auto& d : dicts_) {
+        if (d.pending && (include_disabled || d.enabled)) return true;
+    }
+    return false;
+}
+
+std::shared_lock<std::shared_mutex> DictionaryManagerStd::lock_shared() const {
+    { std::lock_guard<std::mutex> t(turnstile_); }
+    return std::shared_lock<std::shared_mutex>(mu_);
+}
+
+std::unique_lock<std::shared_mutex> DictionaryManagerStd::lock_exclusive() const {
+    // Holding the turnstile while waiting keeps new readers out, so a steady
+    // stream of queries cannot starve writers (std::shared_mutex makes no promise).
+    std::lock_guard<std::mutex> t(turnstile_);
+    return std::unique_lock<std::shared_mutex>(mu_);
+}
+
+std::shared_lock<std::shared_mutex> DictionaryManagerStd::read_lock(bool include_disabled) const {
+    auto lk = lock_shared();
+    if (!needs_activation(include_disabled)) return lk;
+    lk.unlock();
+    activate_pending(include_disabled);
+    // A dictionary registered in between stays pending until the next query
+    return lock_shared();
+}
+
+void DictionaryManagerStd::activate_pending(bool include_disabled) const {
+    // Concurrent first queries wait here for one parse instead of each parsing
+    std::lock_guard<std::mutex> al(activation_mu_);
+    std::vector<uint64_t> ids;
+    std::vector<std::string> paths;
+    LoadOptions opts;
+    {
+        auto lk = lock_shared();
+        if (!needs_activation(include_disabled)) return;
+        for (const auto& d : dicts_) {
+            if (d.pending && (include_disabled || d.enabled)) { ids.push_back(d.id); paths.push_back(d.path); }
+        }
+        opts = load_options();
+    }
+    // Parse without mu_, so lookups on active dictionaries and writers keep going
+    std::vector<Holder> holders;
+    std::vector<DictLoadReportStd> reports;
+    load_batch(paths, holders, reports, 0, opts, registry_.get());
+    auto lk = lock_exclusive();
+    adopt_warmed();
+    adopt_parsed(ids, holders, reports);
+}
+
+bool DictionaryManagerStd::adopt_parsed(const std::vector<uint64_t>& ids, std::vector<Holder>& holders,
+                                        const std::vector<DictLoadReportStd>& reports) const {
+    bool any = false;
+    for (size_t k = 0; k < ids.size(); ++k) {
+        for (size_t i = 0; i < dicts_.size(); ++i) {
+            if (dicts_[i].id != ids[k] || !dicts_[i].pending) continue;
+            activate_holder(i, std::move(holders[k]), reports[k].ok);
+            any = true;
+            break;
+        }
+    }
+    if (any) {
+        rebuild_holder_map();
+        index_.build_index();
+    }
+    return any;
+}
+
+void DictionaryManagerStd::activate_indices(const std::vector<size_t>& which, int threads,
+                                            std::vector<DictLoadReportStd>* reports) const {
+    std::vector<std::string> paths; paths.reserve(which.size());
+    for (size_t i : which) paths.push_back(dicts_[i].path);
+    std::vector<Holder> holders;
+    std::vector<DictLoadReportStd> local;
+    load_batch(paths, holders, local, threads, load_options(), registry_.get());
+    for (size_t k = 0; k < which.size(); ++k) activate_holder(which[k], std::move(holders[k]), local[k].ok);
+    rebuild_holder_map();
+    index_.build_index();
+    if (reports) *reports = std::move(local);
+}
+
+void DictionaryManagerStd::activate_holder(size_t i, Holder&& parsed, bool ok) const {
+    Holder& d = dicts_[i];
+    if (!d.pending) return;
+    invalidate_signature();
+    if (!ok) {
+        // Keep the entry listed (no words) so positions and the signature stay stable
+        d.pending = false;
+        return;
+    }
+    parsed.enabled = d.enabled;
+    parsed.id = d.id;
+    parsed.path = d.path;
+    // A full parse may name the dictionary differently than its header did
+    index_add(parsed);
+    d = std::move(parsed);
+}
+
+bool DictionaryManagerStd::adopt_warmed() const {
+    if (!warmup_) return false;
+    std::vector<std::pair<uint64_t, std::pair<bool, Holder>>> ready;
+    {
+        std::lock_guard<std::mutex> lk(warmup_->mu);
+        ready.swap(warmup_->ready);
+    }
+    bool any = false;
+    for (auto& r : ready) {
+        for (size_t i = 0; i < dicts_.size(); ++i) {
+            if (dicts_[i].id != r.first || !dicts_[i].pending) continue;
+            activate_holder(i, std::move(r.second.second), r.second.first);
+            any = true;
+            break;
+        }
+    }
+    if (any) {
+        rebuild_holder_map();
+        index_.build_index();
+    }
+    return any;
+}
+
+std::vector<DictLoadReportStd> DictionaryManagerStd::warmup_dictionaries(const std::vector<std::string>& names, int threads) {
+    std::vector<uint64_t> ids;
+    std::vector<std::string> paths;
+    LoadOptions opts;
+    {
+        auto lk = lock_exclusive();
+        adopt_warmed();
+        for (const auto& d : dicts_) {
+            if (!d.pending) continue;
+            if (names.empty() || std::find(names.begin(), names.end(), d.name) != names.end()) {
+                ids.push_back(d.id); paths.push_back(d.path);
+            }
+        }
+        opts = load_options();
+    }
+    std::vector<DictLoadReportStd> reports;
+    if (ids.empty()) return reports;
+    // Parse without the lock so queries keep running; adopt by id, since positions
+    // may have shifted (or the dictionary gone) meanwhile.
+    std::vector<Holder> holders;
+    load_batch(paths, holders, reports, threads, opts, registry_.get());
+    auto lk = lock_exclusive();
+    adopt_parsed(ids, holders, reports);
+    return reports;
+}
+
+void DictionaryManagerStd::start_background_warmup() {
+    std::lock_guard<std::mutex> wl(warmup_mu_);
+    // Restarting adopts what is done so far and requeues the rest
+    if (warmup_thread_.joinable()) {
+        warmup_->stop = true;
+        warmup_thread_.join();
+    }
+    auto lk = lock_exclusive();
+    adopt_warmed();
+    std::vector<std::pair<uint64_t, std::string>> jobs;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const auto& d : dicts_) {
+            if (d.pending && d.enabled == (pass == 0)) jobs.push_back({d.id, d.path});
+        }
+    }
+    if (jobs.empty()) return;
+    auto q = std::make_shared<WarmupQueue>();
+    warmup_ = q;
+    const LoadOptions opts = load_options();
+    warmup_thread_ = std::thread([q, jobs = std::move(jobs), opts, registry = registry_]() {
+        for (const auto& j : jobs) {
+            if (q->stop) break;
+            Holder h;
+            bool ok = false;
+            try { ok = load_holder(j.second, h, opts, nullptr, nullptr, registry.get()); } catch (const std::exception&) { ok = false; }
+            std::lock_guard<std::mutex> lk(q->mu);
+            q->ready.push_back({j.first, {ok, std::move(h)}});
+        }
+    });
+}
+
+void DictionaryManagerStd::stop_background_warmup() {
+    join_warmup();
+    auto lk = lock_exclusive();
+    adopt_warmed();
+}
+
+void DictionaryManagerStd::join_warmup() {
+    std::lock_guard<std::mutex> wl(warmup_mu_);
+    if (warmup_) warmup_->stop = true;
+    if (warmup_thread_.joinable()) warmup_thread_.join();
+}
+
+void DictionaryManagerStd::rebuild_holder_map() const {
+    holders_by_name_.clear();
+    for (size_t i = 0; i < dicts_.size(); ++i) holders_by_name_[dicts_[i].name].push_back(i);
+}
+
+bool DictionaryManagerStd::route_lookup(const std::string& word, std::vector<size_t>& out) const {
+    out.clear();
+    if (!index_routing_) return false;
+    // The index folds case and trims, so its dictionary list is a superset of
+    // the dictionaries whose lookup() can succeed.
+    for (const auto& name : index_.dictionaries_for_word(word)) {
+        auto it = holders_by_name_.find(name);
+        if (it != holders_by_name_.end()) out.insert(out.end(), it->second.begin(), it->second.end());
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return true;
+}
+
 bool DictionaryManagerStd::remove_dictionary(const std::string& dict_name) {
+    auto lk = lock_exclusive();
     bool removed = false;
     auto it = dicts_.begin();
     while (it != dicts_.end()) {
         if (it->name == dict_name) {
-            for (const auto& w : it->words) index_.remove_word(w, dict_name);
+            index_remove(*it);
+            def_cache_.invalidate_dictionary(it->id);
             it = dicts_.erase(it); removed = true;
         } else { ++it; }
     }
     if (removed) {
-        ft_index_.reset();
+        set_fulltext_index(nullptr);
+        invalidate_signature();
+        rebuild_holder_map();
     }
     index_.build_index();
     return removed;
 }
 
+bool DictionaryManagerStd::reload_dictionary(const std::string& dict_name) {
+    std::vector<std::pair<uint64_t, std::string>> targets;
+    LoadOptions opts;
+    {
+        auto lk = lock_shared();
+        for (const auto& d : dicts_) {
+            if (d.name == dict_name && !d.pending && !d.path.empty()) targets.push_back({d.id, d.path});
+        }
+        opts = load_options();
+    }
+    bool ok = !targets.empty();
+    for (const auto& t : targets) ok = reload_holder(t.first, t.second, opts) && ok;
+    return ok;
+}
+
+std::vector<std::string> DictionaryManagerStd::reload_changed_dictionaries() {
+    std::vector<std::pair<uint64_t, std::string>> targets;
+    LoadOptions opts;
+    {
+        auto lk = lock_shared();
+        for (const auto& d : dicts_) {
+            if (d.pending || d.path.empty()) continue;
+            // Recompute the companions too: a .mdd or .dict.dz may have appeared
+            if (DictSnapshotStd::fingerprint(source_paths(d.path)) != d.fingerprint) targets.push_back({d.id, d.path});
+        }
+        opts = load_options();
+    }
+    std::vector<std::string> out;
+    for (const auto& t : targets) {
+        if (!reload_holder(t.first, t.second, opts)) continue;
+        auto lk = lock_shared();
+        for (const auto& d : dicts_) if (d.id == t.first) { out.push_back(d.name); break; }
+    }
+    return out;
+}
+
+bool DictionaryManagerStd::reload_holder(uint64_t id, const std::string& path, const LoadOptions& opts) {
+    Holder h;
+    bool ok = false;
+    try { ok = load_holder(path, h, opts, nullptr, nullptr, registry_.get()); } catch (const std::exception&) { ok = false; }
+    if (h.fingerprint.empty()) h.fingerprint = DictSnapshotStd::fingerprint(source_paths(path));
+    // Fetch definitions for the full-text index before taking the lock as well
+    std::vector<std::pair<std::string, int>> texts;
+    bool have_ft = false;
+    {
+        std::lock_guard<std::mutex> fl(ft_mu_);
+        have_ft = ft_index_ != nullptr;
+    }
+    if (ok && have_ft) {
+        for (int wi = 0; wi < (int)h.words.size(); ++wi) {
+            std::string def = h.lookup(std::string(h.words[wi]));
+            if (!def.empty()) texts.push_back({std::move(def), wi});
+        }
+    }
+
+    auto lk = lock_exclusive();
+    size_t i = 0;
+    while (i < dicts_.size() && dicts_[i].id != id) ++i;
+    if (i == dicts_.size() || dicts_[i].pending) return false; // removed (or cleared) meanwhile
+    Holder& d = dicts_[i];
+    if (!ok) {
+        // Do not retry the same broken files on every change notification
+        d.fingerprint = h.fingerprint;
+        d.signature.clear(); // the files did change
+        invalidate_signature();
+        return false;
+    }
+    index_remove(d);
+    index_add(h);
+    h.enabled = d.enabled;
+    h.id = d.id;
+    d = std::move(h);
+    def_cache_.invalidate_dictionary(id);
+    invalidate_signature();
+    rebuild_holder_map();
+    index_.build_index();
+
+    std::lock_guard<std::mutex> fl(ft_mu_);
+    // A background build started from the old contents is stale
+    if (ft_job_) { ft_job_->cancel = true; ft_job_.reset(); }
+    // Disabled dictionaries have no documents in the index
+    if (ft_index_ && d.enabled) {
+        if (have_ft) {
+            std::vector<std::pair<std::string, FullTextIndexStd::DocRef>> docs;
+            docs.reserve(texts.size());
+            for (auto& t : texts) docs.push_back({std::move(t.first), {(int)i, t.second}});
+            const int di = (int)i;
+            ft_index_->replace_documents([di](const FullTextIndexStd::DocRef& r) { return r.dict == di; }, docs);
+        } else {
+            // The index appeared while parsing; rebuild it lazily instead
+            ft_index_.reset();
+        }
+    }
+    ft_result_cache_.clear();
+    ft_cache_signature_.clear();
+    return true;
+}
+
+bool DictionaryManagerStd::start_watching(int poll_ms, bool force_polling) {
+    std::lock_guard<std::mutex> wl(watch_mu_);
+    if (watcher_ && watcher_->running()) return false;
+    // From here on loads take private copies; swap out the mappings made before
+    std::vector<std::pair<uint64_t, std::string>> mapped;
+    LoadOptions opts;
+    {
+        auto lk = lock_exclusive();
+        private_copies_ = true;
+        opts = load_options();
+        for (const auto& d : dicts_) {
+            if (!d.pending && !d.path.empty() && d.maps_sources()) mapped.push_back({d.id, d.path});
+        }
+    }
+    for (const auto& t : mapped) reload_holder(t.first, t.second, opts);
+    watcher_.reset(new FileWatcherStd());
+    watcher_->set_force_polling(force_polling);
+    auto paths = [this]() {
+        std::vector<std::string> out;
+        auto lk = lock_shared();
+        for (const auto& d : dicts_) {
+            if (!d.pending) out.insert(out.end(), d.src_paths.begin(), d.src_paths.end());
+        }
+        return out;
+    };
+    return watcher_->start(paths, [this]() { reload_changed_dictionaries(); }, poll_ms);
+}
+
+void DictionaryManagerStd::stop_watching() {
+    std::lock_guard<std::mutex> wl(watch_mu_);
+    if (watcher_) watcher_->stop();
+    watcher_.reset();
+    auto lk = lock_exclusive();
+    private_copies_ = false;
+}
+
 void DictionaryManagerStd::clear_dictionaries() {
+    std::lock_guard<std::mutex> wl(warmup_mu_);
+    if (warmup_) warmup_->stop = true;
+    if (warmup_thread_.joinable()) warmup_thread_.join();
+    auto lk = lock_exclusive();
+    warmup_.reset();
     dicts_.clear();
+    holders_by_name_.clear();
     index_.clear();
-    ft_index_.reset();
+    index_routing_ = true;
+    def_cache_.clear();
+    invalidate_signature();
+    set_fulltext_index(nullptr);
 }
 
 std::vector<std::string> DictionaryManagerStd::loaded_dictionaries() const {
+    auto lk = lock_shared();
     std::vector<std::string> v; v.reserve(dicts_.size());
     for (auto& d : dicts_) v.push_back(d.name);
     return v;
 }
 
 std::vector<std::string> DictionaryManagerStd::enabled_dictionaries() const {
+    auto lk = lock_shared();
     std::vector<std::string> v;
     v.reserve(dicts_.size());
     for (const auto& d : dicts_) {
@@ -114,27 +773,61 @@ std::vector<std::string> DictionaryManagerStd::enabled_dictionaries() const {
 }
 
 bool DictionaryManagerStd::set_dictionary_enabled(const std::string& dict_name, bool enabled) {
+    auto lk = lock_exclusive();
     for (auto& d : dicts_) {
         if (d.name != dict_name) continue;
         if (d.enabled == enabled) return true;
         d.enabled = enabled;
-        ft_index_.reset();
+        set_fulltext_index(nullptr);
         return true;
     }
     return false;
 }
 
+bool DictionaryManagerStd::set_dictionary_order(const std::vector<std::string>& names) {
+    auto lk = lock_exclusive();
+    std::vector<size_t> order;
+    order.reserve(dicts_.size());
+    std::vector<bool> taken(dicts_.size(), false);
+    for (const auto& n : names) {
+        auto it = holders_by_name_.find(n);
+        if (it == holders_by_name_.end()) return false;
+        for (size_t i : it->second) {
+            if (!taken[i]) { taken[i] = true; order.push_back(i); }
+        }
+    }
+    for (size_t i = 0; i < dicts_.size(); ++i) {
+        if (!taken[i]) order.push_back(i);
+    }
+    bool same = true;
+    for (size_t k = 0; k < order.size(); ++k) same = same && order[k] == k;
+    if (same) return true;
+    std::vector<Holder> reordered;
+    reordered.reserve(dicts_.size());
+    for (size_t i : order) reordered.push_back(std::move(dicts_[i]));
+    dicts_.swap(reordered);
+    rebuild_holder_map();
+    // Full-text documents refer to positions, and the signature covers the order
+    invalidate_signature();
+    set_fulltext_index(nullptr);
+    return true;
+}
+
 bool DictionaryManagerStd::is_dictionary_enabled(const std::string& dict_name) const {
+    auto lk = lock_shared();
     const Holder* d = find_dictionary(dict_name);
     return d ? d->enabled : false;
 }
 
 std::vector<DictionaryManagerStd::DictMeta> DictionaryManagerStd::dictionaries_meta() const {
+    auto lk = lock_shared();
     std::vector<DictMeta> out; out.reserve(dicts_.size());
     for (auto& d : dicts_) {
         int wc = (int)d.words.size();
         std::string desc;
-        if (d.json) desc = d.json->description();
+        if (d.pending) { wc = d.meta_word_count; desc = d.meta_description; }
+        else if (d.snapshot) desc = d.snapshot->description();
+        else if (d.json) desc = d.json->description();
         else if (d.stardict) desc = d.stardict->dictionary_description();
         else if (d.mdict) desc = d.mdict->dictionary_description();
         else if (d.dsl) desc = d.dsl->dictionary_description();
@@ -145,9 +838,15 @@ std::vector<DictionaryManagerStd::DictMeta> DictionaryManagerStd::dictionaries_m
 }
 
 std::string DictionaryManagerStd::search_word(const std::string& word, bool include_disabled) const {
-    for (auto& d : dicts_) {
+    auto lk = read_lock(include_disabled);
+    lookup_count_.fetch_add(1, std::memory_order_relaxed);
+    std::vector<size_t> route;
+    const bool routed = route_lookup(word, route);
+    const size_t n = routed ? route.size() : dicts_.size();
+    for (size_t k = 0; k < n; ++k) {
+        const auto& d = dicts_[routed ? route[k] : k];
         if (!include_disabled && !d.enabled) continue;
-        auto def = d.lookup(word);
+        auto def = cached_lookup(d, word);
         if (!def.empty()) return def;
     }
     return {};
@@ -155,136 +854,586 @@ std::string DictionaryManagerStd::search_word(const std::string& word, bool incl
 
 std::vector<DictEntryStd> DictionaryManagerStd::search_all(const std::string& word, bool include_disabled) const {
     std::vector<DictEntryStd> out;
-    for (auto& d : dicts_) {
+    auto lk = read_lock(include_disabled);
+    lookup_count_.fetch_add(1, std::memory_order_relaxed);
+    std::vector<size_t> route;
+    const bool routed = route_lookup(word, route);
+    const size_t n = routed ? route.size() : dicts_.size();
+    for (size_t k = 0; k < n; ++k) {
+        const auto& d = dicts_[routed ? route[k] : k];
         if (!include_disabled && !d.enabled) continue;
-        auto def = d.lookup(word);
+        auto def = cached_lookup(d, word);
         if (!def.empty()) out.push_back({d.name, word, def});
     }
     return out;
 }
 
-void DictionaryManagerStd::build_index() { index_.build_index(); }
+std::string DictionaryManagerStd::cached_lookup(const Holder& d, const std::string& w) const {
+    std::string def;
+    if (def_cache_.get(d.id, w, &def)) return def;
+    probe_count_.fetch_add(1, std::memory_order_relaxed);
+    def = d.lookup(w);
+    // Misses are cached too: routing folds case, so a probe can come back empty
+    def_cache_.put(d.id, w, def);
+    return def;
+}
 
-std::vector<std::string> DictionaryManagerStd::exact_search(const std::string& word) const { return index_.exact_match(word); }
+void DictionaryManagerStd::fetch_batch(const std::vector<std::pair<size_t, std::string>>& reqs,
+                                       std::vector<std::string>& out) const {
+    out.assign(reqs.size(), std::string());
+    // Cache misses grouped per dictionary: word list plus the slots it answers
+    std::unordered_map<size_t, std::pair<std::vector<std::string>, std::vector<size_t>>> misses;
+    for (size_t i = 0; i < reqs.size(); ++i) {
+        if (reqs[i].first >= dicts_.size()) continue;
+        const Holder& d = dicts_[reqs[i].first];
+        if (def_cache_.get(d.id, reqs[i].second, &out[i])) continue;
+        auto& m = misses[reqs[i].first];
+        m.first.push_back(reqs[i].second);
+        m.second.push_back(i);
+    }
+    for (auto& kv : misses) {
+        const Holder& d = dicts_[kv.first];
+        probe_count_.fetch_add(kv.second.first.size(), std::memory_order_relaxed);
+        auto defs = d.lookup_batch(kv.second.first);
+        for (size_t k = 0; k < defs.size(); ++k) {
+            def_cache_.put(d.id, kv.second.first[k], defs[k]);
+            out[kv.second.second[k]] = std::move(defs[k]);
+        }
+    }
+}
 
-std::vector<std::string> DictionaryManagerStd::prefix_search(const std::string& prefix, int max_results) const { return index_.prefix_search(prefix, max_results); }
-std::vector<std::string> DictionaryManagerStd::fuzzy_search(const std::string& word, int max_results) const { return index_.fuzzy_search(word, max_results); }
-std::vector<std::string> DictionaryManagerStd::wildcard_search(const std::string& pattern, int max_results) const { return index_.wildcard_search(pattern, max_results); }
-std::vector<std::string> DictionaryManagerStd::regex_search(const std::string& pattern, int max_results) const { return index_.regex_search(pattern, max_results); }
-std::vector<std::string> DictionaryManagerStd::dictionaries_for_word(const std::string& word) const { return index_.dictionaries_for_word(word); }
-std::vector<std::string> DictionaryManagerStd::all_indexed_words() const { return index_.all_words(); }
-int DictionaryManagerStd::indexed_word_count() const { return index_.word_count(); }
-bool DictionaryManagerStd::save_index(const std::string& f) const { return index_.save_index(f); }
-bool DictionaryManagerStd::load_index(const std::string& f) { return index_.load_index(f); }
+std::vector<std::string> DictionaryManagerStd::fetch_definitions(const std::vector<DefinitionRefStd>& refs) const {
+    auto lk = read_lock(false);
+    std::vector<std::pair<size_t, std::string>> reqs;
+    reqs.reserve(refs.size());
+    for (const auto& r : refs) {
+        auto it = holders_by_name_.find(r.dict_name);
+        const size_t i = it != holders_by_name_.end() && !it->second.empty() ? it->second.front() : dicts_.size();
+        reqs.push_back({i, r.word});
+    }
+    std::vector<std::string> out;
+    fetch_batch(reqs, out);
+    return out;
+}
+
+DictionaryManagerStd::LookupStats DictionaryManagerStd::lookup_stats() const {
+    LookupStats s;
+    s.lookups = lookup_count_.load(std::memory_order_relaxed);
+    s.probes = probe_count_.load(std::memory_order_relaxed);
+    s.probes_per_lookup = s.lookups ? (double)s.probes / (double)s.lookups : 0.0;
+    auto lk = lock_shared();
+    s.routed = index_routing_;
+    return s;
+}
+
+void DictionaryManagerStd::reset_lookup_stats() { lookup_count_ = 0; probe_count_ = 0; }
+
+void DictionaryManagerStd::set_definition_cache_limit(size_t max_bytes) { def_cache_.set_capacity(max_bytes); }
+DefinitionCacheStd::Stats DictionaryManagerStd::definition_cache_stats() const { return def_cache_.stats(); }
+void DictionaryManagerStd::reset_definition_cache_stats() { def_cache_.reset_stats(); }
+
+void DictionaryManagerStd::build_index() {
+    activate_pending(false);
+    auto lk = lock_exclusive();
+    index_.build_index();
+}
+
+std::vector<std::string> DictionaryManagerStd::exact_search(const std::string& word) const { auto lk = read_lock(false); return index_.exact_match(word); }
+
+std::vector<std::string> DictionaryManagerStd::prefix_search(const std::string& prefix, int max_results) const { auto lk = read_lock(false); return index_.prefix_search(prefix, max_results); }
+std::vector<std::string> DictionaryManagerStd::fuzzy_search(const std::string& word, int max_results) const { auto lk = read_lock(false); return index_.fuzzy_search(word, max_results); }
+std::vector<std::string> DictionaryManagerStd::wildcard_search(const std::string& pattern, int max_results) const { auto lk = read_lock(false); return index_.wildcard_search(pattern, max_results); }
+std::vector<std::string> DictionaryManagerStd::regex_search(const std::string& pattern, int max_results) const { auto lk = read_lock(false); return index_.regex_search(pattern, max_results); }
+std::vector<std::string> DictionaryManagerStd::dictionaries_for_word(const std::string& word) const { auto lk = read_lock(false); return index_.dictionaries_for_word(word); }
+std::vector<std::string> DictionaryManagerStd::all_indexed_words() const { auto lk = read_lock(false); return index_.all_words(); }
+int DictionaryManagerStd::indexed_word_count() const { auto lk = read_lock(false); return index_.word_count(); }
+bool DictionaryManagerStd::save_index(const std::string& f) const { auto lk = read_lock(false); return index_.save_index(f); }
+bool DictionaryManagerStd::load_index(const std::string& f) {
+    auto lk = lock_exclusive();
+    if (!index_.load_index(f)) return false;
+    // A persisted index need not describe the loaded dictionaries; stop routing lookups through it
+    index_routing_ = false;
+    return true;
+}
 
 std::vector<DictEntryStd> DictionaryManagerStd::full_text_search(const std::string& query, int max_results) const {
     std::vector<DictEntryStd> out;
     if (query.empty() || max_results <= 0) return out;
-    ensure_fulltext_index_built();
-    if (!ft_index_) return out;
-    auto refs = ft_index_->search(query, max_results);
-    out.reserve((int)refs.size());
-    for (auto& r : refs) {
+    auto lk = read_lock(false);
+    bool building = false;
+    auto idx = fulltext_index(&building);
+    if (!idx) return building ? scan_fulltext(query, max_results, nullptr) : out;
+
+    std::string key;
+    if (ft_result_cache_enabled_) {
+        const std::string sig = signature_locked();
+        // Key: signature digest | enabled mask | limit | normalized token set
+        key = sig.substr(0, sig.find('|'));
+        key.push_back('|');
+        for (const auto& d : dicts_) key.push_back(d.enabled ? '1' : '0');
+        key.push_back('|');
+        key += std::to_string(max_results);
+        key.push_back('|');
+        key += fulltext_query_key(query);
+        std::lock_guard<std::mutex> fl(ft_mu_);
+        if (sig != ft_cache_signature_) {
+            ft_result_cache_.clear();
+            ft_cache_signature_ = sig;
+        }
+        if (const auto* hit = ft_result_cache_.get(key)) return *hit;
+    }
+
+    auto hits = run_fulltext_query(*idx, query, max_results, nullptr);
+    std::vector<std::pair<size_t, std::string>> reqs;
+    reqs.reserve(hits.size());
+    for (const auto& h : hits) {
+        const auto& r = h.ref;
         if (r.dict < 0 || r.dict >= (int)dicts_.size()) continue;
         const auto& d = dicts_[r.dict];
         if (r.word < 0 || r.word >= (int)d.words.size()) continue;
-        const std::string& w = d.words[r.word];
-        std::string def = d.lookup(w);
-        if (!def.empty()) out.push_back({ d.name, w, std::move(def) });
-        if ((int)out.size() >= max_results) break;
+        reqs.push_back({(size_t)r.dict, std::string(d.words[r.word])});
+    }
+    std::vector<std::string> defs;
+    fetch_batch(reqs, defs);
+    out.reserve(reqs.size());
+    size_t bytes = 0;
+    for (size_t i = 0; i < reqs.size() && (int)out.size() < max_results; ++i) {
+        if (defs[i].empty()) continue;
+        const auto& d = dicts_[reqs[i].first];
+        bytes += reqs[i].second.size() + defs[i].size() + d.name.size();
+        out.push_back({ d.name, std::move(reqs[i].second), std::move(defs[i]) });
+    }
+    if (ft_result_cache_enabled_) {
+        std::lock_guard<std::mutex> fl(ft_mu_);
+        // Results of an index replaced meanwhile must not outlive it
+        if (ft_index_ == idx) ft_result_cache_.put(key, out, bytes + sizeof(DictEntryStd) * out.size());
     }
     return out;
 }
 
-void DictionaryManagerStd::ensure_fulltext_index_built() const {
-    if (ft_index_) return;
-    // Build lazily: index all definitions into an inverted index
-    std::unique_ptr<FullTextIndexStd> idx(new FullTextIndexStd());
+std::vector<FullTextHitStd> DictionaryManagerStd::full_text_search_hits(const std::string& query, int max_results) const {
+    std::vector<FullTextHitStd> out;
+    if (query.empty() || max_results <= 0) return out;
+    auto lk = read_lock(false);
+    bool building = false;
+    auto idx = fulltext_index(&building);
+    if (!idx) {
+        if (!building) return out;
+        std::vector<std::string> terms;
+        for (auto& e : scan_fulltext(query, max_results, &terms)) {
+            FullTextHitStd r;
+            r.dict_name = std::move(e.dict_name);
+            r.word = std::move(e.word);
+            r.snippet = FullTextIndexStd::make_excerpt(e.definition, FullTextIndexStd::kDefaultSnippetLength, terms);
+            r.highlights = FullTextIndexStd::highlight_terms(r.snippet, terms);
+            out.push_back(std::move(r));
+        }
+        return out;
+    }
+    std::vector<std::string> terms;
+    auto hits = run_fulltext_query(*idx, query, max_results, &terms);
+    out.reserve(hits.size());
+    const size_t excerpt_len = idx->snippet_length() ? idx->snippet_length() : FullTextIndexStd::kDefaultSnippetLength;
+    for (const auto& h : hits) {
+        if (h.ref.dict < 0 || h.ref.dict >= (int)dicts_.size()) continue;
+        const auto& d = dicts_[h.ref.dict];
+        if (h.ref.word < 0 || h.ref.word >= (int)d.words.size()) continue;
+        FullTextHitStd r;
+        r.dict_name = d.name;
+        r.word = d.words[h.ref.word];
+        r.score = h.score;
+        if (idx->has_snippets()) {
+            auto sn = idx->snippet(h.doc, terms);
+            r.snippet = std::move(sn.text);
+            r.highlights = std::move(sn.highlights);
+        }
+        if (r.snippet.empty() || (r.highlights.empty() && !terms.empty())) {
+            // No stored excerpt, or the match lies past it: cut one around the match
+            r.snippet = FullTextIndexStd::make_excerpt(cached_lookup(d, r.word), excerpt_len, terms);
+            r.highlights = FullTextIndexStd::highlight_terms(r.snippet, terms);
+        }
+        out.push_back(std::move(r));
+    }
+    return out;
+}
+
+std::string DictionaryManagerStd::fulltext_query_key(const std::string& query) {
+    if (FullTextQueryStd::is_advanced(query)) {
+        FullTextQueryStd q;
+        if (FullTextQueryStd::parse(query, q)) return "Q:" + q.to_string();
+    }
+    return FullTextIndexStd::normalize_query(query);
+}
+
+// A dictionary passes if it is named by a dict: filter (or there are none) and by no -dict: filter.
+static bool dict_filter_allows(const FullTextQueryStd& q, const std::string& name) {
+    const std::string n = lcase(name);
+    for (const auto& f : q.dict_excludes) if (n == lcase(f)) return false;
+    if (q.dict_filters.empty()) return true;
+    for (const auto& f : q.dict_filters) if (n == lcase(f)) return true;
+    return false;
+}
+
+std::vector<FullTextIndexStd::Hit> DictionaryManagerStd::run_fulltext_query(const FullTextIndexStd& idx, const std::string& query,
+                                                                           int max_results, std::vector<std::string>* terms) const {
+    FullTextQueryStd q;
+    // Plain word lists (and malformed syntax) keep the legacy ranked-OR search
+    if (!FullTextQueryStd::is_advanced(query) || !FullTextQueryStd::parse(query, q))
+        return idx.search_hits(query, max_results, terms);
+
+    std::vector<bool> mask;
+    if (!q.dict_filters.empty() || !q.dict_excludes.empty()) {
+        mask.assign(dicts_.size(), false);
+        bool any = false;
+        for (int i = 0; i < (int)dicts_.size(); ++i) {
+            if (dict_filter_allows(q, dicts_[i].name)) { mask[i] = true; any = true; }
+        }
+        if (!any) return {};
+    }
+    auto check = [this](const FullTextIndexStd::DocRef& r, const std::vector<std::string>& words) {
+        if (r.dict < 0 || r.dict >= (int)dicts_.size()) return false;
+        const auto& d = dicts_[r.dict];
+        if (r.word < 0 || r.word >= (int)d.words.size()) return false;
+        return FullTextIndexStd::contains_phrase(cached_lookup(d, std::string(d.words[r.word])), words);
+    };
+    return idx.search_query(q, max_results, mask.empty() ? nullptr : &mask, check, terms);
+}
+
+void DictionaryManagerStd::set_fulltext_result_cache_limits(size_t max_entries, size_t max_bytes) {
+    auto lk = lock_exclusive();
+    std::lock_guard<std::mutex> fl(ft_mu_);
+    ft_result_cache_enabled_ = max_entries > 0;
+    ft_result_cache_.clear();
+    if (ft_result_cache_enabled_) ft_result_cache_.set_limits(max_entries, max_bytes);
+}
+
+void DictionaryManagerStd::set_fulltext_index(std::shared_ptr<FullTextIndexStd> idx) const {
+    std::lock_guard<std::mutex> fl(ft_mu_);
+    // A background build of the previous dictionary set is stale now
+    if (ft_job_) { ft_job_->cancel = true; ft_job_.reset(); }
+    ++ft_generation_;
+    ft_index_ = std::move(idx);
+    ft_result_cache_.clear();
+    ft_cache_signature_.clear();
+}
+
+std::vector<std::pair<std::string, FullTextIndexStd::DocRef>> DictionaryManagerStd::collect_fulltext_documents(
+    const std::vector<Holder>& dicts, const std::atomic<bool>* cancel, const FullTextProgressFn& progress) {
     std::vector<std::pair<std::string, FullTextIndexStd::DocRef>> docs;
-    // Pre-collect documents for parallel build
-    for (int di = 0; di < (int)dicts_.size(); ++di) {
-        const auto& d = dicts_[di];
+    FullTextBuildProgressStd p;
+    for (const auto& d : dicts) if (d.enabled) p.total += d.words.size();
+    for (int di = 0; di < (int)dicts.size(); ++di) {
+        const auto& d = dicts[di];
+        if (!d.enabled) continue;
+        // Fetched in chunks, so StarDict reads each stretch of the .dict once
+        std::vector<std::string> chunk;
+        for (int begin = 0; begin < (int)d.words.size(); begin += 1024) {
+            const int end = std::min<int>((int)d.words.size(), begin + 1024);
+            if (p.done > 0) {
+                if (cancel && cancel->load(std::memory_order_relaxed)) return {};
+                if (progress) progress(p);
+            }
+            chunk.clear();
+            for (int wi = begin; wi < end; ++wi) chunk.emplace_back(d.words[wi]);
+            auto defs = d.lookup_batch(chunk);
+            for (int wi = begin; wi < end; ++wi) {
+                if (!defs[wi - begin].empty()) docs.push_back({std::move(defs[wi - begin]), {di, wi}});
+            }
+            p.done += (size_t)(end - begin);
+        }
+    }
+    return docs;
+}
+
+std::shared_ptr<FullTextIndexStd> DictionaryManagerStd::fulltext_index(bool* building) const {
+    std::promise<std::shared_ptr<FullTextIndexStd>> promise;
+    std::shared_future<std::shared_ptr<FullTextIndexStd>> running;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> fl(ft_mu_);
+        if (building) *building = false;
+        if (ft_index_) return ft_index_;
+        if (ft_job_) { if (building) *building = true; return nullptr; }
+        if (ft_lazy_build_.valid()) running = ft_lazy_build_;
+        else ft_lazy_build_ = promise.get_future().share();
+        generation = ft_generation_;
+    }
+    // Concurrent first queries wait for a single build, without holding ft_mu_
+    if (running.valid()) return running.get();
+    // Build lazily: index all definitions into an inverted index. Only the caller's
+    // shared mu_ is held, so dictionaries cannot change underneath.
+    std::shared_ptr<FullTextIndexStd> idx;
+    try {
+        idx = std::make_shared<FullTextIndexStd>();
+        idx->set_snippet_length(ft_snippet_length_);
+        idx->build_from_documents(collect_fulltext_documents(dicts_, nullptr, FullTextProgressFn()), 0);
+    } catch (...) {
+        { std::lock_guard<std::mutex> fl(ft_mu_); ft_lazy_build_ = {}; }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    {
+        std::lock_guard<std::mutex> fl(ft_mu_);
+        ++ft_builds_;
+        ft_lazy_build_ = {};
+        if (ft_generation_ == generation && !ft_index_) {
+            ft_index_ = idx;
+            ft_result_cache_.clear();
+            ft_cache_signature_.clear();
+        }
+    }
+    promise.set_value(idx);
+    return idx;
+}
+
+std::shared_future<bool> DictionaryManagerStd::start_fulltext_build(FullTextProgressFn progress, int threads) {
+    std::lock_guard<std::mutex> bl(ft_build_mu_);
+    {
+        std::lock_guard<std::mutex> fl(ft_mu_);
+        if (ft_job_) return ft_job_->future;
+    }
+    // Whatever ran before was cancelled or has finished
+    if (ft_build_thread_.joinable()) ft_build_thread_.join();
+    auto job = std::make_shared<FullTextBuildJob>();
+    job->future = job->promise.get_future().share();
+    std::vector<Holder> dicts;
+    {
+        auto lk = read_lock(false);
+        std::lock_guard<std::mutex> fl(ft_mu_);
+        if (ft_index_) { job->promise.set_value(true); return job->future; }
+        // The copies share the parsers, so the build reads them without holding mu_;
+        // a dictionary change meanwhile cancels the job via set_fulltext_index().
+        dicts = dicts_;
+        ft_job_ = job;
+    }
+    ft_build_thread_ = std::thread(&DictionaryManagerStd::run_fulltext_build, this, job, std::move(dicts),
+                                   std::move(progress), threads);
+    return job->future;
+}
+
+void DictionaryManagerStd::run_fulltext_build(std::shared_ptr<FullTextBuildJob> job, std::vector<Holder> dicts,
+                                              FullTextProgressFn progress, int threads) {
+    using Phase = FullTextBuildProgressStd::Phase;
+    bool ok = false;
+    size_t total = 0;
+    try {
+        auto docs = collect_fulltext_documents(dicts, &job->cancel, progress);
+        total = docs.size();
+        auto idx = std::make_shared<FullTextIndexStd>();
+        idx->set_snippet_length(ft_snippet_length_);
+        auto on_indexed = [&](size_t done, size_t n) { if (progress) progress({Phase::Indexing, done, n}); };
+        if (!job->cancel && idx->build_from_documents(docs, threads, &job->cancel, on_indexed)) {
+            std::lock_guard<std::mutex> fl(ft_mu_);
+            if (ft_job_ == job && !job->cancel) {
+                ft_index_ = std::move(idx);
+                ++ft_builds_;
+                ft_result_cache_.clear();
+                ft_cache_signature_.clear();
+                ok = true;
+            }
+        }
+    } catch (const std::exception&) {
+        ok = false;
+    }
+    {
+        std::lock_guard<std::mutex> fl(ft_mu_);
+        if (ft_job_ == job) ft_job_.reset();
+    }
+    if (progress) progress({ok ? Phase::Done : Phase::Cancelled, ok ? total : 0, total});
+    job->promise.set_value(ok);
+}
+
+void DictionaryManagerStd::cancel_fulltext_build() {
+    std::lock_guard<std::mutex> bl(ft_build_mu_);
+    {
+        std::lock_guard<std::mutex> fl(ft_mu_);
+        if (ft_job_) { ft_job_->cancel = true; ft_job_.reset(); }
+    }
+    if (ft_build_thread_.joinable()) ft_build_thread_.join();
+}
+
+FullTextStateStd DictionaryManagerStd::fulltext_state() const {
+    std::lock_guard<std::mutex> fl(ft_mu_);
+    if (ft_index_) return FullTextStateStd::Ready;
+    return ft_job_ || ft_lazy_build_.valid() ? FullTextStateStd::Building : FullTextStateStd::Missing;
+}
+
+static void positive_terms(const FullTextQueryStd::Node& n, std::vector<std::string>& out) {
+    if (n.kind == FullTextQueryStd::Node::Kind::Not) return;
+    out.insert(out.end(), n.words.begin(), n.words.end());
+    for (const auto& c : n.children) positive_terms(c, out);
+}
+
+std::vector<DictEntryStd> DictionaryManagerStd::scan_fulltext(const std::string& query, int max_results,
+                                                              std::vector<std::string>* terms) const {
+    std::vector<DictEntryStd> out;
+    FullTextQueryStd q;
+    const bool advanced = FullTextQueryStd::is_advanced(query) && FullTextQueryStd::parse(query, q);
+    // Plain word lists match any of their tokens, as the ranked-OR search does
+    const std::vector<std::string> words = advanced ? std::vector<std::string>() : FullTextIndexStd::tokenize(query);
+    if (!advanced && words.empty()) return out;
+    if (terms) {
+        if (advanced) positive_terms(q.root, *terms);
+        else *terms = words;
+    }
+    size_t budget = ft_scan_limit_;
+    for (const auto& d : dicts_) {
         if (!d.enabled) continue;
-        for (int wi = 0; wi < (int)d.words.size(); ++wi) {
-            const std::string& w = d.words[wi];
+        if (advanced && !dict_filter_allows(q, d.name)) continue;
+        for (std::string_view wv : d.words) {
+            if (budget == 0) return out;
+            --budget;
+            const std::string w(wv);
             std::string def = d.lookup(w);
-            if (!def.empty()) docs.push_back({std::move(def), {di, wi}});
+            if (def.empty()) continue;
+            const auto toks = FullTextIndexStd::tokenize(def);
+            bool hit = false;
+            if (advanced) hit = q.matches(toks);
+            else for (const auto& t : words) if (std::find(toks.begin(), toks.end(), t) != toks.end()) { hit = true; break; }
+            if (!hit) continue;
+            out.push_back({d.name, w, std::move(def)});
+            if ((int)out.size() >= max_results) return out;
         }
     }
-    idx->build_from_documents(docs, 0);
-    const_cast<DictionaryManagerStd*>(this)->ft_index_ = std::move(idx);
+    return out;
 }
 
-bool DictionaryManagerStd::save_fulltext_index(const std::string& file) const {
-    ensure_fulltext_index_built();
-    if (!ft_index_) return false;
-    ft_index_->set_signature(fulltext_signature());
-    return ft_index_->save(file);
+bool DictionaryManagerStd::save_fulltext_index(const std::string& file, int format) const {
+    // Let a running background build finish instead of building a second index
+    std::shared_future<bool> running;
+    {
+        std::lock_guard<std::mutex> fl(ft_mu_);
+        if (ft_job_) running = ft_job_->future;
+    }
+    if (running.valid()) running.wait();
+    auto lk = read_lock(true);
+    auto idx = fulltext_index();
+    if (!idx) return false;
+    const std::string sig = signature_locked();
+    std::lock_guard<std::mutex> fl(ft_mu_);
+    idx->set_signature(sig);
+    return idx->save(file, format);
 }
 
 bool DictionaryManagerStd::load_fulltext_index(const std::string& file) {
-    std::unique_ptr<FullTextIndexStd> idx(new FullTextIndexStd());
+    auto idx = std::make_shared<FullTextIndexStd>();
     if (!idx->load(file)) return false;
+    activate_pending(true);
+    auto lk = lock_exclusive();
+    // Only a dictionary registered since activate_pending() is parsed under the lock
+    ensure_active(true);
     // Check signature consistency
-    const std::string cur = fulltext_signature();
-    if (idx->signature() != cur) return false;
-    ft_index_ = std::move(idx);
+    if (idx->signature() != signature_locked(true)) return false;
+    set_fulltext_index(std::move(idx));
     return true;
 }
 
-static inline uint64_t fnv1a64(const void* data, size_t len) {
-    const unsigned char* p = static_cast<const unsigned char*>(data);
-    uint64_t h = 1469598103934665603ULL;
-    for (size_t i = 0; i < len; ++i) { h ^= p[i]; h *= 1099511628211ULL; }
-    return h;
+// MurmurHash3 x64_128: eight bytes per step on two lanes.
+static inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+static inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33; k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33; k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+static std::string hash128_hex(const std::string& s) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(s.data());
+    const size_t len = s.size();
+    const size_t nblocks = len / 16;
+    const uint64_t c1 = 0x87c37b91114253d5ULL, c2 = 0x4cf5ad432745937fULL;
+    uint64_t h1 = 0, h2 = 0;
+    auto load = [](const unsigned char* p) { uint64_t v = 0; for (int i = 7; i >= 0; --i) v = (v << 8) | p[i]; return v; };
+    for (size_t i = 0; i < nblocks; ++i) {
+        uint64_t k1 = load(data + i * 16), k2 = load(data + i * 16 + 8);
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+    const unsigned char* tail = data + nblocks * 16;
+    uint64_t k1 = 0, k2 = 0;
+    const size_t rest = len & 15;
+    for (size_t i = rest; i > 8; --i) k2 ^= uint64_t(tail[i - 1]) << (8 * (i - 9));
+    if (rest > 8) { k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2; }
+    for (size_t i = std::min<size_t>(rest, 8); i > 0; --i) k1 ^= uint64_t(tail[i - 1]) << (8 * (i - 1));
+    if (rest > 0) { k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1; }
+    h1 ^= len; h2 ^= len;
+    h1 += h2; h2 += h1;
+    h1 = fmix64(h1); h2 = fmix64(h2);
+    h1 += h2; h2 += h1;
+    char hex[33];
+    std::snprintf(hex, sizeof(hex), "%016llx%016llx", (unsigned long long)h1, (unsigned long long)h2);
+    return hex;
 }
 
-std::string DictionaryManagerStd::fulltext_signature() const {
-    // Deterministic signature combining names/word stats AND filesystem metadata of source paths.
+std::string DictionaryManagerStd::fulltext_signature(bool verify) const {
+    auto lk = read_lock(true);
+    return signature_locked(verify);
+}
+
+std::string DictionaryManagerStd::signature_segment(const Holder& d) {
     std::ostringstream ss;
-    ss << "N=" << dicts_.size() << ';';
-    for (const auto& d : dicts_) {
-        ss << d.name << '|' << d.words.size() << '|';
-        if (!d.words.empty()) ss << d.words.front() << '|' << d.words.back();
-        ss << '|';
-        // filesystem metadata for all companion source paths (stable order)
-        std::vector<std::string> srcs = d.src_paths;
-        std::sort(srcs.begin(), srcs.end());
-        std::error_code ec;
-        for (const auto& sp : srcs) {
-            fs::path p = sp;
-            if (fs::exists(p, ec)) {
-                auto sz = fs::is_regular_file(p, ec) ? fs::file_size(p, ec) : 0ull;
-                auto ts = fs::last_write_time(p, ec).time_since_epoch().count();
-                ss << p.string() << '|' << (unsigned long long)sz << '|' << (long long)ts;
-            } else {
-                ss << p.string() << "|(missing)";
-            }
-            ss << '#';
+    ss << d.name << '|' << d.words.size() << '|';
+    if (!d.words.empty()) ss << d.words.front() << '|' << d.words.back();
+    ss << '|';
+    // filesystem metadata for all companion source paths (stable order)
+    std::vector<std::string> srcs = d.src_paths;
+    std::sort(srcs.begin(), srcs.end());
+    std::error_code ec;
+    for (const auto& sp : srcs) {
+        fs::path p = sp;
+        if (fs::exists(p, ec)) {
+            auto sz = fs::is_regular_file(p, ec) ? fs::file_size(p, ec) : 0ull;
+            auto ts = fs::last_write_time(p, ec).time_since_epoch().count();
+            ss << p.string() << '|' << (unsigned long long)sz << '|' << (long long)ts;
+        } else {
+            ss << p.string() << "|(missing)";
         }
-        ss << ';';
+        ss << '#';
     }
-    std::string s = ss.str();
-    uint64_t hv = fnv1a64(s.data(), s.size());
-    std::ostringstream out; out << std::hex << hv << '|' << s;
-    return out.str();
+    ss << ';';
+    return ss.str();
+}
+
+std::string DictionaryManagerStd::signature_locked(bool verify) const {
+    std::lock_guard<std::mutex> sl(sig_mu_);
+    if (!verify && !sig_cache_.empty()) return sig_cache_;
+    // Deterministic signature combining names/word stats AND filesystem metadata of source paths.
+    std::string s = "N=" + std::to_string(dicts_.size()) + ";";
+    for (const auto& d : dicts_) {
+        if (verify || d.signature.empty()) d.signature = signature_segment(d);
+        s += d.signature;
+    }
+    sig_cache_ = hash128_hex(s) + "|" + s;
+    return sig_cache_;
+}
+
+void DictionaryManagerStd::invalidate_signature() const {
+    std::lock_guard<std::mutex> sl(sig_mu_);
+    sig_cache_.clear();
 }
 
 bool DictionaryManagerStd::load_fulltext_index_relaxed(const std::string& file, int* out_version, std::string* out_error) {
-    std::unique_ptr<FullTextIndexStd> idx(new FullTextIndexStd());
+    auto idx = std::make_shared<FullTextIndexStd>();
     if (!idx->load(file)) {
         if (out_error) *out_error = idx->last_error();
         return false;
     }
     if (out_version) *out_version = idx->version();
     // Ignore signature; accept any version we can parse
-    ft_index_ = std::move(idx);
+    auto lk = lock_exclusive();
+    set_fulltext_index(std::move(idx));
     return true;
 }
 
 FullTextIndexStd::Stats DictionaryManagerStd::fulltext_stats() const {
-    if (!ft_index_) return FullTextIndexStd::Stats{};
-    return ft_index_->stats();
+    std::lock_guard<std::mutex> fl(ft_mu_);
+    FullTextIndexStd::Stats s = ft_index_ ? ft_index_->stats() : FullTextIndexStd::Stats{};
+    s.result_cache_hits = ft_result_cache_.hits();
+    s.result_cache_misses = ft_result_cache_.misses();
+    s.result_cache_entries = ft_result_cache_.size();
+    s.index_builds = ft_builds_;
+    return s;
 }
 
 const DictionaryManagerStd::Holder* DictionaryManagerStd::find_dictionary(const std::string& dict_name) const {
@@ -3,8 +3,15 @@
 #ifndef UNIDICT_DICTIONARY_MANAGER_STD_H
 #define UNIDICT_DICTIONARY_MANAGER_STD_H
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -15,28 +22,148 @@
 #include "mdict_parser_std.h"
 #include "dsl_parser_std.h"
 #include "csv_parser_std.h"
+#include "definition_cache_std.h"
+#include "dict_snapshot_std.h"
+#include "dictionary_registry_std.h"
+#include "file_watcher_std.h"
 #include "fulltext_index_std.h"
+#include "lru_cache_std.h"
 
 namespace UnidictCoreStd {
 
 struct DictEntryStd { std::string dict_name; std::string word; std::string definition; };
+// One entry to fetch with DictionaryManagerStd::fetch_definitions.
+struct DefinitionRefStd { std::string dict_name; std::string word; };
+// Full-text hit with a short plain-text preview; highlights are [offset, length) byte ranges into snippet.
+struct FullTextHitStd {
+    std::string dict_name;
+    std::string word;
+    std::string snippet;
+    std::vector<std::pair<size_t,size_t>> highlights;
+    double score = 0.0;
+};
+
+// Outcome of loading one dictionary via DictionaryManagerStd::add_dictionaries.
+struct DictLoadReportStd {
+    std::string path;
+    std::string name;       // dictionary name when loaded
+    bool ok = false;
+    std::string error;      // reason when !ok
+    double millis = 0.0;    // parse time on the worker thread
+    size_t word_count = 0;
+    bool from_snapshot = false; // served from a load snapshot instead of reparsing
+};
 
+// Progress of a background full-text build (DictionaryManagerStd::start_fulltext_build).
+struct FullTextBuildProgressStd {
+    enum class Phase { Collecting, Indexing, Done, Cancelled };
+    Phase phase = Phase::Collecting;
+    size_t done = 0;  // definitions fetched (Collecting) or indexed (Indexing)
+    size_t total = 0;
+};
+enum class FullTextStateStd { Missing, Building, Ready };
+
+// Thread safety: const queries may run concurrently with each other and with
+// mutations (add/register/remove/clear, enable/disable, index loads), which are
+// serialized behind a reader/writer lock. Dictionaries are parsed without the lock
+// (add, reload, warmup and the first query after register_dictionary alike) and
+// installed under a short write lock, so loading one does not stall lookups.
+// The full-text index built by the first full-text query is the exception: it is
+// built under the shared lock, so queries continue but mutations wait for it.
+// start_fulltext_build() builds on its own thread without the lock instead.
 class DictionaryManagerStd {
 public:
     DictionaryManagerStd();
+    // A view over dictionaries shared through registry (e.g. DictionaryRegistryStd::global()):
+    // a file another manager on the same registry already loaded is not parsed or
+    // indexed again. Order, enabled flags, caches and the full-text index stay per manager.
+    explicit DictionaryManagerStd(std::shared_ptr<DictionaryRegistryStd> registry);
+    ~DictionaryManagerStd();
 
     bool add_dictionary(const std::string& path);
+    // Parse several dictionaries concurrently (threads <= 0: hardware concurrency),
+    // then register them in the order given, exactly as sequential add_dictionary
+    // calls would. Returns one report per path, in input order.
+    std::vector<DictLoadReportStd> add_dictionaries(const std::vector<std::string>& paths, int threads = 0);
+    // Load snapshots (off by default): after a dictionary is parsed its headwords and
+    // definitions (StarDict: offsets) are written to dir (default cache_dir()/snapshots),
+    // and later loads of the unchanged source map that file instead of reparsing.
+    // Encrypted MDict files and MDict files with .mdd resources are always reparsed.
+    void set_load_snapshots(bool enabled, const std::string& dir = "");
+    bool load_snapshots_enabled() const;
+
+    // Metadata-only registration: reads the name (and the word count where the format
+    // header stores it) without parsing. The dictionary is listed immediately and is
+    // parsed and indexed on first access: any lookup, index or full-text query activates
+    // the pending enabled dictionaries (include_disabled lookups and signatures activate
+    // all of them). Disabled dictionaries stay dormant until enabled and queried.
+    bool register_dictionary(const std::string& path);
+    bool is_dictionary_active(const std::string& dict_name) const;
+    size_t pending_dictionary_count() const;
+    // Activate the named pending dictionaries now (empty: all pending), in parallel.
+    std::vector<DictLoadReportStd> warmup_dictionaries(const std::vector<std::string>& names = {}, int threads = 0);
+    // Parse pending dictionaries one at a time on a background thread (enabled ones
+    // first); finished ones are adopted by the next query. Stopped by the destructor,
+    // clear_dictionaries() and stop_background_warmup().
+    void start_background_warmup();
+    void stop_background_warmup();
     bool remove_dictionary(const std::string& dict_name);
     void clear_dictionaries();
+
+    // Hot reload. The new version is parsed without holding the lock and swapped in
+    // at the same position in one step, so queries see either the old or the new
+    // dictionary. The word index is updated for that dictionary only, and the
+    // full-text index drops and re-adds just its documents.
+    // A failed reparse keeps the old contents.
+    bool reload_dictionary(const std::string& dict_name);
+    // Reload every active dictionary whose source files (path/size/mtime) changed
+    // since it was loaded. Returns the names reloaded.
+    std::vector<std::string> reload_changed_dictionaries();
+    // Watch the source files of all dictionaries and reload changed ones on the
+    // watcher thread (inotify on Linux, polling every poll_ms elsewhere).
+    // Watched files may be rewritten in place (cp new.dict old.dict), which faults
+    // a mapping once the file shrinks, so while watching StarDict and .mdx files
+    // are read into memory instead of mapped; dictionaries already mapped are
+    // reloaded that way before watching starts.
+    bool start_watching(int poll_ms = 1000, bool force_polling = false);
+    void stop_watching();
     std::vector<std::string> loaded_dictionaries() const;
     std::vector<std::string> enabled_dictionaries() const;
     bool set_dictionary_enabled(const std::string& dict_name, bool enabled);
+    // Move the named dictionaries to the front, in the order given; the others keep
+    // their relative order after them. False (nothing changed) if a name is unknown.
+    bool set_dictionary_order(const std::vector<std::string>& names);
     bool is_dictionary_enabled(const std::string& dict_name) const;
+    // word_count is -1 for a registered dictionary whose header does not record it.
     struct DictMeta { std::string name; int word_count; std::string description; };
     std::vector<DictMeta> dictionaries_meta() const;
 
+    // Exact lookups are routed through the word index: only dictionaries whose
+    // headword list contains the (case-folded) word are probed.
     std::string search_word(const std::string& word, bool include_disabled = false) const; // returns first match
     std::vector<DictEntryStd> search_all(const std::string& word, bool include_disabled = false) const;
+    // Definitions of many entries at once (export, flashcards, result pages), in the
+    // order given; empty where the dictionary or word is unknown. Requests are grouped
+    // per dictionary and read in file order: StarDict fetches neighbouring definitions
+    // with one read. A name shared by several dictionaries refers to the first one.
+    std::vector<std::string> fetch_definitions(const std::vector<DefinitionRefStd>& refs) const;
+
+    // Exact-lookup counters: dictionary probes (Holder::lookup calls) per lookup.
+    struct LookupStats {
+        uint64_t lookups = 0;
+        uint64_t probes = 0;
+        double probes_per_lookup = 0.0;
+        bool routed = true; // false after load_index() replaced the word index
+    };
+    LookupStats lookup_stats() const;
+    void reset_lookup_stats();
+
+    // Definition cache shared by exact lookups and full-text result materialization,
+    // keyed by (dictionary, headword) and invalidated per dictionary on reload or
+    // removal. Cache hits do not count as probes. 0 bytes disables it.
+    void set_definition_cache_limit(size_t max_bytes);
+    DefinitionCacheStd::Stats definition_cache_stats() const;
+    void reset_definition_cache_stats();
 
     // Indexed searches
     void build_index();
@@ -51,19 +178,53 @@ public:
     bool save_index(const std::string& file) const;
     bool load_index(const std::string& file);
 
-    // Minimal full-text search (MVP): scans definitions for substring matches.
-    // Returns matching entries across all loaded dictionaries, in load order.
+    // Full-text search over the inverted index (built on first use or loaded),
+    // returning entries ranked by TF-IDF. Plain word lists match any of their words.
+    // Queries using operators are parsed by FullTextQueryStd: AND/OR/NOT, -term,
+    // "quoted phrases", prefix*, dict:Name / -dict:Name filters and parentheses.
+    // Results are memoized in a bounded LRU keyed by the normalized query, the
+    // dictionary signature and the enabled-dictionary mask.
     std::vector<DictEntryStd> full_text_search(const std::string& query, int max_results = 10) const;
+    // Ranked hits with a preview built around the first matched term. With the
+    // snippet store on, previews come from the index and a definition is only
+    // fetched when the stored excerpt does not contain a match.
+    std::vector<FullTextHitStd> full_text_search_hits(const std::string& query, int max_results = 10) const;
+    // Excerpt bytes kept per document by indexes built from now on (0, the default,
+    // keeps none; see FullTextIndexStd::set_snippet_length).
+    void set_fulltext_snippet_length(size_t bytes) { ft_snippet_length_ = bytes; }
+    // Resize the full-text result cache (entries and total definition bytes). 0 entries disables it.
+    void set_fulltext_result_cache_limits(size_t max_entries, size_t max_bytes);
+
+    // Build the full-text index on a background thread instead of in the first query.
+    // progress runs on that thread: periodically while definitions are fetched and
+    // indexed, then once with Done or Cancelled. The future yields true once the index
+    // is installed, false if the build was cancelled or superseded (dictionary changes
+    // and index loads cancel it). While one runs, further calls return its future; with
+    // an index already present the future is ready at once.
+    using FullTextProgressFn = std::function<void(const FullTextBuildProgressStd&)>;
+    std::shared_future<bool> start_fulltext_build(FullTextProgressFn progress = {}, int threads = 0);
+    // Cancel a running build and wait for its thread to exit.
+    void cancel_fulltext_build();
+    FullTextStateStd fulltext_state() const;
+    // During a background build full-text queries do not wait for the index: they scan
+    // up to max_definitions definitions in load order and return unranked matches.
+    // 0 makes them return nothing until the index is ready.
+    void set_fulltext_scan_limit(size_t max_definitions) { ft_scan_limit_ = max_definitions; }
 
     // Full-text inverted index persistence (must match the same dictionary set/order)
-    bool save_fulltext_index(const std::string& file) const;
+    // format: 4 = UDFT4 (default), 3 = UDFT3 for older readers.
+    bool save_fulltext_index(const std::string& file, int format = 4) const;
     bool load_fulltext_index(const std::string& file);
     // Load full-text index without signature check (for legacy/loose compatibility).
     bool load_fulltext_index_relaxed(const std::string& file, int* out_version = nullptr, std::string* out_error = nullptr);
 
-    // Deterministic signature of currently loaded dictionary set/order.
-    std::string fulltext_signature() const;
-    // Stats of the currently loaded full-text index (empty if none loaded/built)
+    // Deterministic signature of currently loaded dictionary set/order: a 128-bit
+    // hash followed by names, word stats and source file size/mtime. Memoized per
+    // dictionary and invalidated by dictionary changes and reloads, so repeated calls
+    // touch no files. verify re-reads the file metadata (and refreshes the memo).
+    std::string fulltext_signature(bool verify = false) const;
+    // Stats of the currently loaded full-text index (empty if none loaded/built).
+    // Concurrent first queries share one lazy build; index_builds counts them.
     FullTextIndexStd::Stats fulltext_stats() const;
 
 private:
@@ -74,17 +235,170 @@ private:
         std::shared_ptr<MdictParserStd> mdict;
         std::shared_ptr<DslParserStd> dsl;
         std::shared_ptr<CsvParserStd> csv;
+        std::shared_ptr<DictSnapshotStd> snapshot; // set instead of a parser on a warm start
         std::string name;
         bool enabled = true;
         std::vector<std::string> src_paths; // original source paths for signature binding (companion files)
-        std::vector<std::string> words;
+        // Headwords viewed in place in the parser or snapshot this holder owns
+        HeadwordViewStd words;
+        // Extra index keys resolving to a headword's definition (StarDict synonyms)
+        HeadwordViewStd aliases;
+        // Registered via register_dictionary() and not parsed yet
+        bool pending = false;
+        uint64_t id = 0;
+        std::string path;
+        int meta_word_count = -1;
+        std::string meta_description;
+        std::string fingerprint; // of src_paths when parsed (see DictSnapshotStd::fingerprint)
+        bool private_copy = false; // loaded with LoadOptions::private_copy
+        mutable std::string signature; // this dictionary's signature segment; empty until needed (sig_mu_)
+        // Set when loaded through registry_; keeps the parser and index segment alive
+        std::shared_ptr<const SharedDictionaryStd> shared;
         std::string lookup(const std::string& w) const;
+        std::vector<std::string> lookup_batch(const std::vector<std::string>& ws) const;
+        // True if lookups read a mapping of its source files
+        bool maps_sources() const;
     };
+    // d.lookup(w) through def_cache_ (mu_ held, shared is enough).
+    std::string cached_lookup(const Holder& d, const std::string& w) const;
+    // Batched cached_lookup: reqs are (index into dicts_, word); out is index-aligned (mu_ held).
+    void fetch_batch(const std::vector<std::pair<size_t, std::string>>& reqs, std::vector<std::string>& out) const;
+
+    // How dictionaries are loaded; copied from the manager under mu_ before parsing.
+    struct LoadOptions {
+        std::string snapshot_dir;  // empty: load snapshots disabled
+        bool private_copy = false; // read mapped files (StarDict, .mdx) into memory instead
+    };
+    LoadOptions load_options() const { return {snapshot_dir_, private_copies_}; } // mu_ held
+    // Parse a dictionary file into h (no shared state touched; safe to run concurrently).
+    // With a non-empty snapshot_dir a valid snapshot replaces parsing, and a fresh
+    // parse writes one.
+    // With a registry the dictionary is taken from (or parsed into) it instead.
+    static bool load_holder(const std::string& path, Holder& h, const LoadOptions& opts,
+                            bool* from_snapshot, std::string* error, DictionaryRegistryStd* registry);
+    static bool parse_holder(const std::string& path, Holder& h, const LoadOptions& opts,
+                             bool* from_snapshot, std::string* error);
+    // The source file plus its companions (.idx/.dict[.dz], same-stem .mdd).
+    static std::vector<std::string> source_paths(const std::string& path);
+    // Parse paths on up to threads workers into holders/reports (index-aligned).
+    static void load_batch(const std::vector<std::string>& paths, std::vector<Holder>& holders,
+                           std::vector<DictLoadReportStd>& reports, int threads, const LoadOptions& opts,
+                           DictionaryRegistryStd* registry);
+    // Add or drop h's words in index_ (its shared segment when it has one).
+    void index_add(const Holder& h) const;
+    void index_remove(const Holder& h) const;
+    // Register a parsed dictionary with the word index and invalidate the full-text index.
+    // Callers hold mu_ exclusively (as for every helper below that mutates state).
+    void insert_holder(Holder&& h);
+    // Lazy activation. Replacing a pending holder in place keeps dictionary positions
+    // (and thus full-text document references) stable.
+    void ensure_active(bool include_disabled) const;
+    bool needs_activation(bool include_disabled) const;
+    void activate_indices(const std::vector<size_t>& which, int threads, std::vector<DictLoadReportStd>* reports) const;
+    void activate_holder(size_t i, Holder&& parsed, bool ok) const;
+    bool adopt_warmed() const;
+    // Parse the pending dictionaries a query would see without holding mu_, then
+    // install them under a short exclusive lock (call without mu_ held).
+    void activate_pending(bool include_disabled) const;
+    // Install parsed holders by id, skipping any removed or activated meanwhile (mu_ held exclusively).
+    bool adopt_parsed(const std::vector<uint64_t>& ids, std::vector<Holder>& holders,
+                      const std::vector<DictLoadReportStd>& reports) const;
+    mutable std::mutex activation_mu_; // serializes activate_pending(); taken before mu_
+    // Shared lock for a query, activating pending dictionaries first (see
+    // activate_pending) when the query would see them.
+    std::shared_lock<std::shared_mutex> read_lock(bool include_disabled) const;
+    // mu_ acquisition through turnstile_; never call either while holding mu_.
+    std::shared_lock<std::shared_mutex> lock_shared() const;
+    std::unique_lock<std::shared_mutex> lock_exclusive() const;
+
+    // Background warmup hand-off: the worker parses, queries adopt.
+    struct WarmupQueue {
+        std::mutex mu;
+        std::vector<std::pair<uint64_t, std::pair<bool, Holder>>> ready; // id -> (ok, parsed)
+        std::atomic<bool> stop{false};
+    };
+    std::shared_ptr<WarmupQueue> warmup_; // assigned under both warmup_mu_ and mu_
+    std::thread warmup_thread_;
+    std::mutex warmup_mu_;                // start/stop of warmup_thread_; taken before mu_
+    void join_warmup();
+    uint64_t next_holder_id_ = 1;
+    // Indices into dicts_ that may contain word, in load order. Returns false when
+    // the word index cannot be trusted for routing (caller probes every dictionary).
+    bool route_lookup(const std::string& word, std::vector<size_t>& out) const;
+    void rebuild_holder_map() const;
+
+    // Guards everything below except the full-text state and the counters.
+    mutable std::shared_mutex mu_;
+    mutable std::mutex turnstile_;
+    mutable std::unordered_map<std::string, std::vector<size_t>> holders_by_name_; // name -> indices into dicts_
+    bool index_routing_ = true;
+    std::string snapshot_dir_; // empty: load snapshots disabled
+    bool private_copies_ = false; // set by start_watching(): watched files may be rewritten in place
+    const std::shared_ptr<DictionaryRegistryStd> registry_; // null: dictionaries are private to this manager
+    mutable std::atomic<uint64_t> lookup_count_{0};
+    mutable std::atomic<uint64_t> probe_count_{0};
+    // Internally locked; entries are only added under mu_, so invalidating a holder
+    // under the exclusive lock cannot race with a stale insert.
+    mutable DefinitionCacheStd def_cache_;
+
+    // Mutable so queries can activate registered dictionaries on first access.
+    mutable std::vector<Holder> dicts_;
+    mutable IndexEngineStd index_;
+
+    // Full-text state, guarded by ft_mu_ (taken after mu_). Queries keep their own
+    // reference to the index, so it can be replaced while they run.
+    mutable std::mutex ft_mu_;
+    mutable std::shared_ptr<FullTextIndexStd> ft_index_; // built lazily
+    mutable uint64_t ft_builds_ = 0;
+    mutable uint64_t ft_generation_ = 0; // bumped by set_fulltext_index()
+    // Valid while a query builds the index (fulltext_index); others wait on it
+    mutable std::shared_future<std::shared_ptr<FullTextIndexStd>> ft_lazy_build_;
+    // Current full-text index, built on first use (exactly once across threads,
+    // without holding ft_mu_ while building).
+    // Null while a background build is running (*building set), so queries can scan instead.
+    std::shared_ptr<FullTextIndexStd> fulltext_index(bool* building = nullptr) const;
+    // Definitions of the enabled dictionaries as index documents.
+    static std::vector<std::pair<std::string, FullTextIndexStd::DocRef>> collect_fulltext_documents(
+        const std::vector<Holder>& dicts, const std::atomic<bool>* cancel, const FullTextProgressFn& progress);
+
+    // Background build: the job is current while ft_job_ points at it (under ft_mu_).
+    struct FullTextBuildJob {
+        std::atomic<bool> cancel{false};
+        std::promise<bool> promise;
+        std::shared_future<bool> future;
+    };
+    mutable std::shared_ptr<FullTextBuildJob> ft_job_;
+    std::thread ft_build_thread_;
+    std::mutex ft_build_mu_; // start/join of ft_build_thread_; taken before mu_
+    void run_fulltext_build(std::shared_ptr<FullTextBuildJob> job, std::vector<Holder> dicts,
+                            FullTextProgressFn progress, int threads);
+    std::atomic<size_t> ft_scan_limit_{20000};
+    std::atomic<size_t> ft_snippet_length_{0};
+
+    // Reparse the holder with this id and swap it in (see reload_dictionary).
+    bool reload_holder(uint64_t id, const std::string& path, const LoadOptions& opts);
+    std::unique_ptr<FileWatcherStd> watcher_;
+    std::mutex watch_mu_; // start/stop of watcher_; never taken by the watcher thread
+    // Unindexed fallback for queries made during a background build (mu_ held).
+    std::vector<DictEntryStd> scan_fulltext(const std::string& query, int max_results,
+                                            std::vector<std::string>* terms) const;
+    void set_fulltext_index(std::shared_ptr<FullTextIndexStd> idx) const;
+    // Dispatch to the boolean query plan or the legacy ranked-OR search.
+    std::vector<FullTextIndexStd::Hit> run_fulltext_query(const FullTextIndexStd& idx, const std::string& query,
+                                                          int max_results, std::vector<std::string>* terms) const;
+    static std::string fulltext_query_key(const std::string& query);
+    // fulltext_signature() without activating anything (mu_ held).
+    std::string signature_locked(bool verify = false) const;
+    static std::string signature_segment(const Holder& d);
+    // Drop the memoized signature after changing dicts_ (mu_ held exclusively).
+    void invalidate_signature() const;
+    mutable std::mutex sig_mu_; // taken after mu_
+    mutable std::string sig_cache_;
 
-    std::vector<Holder> dicts_;
-    IndexEngineStd index_;
-    mutable std::unique_ptr<FullTextIndexStd> ft_index_; // built lazily
-    void ensure_fulltext_index_built() const;
+    // Full-text result cache; flushed whenever the index or the signature it is bound to changes.
+    mutable LruCacheStd<std::string, std::vector<DictEntryStd>> ft_result_cache_{256, 8u * 1024u * 1024u};
+    mutable std::string ft_cache_signature_;
+    bool ft_result_cache_enabled_ = true;
     const Holder* find_dictionary(const std::string& dict_name) const;
 };
 
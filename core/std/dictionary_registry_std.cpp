@@ -0,0 +1,89 @@
+#include "dictionary_registry_std.h"
+
+#include <exception>
+
+namespace UnidictCoreStd {
+
+std::shared_ptr<DictionaryRegistryStd> DictionaryRegistryStd::global() {
+    static std::shared_ptr<DictionaryRegistryStd> instance = std::make_shared<DictionaryRegistryStd>();
+    return instance;
+}
+
+std::shared_ptr<const SharedDictionaryStd> DictionaryRegistryStd::acquire(const std::string& path, const std::string& fingerprint,
+                                                                          const Loader& load, bool* reused, std::string* error) {
+    if (reused) *reused = false;
+    const std::string key = path + '\n' + fingerprint;
+    std::promise<Result> promise;
+    {
+        std::unique_lock<std::mutex> lk(mu_);
+        // Drop slots whose entries every manager has released
+        for (auto it = slots_.begin(); it != slots_.end();) {
+            if (!it->second.pending.valid() && it->second.entry.expired()) it = slots_.erase(it);
+            else ++it;
+        }
+        auto it = slots_.find(key);
+        if (it != slots_.end()) {
+            if (auto e = it->second.entry.lock()) {
+                ++reuses_;
+                if (reused) *reused = true;
+                return e;
+            }
+        }
+        // A slot whose entry expired after the sweep above has nothing
+        // pending: take it over and load it like a missing key
+        if (it != slots_.end() && it->second.pending.valid()) {
+            // Someone else is parsing it: wait without the lock
+            std::shared_future<Result> f = it->second.pending;
+            lk.unlock();
+            const Result& r = f.get();
+            if (!r.entry) {
+                if (error) *error = r.error;
+                return nullptr;
+            }
+            std::lock_guard<std::mutex> relk(mu_);
+            ++reuses_;
+            if (reused) *reused = true;
+            return r.entry;
+        }
+        slots_[key].pending = promise.get_future().share();
+        ++loads_;
+    }
+
+    Result r;
+    try {
+        auto e = std::make_shared<SharedDictionaryStd>();
+        if (load(*e, &r.error)) {
+            e->segment = std::make_shared<IndexSegmentStd>(e->words, e->aliases);
+            r.entry = std::move(e);
+        }
+    } catch (const std::exception& ex) {
+        r.error = ex.what();
+    }
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        auto it = slots_.find(key);
+        if (r.entry) {
+            it->second.entry = r.entry;
+            it->second.pending = {};
+        } else {
+            // Not cached: the next acquire retries
+            slots_.erase(it);
+        }
+    }
+    promise.set_value(r);
+    if (!r.entry && error) *error = r.error;
+    return r.entry;
+}
+
+DictionaryRegistryStd::Stats DictionaryRegistryStd::stats() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    Stats s;
+    s.loads = loads_;
+    s.reuses = reuses_;
+    for (const auto& kv : slots_) {
+        if (!kv.second.entry.expired()) ++s.live;
+    }
+    return s;
+}
+
+} // namespace UnidictCoreStd
@@ -0,0 +1,93 @@
+// Process-wide registry of loaded dictionaries (std-only).
+// Parsed dictionaries are immutable once loaded, so managers that open the same
+// file can share one copy: the registry hands out reference-counted entries keyed
+// by source path and fingerprint (path/size/mtime of the source files), parses
+// each at most once even when several managers ask concurrently, and forgets an
+// entry when the last manager drops it. A changed file gets a new entry; managers
+// still holding the old version keep it alive until they reload.
+//
+// Each manager stays a lightweight view over shared entries: it owns the order
+// and enabled flags, its caches and its full-text index.
+
+#ifndef UNIDICT_DICTIONARY_REGISTRY_STD_H
+#define UNIDICT_DICTIONARY_REGISTRY_STD_H
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "index_engine_std.h"
+#include "json_parser_std.h"
+#include "stardict_parser_std.h"
+#include "mdict_parser_std.h"
+#include "dsl_parser_std.h"
+#include "csv_parser_std.h"
+#include "dict_snapshot_std.h"
+
+namespace UnidictCoreStd {
+
+// One loaded dictionary. Only one parser (or the snapshot) is set.
+struct SharedDictionaryStd {
+    std::shared_ptr<JsonParserStd> json;
+    std::shared_ptr<StarDictParserStd> stardict;
+    std::shared_ptr<MdictParserStd> mdict;
+    std::shared_ptr<DslParserStd> dsl;
+    std::shared_ptr<CsvParserStd> csv;
+    std::shared_ptr<DictSnapshotStd> snapshot;
+    std::string name;
+    std::string fingerprint;
+    HeadwordViewStd words;                          // in place in the parser or snapshot
+    HeadwordViewStd aliases;                        // StarDict synonyms, likewise
+    std::shared_ptr<const IndexSegmentStd> segment; // words and aliases, normalized and sorted
+    bool from_snapshot = false;
+};
+
+class DictionaryRegistryStd {
+public:
+    // Fills the entry (everything but segment); false and *error on failure.
+    using Loader = std::function<bool(SharedDictionaryStd& entry, std::string* error)>;
+
+    DictionaryRegistryStd() = default;
+    DictionaryRegistryStd(const DictionaryRegistryStd&) = delete;
+    DictionaryRegistryStd& operator=(const DictionaryRegistryStd&) = delete;
+
+    // The process-wide instance.
+    static std::shared_ptr<DictionaryRegistryStd> global();
+
+    // Entry for (path, fingerprint): the live one if any, else the result of load.
+    // Concurrent callers for the same key wait for a single load. *reused tells
+    // whether the entry was already loaded (or being loaded) by someone else.
+    std::shared_ptr<const SharedDictionaryStd> acquire(const std::string& path, const std::string& fingerprint,
+                                                       const Loader& load, bool* reused, std::string* error);
+
+    struct Stats {
+        uint64_t loads = 0;  // entries parsed
+        uint64_t reuses = 0; // acquires served by an existing entry
+        size_t live = 0;     // entries currently referenced
+    };
+    Stats stats() const;
+
+private:
+    struct Result {
+        std::shared_ptr<const SharedDictionaryStd> entry;
+        std::string error;
+    };
+    struct Slot {
+        std::weak_ptr<const SharedDictionaryStd> entry;
+        std::shared_future<Result> pending; // valid while loading
+    };
+
+    mutable std::mutex mu_;
+    std::unordered_map<std::string, Slot> slots_; // path + '\n' + fingerprint
+    uint64_t loads_ = 0;
+    uint64_t reuses_ = 0;
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_DICTIONARY_REGISTRY_STD_H
@@ -0,0 +1,175 @@
+#include "dictzip_reader_std.h"
+
+#include <algorithm>
+#include <zlib.h>
+
+namespace UnidictCoreStd {
+
+namespace {
+
+constexpr unsigned char kFHcrc = 0x02, kFExtra = 0x04, kFName = 0x08, kFComment = 0x10;
+
+uint16_t le16(const unsigned char* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+uint32_t le32(const unsigned char* p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+} // namespace
+
+DictzipReaderStd::~DictzipReaderStd() { close(); }
+
+void DictzipReaderStd::close() {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (gz_) { gzclose((gzFile)gz_); gz_ = nullptr; }
+    if (in_.is_open()) in_.close();
+    in_.clear();
+    chunk_len_ = 0;
+    chunk_offs_.clear();
+    size_ = 0;
+    cache_.clear();
+    stats_ = {};
+    open_ = false;
+}
+
+bool DictzipReaderStd::open(const std::string& path) {
+    close();
+    std::lock_guard<std::mutex> lk(mu_);
+    in_.open(path, std::ios::binary);
+    if (!in_ || !parse_header()) {
+        in_.close();
+        chunk_offs_.clear();
+        return false;
+    }
+    if (random_access()) {
+        // Every chunk but the last inflates to exactly CHLEN bytes
+        auto last = chunk(chunk_offs_.size() - 2);
+        if (!last) { in_.close(); chunk_offs_.clear(); return false; }
+        size_ = (uint64_t)chunk_len_ * (chunk_offs_.size() - 2) + last->size();
+    } else {
+        in_.close();
+        gz_ = gzopen(path.c_str(), "rb");
+        if (!gz_) return false;
+    }
+    open_ = true;
+    return true;
+}
+
+bool DictzipReaderStd::parse_header() {
+    unsigned char h[10];
+    if (!in_.read((char*)h, sizeof(h)) || h[0] != 0x1f || h[1] != 0x8b || h[2] != 8) return false;
+    const unsigned char flags = h[3];
+    if (flags & kFExtra) {
+        unsigned char xl[2];
+        if (!in_.read((char*)xl, 2)) return false;
+        std::string extra(le16(xl), '\0');
+        if (!in_.read(extra.data(), (std::streamsize)extra.size())) return false;
+        // Subfields: SI1 SI2 LEN(le16) data; dictzip's is "RA": VER CHLEN CHCNT sizes...
+        const unsigned char* p = (const unsigned char*)extra.data();
+        const unsigned char* end = p + extra.size();
+        while (end - p >= 4) {
+            const uint16_t len = le16(p + 2);
+            const unsigned char* data = p + 4;
+            if (len > end - data) break;
+            if (p[0] == 'R' && p[1] == 'A' && len >= 6 && le16(data) == 1) {
+                const uint16_t count = le16(data + 4);
+                if (len >= 6 + 2 * (size_t)count && count > 0 && le16(data + 2) > 0) {
+                    chunk_len_ = le16(data + 2);
+                    chunk_offs_.assign(1, 0);
+                    for (uint16_t i = 0; i < count; ++i) chunk_offs_.push_back(chunk_offs_.back() + le16(data + 6 + 2 * i));
+                }
+            }
+            p = data + len;
+        }
+    }
+    auto skip_zstring = [this]() {
+        char c = 0;
+        while (in_.get(c) && c != '\0') {}
+        return (bool)in_;
+    };
+    if ((flags & kFName) && !skip_zstring()) return false;
+    if ((flags & kFComment) && !skip_zstring()) return false;
+    if ((flags & kFHcrc) && !in_.ignore(2)) return false;
+    const uint64_t data_start = (uint64_t)in_.tellg();
+    for (auto& off : chunk_offs_) off += data_start;
+    if (!random_access()) {
+        // Plain gzip: the trailer records the uncompressed size
+        unsigned char t[4];
+        in_.seekg(-4, std::ios::end);
+        if (!in_.read((char*)t, 4)) return false;
+        size_ = le32(t);
+    }
+    return true;
+}
+
+std::shared_ptr<const std::string> DictzipReaderStd::chunk(size_t i) const {
+    if (const auto* hit = cache_.get(i)) {
+        ++stats_.cache_hits;
+        return *hit;
+    }
+    std::string comp((size_t)(chunk_offs_[i + 1] - chunk_offs_[i]), '\0');
+    in_.clear();
+    in_.seekg((std::streamoff)chunk_offs_[i]);
+    if (!in_.read(comp.data(), (std::streamsize)comp.size())) return nullptr;
+    // Each chunk ends on a full flush, so it inflates on its own as raw deflate
+    auto out = std::make_shared<std::string>(chunk_len_, '\0');
+    z_stream zs{};
+    if (inflateInit2(&zs, -MAX_WBITS) != Z_OK) return nullptr;
+    zs.next_in = (Bytef*)comp.data();
+    zs.avail_in = (uInt)comp.size();
+    zs.next_out = (Bytef*)out->data();
+    zs.avail_out = (uInt)out->size();
+    const int rc = inflate(&zs, Z_SYNC_FLUSH);
+    const size_t produced = out->size() - zs.avail_out;
+    inflateEnd(&zs);
+    if (rc != Z_OK && rc != Z_STREAM_END && !(rc == Z_BUF_ERROR && produced > 0)) return nullptr;
+    out->resize(produced);
+    ++stats_.inflated;
+    std::shared_ptr<const std::string> c = std::move(out);
+    cache_.put(i, c);
+    return c;
+}
+
+bool DictzipReaderStd::read(uint64_t offset, size_t size, std::string& out) const {
+    out.clear();
+    std::lock_guard<std::mutex> lk(mu_);
+    if (!open_ || offset > size_ || size > size_ - offset) return false;
+    if (size == 0) return true;
+    out.reserve(size);
+    if (!random_access()) {
+        // gzseek inflates forward from the current position (or rewinds)
+        gzFile gz = (gzFile)gz_;
+        if (gzseek(gz, (z_off_t)offset, SEEK_SET) < 0) return false;
+        out.resize(size);
+        size_t got = 0;
+        while (got < size) {
+            const unsigned step = (unsigned)std::min<size_t>(size - got, 1u << 30);
+            const int n = gzread(gz, out.data() + got, step);
+            if (n <= 0) break;
+            got += (size_t)n;
+        }
+        out.resize(got);
+        return got == size;
+    }
+    const uint64_t end = offset + size;
+    for (uint64_t c = offset / chunk_len_; c * chunk_len_ < end; ++c) {
+        if (c + 1 >= chunk_offs_.size()) return false;
+        auto data = chunk((size_t)c);
+        if (!data) return false;
+        const uint64_t base = c * chunk_len_;
+        const uint64_t from = std::max(offset, base) - base;
+        const uint64_t to = std::min<uint64_t>(end - base, data->size());
+        if (from > to) return false;
+        out.append(*data, (size_t)from, (size_t)(to - from));
+    }
+    return out.size() == size;
+}
+
+void DictzipReaderStd::set_cache_chunks(size_t n) {
+    std::lock_guard<std::mutex> lk(mu_);
+    cache_.set_limits(n);
+}
+
+DictzipReaderStd::Stats DictzipReaderStd::stats() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return stats_;
+}
+
+} // namespace UnidictCoreStd
@@ -0,0 +1,71 @@
+// Random-access reader for dictzip files (.dict.dz, .dsl.dz), std-only.
+// dictzip is gzip whose deflate stream is fully flushed every CHLEN input bytes;
+// the gzip "RA" extra field lists each chunk's compressed size, so a byte range
+// inflates only the chunks covering it. Recently inflated chunks are kept in a
+// small LRU. Plain gzip files (no RA table) open as well, but reads then inflate
+// sequentially from the start of the file.
+
+#ifndef UNIDICT_DICTZIP_READER_STD_H
+#define UNIDICT_DICTZIP_READER_STD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "lru_cache_std.h"
+
+namespace UnidictCoreStd {
+
+class DictzipReaderStd {
+public:
+    DictzipReaderStd() = default;
+    ~DictzipReaderStd();
+    DictzipReaderStd(const DictzipReaderStd&) = delete;
+    DictzipReaderStd& operator=(const DictzipReaderStd&) = delete;
+
+    // False if the file is missing or not gzip.
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return open_; }
+    // True for dictzip files: reads touch only the chunks they need.
+    bool random_access() const { return !chunk_offs_.empty(); }
+    // Uncompressed size (plain gzip: from the trailer, modulo 4 GiB).
+    uint64_t size() const { return size_; }
+
+    // size bytes at offset of the uncompressed data; false if out of range or corrupt.
+    // Safe to call from several threads.
+    bool read(uint64_t offset, size_t size, std::string& out) const;
+    bool read_all(std::string& out) const { return read(0, (size_t)size_, out); }
+
+    // Inflated chunks kept (default 32, about 2 MiB with dictzip's usual CHLEN).
+    void set_cache_chunks(size_t n);
+
+    struct Stats {
+        uint64_t inflated = 0;   // chunks inflated
+        uint64_t cache_hits = 0; // chunks served from the LRU
+    };
+    Stats stats() const;
+
+private:
+    bool parse_header();
+    // Chunk i, inflated (mu_ held).
+    std::shared_ptr<const std::string> chunk(size_t i) const;
+
+    mutable std::mutex mu_;
+    mutable std::ifstream in_;
+    void* gz_ = nullptr;            // gzFile for plain gzip
+    uint32_t chunk_len_ = 0;
+    std::vector<uint64_t> chunk_offs_; // file offset of each chunk, plus the end of the last
+    uint64_t size_ = 0;
+    mutable LruCacheStd<size_t, std::shared_ptr<const std::string>> cache_{32};
+    mutable Stats stats_;
+    bool open_ = false;
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_DICTZIP_READER_STD_H
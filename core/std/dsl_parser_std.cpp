@@ -4,8 +4,11 @@
 #include <cctype>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
 
+#include "dictzip_reader_std.h"
+
 namespace UnidictCoreStd {
 
 static inline std::string trim(const std::string& str) {
@@ -22,6 +25,20 @@ static inline std::string lcase(const std::string& s) {
     return result;
 }
 
+// Plain .dsl, or .dsl.dz (dictzip or gzip) inflated up to limit bytes.
+static std::unique_ptr<std::istream> open_source(const std::string& path, uint64_t limit = UINT64_MAX) {
+    const bool dz = path.size() > 3 && lcase(path.substr(path.size() - 3)) == ".dz";
+    if (!dz) {
+        auto file = std::make_unique<std::ifstream>(path, std::ios::binary);
+        if (!*file) return nullptr;
+        return file;
+    }
+    DictzipReaderStd reader;
+    std::string text;
+    if (!reader.open(path) || !reader.read(0, (size_t)std::min<uint64_t>(reader.size(), limit), text)) return nullptr;
+    return std::make_unique<std::istringstream>(std::move(text));
+}
+
 DslParserStd::DslParserStd() = default;
 
 bool DslParserStd::load_dictionary(const std::string& dsl_path) {
@@ -31,10 +48,11 @@ bool DslParserStd::load_dictionary(const std::string& dsl_path) {
     name_.clear();
     desc_.clear();
 
-    std::ifstream file(dsl_path, std::ios::binary);
-    if (!file) {
+    auto source = open_source(dsl_path);
+    if (!source) {
         return false;
     }
+    std::istream& file = *source;
 
     std::string line;
     std::string current_headword;
@@ -118,6 +136,28 @@ bool DslParserStd::load_dictionary(const std::string& dsl_path) {
     return loaded_;
 }
 
+bool DslParserStd::read_header(const std::string& dsl_path, std::string& name) {
+    name.clear();
+    // The header is at the top; a compressed file is only inflated that far
+    auto source = open_source(dsl_path, 64 * 1024);
+    if (!source) return false;
+    std::istream& file = *source;
+    DslParserStd header;
+    std::string line;
+    bool first = true;
+    while (std::getline(file, line)) {
+        if (first && line.size() >= 3 && (unsigned char)line[0] == 0xEF && (unsigned char)line[1] == 0xBB && (unsigned char)line[2] == 0xBF) {
+            line = line.substr(3);
+        }
+        first = false;
+        line = trim(line);
+        if (line.empty()) continue;
+        if (line[0] != '#' || !header.parse_header(line)) break; // first entry: header is over
+    }
+    name = header.name_.empty() ? "DSL Dictionary" : header.name_;
+    return true;
+}
+
 bool DslParserStd::parse_header(const std::string& line) {
     if (line.find("#NAME") == 0) {
         size_t pos = line.find_first_of(" \t");
@@ -5,6 +5,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "headword_view_std.h"
+
 namespace UnidictCoreStd {
 
 // DSL (Dictionary Specification Language) parser for ABBYY Lingvo dictionaries
@@ -15,6 +17,8 @@ public:
 
     bool load_dictionary(const std::string& dsl_path);
     bool is_loaded() const;
+    // Read only the leading #NAME / #..._LANGUAGE header lines.
+    static bool read_header(const std::string& dsl_path, std::string& name);
 
     std::string dictionary_name() const;
     std::string dictionary_description() const;
@@ -23,6 +27,8 @@ public:
     std::string lookup(const std::string& word) const;
     std::vector<std::string> find_similar(const std::string& word, int max_results) const;
     std::vector<std::string> all_words() const;
+    // Non-owning view of the same list; valid while the parser is alive and not reloaded.
+    HeadwordViewStd headwords() const { return HeadwordViewStd(words_); }
 
 private:
     bool parse_header(const std::string& line);
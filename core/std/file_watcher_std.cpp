@@ -0,0 +1,170 @@
+#include "file_watcher_std.h"
+
+#include <chrono>
+#include <filesystem>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace UnidictCoreStd {
+
+static std::string normalized(const std::string& p) {
+    std::error_code ec;
+    fs::path a = fs::absolute(fs::path(p), ec);
+    return (ec ? fs::path(p) : a).lexically_normal().string();
+}
+
+// size/mtime of every path, in order; missing files are recorded as such
+static std::string stat_all(const std::vector<std::string>& paths) {
+    std::ostringstream ss;
+    for (const auto& p : paths) {
+        std::error_code ec;
+        const auto sz = fs::file_size(p, ec);
+        if (ec) { ss << p << "|(missing);"; continue; }
+        const auto ts = fs::last_write_time(p, ec).time_since_epoch().count();
+        ss << p << '|' << (unsigned long long)sz << '|' << (long long)ts << ';';
+    }
+    return ss.str();
+}
+
+FileWatcherStd::~FileWatcherStd() { stop(); }
+
+bool FileWatcherStd::start(PathsFn paths, ChangeFn on_change, int poll_ms, int settle_ms) {
+    if (thread_.joinable()) return false;
+    paths_ = std::move(paths);
+    on_change_ = std::move(on_change);
+    poll_ms_ = poll_ms > 0 ? poll_ms : 1000;
+    settle_ms_ = settle_ms >= 0 ? settle_ms : 0;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_ = false;
+    }
+    int fd = -1;
+#ifdef __linux__
+    if (!force_polling_) fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    inotify_ = fd >= 0;
+    thread_ = std::thread([this, fd]() {
+        if (fd >= 0) run_inotify(fd);
+        else run_polling();
+    });
+    return true;
+}
+
+void FileWatcherStd::stop() {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    inotify_ = false;
+}
+
+bool FileWatcherStd::wait_for(int ms) {
+    std::unique_lock<std::mutex> lk(mu_);
+    return !cv_.wait_for(lk, std::chrono::milliseconds(ms), [this]() { return stop_; });
+}
+
+void FileWatcherStd::run_polling() {
+    std::string last = stat_all(paths_());
+    on_change_(); // catch up with anything changed before the baseline
+    while (wait_for(poll_ms_)) {
+        std::string cur = stat_all(paths_());
+        if (cur == last) continue;
+        // Settle: wait until two consecutive looks agree
+        for (;;) {
+            if (!wait_for(settle_ms_)) return;
+            std::string again = stat_all(paths_());
+            if (again == cur) break;
+            cur = std::move(again);
+        }
+        last = cur;
+        on_change_();
+    }
+}
+
+void FileWatcherStd::run_inotify(int fd) {
+#ifdef __linux__
+    using clock = std::chrono::steady_clock;
+    std::unordered_map<int, std::string> wd_dir;
+    std::unordered_map<std::string, int> dir_wd;
+    std::unordered_set<std::string> names;
+    auto refresh = [&]() {
+        names.clear();
+        std::set<std::string> dirs;
+        for (const auto& p : paths_()) {
+            const std::string n = normalized(p);
+            names.insert(n);
+            dirs.insert(fs::path(n).parent_path().string());
+        }
+        for (auto it = dir_wd.begin(); it != dir_wd.end();) {
+            if (dirs.count(it->first)) { ++it; continue; }
+            ::inotify_rm_watch(fd, it->second);
+            wd_dir.erase(it->second);
+            it = dir_wd.erase(it);
+        }
+        for (const auto& d : dirs) {
+            if (dir_wd.count(d)) continue;
+            int wd = ::inotify_add_watch(fd, d.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE |
+                                                        IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+            if (wd < 0) continue;
+            wd_dir[wd] = d;
+            dir_wd[d] = wd;
+        }
+    };
+    refresh();
+    on_change_(); // catch up with anything changed before the watches existed
+    bool dirty = false;
+    auto last_event = clock::now();
+    auto last_refresh = clock::now();
+    alignas(struct inotify_event) char buf[8192];
+    // Short poll slices keep stop() responsive
+    while (wait_for(0)) {
+        struct pollfd pfd{fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 50) > 0 && (pfd.revents & POLLIN)) {
+            for (;;) {
+                const ssize_t n = ::read(fd, buf, sizeof(buf));
+                if (n <= 0) break;
+                for (ssize_t off = 0; off < n;) {
+                    const auto* ev = reinterpret_cast<const struct inotify_event*>(buf + off);
+                    off += (ssize_t)sizeof(struct inotify_event) + ev->len;
+                    if (ev->mask & IN_Q_OVERFLOW) { dirty = true; last_event = clock::now(); continue; }
+                    auto it = wd_dir.find(ev->wd);
+                    if (it == wd_dir.end() || ev->len == 0) continue;
+                    if (names.count((fs::path(it->second) / ev->name).lexically_normal().string())) {
+                        dirty = true;
+                        last_event = clock::now();
+                    }
+                }
+            }
+        }
+        const auto now = clock::now();
+        if (dirty && now - last_event >= std::chrono::milliseconds(settle_ms_)) {
+            dirty = false;
+            on_change_();
+            refresh();
+            last_refresh = clock::now();
+        } else if (now - last_refresh >= std::chrono::milliseconds(poll_ms_)) {
+            refresh();
+            last_refresh = now;
+        }
+    }
+    for (const auto& kv : wd_dir) ::inotify_rm_watch(fd, kv.first);
+    ::close(fd);
+#else
+    (void)fd;
+    run_polling();
+#endif
+}
+
+} // namespace UnidictCoreStd
@@ -0,0 +1,62 @@
+// Change notification for a set of files (std-only).
+// Uses inotify on Linux and falls back to polling size/mtime elsewhere (or when
+// forced, e.g. for network filesystems that deliver no events). The directories
+// holding the files are watched, so replacing a file by rename is seen as well.
+
+#ifndef UNIDICT_FILE_WATCHER_STD_H
+#define UNIDICT_FILE_WATCHER_STD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace UnidictCoreStd {
+
+class FileWatcherStd {
+public:
+    using PathsFn = std::function<std::vector<std::string>()>;
+    using ChangeFn = std::function<void()>;
+
+    FileWatcherStd() = default;
+    ~FileWatcherStd();
+    FileWatcherStd(const FileWatcherStd&) = delete;
+    FileWatcherStd& operator=(const FileWatcherStd&) = delete;
+
+    // Watch the files listed by paths; the list is re-read every poll_ms and after
+    // each notification, so it may change while watching. on_change runs on the
+    // watcher thread once no further change was seen for settle_ms (a file being
+    // copied in fires once, not per write), and once right after watching begins,
+    // since changes made before that cannot be told apart. Returns false if already running.
+    bool start(PathsFn paths, ChangeFn on_change, int poll_ms = 1000, int settle_ms = 200);
+    void stop();
+    bool running() const { return thread_.joinable(); }
+    // Poll even where inotify is available. Takes effect on the next start().
+    void set_force_polling(bool force) { force_polling_ = force; }
+    // True while running on inotify rather than polling.
+    bool uses_inotify() const { return inotify_; }
+
+private:
+    void run_polling();
+    void run_inotify(int fd);
+    // Sleep up to ms; false once stop() was called.
+    bool wait_for(int ms);
+
+    PathsFn paths_;
+    ChangeFn on_change_;
+    int poll_ms_ = 1000;
+    int settle_ms_ = 200;
+    bool force_polling_ = false;
+    std::atomic<bool> inotify_{false};
+    std::thread thread_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_FILE_WATCHER_STD_H
@@ -1,12 +1,19 @@
 #include "fulltext_index_std.h"
+#include "fulltext_query_std.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cmath>
+#include <filesystem>
 #include <fstream>
+#include <string>
 #include <unordered_set>
 #include <thread>
 #include <future>
+#include <iterator>
+
+#include <zlib.h>
 
 namespace UnidictCoreStd {
 
@@ -36,6 +43,10 @@ int FullTextIndexStd::add_document(const std::string& text, DocRef ref) {
     const int docId = (int)doc_tf_.size();
     doc_tf_.emplace_back();
     doc_map_.push_back(ref);
+    if (snippet_length_ > 0) {
+        snippets_.resize(doc_map_.size());
+        snippets_[docId] = make_excerpt(text, snippet_length_);
+    }
     auto& tf = doc_tf_.back();
     for (auto& tok : tokenize(text)) ++tf[tok];
     for (const auto& kv : tf) postings_[kv.first].vec.emplace_back(docId, kv.second);
@@ -43,12 +54,18 @@ int FullTextIndexStd::add_document(const std::string& text, DocRef ref) {
 }
 
 void FullTextIndexStd::build_from_documents(const std::vector<std::pair<std::string, DocRef>>& docs, int threads) {
+    build_from_documents(docs, threads, nullptr);
+}
+
+bool FullTextIndexStd::build_from_documents(const std::vector<std::pair<std::string, DocRef>>& docs, int threads,
+                                            const std::atomic<bool>* cancel, const BuildProgress& progress) {
     clear();
     const size_t N = docs.size();
     doc_map_.resize(N);
     for (size_t i = 0; i < N; ++i) doc_map_[i] = docs[i].second;
     // Ensure doc_tf_ is non-empty to satisfy legacy checks; keep minimal
     doc_tf_.clear(); doc_tf_.resize(N);
+    if (snippet_length_ > 0) snippets_.assign(N, std::string());
 
     if (threads <= 0) {
         unsigned int hc = std::thread::hardware_concurrency();
@@ -59,12 +76,21 @@ void FullTextIndexStd::build_from_documents(const std::vector<std::pair<std::str
 
     // Per-thread postings map: term -> vector of (docId, tf)
     std::vector<std::unordered_map<std::string, std::vector<std::pair<int,int>>>> local(threads);
+    std::atomic<size_t> done{0};
+    std::mutex progress_mu;
+    const size_t kProgressStep = 512;
     auto worker = [&](int tid) {
         size_t start = (N * tid) / threads;
         size_t end = (N * (tid + 1)) / threads;
         auto& lm = local[tid];
         for (size_t i = start; i < end; ++i) {
+            if (((i - start) % kProgressStep) == kProgressStep - 1) {
+                if (cancel && cancel->load(std::memory_order_relaxed)) return;
+                const size_t d = done.fetch_add(kProgressStep) + kProgressStep;
+                if (progress) { std::lock_guard<std::mutex> lk(progress_mu); progress(d, N); }
+            }
             const std::string& text = docs[i].first;
+            if (snippet_length_ > 0) snippets_[i] = make_excerpt(text, snippet_length_);
             std::unordered_map<std::string,int> tf;
             for (auto& tok : tokenize(text)) ++tf[tok];
             for (const auto& kv : tf) lm[kv.first].emplace_back((int)i, kv.second);
@@ -73,6 +99,7 @@ void FullTextIndexStd::build_from_documents(const std::vector<std::pair<std::str
     std::vector<std::thread> pool; pool.reserve(threads);
     for (int t = 0; t < threads; ++t) pool.emplace_back(worker, t);
     for (auto& th : pool) th.join();
+    if (cancel && cancel->load()) { clear(); return false; }
 
     // Merge all locals into postings_
     postings_.clear(); postings_.reserve(N * 2);
@@ -86,17 +113,122 @@ void FullTextIndexStd::build_from_documents(const std::vector<std::pair<std::str
     }
     // finalize: compute idf and build term directory
     finalize();
+    if (progress) progress(N, N);
+    return true;
+}
+
+// Simple varint (LEB128-like) encode/decode for 32-bit unsigned integers
+static inline void vencode_u32(uint32_t v, std::string& out) {
+    while (v >= 0x80) { out.push_back((char)((v & 0x7F) | 0x80)); v >>= 7; }
+    out.push_back((char)(v & 0x7F));
+}
+
+static inline bool vdecode_u32(const unsigned char*& p, const unsigned char* end, uint32_t& v) {
+    uint32_t result = 0; int shift = 0; const int max_shift = 35; // up to 5 bytes
+    while (p < end && shift <= max_shift) {
+        unsigned char b = *p++;
+        result |= (uint32_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) { v = result; return true; }
+        shift += 7;
+    }
+    return false;
+}
+
+// replace_documents compacts doc ids once this share of them is dead (1/4)
+static constexpr size_t kCompactDivisor = 4;
+
+void FullTextIndexStd::replace_documents(const std::function<bool(const DocRef&)>& drop,
+                                         const std::vector<std::pair<std::string, DocRef>>& docs) {
+    // Dropped ids are only marked dead: their postings stay (searches skip them)
+    // until enough ids are dead to make compacting them worth a pass over every list
+    size_t dead = 0;
+    for (size_t i = 0; i < doc_map_.size(); ++i) {
+        if (doc_map_[i].dict < 0) { ++dead; continue; }
+        if (!drop(doc_map_[i])) continue;
+        ++dead;
+        doc_map_[i] = DocRef{};
+        if (i < snippets_.size()) snippets_[i].clear();
+    }
+    if (dead > 0 && dead * kCompactDivisor >= doc_map_.size()) compact_documents();
+    // Keep the snippet store parallel to doc_map_ (an index loaded without one stays without)
+    const bool with_snippets = snippet_length_ > 0 && snippets_.size() == doc_map_.size();
+    for (const auto& d : docs) {
+        const int docId = (int)doc_map_.size();
+        doc_map_.push_back(d.second);
+        doc_tf_.emplace_back();
+        if (with_snippets) snippets_.push_back(make_excerpt(d.first, snippet_length_));
+        std::unordered_map<std::string,int> tf;
+        for (auto& tok : tokenize(d.first)) ++tf[tok];
+        // New ids are larger than any existing one, so lists stay docId-sorted.
+        // Only the lists gaining a posting are decoded if still compressed.
+        for (const auto& kv : tf) {
+            ensure_postings(kv.first);
+            postings_[kv.first].vec.emplace_back(docId, kv.second);
+        }
+    }
+    finalize();
+}
+
+void FullTextIndexStd::compact_documents() {
+    // Live ids keep their order, so renumbered lists stay docId-sorted
+    std::vector<int> remap(doc_map_.size(), -1);
+    const bool tf = doc_tf_.size() == doc_map_.size(), snip = snippets_.size() == doc_map_.size();
+    size_t live = 0;
+    for (size_t i = 0; i < doc_map_.size(); ++i) {
+        if (doc_map_[i].dict < 0) continue;
+        remap[i] = (int)live;
+        doc_map_[live] = doc_map_[i];
+        if (tf) doc_tf_[live] = std::move(doc_tf_[i]);
+        if (snip) snippets_[live] = std::move(snippets_[i]);
+        ++live;
+    }
+    doc_map_.resize(live);
+    if (tf) doc_tf_.resize(live);
+    if (snip) snippets_.resize(live);
+    for (auto it = postings_.begin(); it != postings_.end();) {
+        ensure_postings(it->first);
+        auto& vec = it->second.vec;
+        size_t n = 0;
+        for (const auto& p : vec) {
+            const int id = p.first >= 0 && (size_t)p.first < remap.size() ? remap[p.first] : -1;
+            if (id >= 0) vec[n++] = {id, p.second};
+        }
+        vec.resize(n);
+        if (vec.empty()) it = postings_.erase(it);
+        else ++it;
+    }
 }
 
 void FullTextIndexStd::finalize() {
     idf_.clear();
-    const double N = (double)doc_map_.size();
-    if (N <= 0.0) return;
+    double N = 0.0;
+    for (const auto& r : doc_map_) if (r.dict >= 0) N += 1.0; // ids dropped by replace_documents do not count
+    if (N <= 0.0) { build_term_directory(); return; }
+    const bool any_dead = N < (double)doc_map_.size();
     idf_.reserve(postings_.size());
     for (auto& kv : postings_) {
         PostingEntry& pe = kv.second;
-        if (!pe.compressed) pe.count = (uint32_t)pe.vec.size();
-        double df = pe.compressed ? (double)pe.count : (double)pe.vec.size();
+        double df = (double)pe.count;
+        if (!pe.compressed) {
+            pe.count = (uint32_t)pe.vec.size();
+            // Boolean queries intersect postings by docId; legacy files may be unordered
+            if (!std::is_sorted(pe.vec.begin(), pe.vec.end()))
+                std::sort(pe.vec.begin(), pe.vec.end());
+            df = (double)pe.vec.size();
+            if (any_dead) df = (double)std::count_if(pe.vec.begin(), pe.vec.end(), [&](const std::pair<int,int>& p) { return live(p.first); });
+        } else if (any_dead) {
+            // Walk the varints rather than decode, so the list stays compressed
+            const unsigned char* p = (const unsigned char*)pe.buf.data();
+            const unsigned char* end = p + pe.buf.size();
+            uint32_t doc = 0, n = 0;
+            for (uint32_t i = 0; i < pe.count; ++i) {
+                uint32_t delta = 0, tf = 0;
+                if (!vdecode_u32(p, end, delta) || !vdecode_u32(p, end, tf)) break;
+                doc = i == 0 ? delta : doc + delta;
+                if (live((int)doc)) ++n;
+            }
+            df = (double)n;
+        }
         double val = std::log((N + 1.0) / (df + 1.0)) + 1.0;
         idf_.emplace(kv.first, val);
     }
@@ -105,20 +237,24 @@ void FullTextIndexStd::finalize() {
 
 std::vector<FullTextIndexStd::DocRef> FullTextIndexStd::search(const std::string& query, int max_results) const {
     std::vector<DocRef> out;
+    auto hits = search_hits(query, max_results);
+    out.reserve(hits.size());
+    for (const auto& h : hits) out.push_back(h.ref);
+    return out;
+}
+
+std::vector<FullTextIndexStd::Hit> FullTextIndexStd::search_hits(const std::string& query, int max_results,
+                                                                 std::vector<std::string>* matched_terms) const {
+    std::vector<Hit> out;
     if (query.empty() || doc_map_.empty()) return out;
     std::unordered_map<int, double> score; // docId -> score
     std::unordered_set<std::string> seen_query_terms;
     std::unordered_set<std::string> used_terms;
+    size_t typo_budget = typo_max_expansions_;
     for (auto& tok : tokenize(query)) {
         if (!seen_query_terms.insert(tok).second) continue; // de-dup query term
-        // Collect exact token and, if missing, substring matches to approximate substring search
-        std::vector<std::string> terms; terms.push_back(tok);
-        if (postings_.find(tok) == postings_.end()) {
-            const size_t kCap = 256;
-            auto cand = substring_candidates(tok, kCap);
-            terms.insert(terms.end(), cand.begin(), cand.end());
-        }
-        for (const auto& term : terms) {
+        // Collect exact token and, if missing, substring matches and near misses
+        for (const auto& [term, weight] : expand_term(tok, false, &typo_budget)) {
             if (!used_terms.insert(term).second) continue; // avoid double-count when multiple query tokens share expansions
             auto pit = postings_.find(term);
             if (pit == postings_.end()) continue;
@@ -126,7 +262,8 @@ std::vector<FullTextIndexStd::DocRef> FullTextIndexStd::search(const std::string
             auto ii = idf_.find(term);
             if (ii != idf_.end()) idf = ii->second;
             const auto& pl = ensure_postings(term);
-            for (auto& p : pl) { score[p.first] += (double)p.second * idf; }
+            for (auto& p : pl) { if (live(p.first)) score[p.first] += (double)p.second * idf * weight; }
+            if (matched_terms && !pl.empty()) matched_terms->push_back(term);
         }
     }
     if (score.empty()) return out;
@@ -138,13 +275,442 @@ std::vector<FullTextIndexStd::DocRef> FullTextIndexStd::search(const std::string
     });
     const int n = (int)std::min<size_t>(ranked.size(), (size_t)std::max(0, max_results));
     out.reserve(n);
-    for (int i = 0; i < n; ++i) out.push_back(doc_map_[ranked[i].first]);
+    for (int i = 0; i < n; ++i) out.push_back({ranked[i].first, doc_map_[ranked[i].first], ranked[i].second});
+    return out;
+}
+
+FullTextIndexStd::Snippet FullTextIndexStd::snippet(int doc, const std::vector<std::string>& terms) const {
+    Snippet s;
+    if (doc < 0 || doc >= (int)snippets_.size()) return s;
+    s.text = snippets_[doc];
+    s.highlights = highlight_terms(s.text, terms);
+    return s;
+}
+
+// Cut plain text longer than max_bytes at the last space in the second half,
+// otherwise on a UTF-8 boundary, and mark the cut with "...".
+static void cut_excerpt(std::string& out, size_t max_bytes) {
+    if (out.size() <= max_bytes) return;
+    size_t cut = max_bytes;
+    size_t sp = out.rfind(' ', max_bytes);
+    if (sp != std::string::npos && sp >= max_bytes / 2) cut = sp;
+    else while (cut > 0 && ((unsigned char)out[cut] & 0xC0) == 0x80) --cut;
+    out.resize(cut);
+    out += "...";
+}
+
+std::string FullTextIndexStd::make_excerpt(const std::string& text, size_t max_bytes) {
+    std::string out;
+    if (max_bytes == 0) return out;
+    out.reserve(std::min(text.size(), max_bytes + 4));
+    bool in_tag = false, pending_space = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = (unsigned char)text[i];
+        if (in_tag) { if (c == '>') { in_tag = false; pending_space = true; } continue; }
+        if (c == '<') { in_tag = true; continue; }
+        if (std::isspace(c)) { pending_space = true; continue; }
+        if (pending_space && !out.empty()) out.push_back(' ');
+        pending_space = false;
+        if (c == '&') {
+            static const std::pair<const char*, char> ents[] = {
+                {"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&#39;", '\''}, {"&nbsp;", ' '} };
+            bool matched = false;
+            for (const auto& e : ents) {
+                size_t len = std::char_traits<char>::length(e.first);
+                if (text.compare(i, len, e.first) == 0) { out.push_back(e.second); i += len - 1; matched = true; break; }
+            }
+            if (!matched) out.push_back('&');
+        } else {
+            out.push_back((char)c);
+        }
+        if (out.size() > max_bytes) break;
+    }
+    cut_excerpt(out, max_bytes);
+    return out;
+}
+
+std::string FullTextIndexStd::make_excerpt(const std::string& text, size_t max_bytes, const std::vector<std::string>& terms) {
+    if (max_bytes == 0 || terms.empty()) return make_excerpt(text, max_bytes);
+    // Plain text never grows past its source, so this keeps all of it
+    std::string plain = make_excerpt(text, text.size());
+    const auto hl = highlight_terms(plain, terms);
+    if (hl.empty() || hl[0].first + hl[0].second <= max_bytes) {
+        cut_excerpt(plain, max_bytes);
+        return plain;
+    }
+    // Open a quarter of the budget before the match, on a word start if there is one
+    const size_t at = hl[0].first;
+    size_t start = at - std::min(at, max_bytes / 4);
+    const size_t sp = plain.find(' ', start);
+    if (sp != std::string::npos && sp < at) start = sp + 1;
+    else while (start > 0 && ((unsigned char)plain[start] & 0xC0) == 0x80) --start;
+    std::string out = "..." + plain.substr(start);
+    cut_excerpt(out, max_bytes);
+    return out;
+}
+
+std::vector<std::pair<size_t,size_t>> FullTextIndexStd::highlight_terms(const std::string& text, const std::vector<std::string>& terms) {
+    std::vector<std::pair<size_t,size_t>> out;
+    if (terms.empty()) return out;
+    std::unordered_set<std::string> want(terms.begin(), terms.end());
+    std::string cur;
+    size_t start = 0;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        unsigned char c = i < text.size() ? (unsigned char)text[i] : 0;
+        if (i < text.size() && is_word_char(c)) {
+            if (cur.empty()) start = i;
+            cur.push_back((char)std::tolower(c));
+        } else if (!cur.empty()) {
+            if (want.count(cur)) out.emplace_back(start, cur.size());
+            cur.clear();
+        }
+    }
+    return out;
+}
+
+std::vector<std::pair<std::string,double>> FullTextIndexStd::expand_term(const std::string& tok, bool prefix,
+                                                                        size_t* typo_budget) const {
+    std::vector<std::pair<std::string,double>> terms;
+    if (prefix) {
+        const size_t kCap = 512;
+        auto it = std::lower_bound(terms_sorted_.begin(), terms_sorted_.end(), tok,
+                                   [](const auto& a, const std::string& b){ return a.first < b; });
+        for (; it != terms_sorted_.end() && it->first.compare(0, tok.size(), tok) == 0; ++it) {
+            terms.emplace_back(it->first, 1.0);
+            if (terms.size() >= kCap) break;
+        }
+        return terms;
+    }
+    if (postings_.find(tok) != postings_.end()) { terms.emplace_back(tok, 1.0); return terms; }
+    for (auto& t : substring_candidates(tok, 256)) terms.emplace_back(std::move(t), 1.0);
+    // Unknown token: add near misses, weight decaying with each edit
+    const int k = typo_max_edits(tok.size());
+    if (typo_budget && *typo_budget > 0 && k > 0) {
+        std::unordered_set<std::string> have;
+        for (const auto& t : terms) have.insert(t.first);
+        for (auto& c : typo_candidates(tok, k, *typo_budget)) {
+            if (have.count(c.first)) continue;
+            terms.emplace_back(std::move(c.first), std::pow(typo_decay_, c.second));
+            --*typo_budget;
+        }
+    }
+    return terms;
+}
+
+int FullTextIndexStd::typo_max_edits(size_t len) {
+    if (len < 4) return 0;
+    if (len < 8) return 1;
+    return 2;
+}
+
+std::vector<std::pair<std::string,int>> FullTextIndexStd::typo_candidates(const std::string& tok, int max_edits, size_t cap) const {
+    std::vector<std::pair<std::string,int>> out;
+    if (max_edits <= 0 || cap == 0 || tok.empty() || terms_sorted_.empty()) return out;
+    const std::string q = lcase(tok);
+    const int m = (int)q.size();
+    const int k = max_edits;
+    // Walk the sorted term list as an implicit trie. rows[d] is the optimal
+    // string alignment DP row for the first d characters of the current term,
+    // shared with the previous term up to their common prefix; row_min[d] is
+    // its minimum. Once a prefix can no longer end within k edits every term
+    // under it is skipped with one binary search, so the walk only touches
+    // prefixes the Levenshtein automaton would accept.
+    std::vector<std::vector<int>> rows(1, std::vector<int>(m + 1));
+    std::vector<int> row_min(1, 0);
+    for (int j = 0; j <= m; ++j) rows[0][j] = j;
+    std::string prev; // prefix for which rows[1..prev.size()] are valid
+    const auto less_term = [](const auto& a, const std::string& b){ return a.first < b; };
+    size_t i = 0;
+    const size_t T = terms_sorted_.size();
+    while (i < T) {
+        const std::string& term = terms_sorted_[i].first;
+        size_t d = 0;
+        while (d < prev.size() && d < term.size() && prev[d] == term[d]) ++d;
+        if (rows.size() < term.size() + 1) {
+            rows.resize(term.size() + 1, std::vector<int>(m + 1));
+            row_min.resize(term.size() + 1);
+        }
+        bool dead = false;
+        for (; d < term.size(); ++d) {
+            const std::vector<int>& up = rows[d];
+            std::vector<int>& cur = rows[d + 1];
+            const char c = term[d];
+            cur[0] = (int)d + 1;
+            int best = cur[0];
+            for (int j = 1; j <= m; ++j) {
+                int v = std::min(up[j] + 1, cur[j - 1] + 1);
+                v = std::min(v, up[j - 1] + (c == q[j - 1] ? 0 : 1));
+                if (d >= 1 && j >= 2 && c == q[j - 2] && term[d - 1] == q[j - 1])
+                    v = std::min(v, rows[d - 1][j - 2] + 1); // adjacent transposition
+                cur[j] = v;
+                best = std::min(best, v);
+            }
+            row_min[d + 1] = best;
+            // A transposition can reach back one row, so both rows must be out of range
+            if (best > k && row_min[d] >= k) { dead = true; break; }
+        }
+        if (dead) {
+            std::string next = term.substr(0, d + 1);
+            prev = term.substr(0, d);
+            while (!next.empty() && (unsigned char)next.back() == 0xFF) next.pop_back();
+            if (next.empty()) break;
+            next.back() = (char)((unsigned char)next.back() + 1);
+            i = (size_t)(std::lower_bound(terms_sorted_.begin() + (std::ptrdiff_t)(i + 1), terms_sorted_.end(), next, less_term)
+                         - terms_sorted_.begin());
+            continue;
+        }
+        const int dist = rows[term.size()][m];
+        if (dist <= k && dist > 0) out.emplace_back(term, dist);
+        prev = term;
+        ++i;
+    }
+    // Closest first; among equals prefer frequent terms
+    std::sort(out.begin(), out.end(), [this](const auto& a, const auto& b){
+        if (a.second != b.second) return a.second < b.second;
+        auto da = postings_.find(a.first)->second.count, db = postings_.find(b.first)->second.count;
+        if (da != db) return da > db;
+        return a.first < b.first;
+    });
+    if (out.size() > cap) out.resize(cap);
+    return out;
+}
+
+namespace {
+
+// Sorted docId list: either borrowed postings (no copy) or owned ids.
+struct DocList {
+    const std::vector<std::pair<int,int>>* pl = nullptr;
+    std::vector<int> ids;
+    size_t size() const { return pl ? pl->size() : ids.size(); }
+    int at(size_t i) const { return pl ? (*pl)[i].first : ids[i]; }
+};
+
+// Smallest index >= from whose doc is >= target (exponential probe, then binary search).
+size_t gallop(const DocList& l, size_t from, int target) {
+    const size_t n = l.size();
+    if (from >= n || l.at(from) >= target) return from;
+    size_t lo = from, step = 1;
+    while (lo + step < n && l.at(lo + step) < target) { lo += step; step <<= 1; }
+    size_t hi = std::min(lo + step, n);
+    ++lo;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (l.at(mid) < target) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+std::vector<int> intersect_gallop(const std::vector<int>& small, const DocList& big) {
+    std::vector<int> out;
+    size_t j = 0;
+    for (int d : small) {
+        j = gallop(big, j, d);
+        if (j >= big.size()) break;
+        if (big.at(j) == d) out.push_back(d);
+    }
+    return out;
+}
+
+std::vector<int> subtract_gallop(const std::vector<int>& a, const DocList& b) {
+    std::vector<int> out;
+    out.reserve(a.size());
+    size_t j = 0;
+    for (int d : a) {
+        j = gallop(b, j, d);
+        if (j < b.size() && b.at(j) == d) continue;
+        out.push_back(d);
+    }
+    return out;
+}
+
+std::vector<int> materialize(DocList l) {
+    if (!l.pl) return std::move(l.ids);
+    std::vector<int> out; out.reserve(l.pl->size());
+    for (const auto& p : *l.pl) out.push_back(p.first);
+    return out;
+}
+
+} // namespace
+
+struct FullTextIndexStd::QueryRunner {
+    using Node = FullTextQueryStd::Node;
+    using K = Node::Kind;
+
+    const FullTextIndexStd& ix;
+    const std::vector<bool>* mask;
+    const PhraseCheck& check;
+    std::vector<std::pair<std::string,double>> scoring; // positive terms and weights, first-seen order
+    std::unordered_set<std::string> scoring_seen;
+    size_t typo_budget;
+
+    bool allowed(int doc) const {
+        if (!mask) return true;
+        int d = ix.doc_map_[doc].dict;
+        return d >= 0 && d < (int)mask->size() && (*mask)[d];
+    }
+
+    std::vector<int> all_docs() const {
+        std::vector<int> out;
+        out.reserve(ix.doc_map_.size());
+        for (int i = 0; i < (int)ix.doc_map_.size(); ++i) if (ix.doc_map_[i].dict >= 0 && allowed(i)) out.push_back(i);
+        return out;
+    }
+
+    void note_term(const std::string& t, bool positive, double weight = 1.0) {
+        if (positive && scoring_seen.insert(t).second) scoring.emplace_back(t, weight);
+    }
+
+    DocList leaf(const std::string& tok, bool prefix, bool positive) {
+        DocList l;
+        auto terms = ix.expand_term(tok, prefix, &typo_budget);
+        if (terms.size() == 1) {
+            l.pl = &ix.ensure_postings(terms[0].first);
+            note_term(terms[0].first, positive, terms[0].second);
+            return l;
+        }
+        for (const auto& [t, w] : terms) {
+            const auto& pl = ix.ensure_postings(t);
+            for (const auto& p : pl) l.ids.push_back(p.first);
+            note_term(t, positive, w);
+        }
+        std::sort(l.ids.begin(), l.ids.end());
+        l.ids.erase(std::unique(l.ids.begin(), l.ids.end()), l.ids.end());
+        return l;
+    }
+
+    // Conjunction: rarest list first, each further list probed by galloping.
+    std::vector<int> conjoin(std::vector<DocList>& pos, const std::vector<DocList>& neg,
+                             const std::vector<const Node*>& phrases) {
+        std::vector<int> acc;
+        if (pos.empty()) {
+            acc = all_docs();
+        } else {
+            std::sort(pos.begin(), pos.end(), [](const DocList& a, const DocList& b){ return a.size() < b.size(); });
+            acc = materialize(std::move(pos[0]));
+            for (size_t i = 1; i < pos.size() && !acc.empty(); ++i) acc = intersect_gallop(acc, pos[i]);
+            if (mask) acc.erase(std::remove_if(acc.begin(), acc.end(), [&](int d){ return !allowed(d); }), acc.end());
+        }
+        for (const auto& n : neg) { if (acc.empty()) break; acc = subtract_gallop(acc, n); }
+        if (check) {
+            for (const Node* ph : phrases) {
+                acc.erase(std::remove_if(acc.begin(), acc.end(), [&](int d){ return !check(ix.doc_map_[d], ph->words); }), acc.end());
+            }
+        }
+        return acc;
+    }
+
+    void add_phrase_lists(const Node& n, bool positive, std::vector<DocList>& pos) {
+        for (const auto& w : n.words) {
+            DocList l;
+            if (ix.postings_.find(w) != ix.postings_.end()) { l.pl = &ix.ensure_postings(w); note_term(w, positive); }
+            pos.push_back(std::move(l));
+        }
+    }
+
+    DocList eval(const Node& n, bool positive) {
+        DocList out;
+        switch (n.kind) {
+        case K::Term: return leaf(n.words[0], false, positive);
+        case K::Prefix: return leaf(n.words[0], true, positive);
+        case K::Phrase: {
+            std::vector<DocList> pos; add_phrase_lists(n, positive, pos);
+            out.ids = conjoin(pos, {}, {&n});
+            return out;
+        }
+        case K::And: {
+            std::vector<DocList> pos, neg;
+            std::vector<const Node*> phrases;
+            for (const auto& c : n.children) {
+                if (c.kind == K::Not) neg.push_back(eval(c.children[0], !positive));
+                else if (c.kind == K::Phrase) { add_phrase_lists(c, positive, pos); phrases.push_back(&c); }
+                else pos.push_back(eval(c, positive));
+            }
+            out.ids = conjoin(pos, neg, phrases);
+            return out;
+        }
+        case K::Or: {
+            for (const auto& c : n.children) {
+                auto ids = materialize(eval(c, positive));
+                std::vector<int> merged; merged.reserve(out.ids.size() + ids.size());
+                std::set_union(out.ids.begin(), out.ids.end(), ids.begin(), ids.end(), std::back_inserter(merged));
+                out.ids.swap(merged);
+            }
+            return out;
+        }
+        case K::Not: {
+            DocList excl = eval(n.children[0], !positive);
+            out.ids = subtract_gallop(all_docs(), excl);
+            return out;
+        }
+        }
+        return out;
+    }
+};
+
+std::vector<FullTextIndexStd::Hit> FullTextIndexStd::search_query(const FullTextQueryStd& query, int max_results,
+                                                                  const std::vector<bool>* dict_mask,
+                                                                  const PhraseCheck& phrase_check,
+                                                                  std::vector<std::string>* matched_terms) const {
+    std::vector<Hit> out;
+    if (doc_map_.empty() || max_results <= 0) return out;
+    QueryRunner run{*this, dict_mask, phrase_check, {}, {}, typo_max_expansions_};
+    std::vector<int> docs = materialize(run.eval(query.root, true));
+    docs.erase(std::remove_if(docs.begin(), docs.end(), [&](int d){ return !live(d) || !run.allowed(d); }), docs.end());
+    if (docs.empty()) return out;
+
+    // Score only the candidates: walk each positive term's postings with galloping probes
+    std::vector<double> score(docs.size(), 0.0);
+    for (const auto& [term, weight] : run.scoring) {
+        DocList l; l.pl = &ensure_postings(term);
+        if (l.size() == 0) continue;
+        double idf = 1.0;
+        auto ii = idf_.find(term);
+        if (ii != idf_.end()) idf = ii->second;
+        size_t j = 0;
+        for (size_t k = 0; k < docs.size(); ++k) {
+            j = gallop(l, j, docs[k]);
+            if (j >= l.size()) break;
+            if (l.at(j) == docs[k]) score[k] += (double)(*l.pl)[j].second * idf * weight;
+        }
+        if (matched_terms) matched_terms->push_back(term);
+    }
+    std::vector<std::pair<int,double>> ranked; ranked.reserve(docs.size());
+    for (size_t k = 0; k < docs.size(); ++k) ranked.emplace_back(docs[k], score[k]);
+    const size_t n = std::min<size_t>(ranked.size(), (size_t)max_results);
+    std::partial_sort(ranked.begin(), ranked.begin() + n, ranked.end(), [](const auto& a, const auto& b){
+        if (a.second != b.second) return a.second > b.second;
+        return a.first < b.first;
+    });
+    out.reserve(n);
+    for (size_t i = 0; i < n; ++i) out.push_back({ranked[i].first, doc_map_[ranked[i].first], ranked[i].second});
+    return out;
+}
+
+bool FullTextIndexStd::contains_phrase(const std::string& text, const std::vector<std::string>& words) {
+    if (words.empty()) return true;
+    auto toks = tokenize(text);
+    if (toks.size() < words.size()) return false;
+    for (size_t i = 0; i + words.size() <= toks.size(); ++i) {
+        if (std::equal(words.begin(), words.end(), toks.begin() + i)) return true;
+    }
+    return false;
+}
+
+std::string FullTextIndexStd::normalize_query(const std::string& query) {
+    auto toks = tokenize(query);
+    std::sort(toks.begin(), toks.end());
+    toks.erase(std::unique(toks.begin(), toks.end()), toks.end());
+    std::string out;
+    for (const auto& t : toks) {
+        if (!out.empty()) out.push_back(' ');
+        out += t;
+    }
     return out;
 }
 
 int FullTextIndexStd::doc_count() const { return (int)doc_tf_.size(); }
 
-void FullTextIndexStd::clear() { doc_tf_.clear(); doc_map_.clear(); postings_.clear(); idf_.clear(); }
+void FullTextIndexStd::clear() { doc_tf_.clear(); doc_map_.clear(); snippets_.clear(); postings_.clear(); idf_.clear(); }
 
 static inline void write_u32(std::ofstream& out, uint32_t v) {
     unsigned char b[4] = { (unsigned char)(v & 0xFF), (unsigned char)((v>>8)&0xFF), (unsigned char)((v>>16)&0xFF), (unsigned char)((v>>24)&0xFF) };
@@ -154,26 +720,96 @@ static inline bool read_u32(std::ifstream& in, uint32_t& v) {
     unsigned char b[4]; if (!in.read((char*)b, 4)) return false; v = (uint32_t)b[0] | ((uint32_t)b[1]<<8) | ((uint32_t)b[2]<<16) | ((uint32_t)b[3]<<24); return true;
 }
 
-// Simple varint (LEB128-like) encode/decode for 32-bit unsigned integers
-static inline void vencode_u32(uint32_t v, std::string& out) {
-    while (v >= 0x80) { out.push_back((char)((v & 0x7F) | 0x80)); v >>= 7; }
-    out.push_back((char)(v & 0x7F));
+static inline void put_u32(std::string& out, uint32_t v) {
+    char b[4] = { (char)(v & 0xFF), (char)((v>>8)&0xFF), (char)((v>>16)&0xFF), (char)((v>>24)&0xFF) };
+    out.append(b, 4);
+}
+static inline void write_u64(std::ofstream& out, uint64_t v) {
+    write_u32(out, (uint32_t)(v & 0xFFFFFFFFu)); write_u32(out, (uint32_t)(v >> 32));
+}
+static inline bool read_u64(std::ifstream& in, uint64_t& v) {
+    uint32_t lo = 0, hi = 0; if (!read_u32(in, lo) || !read_u32(in, hi)) return false;
+    v = (uint64_t)lo | ((uint64_t)hi << 32); return true;
 }
 
-static inline bool vdecode_u32(const unsigned char*& p, const unsigned char* end, uint32_t& v) {
-    uint32_t result = 0; int shift = 0; const int max_shift = 35; // up to 5 bytes
-    while (p < end && shift <= max_shift) {
-        unsigned char b = *p++;
-        result |= (uint32_t)(b & 0x7F) << shift;
-        if ((b & 0x80) == 0) { v = result; return true; }
-        shift += 7;
+// Bytes between the read position and the end of the file. Lengths and counts
+// read from a file are checked against it before anything is allocated.
+static uint64_t stream_end(std::ifstream& in) {
+    const auto pos = in.tellg();
+    if (pos < 0) return 0;
+    in.seekg(0, std::ios::end);
+    const auto end = in.tellg();
+    in.seekg(pos);
+    return end < 0 ? 0 : (uint64_t)end;
+}
+static uint64_t bytes_left(std::ifstream& in, uint64_t end) {
+    const auto pos = in.tellg();
+    return pos >= 0 && (uint64_t)pos < end ? end - (uint64_t)pos : 0;
+}
+
+// Bounds-checked little-endian reader over an in-memory section payload
+struct SectionReader {
+    const char* p; const char* end;
+    bool u32(uint32_t& v) {
+        if (end - p < 4) return false;
+        const unsigned char* b = (const unsigned char*)p;
+        v = (uint32_t)b[0] | ((uint32_t)b[1]<<8) | ((uint32_t)b[2]<<16) | ((uint32_t)b[3]<<24);
+        p += 4; return true;
     }
-    return false;
+    bool bytes(std::string& s, uint32_t n) {
+        if ((size_t)(end - p) < n) return false;
+        s.assign(p, n); p += n; return true;
+    }
+    size_t left() const { return (size_t)(end - p); }
+};
+
+void FullTextIndexStd::encode_postings(const PostingEntry& pe, std::string& buf, uint32_t& count) {
+    buf.clear();
+    if (pe.compressed) { buf = pe.buf; count = pe.count; return; } // already delta+varint encoded
+    const std::vector<std::pair<int,int>>* src = &pe.vec;
+    std::vector<std::pair<int,int>> sorted;
+    if (!std::is_sorted(pe.vec.begin(), pe.vec.end())) { sorted = pe.vec; std::sort(sorted.begin(), sorted.end()); src = &sorted; }
+    buf.reserve(src->size() * 2);
+    uint32_t prev = 0;
+    for (size_t i = 0; i < src->size(); ++i) {
+        uint32_t did = (uint32_t)(*src)[i].first;
+        uint32_t tf = (uint32_t)(*src)[i].second;
+        vencode_u32((i == 0) ? did : (did - prev), buf);
+        vencode_u32(tf, buf);
+        prev = did;
+    }
+    count = (uint32_t)src->size();
+}
+
+bool FullTextIndexStd::save(const std::string& path, int format) const {
+    if (format != 3 && format != 4) return false;
+    // Postings are read in both representations; keep concurrent lazy decodes out
+    std::lock_guard<std::mutex> lk(decode_mu_);
+    // Write next to the target and rename, so readers never observe a partial file
+    const std::string tmp = path + ".tmp";
+    bool ok = false;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        ok = (format == 4) ? write_udft4(out) : write_udft3(out);
+        out.flush();
+        ok = ok && (bool)out;
+    }
+    std::error_code ec;
+    if (ok) {
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) { // e.g. Windows refuses to replace an existing file
+            std::filesystem::remove(path, ec);
+            ec.clear();
+            std::filesystem::rename(tmp, path, ec);
+        }
+        ok = !ec;
+    }
+    if (!ok) std::filesystem::remove(tmp, ec);
+    return ok;
 }
 
-bool FullTextIndexStd::save(const std::string& path) const {
-    std::ofstream out(path, std::ios::binary | std::ios::trunc);
-    if (!out) return false;
+bool FullTextIndexStd::write_udft3(std::ofstream& out) const {
     // UDFT3: compressed postings with varint + docId delta
     const char magic[5] = {'U','D','F','T','3'};
     out.write(magic, 5);
@@ -188,31 +824,212 @@ bool FullTextIndexStd::save(const std::string& path) const {
     }
     // Postings count
     write_u32(out, (uint32_t)postings_.size());
+    std::string buf;
     for (const auto& kv : postings_) {
         const std::string& term = kv.first;
         write_u32(out, (uint32_t)term.size());
         out.write(term.data(), (std::streamsize)term.size());
-        // compress postings: sort by docId, delta-encode docId and varint(docDelta, tf)
-        std::vector<std::pair<int,int>> postings = kv.second.vec;
-        std::sort(postings.begin(), postings.end(), [](auto& a, auto& b){ return a.first < b.first; });
-        std::string buf; buf.reserve(postings.size() * 2);
-        uint32_t prev = 0;
-        for (size_t i = 0; i < postings.size(); ++i) {
-            uint32_t did = (uint32_t)postings[i].first;
-            uint32_t tf = (uint32_t)postings[i].second;
-            uint32_t delta = (i == 0) ? did : (did - prev);
-            vencode_u32(delta, buf);
-            vencode_u32(tf, buf);
-            prev = did;
-        }
+        uint32_t count = 0;
+        encode_postings(kv.second, buf, count);
         // write count and compressed buffer
-        write_u32(out, (uint32_t)postings.size());
+        write_u32(out, count);
         write_u32(out, (uint32_t)buf.size());
         if (!buf.empty()) out.write(buf.data(), (std::streamsize)buf.size());
     }
+    // Optional trailing snippet section; older readers stop after the postings
+    if (!snippets_.empty()) {
+        out.write("SNIP", 4);
+        write_u32(out, (uint32_t)snippets_.size());
+        for (const auto& sn : snippets_) {
+            write_u32(out, (uint32_t)sn.size());
+            if (!sn.empty()) out.write(sn.data(), (std::streamsize)sn.size());
+        }
+    }
     return (bool)out;
 }
 
+// UDFT4 section: tag(4) | u32 crc32(payload) | u64 payload length | payload
+static void write_section(std::ofstream& out, const char tag[4], const std::string& payload, uint32_t crc) {
+    out.write(tag, 4);
+    write_u32(out, crc);
+    write_u64(out, (uint64_t)payload.size());
+    if (!payload.empty()) out.write(payload.data(), (std::streamsize)payload.size());
+}
+
+static uint32_t crc32_of(const std::string& s) {
+    uLong c = crc32(0L, Z_NULL, 0);
+    const Bytef* p = (const Bytef*)s.data();
+    size_t left = s.size();
+    while (left > 0) { // zlib takes uInt lengths
+        uInt n = (uInt)std::min<size_t>(left, 1u << 30);
+        c = crc32(c, p, n); p += n; left -= n;
+    }
+    return (uint32_t)c;
+}
+
+bool FullTextIndexStd::write_udft4(std::ofstream& out) const {
+    const char magic[5] = {'U','D','F','T','4'};
+    out.write(magic, 5);
+
+    std::string payload = signature_;
+    write_section(out, "SIGN", payload, crc32_of(payload));
+
+    payload.clear();
+    payload.reserve(4 + doc_map_.size() * 8);
+    put_u32(payload, (uint32_t)doc_map_.size());
+    for (const auto& r : doc_map_) { put_u32(payload, (uint32_t)r.dict); put_u32(payload, (uint32_t)r.word); }
+    write_section(out, "DOCS", payload, crc32_of(payload));
+    payload.clear(); payload.shrink_to_fit();
+
+    // Deterministic term order
+    std::vector<const std::pair<const std::string, PostingEntry>*> terms;
+    terms.reserve(postings_.size());
+    for (const auto& kv : postings_) terms.push_back(&kv);
+    std::sort(terms.begin(), terms.end(), [](const auto* a, const auto* b){ return a->first < b->first; });
+
+    // Postings are split into fixed-size term blocks. Blocks are encoded (and
+    // checksummed) on worker threads a wave at a time, then written in order,
+    // so memory stays bounded by one wave regardless of index size.
+    const size_t kTermsPerBlock = 4096;
+    const size_t nblocks = (terms.size() + kTermsPerBlock - 1) / kTermsPerBlock;
+    int threads = save_threads_;
+    if (threads <= 0) {
+        unsigned int hc = std::thread::hardware_concurrency();
+        threads = (hc == 0) ? 1 : (int)hc;
+    }
+    const size_t wave = (size_t)threads * 4;
+    std::vector<std::string> blocks;
+    std::vector<uint32_t> crcs;
+    for (size_t first = 0; first < nblocks; first += wave) {
+        const size_t count = std::min(wave, nblocks - first);
+        blocks.assign(count, std::string());
+        crcs.assign(count, 0);
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            std::string buf;
+            for (size_t b = next.fetch_add(1); b < count; b = next.fetch_add(1)) {
+                const size_t t0 = (first + b) * kTermsPerBlock;
+                const size_t t1 = std::min(terms.size(), t0 + kTermsPerBlock);
+                std::string& blk = blocks[b];
+                put_u32(blk, (uint32_t)(t1 - t0));
+                for (size_t t = t0; t < t1; ++t) {
+                    const std::string& term = terms[t]->first;
+                    uint32_t n = 0;
+                    encode_postings(terms[t]->second, buf, n);
+                    put_u32(blk, (uint32_t)term.size());
+                    blk.append(term);
+                    put_u32(blk, n);
+                    put_u32(blk, (uint32_t)buf.size());
+                    blk.append(buf);
+                }
+                crcs[b] = crc32_of(blk);
+            }
+        };
+        const int nt = (int)std::min<size_t>((size_t)threads, count);
+        std::vector<std::thread> pool; pool.reserve(nt > 1 ? nt - 1 : 0);
+        for (int t = 1; t < nt; ++t) pool.emplace_back(worker);
+        worker();
+        for (auto& th : pool) th.join();
+        for (size_t b = 0; b < count; ++b) write_section(out, "POST", blocks[b], crcs[b]);
+        if (!out) return false;
+    }
+    blocks.clear();
+
+    if (!snippets_.empty()) {
+        payload.clear();
+        put_u32(payload, (uint32_t)snippets_.size());
+        for (const auto& sn : snippets_) { put_u32(payload, (uint32_t)sn.size()); payload.append(sn); }
+        write_section(out, "SNIP", payload, crc32_of(payload));
+    }
+
+    payload.clear();
+    put_u32(payload, (uint32_t)terms.size());
+    put_u32(payload, (uint32_t)nblocks);
+    write_section(out, "END!", payload, crc32_of(payload));
+    return (bool)out;
+}
+
+bool FullTextIndexStd::load_udft4(std::ifstream& in) {
+    const uint64_t file_end = stream_end(in);
+    bool seen_docs = false, seen_end = false;
+    uint32_t post_sections = 0;
+    std::string payload;
+    while (!seen_end) {
+        char tag[4];
+        if (!in.read(tag, 4)) { last_error_ = "truncated (missing END section)"; return false; }
+        const std::string t(tag, 4);
+        uint32_t crc = 0; uint64_t len = 0;
+        if (!read_u32(in, crc) || !read_u64(in, len)) { last_error_ = "truncated (section header " + t + ")"; return false; }
+        if (len > bytes_left(in, file_end)) { last_error_ = "corrupt section length (section " + t + ")"; return false; }
+        payload.resize((size_t)len);
+        if (len && !in.read(payload.data(), (std::streamsize)len)) { last_error_ = "truncated (section " + t + ")"; return false; }
+        if (crc32_of(payload) != crc) { last_error_ = "checksum mismatch (section " + t + ")"; return false; }
+        SectionReader r{payload.data(), payload.data() + payload.size()};
+        if (t == "SIGN") {
+            signature_ = payload;
+        } else if (t == "DOCS") {
+            uint32_t docs = 0; if (!r.u32(docs) || docs > r.left() / 8) { last_error_ = "bad DOCS section"; return false; }
+            doc_tf_.resize(docs);
+            doc_map_.resize(docs);
+            for (uint32_t i = 0; i < docs; ++i) {
+                uint32_t d = 0, w = 0; if (!r.u32(d) || !r.u32(w)) { last_error_ = "bad DOCS section"; return false; }
+                doc_map_[i] = {(int)d, (int)w};
+            }
+            seen_docs = true;
+        } else if (t == "POST") {
+            uint32_t nterms = 0; if (!r.u32(nterms)) { last_error_ = "bad POST section"; return false; }
+            for (uint32_t i = 0; i < nterms; ++i) {
+                uint32_t tlen = 0, n = 0, blen = 0;
+                std::string term;
+                if (!r.u32(tlen) || !r.bytes(term, tlen) || !r.u32(n) || !r.u32(blen)) { last_error_ = "bad POST section"; return false; }
+                auto& ent = postings_[term];
+                if (!r.bytes(ent.buf, blen)) { last_error_ = "bad POST section"; return false; }
+                ent.compressed = true; ent.count = n; // lazy decode later
+            }
+            ++post_sections;
+        } else if (t == "SNIP") {
+            uint32_t n = 0; if (!r.u32(n) || n > r.left() / 4) { last_error_ = "bad SNIP section"; return false; }
+            snippets_.resize(n);
+            for (uint32_t i = 0; i < n; ++i) {
+                uint32_t l = 0; if (!r.u32(l) || !r.bytes(snippets_[i], l)) { last_error_ = "bad SNIP section"; return false; }
+            }
+            // Documents added by later updates get excerpts too
+            if (snippet_length_ == 0) snippet_length_ = kDefaultSnippetLength;
+        } else if (t == "END!") {
+            uint32_t nterms = 0, nblocks = 0;
+            if (!r.u32(nterms) || !r.u32(nblocks) || nterms != postings_.size() || nblocks != post_sections) {
+                last_error_ = "section count mismatch"; return false;
+            }
+            seen_end = true;
+        } // unknown sections are skipped (checksummed, length-prefixed)
+    }
+    if (!seen_docs) { last_error_ = "missing DOCS section"; return false; }
+    if (!snippets_.empty() && snippets_.size() != doc_map_.size()) { last_error_ = "bad SNIP section"; return false; }
+    finalize();
+    return true;
+}
+
+bool FullTextIndexStd::verify_file(const std::string& path, std::string* error) {
+    auto fail = [&](const std::string& e) { if (error) *error = e; return false; };
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return fail("open failed");
+    char magic[5]; if (!in.read(magic, 5)) return fail("truncated (magic)");
+    if (std::string(magic, 5) != "UDFT4") return fail("not a UDFT4 file");
+    const uint64_t file_end = stream_end(in);
+    std::string payload;
+    for (;;) {
+        char tag[4];
+        if (!in.read(tag, 4)) return fail("truncated (missing END section)");
+        uint32_t crc = 0; uint64_t len = 0;
+        if (!read_u32(in, crc) || !read_u64(in, len)) return fail("truncated (section header)");
+        if (len > bytes_left(in, file_end)) return fail("corrupt section length (section " + std::string(tag, 4) + ")");
+        payload.resize((size_t)len);
+        if (len && !in.read(payload.data(), (std::streamsize)len)) return fail("truncated (section " + std::string(tag, 4) + ")");
+        if (crc32_of(payload) != crc) return fail("checksum mismatch (section " + std::string(tag, 4) + ")");
+        if (std::string(tag, 4) == "END!") return true;
+    }
+}
+
 bool FullTextIndexStd::load(const std::string& path) {
     std::ifstream in(path, std::ios::binary);
     if (!in) { last_error_ = "open failed"; return false; }
@@ -221,17 +1038,25 @@ bool FullTextIndexStd::load(const std::string& path) {
     bool v1 = (mg == std::string("UDFT1",5));
     bool v2 = (mg == std::string("UDFT2",5));
     bool v3 = (mg == std::string("UDFT3",5));
+    if (mg == std::string("UDFT4",5)) {
+        clear();
+        signature_.clear();
+        version_ = 4;
+        return load_udft4(in);
+    }
     if (!v1 && !v2 && !v3) { last_error_ = "unsupported format"; return false; }
     version_ = v3 ? 3 : (v2 ? 2 : 1);
     clear();
+    const uint64_t file_end = stream_end(in);
     if (v2 || v3) {
-        uint32_t siglen = 0; if (!read_u32(in, siglen)) { last_error_ = "truncated (siglen)"; return false; }
+        uint32_t siglen = 0; if (!read_u32(in, siglen) || siglen > bytes_left(in, file_end)) { last_error_ = "truncated (siglen)"; return false; }
         signature_.clear(); signature_.resize(siglen);
         if (siglen) { if (!in.read(signature_.data(), (std::streamsize)siglen)) { last_error_ = "truncated (sig)"; return false; } }
     } else {
         signature_.clear();
     }
     uint32_t docs = 0; if (!read_u32(in, docs)) { last_error_ = "truncated (docs)"; return false; }
+    if ((uint64_t)docs * 8 > bytes_left(in, file_end)) { last_error_ = "truncated (docmap)"; return false; }
     doc_tf_.resize(docs);
     doc_map_.resize(docs);
     for (uint32_t i = 0; i < docs; ++i) {
@@ -240,16 +1065,17 @@ bool FullTextIndexStd::load(const std::string& path) {
     }
     uint32_t terms = 0; if (!read_u32(in, terms)) { last_error_ = "truncated (terms)"; return false; }
     for (uint32_t t = 0; t < terms; ++t) {
-        uint32_t len = 0; if (!read_u32(in, len)) { last_error_ = "truncated (term len)"; return false; }
+        uint32_t len = 0; if (!read_u32(in, len) || len > bytes_left(in, file_end)) { last_error_ = "truncated (term len)"; return false; }
         std::string term; term.resize(len); if (!in.read(term.data(), (std::streamsize)len)) { last_error_ = "truncated (term)"; return false; }
         uint32_t n = 0; if (!read_u32(in, n)) { last_error_ = "truncated (postings count)"; return false; }
         auto& ent = postings_[term];
         if (v3) {
-            uint32_t blen = 0; if (!read_u32(in, blen)) { last_error_ = "truncated (compressed len)"; return false; }
+            uint32_t blen = 0; if (!read_u32(in, blen) || blen > bytes_left(in, file_end)) { last_error_ = "truncated (compressed len)"; return false; }
             std::string buf; buf.resize(blen);
             if (blen && !in.read(buf.data(), (std::streamsize)blen)) { last_error_ = "truncated (compressed data)"; return false; }
             ent.buf = std::move(buf); ent.compressed = true; ent.count = n; // lazy decode later
         } else {
+            if ((uint64_t)n * 8 > bytes_left(in, file_end)) { last_error_ = "truncated (posting)"; return false; }
             ent.vec.reserve(n);
             for (uint32_t i = 0; i < n; ++i) {
                 uint32_t docId=0, tf=0; if (!read_u32(in, docId) || !read_u32(in, tf)) { last_error_ = "truncated (posting)"; return false; }
@@ -257,6 +1083,19 @@ bool FullTextIndexStd::load(const std::string& path) {
             }
         }
     }
+    if (v3) {
+        char tag[4];
+        if (in.read(tag, 4) && std::string(tag, 4) == "SNIP") {
+            uint32_t n = 0; if (!read_u32(in, n) || n != docs) { last_error_ = "bad snippet section"; return false; }
+            snippets_.resize(n);
+            for (uint32_t i = 0; i < n; ++i) {
+                uint32_t len = 0; if (!read_u32(in, len) || len > bytes_left(in, file_end)) { last_error_ = "truncated (snippet len)"; return false; }
+                snippets_[i].resize(len);
+                if (len && !in.read(snippets_[i].data(), (std::streamsize)len)) { last_error_ = "truncated (snippet)"; return false; }
+            }
+            if (snippet_length_ == 0) snippet_length_ = kDefaultSnippetLength;
+        }
+    }
     finalize();
     return true;
 }
@@ -266,9 +1105,12 @@ const std::vector<std::pair<int,int>>& UnidictCoreStd::FullTextIndexStd::ensure_
     auto it = postings_.find(term);
     if (it == postings_.end()) { static const std::vector<std::pair<int,int>> empty; return empty; }
     PostingEntry& pe = const_cast<PostingEntry&>(it->second);
-    if (!pe.compressed) return pe.vec;
+    if (!pe.compressed.load(std::memory_order_acquire)) return pe.vec;
+    std::lock_guard<std::mutex> lk(decode_mu_);
+    if (!pe.compressed.load(std::memory_order_relaxed)) return pe.vec; // decoded by another reader
     // Decode varint compressed buffer into vec
-    pe.vec.clear(); pe.vec.reserve(pe.count);
+    // Each posting takes at least two bytes, whatever count the file claims
+    pe.vec.clear(); pe.vec.reserve(std::min<size_t>(pe.count, pe.buf.size() / 2));
     const unsigned char* p = (const unsigned char*)pe.buf.data();
     const unsigned char* end = p + pe.buf.size();
     uint32_t prev = 0;
@@ -278,7 +1120,8 @@ const std::vector<std::pair<int,int>>& UnidictCoreStd::FullTextIndexStd::ensure_
         uint32_t docId = (i == 0) ? delta : (prev + delta);
         prev = docId; pe.vec.emplace_back((int)docId, (int)tf);
     }
-    pe.compressed = false; pe.buf.clear();
+    pe.buf.clear();
+    pe.compressed.store(false, std::memory_order_release);
     return pe.vec;
 }
 
@@ -292,6 +1135,7 @@ void UnidictCoreStd::FullTextIndexStd::build_term_directory() {
 
 UnidictCoreStd::FullTextIndexStd::Stats UnidictCoreStd::FullTextIndexStd::stats() const {
     Stats s;
+    std::lock_guard<std::mutex> lk(decode_mu_);
     s.terms = postings_.size();
     s.docs = doc_map_.size();
     s.version = version_;
@@ -306,6 +1150,7 @@ UnidictCoreStd::FullTextIndexStd::Stats UnidictCoreStd::FullTextIndexStd::stats(
     s.compressed_bytes = comp_bytes;
     s.pairs_decompressed = dec_pairs;
     s.avg_df = s.terms ? (double)total_df / (double)s.terms : 0.0;
+    for (const auto& sn : snippets_) s.snippet_bytes += sn.size();
     return s;
 }
 
@@ -4,15 +4,26 @@
 #ifndef UNIDICT_FULLTEXT_INDEX_STD_H
 #define UNIDICT_FULLTEXT_INDEX_STD_H
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 namespace UnidictCoreStd {
 
+class FullTextQueryStd;
+
 class FullTextIndexStd {
 public:
     struct DocRef { int dict = -1; int word = -1; };
+    // Ranked hit: internal doc id (for snippet lookup), its reference and TF-IDF score.
+    struct Hit { int doc = -1; DocRef ref; double score = 0.0; };
+    // Plain-text excerpt with [offset, length) byte ranges of matched terms.
+    struct Snippet { std::string text; std::vector<std::pair<size_t,size_t>> highlights; };
 
     FullTextIndexStd();
 
@@ -22,19 +33,86 @@ public:
     // Parallel builder: build index from a batch of documents (definition texts) and their refs.
     // If threads <= 0, uses hardware_concurrency or 1.
     void build_from_documents(const std::vector<std::pair<std::string, DocRef>>& docs, int threads = 0);
+    // Same, for long builds: progress(done, total) is called from the workers (one call
+    // at a time, every few hundred documents), and once *cancel becomes true they stop
+    // early and the build returns false, leaving the index empty.
+    using BuildProgress = std::function<void(size_t done, size_t total)>;
+    bool build_from_documents(const std::vector<std::pair<std::string, DocRef>>& docs, int threads,
+                              const std::atomic<bool>* cancel, const BuildProgress& progress = BuildProgress());
 
     // Once all documents are added, call finalize() to compute IDF.
     void finalize();
+    // Incremental update: drop every document whose ref satisfies drop (its id stays
+    // allocated but maps to {-1,-1} and matches nothing), append docs, and finalize.
+    // Only the postings the new docs extend are touched; once a quarter of the ids
+    // are dead they are compacted away, renumbering the live documents.
+    void replace_documents(const std::function<bool(const DocRef&)>& drop,
+                           const std::vector<std::pair<std::string, DocRef>>& docs);
 
     // Query using simple tokenization; returns DocRefs ordered by score desc.
     std::vector<DocRef> search(const std::string& query, int max_results = 20) const;
-    bool save(const std::string& path) const;
+    // Same ranking as search(), keeping doc ids and scores. If matched_terms is
+    // given it receives the index terms that contributed (after substring expansion).
+    std::vector<Hit> search_hits(const std::string& query, int max_results = 20,
+                                 std::vector<std::string>* matched_terms = nullptr) const;
+    // Execute a parsed boolean query. AND/NOT are evaluated over docId-sorted
+    // postings with galloping intersection, rarest list first; only the
+    // surviving candidates are scored. dict_mask (indexed by DocRef::dict)
+    // restricts results when non-null. Phrase nodes are matched as AND of their
+    // tokens and, if phrase_check is set, verified by the caller (the index
+    // stores no positions).
+    using PhraseCheck = std::function<bool(const DocRef&, const std::vector<std::string>&)>;
+    std::vector<Hit> search_query(const FullTextQueryStd& query, int max_results = 20,
+                                  const std::vector<bool>* dict_mask = nullptr,
+                                  const PhraseCheck& phrase_check = PhraseCheck(),
+                                  std::vector<std::string>* matched_terms = nullptr) const;
+    // Typo tolerance: a query token that is not an indexed term is also matched
+    // against terms within a few edits (insert/delete/substitute/transpose;
+    // 1 edit for 4-7 chars, 2 from 8). Each candidate's score is scaled by
+    // decay^edits; max_expansions caps candidates per query (0 disables).
+    void set_typo_tolerance(size_t max_expansions, double decay = 0.5) { typo_max_expansions_ = max_expansions; typo_decay_ = decay; }
+    // Terms within max_edits of tok, closest (then most frequent) first, at most cap.
+    std::vector<std::pair<std::string,int>> typo_candidates(const std::string& tok, int max_edits, size_t cap) const;
+    static int typo_max_edits(size_t len);
+    // True if the tokens of text contain words as a contiguous run.
+    static bool contains_phrase(const std::string& text, const std::vector<std::string>& words);
+    // Split text into lowercase ASCII word tokens (alnum, '_' and '-'), as indexed.
+    static std::vector<std::string> tokenize(const std::string& s);
+    // Canonical form of a query as seen by search(): de-duplicated, sorted tokens
+    // joined by a single space. Queries with equal normal forms score identically.
+    static std::string normalize_query(const std::string& query);
+    // Write the index (format 4 = UDFT4 sectioned/checksummed, 3 = legacy UDFT3)
+    // to a temp file and rename it over path.
+    bool save(const std::string& path, int format = 4) const;
+    // Worker threads used to encode UDFT4 postings blocks (<= 0: hardware concurrency).
+    void set_save_threads(int threads) { save_threads_ = threads; }
+    // Loads UDFT1..UDFT4. UDFT4 sections are checksum-verified as they are read.
     bool load(const std::string& path);
+    // Walk a UDFT4 file's sections and verify their checksums without building an index.
+    static bool verify_file(const std::string& path, std::string* error = nullptr);
     void set_signature(const std::string& sig) { signature_ = sig; }
     const std::string& signature() const { return signature_; }
     int version() const { return version_; }
     const std::string& last_error() const { return last_error_; }
 
+    // Optional snippet store: keep a short plain-text excerpt per document so
+    // result previews do not need the full definition. Off (0) by default;
+    // applies to documents added afterwards. Excerpts persist with save()/load().
+    // Loading a file with excerpts turns the store on at kDefaultSnippetLength.
+    static constexpr size_t kDefaultSnippetLength = 160;
+    void set_snippet_length(size_t bytes) { snippet_length_ = bytes; }
+    size_t snippet_length() const { return snippet_length_; }
+    bool has_snippets() const { return !snippets_.empty(); }
+    // Excerpt for a doc id with matched terms highlighted; empty if none stored.
+    Snippet snippet(int doc, const std::vector<std::string>& terms) const;
+    // Strip markup, collapse whitespace and cut to at most max_bytes on a word/UTF-8 boundary.
+    static std::string make_excerpt(const std::string& text, size_t max_bytes);
+    // Same, but the window starts shortly before the first token equal to one of
+    // terms (lowercase), with a leading "..." when it does not start the text.
+    static std::string make_excerpt(const std::string& text, size_t max_bytes, const std::vector<std::string>& terms);
+    // Highlight ranges of whole tokens in text equal to one of terms (lowercase).
+    static std::vector<std::pair<size_t,size_t>> highlight_terms(const std::string& text, const std::vector<std::string>& terms);
+
     // For diagnostics
     int doc_count() const;    
 
@@ -42,18 +120,23 @@ public:
 
 private:
     static inline bool is_word_char(unsigned char c);
-    static std::vector<std::string> tokenize(const std::string& s);
+    // False for ids dropped by replace_documents (their postings may remain)
+    bool live(int doc) const { return doc >= 0 && (size_t)doc < doc_map_.size() && doc_map_[doc].dict >= 0; }
+    // Drop dead ids from doc_map_, doc_tf_, snippets_ and every postings list
+    void compact_documents();
 
     // Per-doc term frequencies (only used when building from scratch)
     // doc_tf_[docId][token] = count
     std::vector<std::unordered_map<std::string, int>> doc_tf_;
     std::vector<DocRef> doc_map_; // docId -> DocRef
+    std::vector<std::string> snippets_; // docId -> excerpt (empty when store disabled)
+    size_t snippet_length_ = 0;
 
     struct PostingEntry {
         std::vector<std::pair<int,int>> vec; // decompressed postings
         std::string buf;                     // compressed postings (UDFT3)
         uint32_t count = 0;                  // expected number of postings
-        bool compressed = false;             // true if using buf
+        std::atomic<bool> compressed{false}; // true if using buf; cleared once by ensure_postings
     };
 
     // Postings: token -> postings entry
@@ -61,11 +144,20 @@ private:
     // IDF values for tokens
     std::unordered_map<std::string, double> idf_;
     std::string signature_;
-    int version_ = 0; // 0=unset, 1=UDFT1, 2=UDFT2
+    int version_ = 0; // 0=unset, 1..4=UDFTn
+    int save_threads_ = 0;
     std::string last_error_;
 
-    // Helper: ensure postings for a term are decompressed (if stored compressed)
+    // Serialization helpers
+    static void encode_postings(const PostingEntry& pe, std::string& buf, uint32_t& count);
+    bool write_udft3(std::ofstream& out) const;
+    bool write_udft4(std::ofstream& out) const;
+    bool load_udft4(std::ifstream& in);
+
+    // Helper: ensure postings for a term are decompressed (if stored compressed).
+    // Safe under concurrent const use: decoding is serialized by decode_mu_.
     const std::vector<std::pair<int,int>>& ensure_postings(const std::string& term) const;
+    mutable std::mutex decode_mu_;
 
     // Term directory for faster scans (prefix/substring candidates)
     // Built in finalize(). Points into postings_ entries; invalidated by clear().
@@ -78,6 +170,14 @@ private:
     std::unordered_map<char, std::vector<int>> char_index_;
     void build_ngram3_index();
     std::vector<std::string> substring_candidates(const std::string& tok, size_t cap = 256) const;
+    // Index terms (with score weights) a query token stands for: the exact term
+    // if indexed, otherwise substring matches plus typo candidates drawn from
+    // *typo_budget; prefix=true uses the sorted term directory instead.
+    std::vector<std::pair<std::string,double>> expand_term(const std::string& tok, bool prefix,
+                                                           size_t* typo_budget = nullptr) const;
+    double typo_decay_ = 0.5;
+    size_t typo_max_expansions_ = 16;
+    struct QueryRunner; // boolean plan evaluation (fulltext_index_std.cpp)
 
     // Prefix bucket index: first character -> term indices (sorted by term)
     std::unordered_map<char, std::vector<int>> prefix_index_;
@@ -93,6 +193,12 @@ public:
         size_t pairs_decompressed = 0;  // total decompressed pairs available in memory
         double avg_df = 0.0;
         int version = 0;
+        size_t snippet_bytes = 0;       // total bytes held by the snippet store
+        // Query result cache (filled in by DictionaryManagerStd::fulltext_stats)
+        uint64_t result_cache_hits = 0;
+        uint64_t result_cache_misses = 0;
+        size_t result_cache_entries = 0;
+        uint64_t index_builds = 0;      // lazy builds performed by the manager
     };
     Stats stats() const;
 };
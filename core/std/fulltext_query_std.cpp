@@ -0,0 +1,292 @@
+#include "fulltext_query_std.h"
+
+#include "fulltext_index_std.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace UnidictCoreStd {
+
+namespace {
+
+struct Lexeme {
+    enum class Type { LParen, RParen, And, Or, Not, Word, Phrase, Dict };
+    Type type;
+    std::string text;
+};
+
+bool lex(const std::string& q, std::vector<Lexeme>& out, std::string* error) {
+    using T = Lexeme::Type;
+    size_t i = 0;
+    const size_t n = q.size();
+    auto read_quoted = [&](std::string& s) -> bool {
+        // q[i] == '"'
+        size_t end = q.find('"', i + 1);
+        if (end == std::string::npos) { if (error) *error = "unterminated quote"; return false; }
+        s = q.substr(i + 1, end - i - 1);
+        i = end + 1;
+        return true;
+    };
+    while (i < n) {
+        unsigned char c = (unsigned char)q[i];
+        if (std::isspace(c)) { ++i; continue; }
+        if (c == '(') { out.push_back({T::LParen, {}}); ++i; continue; }
+        if (c == ')') { out.push_back({T::RParen, {}}); ++i; continue; }
+        if (c == '"') {
+            std::string s; if (!read_quoted(s)) return false;
+            out.push_back({T::Phrase, s});
+            continue;
+        }
+        if (c == '-' && i + 1 < n && !std::isspace((unsigned char)q[i + 1])) {
+            out.push_back({T::Not, {}}); ++i; continue;
+        }
+        size_t start = i;
+        while (i < n && !std::isspace((unsigned char)q[i]) && q[i] != '(' && q[i] != ')' && q[i] != '"') ++i;
+        std::string w = q.substr(start, i - start);
+        if (w == "AND" || w == "&&") { out.push_back({T::And, {}}); continue; }
+        if (w == "OR" || w == "||") { out.push_back({T::Or, {}}); continue; }
+        if (w == "NOT") { out.push_back({T::Not, {}}); continue; }
+        if (w.size() >= 5 && (w.compare(0, 5, "dict:") == 0 || w.compare(0, 5, "DICT:") == 0)) {
+            std::string name = w.substr(5);
+            if (name.empty() && i < n && q[i] == '"') { if (!read_quoted(name)) return false; }
+            if (name.empty()) { if (error) *error = "empty dict: filter"; return false; }
+            out.push_back({T::Dict, name});
+            continue;
+        }
+        out.push_back({T::Word, w});
+    }
+    return true;
+}
+
+class Parser {
+public:
+    Parser(const std::vector<Lexeme>& lx, FullTextQueryStd& q) : lx_(lx), q_(q) {}
+
+    bool run(std::string* error) {
+        bool has = false;
+        if (!parse_or(q_.root, has)) { if (error) *error = error_; return false; }
+        if (pos_ != lx_.size()) { if (error) *error = "unexpected ')'"; return false; }
+        if (!has) q_.root = FullTextQueryStd::Node{};
+        return true;
+    }
+
+private:
+    using Node = FullTextQueryStd::Node;
+    using T = Lexeme::Type;
+
+    bool at(T t) const { return pos_ < lx_.size() && lx_[pos_].type == t; }
+
+    static void flatten_into(Node& parent, Node child) {
+        if (child.kind == parent.kind && (parent.kind == Node::Kind::And || parent.kind == Node::Kind::Or))
+            for (auto& c : child.children) parent.children.push_back(std::move(c));
+        else parent.children.push_back(std::move(child));
+    }
+
+    bool parse_or(Node& out, bool& has) {
+        Node acc; acc.kind = Node::Kind::Or;
+        bool first = true;
+        const size_t dicts_before = dicts_seen_;
+        size_t alternatives = 0;
+        for (;;) {
+            Node part; bool part_has = false;
+            if (!parse_and(part, part_has)) return false;
+            if (part_has) flatten_into(acc, std::move(part));
+            else if (!first) { error_ = "OR without right operand"; return false; }
+            first = false;
+            ++alternatives;
+            if (!at(T::Or)) break;
+            if (!part_has) { error_ = "OR without left operand"; return false; }
+            ++pos_;
+        }
+        // Filters apply to the whole query, so they cannot be one alternative of several
+        if (alternatives > 1 && dicts_seen_ != dicts_before) { error_ = "dict: filter inside OR"; return false; }
+        has = !acc.children.empty();
+        if (acc.children.size() == 1) out = std::move(acc.children[0]);
+        else out = std::move(acc);
+        return true;
+    }
+
+    bool parse_and(Node& out, bool& has) {
+        Node acc; acc.kind = Node::Kind::And;
+        bool pending_and = false;
+        while (pos_ < lx_.size() && !at(T::RParen) && !at(T::Or)) {
+            if (at(T::And)) {
+                if (acc.children.empty() || pending_and) { error_ = "AND without left operand"; return false; }
+                pending_and = true; ++pos_; continue;
+            }
+            Node item; bool item_has = false;
+            if (!parse_unary(item, item_has)) return false;
+            if (item_has) flatten_into(acc, std::move(item));
+            pending_and = false;
+        }
+        if (pending_and) { error_ = "AND without right operand"; return false; }
+        has = !acc.children.empty();
+        if (acc.children.size() == 1) out = std::move(acc.children[0]);
+        else out = std::move(acc);
+        return true;
+    }
+
+    bool parse_unary(Node& out, bool& has) {
+        if (at(T::Not)) {
+            ++pos_;
+            Node child; bool child_has = false;
+            if (pos_ >= lx_.size() || at(T::RParen) || at(T::Or) || at(T::And)) { error_ = "NOT without operand"; return false; }
+            if (at(T::Dict) && negated_ == 0) {
+                // NOT dict:Name / -dict:Name excludes that dictionary
+                q_.dict_excludes.push_back(lx_[pos_++].text);
+                ++dicts_seen_;
+                has = false;
+                return true;
+            }
+            ++negated_;
+            const bool ok = parse_unary(child, child_has);
+            --negated_;
+            if (!ok) return false;
+            if (!child_has) { has = false; return true; }
+            out = Node{}; out.kind = Node::Kind::Not;
+            out.children.push_back(std::move(child));
+            has = true;
+            return true;
+        }
+        return parse_primary(out, has);
+    }
+
+    bool parse_primary(Node& out, bool& has) {
+        has = false;
+        const Lexeme& l = lx_[pos_++];
+        switch (l.type) {
+        case T::LParen: {
+            if (!parse_or(out, has)) return false;
+            if (!at(T::RParen)) { error_ = "missing ')'"; return false; }
+            ++pos_;
+            return true;
+        }
+        case T::Dict:
+            if (negated_) { error_ = "dict: filter inside a negated group"; return false; }
+            q_.dict_filters.push_back(l.text);
+            ++dicts_seen_;
+            return true;
+        case T::Phrase: {
+            auto toks = FullTextIndexStd::tokenize(l.text);
+            if (toks.empty()) return true;
+            out = Node{};
+            out.kind = toks.size() == 1 ? Node::Kind::Term : Node::Kind::Phrase;
+            out.words = std::move(toks);
+            has = true;
+            return true;
+        }
+        case T::Word: {
+            std::string w = l.text;
+            bool prefix = !w.empty() && w.back() == '*';
+            while (!w.empty() && w.back() == '*') w.pop_back();
+            auto toks = FullTextIndexStd::tokenize(w);
+            if (toks.empty()) return true;
+            out = Node{};
+            if (toks.size() == 1) out.kind = prefix ? Node::Kind::Prefix : Node::Kind::Term;
+            else out.kind = Node::Kind::Phrase; // e.g. "don't" -> adjacent tokens
+            out.words = std::move(toks);
+            has = true;
+            return true;
+        }
+        default:
+            error_ = "unexpected operator";
+            return false;
+        }
+    }
+
+    const std::vector<Lexeme>& lx_;
+    FullTextQueryStd& q_;
+    size_t pos_ = 0;
+    int negated_ = 0;       // NOT operators enclosing the current position
+    size_t dicts_seen_ = 0; // dict: filters parsed so far
+    std::string error_;
+};
+
+void append_node(const FullTextQueryStd::Node& n, std::string& out) {
+    using K = FullTextQueryStd::Node::Kind;
+    auto join = [&](const std::vector<std::string>& ws) {
+        for (size_t i = 0; i < ws.size(); ++i) { if (i) out.push_back(' '); out += ws[i]; }
+    };
+    switch (n.kind) {
+    case K::Term: join(n.words); break;
+    case K::Prefix: join(n.words); out.push_back('*'); break;
+    case K::Phrase: out.push_back('"'); join(n.words); out.push_back('"'); break;
+    case K::Not: out += "NOT "; append_node(n.children[0], out); break;
+    case K::And:
+    case K::Or:
+        out.push_back('(');
+        for (size_t i = 0; i < n.children.size(); ++i) {
+            if (i) out += (n.kind == K::And) ? " AND " : " OR ";
+            append_node(n.children[i], out);
+        }
+        out.push_back(')');
+        break;
+    }
+}
+
+bool eval_node(const FullTextQueryStd::Node& n, const std::vector<std::string>& toks) {
+    using K = FullTextQueryStd::Node::Kind;
+    switch (n.kind) {
+    case K::Term:
+        return std::find(toks.begin(), toks.end(), n.words[0]) != toks.end();
+    case K::Prefix:
+        for (const auto& t : toks) if (t.compare(0, n.words[0].size(), n.words[0]) == 0) return true;
+        return false;
+    case K::Phrase:
+        for (size_t i = 0; i + n.words.size() <= toks.size(); ++i) {
+            if (std::equal(n.words.begin(), n.words.end(), toks.begin() + i)) return true;
+        }
+        return false;
+    case K::Not:
+        return !eval_node(n.children[0], toks);
+    case K::And:
+        for (const auto& c : n.children) if (!eval_node(c, toks)) return false;
+        return true;
+    case K::Or:
+        for (const auto& c : n.children) if (eval_node(c, toks)) return true;
+        return false;
+    }
+    return false;
+}
+
+} // namespace
+
+bool FullTextQueryStd::is_advanced(const std::string& query) {
+    std::vector<Lexeme> lx;
+    if (!lex(query, lx, nullptr)) return true; // let parse() report the error
+    for (const auto& l : lx) {
+        if (l.type != Lexeme::Type::Word) return true;
+        if (l.text.find('*') != std::string::npos) return true;
+    }
+    return false;
+}
+
+bool FullTextQueryStd::parse(const std::string& query, FullTextQueryStd& out, std::string* error) {
+    out = FullTextQueryStd{};
+    std::vector<Lexeme> lx;
+    if (!lex(query, lx, error)) return false;
+    Parser p(lx, out);
+    return p.run(error);
+}
+
+std::string FullTextQueryStd::to_string() const {
+    std::string out;
+    append_node(root, out);
+    for (const auto& d : dict_filters) {
+        out += " dict:\"";
+        for (char c : d) out.push_back((char)std::tolower((unsigned char)c));
+        out.push_back('"');
+    }
+    for (const auto& d : dict_excludes) {
+        out += " -dict:\"";
+        for (char c : d) out.push_back((char)std::tolower((unsigned char)c));
+        out.push_back('"');
+    }
+    return out;
+}
+
+bool FullTextQueryStd::matches(const std::vector<std::string>& tokens) const {
+    return eval_node(root, tokens);
+}
+
+} // namespace UnidictCoreStd
@@ -0,0 +1,49 @@
+// Boolean query syntax for the full-text index (std-only).
+// Supports AND / OR / NOT (also leading '-'), parentheses, quoted phrases,
+// prefix terms ("term*") and dictionary filters ("dict:Name" or dict:"Long Name";
+// "-dict:Name" / "NOT dict:Name" excludes). Filters restrict the whole query, so
+// they are rejected inside OR alternatives and negated groups.
+// Juxtaposed terms are AND-ed; plain queries without any operator keep the
+// legacy OR semantics of FullTextIndexStd::search (see is_advanced()).
+
+#ifndef UNIDICT_FULLTEXT_QUERY_STD_H
+#define UNIDICT_FULLTEXT_QUERY_STD_H
+
+#include <string>
+#include <vector>
+
+namespace UnidictCoreStd {
+
+class FullTextQueryStd {
+public:
+    struct Node {
+        enum class Kind { Term, Prefix, Phrase, And, Or, Not };
+        Kind kind = Kind::And;
+        std::vector<std::string> words; // Term/Prefix: one token; Phrase: token sequence
+        std::vector<Node> children;     // And/Or: operands; Not: exactly one
+    };
+
+    // True if the query uses any operator syntax; plain word lists return false.
+    static bool is_advanced(const std::string& query);
+    // Parse query into out. Returns false (and sets error) on malformed input.
+    static bool parse(const std::string& query, FullTextQueryStd& out, std::string* error = nullptr);
+
+    // Root expression. An And node without children matches every document
+    // (e.g. a query consisting only of dict: filters).
+    Node root;
+    // Dictionary names from dict: filters; a document matches if its dictionary
+    // is any of them (case-insensitive). Empty means no restriction.
+    std::vector<std::string> dict_filters;
+    // Dictionary names from negated dict: filters; their documents never match.
+    std::vector<std::string> dict_excludes;
+
+    // Canonical text form, stable across whitespace/case differences.
+    std::string to_string() const;
+    // Evaluate root against one document's tokens (FullTextIndexStd::tokenize order),
+    // without an index. dict_filters and dict_excludes are left to the caller.
+    bool matches(const std::vector<std::string>& tokens) const;
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_FULLTEXT_QUERY_STD_H
@@ -0,0 +1,68 @@
+// Non-owning, random-access view over a dictionary's headwords (std-only).
+// Backed either by a parser's std::vector<std::string> or by an accessor into
+// external storage such as a mapped load snapshot. The owner must outlive the view.
+
+#ifndef UNIDICT_HEADWORD_VIEW_STD_H
+#define UNIDICT_HEADWORD_VIEW_STD_H
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UnidictCoreStd {
+
+class HeadwordViewStd {
+public:
+    using Accessor = std::string_view (*)(const void* owner, size_t i);
+
+    HeadwordViewStd() = default;
+    explicit HeadwordViewStd(const std::vector<std::string>& words) : vec_(&words) {}
+    HeadwordViewStd(const void* owner, size_t size, Accessor at) : owner_(owner), at_(at), size_(size) {}
+
+    size_t size() const { return vec_ ? vec_->size() : size_; }
+    bool empty() const { return size() == 0; }
+    std::string_view operator[](size_t i) const { return vec_ ? std::string_view((*vec_)[i]) : at_(owner_, i); }
+    std::string_view front() const { return (*this)[0]; }
+    std::string_view back() const { return (*this)[size() - 1]; }
+    // Owning copy, for callers that need to keep the words beyond the owner's lifetime.
+    std::vector<std::string> to_vector() const {
+        std::vector<std::string> out; out.reserve(size());
+        for (size_t i = 0; i < size(); ++i) out.emplace_back((*this)[i]);
+        return out;
+    }
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::string_view;
+
+        const_iterator() = default;
+        const_iterator(const HeadwordViewStd* v, size_t i) : v_(v), i_(i) {}
+        std::string_view operator*() const { return (*v_)[i_]; }
+        const_iterator& operator++() { ++i_; return *this; }
+        const_iterator operator++(int) { const_iterator t = *this; ++i_; return t; }
+        bool operator==(const const_iterator& o) const { return i_ == o.i_; }
+        bool operator!=(const const_iterator& o) const { return i_ != o.i_; }
+
+    private:
+        const HeadwordViewStd* v_ = nullptr;
+        size_t i_ = 0;
+    };
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+private:
+    const std::vector<std::string>* vec_ = nullptr;
+    const void* owner_ = nullptr;
+    Accessor at_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_HEADWORD_VIEW_STD_H
@@ -16,13 +16,6 @@ static inline std::string lcase(const std::string& s) {
     return out;
 }
 
-static inline std::string trim(const std::string& s) {
-    size_t b = 0, e = s.size();
-    while (b < e && std::isspace((unsigned char)s[b])) ++b;
-    while (e > b && std::isspace((unsigned char)s[e-1])) --e;
-    return s.substr(b, e - b);
-}
-
 void TrieNode::insert(const std::string& word) {
     TrieNode* cur = this;
     for (char ch : lcase(word)) {
@@ -49,47 +42,144 @@ void TrieNode::collect(const std::string& prefix, std::vector<std::string>& out,
     }
 }
 
+IndexSegmentStd::IndexSegmentStd(const HeadwordViewStd& words, const HeadwordViewStd& aliases) {
+    entries_.reserve(words.size() + aliases.size());
+    std::string norm;
+    for (const HeadwordViewStd* list : {&words, &aliases}) {
+        for (std::string_view w : *list) {
+            if (w.empty()) continue;
+            // Same folding as IndexEngineStd::normalize_into
+            size_t b = 0, e = w.size();
+            while (b < e && std::isspace((unsigned char)w[b])) ++b;
+            while (e > b && std::isspace((unsigned char)w[e-1])) --e;
+            norm.clear();
+            for (size_t i = b; i < e; ++i) norm.push_back((char)std::tolower((unsigned char)w[i]));
+            entries_.push_back({norm, std::string(w), 1});
+        }
+    }
+    // Stable, so the first spelling in dictionary order survives the merge
+    std::stable_sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    size_t out = 0;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        if (out > 0 && entries_[out - 1].key == entries_[i].key) { ++entries_[out - 1].frequency; continue; }
+        if (out != i) entries_[out] = std::move(entries_[i]);
+        ++out;
+    }
+    entries_.resize(out);
+    entries_.shrink_to_fit();
+}
+
+bool IndexSegmentStd::find(std::string_view norm, size_t& i) const {
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), norm,
+                               [](const Entry& e, std::string_view k) { return std::string_view(e.key) < k; });
+    if (it == entries_.end() || it->key != norm) return false;
+    i = (size_t)(it - entries_.begin());
+    return true;
+}
+
+std::pair<size_t, size_t> IndexSegmentStd::prefix_range(std::string_view prefix) const {
+    auto lo = std::lower_bound(entries_.begin(), entries_.end(), prefix,
+                               [](const Entry& e, std::string_view k) { return std::string_view(e.key) < k; });
+    auto hi = lo;
+    while (hi != entries_.end() && std::string_view(hi->key).substr(0, prefix.size()) == prefix) ++hi;
+    return {(size_t)(lo - entries_.begin()), (size_t)(hi - entries_.begin())};
+}
+
 IndexEngineStd::IndexEngineStd() : trie_(new TrieNode) {}
 
-void IndexEngineStd::add_word(const std::string& word, const std::string& dictionary_id) {
+bool IndexEngineStd::seen_before(const std::string& key, size_t seg) const {
+    if (word_index_.count(key)) return true;
+    size_t i = 0;
+    for (size_t s = 0; s < seg; ++s) {
+        if (segments_[s].first->find(key, i)) return true;
+    }
+    return false;
+}
+
+template <typename Fn>
+void IndexEngineStd::for_each_word(Fn fn) const {
+    for (const auto& kv : word_index_) {
+        if (!fn(kv.first, kv.second.word)) return;
+    }
+    for (size_t s = 0; s < segments_.size(); ++s) {
+        const IndexSegmentStd& seg = *segments_[s].first;
+        for (size_t i = 0; i < seg.size(); ++i) {
+            if (seen_before(seg.key(i), s)) continue;
+            if (!fn(seg.key(i), seg.word(i))) return;
+        }
+    }
+}
+
+void IndexEngineStd::add_one(std::string_view word, const std::string& dictionary_id, std::string& norm) {
     if (word.empty()) return;
-    const std::string norm = normalize(word);
+    normalize_into(word, norm);
     IndexEntry& e = word_index_[norm];
-    if (e.word.empty()) { e.word = word; e.normalized_word = norm; }
+    if (e.word.empty()) e.word.assign(word);
     if (std::find(e.dictionary_ids.begin(), e.dictionary_ids.end(), dictionary_id) == e.dictionary_ids.end()) {
         e.dictionary_ids.push_back(dictionary_id);
     }
     ++e.frequency;
-    dict_[dictionary_id].insert(word);
 }
 
-void IndexEngineStd::remove_word(const std::string& word, const std::string& dictionary_id) {
-    const std::string norm = normalize(word);
+void IndexEngineStd::remove_one(std::string_view word, const std::string& dictionary_id, std::string& norm) {
+    normalize_into(word, norm);
     auto it = word_index_.find(norm);
     if (it != word_index_.end()) {
         auto& vec = it->second.dictionary_ids;
         vec.erase(std::remove(vec.begin(), vec.end(), dictionary_id), vec.end());
         if (vec.empty()) word_index_.erase(it);
     }
-    auto dit = dict_.find(dictionary_id);
-    if (dit != dict_.end()) {
-        dit->second.erase(word);
-        if (dit->second.empty()) dict_.erase(dit);
+}
+
+void IndexEngineStd::add_word(const std::string& word, const std::string& dictionary_id) {
+    std::string norm;
+    add_one(word, dictionary_id, norm);
+}
+
+void IndexEngineStd::add_words(const HeadwordViewStd& words, const std::string& dictionary_id) {
+    word_index_.reserve(word_index_.size() + words.size());
+    std::string norm;
+    for (std::string_view w : words) add_one(w, dictionary_id, norm);
+}
+
+void IndexEngineStd::remove_word(const std::string& word, const std::string& dictionary_id) {
+    std::string norm;
+    remove_one(word, dictionary_id, norm);
+}
+
+void IndexEngineStd::remove_words(const HeadwordViewStd& words, const std::string& dictionary_id) {
+    std::string norm;
+    for (std::string_view w : words) remove_one(w, dictionary_id, norm);
+}
+
+void IndexEngineStd::add_segment(std::shared_ptr<const IndexSegmentStd> seg, const std::string& dictionary_id) {
+    if (seg) segments_.push_back({std::move(seg), dictionary_id});
+}
+
+bool IndexEngineStd::remove_segment(const IndexSegmentStd* seg, const std::string& dictionary_id) {
+    for (auto it = segments_.begin(); it != segments_.end(); ++it) {
+        if (it->first.get() == seg && it->second == dictionary_id) { segments_.erase(it); return true; }
     }
+    return false;
 }
 
 void IndexEngineStd::clear_dictionary(const std::string& dictionary_id) {
-    auto it = dict_.find(dictionary_id);
-    if (it == dict_.end()) return;
-    // Copy to a stable list to avoid iterator invalidation while erasing
-    std::vector<std::string> words(it->second.begin(), it->second.end());
-    for (const auto& w : words) remove_word(w, dictionary_id);
+    segments_.erase(std::remove_if(segments_.begin(), segments_.end(),
+                                   [&](const auto& s) { return s.second == dictionary_id; }),
+                    segments_.end());
+    // No per-dictionary word lists are kept (they duplicated every headword); scan instead
+    for (auto it = word_index_.begin(); it != word_index_.end();) {
+        auto& vec = it->second.dictionary_ids;
+        vec.erase(std::remove(vec.begin(), vec.end(), dictionary_id), vec.end());
+        if (vec.empty()) it = word_index_.erase(it);
+        else ++it;
+    }
 }
 
 void IndexEngineStd::clear() {
     trie_.reset(new TrieNode);
     word_index_.clear();
-    dict_.clear();
+    segments_.clear();
     built_ = false;
 }
 
@@ -104,8 +194,12 @@ void IndexEngineStd::build_index() {
 std::vector<std::string> IndexEngineStd::exact_match(const std::string& word) const {
     const std::string norm = normalize(word);
     auto it = word_index_.find(norm);
-    if (it == word_index_.end()) return {};
-    return {it->second.word};
+    if (it != word_index_.end()) return {it->second.word};
+    size_t i = 0;
+    for (const auto& s : segments_) {
+        if (s.first->find(norm, i)) return {s.first->word(i)};
+    }
+    return {};
 }
 
 std::vector<std::string> IndexEngineStd::prefix_search(const std::string& prefix, int max_results) const {
@@ -116,21 +210,32 @@ std::vector<std::string> IndexEngineStd::prefix_search(const std::string& prefix
     const TrieNode* cur = trie_.get();
     for (char ch : lp) {
         auto it = cur->children.find(ch);
-        if (it == cur->children.end()) return out;
+        if (it == cur->children.end()) { cur = nullptr; break; }
         cur = it->second.get();
     }
     int count = 0;
-    cur->collect(prefix, out, count, max_results);
+    if (cur) cur->collect(prefix, out, count, max_results);
+    // Shared segments are sorted, so their matches are one contiguous range each
+    for (size_t s = 0; s < segments_.size() && count < max_results; ++s) {
+        const IndexSegmentStd& seg = *segments_[s].first;
+        auto r = seg.prefix_range(lp);
+        for (size_t i = r.first; i < r.second && count < max_results; ++i) {
+            if (seen_before(seg.key(i), s)) continue;
+            out.push_back(seg.word(i));
+            ++count;
+        }
+    }
     return out;
 }
 
 std::vector<std::string> IndexEngineStd::fuzzy_search(const std::string& word, int max_results) const {
     std::vector<std::pair<int, std::string>> scored;
     const std::string lw = lcase(word);
-    for (const auto& kv : word_index_) {
-        int d = edit_distance(lw, lcase(kv.second.word));
-        if (d <= 2) scored.emplace_back(d, kv.second.word);
-    }
+    for_each_word([&](const std::string&, const std::string& w) {
+        int d = edit_distance(lw, lcase(w));
+        if (d <= 2) scored.emplace_back(d, w);
+        return true;
+    });
     std::sort(scored.begin(), scored.end(), [](auto& a, auto& b){ return a.first < b.first; });
     std::vector<std::string> out; out.reserve(std::min<int>(max_results, (int)scored.size()));
     for (auto& p : scored) { if ((int)out.size() >= max_results) break; out.push_back(p.second); }
@@ -139,10 +244,11 @@ std::vector<std::string> IndexEngineStd::fuzzy_search(const std::string& word, i
 
 std::vector<std::string> IndexEngineStd::wildcard_search(const std::string& pattern, int max_results) const {
     std::vector<std::string> out;
-    for (const auto& kv : word_index_) {
-        if ((int)out.size() >= max_results) break;
-        if (wildcard_match(kv.second.word, pattern)) out.push_back(kv.second.word);
-    }
+    for_each_word([&](const std::string&, const std::string& w) {
+        if ((int)out.size() >= max_results) return false;
+        if (wildcard_match(w, pattern)) out.push_back(w);
+        return true;
+    });
     return out;
 }
 
@@ -150,10 +256,11 @@ std::vector<std::string> IndexEngineStd::regex_search(const std::string& pattern
     std::vector<std::string> out;
     try {
         std::regex re(pattern, std::regex::icase);
-        for (const auto& kv : word_index_) {
-            if ((int)out.size() >= max_results) break;
-            if (std::regex_search(kv.second.word, re)) out.push_back(kv.second.word);
-        }
+        for_each_word([&](const std::string&, const std::string& w) {
+            if ((int)out.size() >= max_results) return false;
+            if (std::regex_search(w, re)) out.push_back(w);
+            return true;
+        });
     } catch (const std::regex_error&) {
         // invalid pattern: return empty
         return {};
@@ -163,32 +270,61 @@ std::vector<std::string> IndexEngineStd::regex_search(const std::string& pattern
 
 std::vector<std::string> IndexEngineStd::all_words() const {
     std::vector<std::string> v; v.reserve(word_index_.size());
-    for (const auto& kv : word_index_) v.push_back(kv.second.word);
+    for_each_word([&](const std::string&, const std::string& w) { v.push_back(w); return true; });
     return v;
 }
 
 std::vector<std::string> IndexEngineStd::dictionaries_for_word(const std::string& word) const {
     const std::string norm = normalize(word);
+    std::vector<std::string> ids;
     auto it = word_index_.find(norm);
-    if (it == word_index_.end()) return {};
-    return it->second.dictionary_ids;
+    if (it != word_index_.end()) ids = it->second.dictionary_ids;
+    size_t i = 0;
+    for (const auto& s : segments_) {
+        if (s.first->find(norm, i) && std::find(ids.begin(), ids.end(), s.second) == ids.end()) ids.push_back(s.second);
+    }
+    return ids;
 }
 
-int IndexEngineStd::word_count() const { return (int)word_index_.size(); }
+int IndexEngineStd::word_count() const {
+    if (segments_.empty()) return (int)word_index_.size();
+    int n = 0;
+    for_each_word([&](const std::string&, const std::string&) { ++n; return true; });
+    return n;
+}
 
 bool IndexEngineStd::save_index(const std::string& file_path) const {
     std::ofstream out(file_path, std::ios::binary);
     if (!out) return false;
     // Simple line format: word\tfrequency\tdict1|dict2|...\n
-    for (const auto& kv : word_index_) {
-        const auto& e = kv.second;
+    auto write = [&out](const IndexEntry& e) {
         out << e.word << "\t" << e.frequency << "\t";
         for (size_t i = 0; i < e.dictionary_ids.size(); ++i) {
             if (i) out << '|';
             out << e.dictionary_ids[i];
         }
         out << "\n";
+    };
+    if (segments_.empty()) {
+        for (const auto& kv : word_index_) write(kv.second);
+        return true;
     }
+    // Fold the shared segments in, so the file loads back into a plain index
+    for_each_word([&](const std::string& key, const std::string& w) {
+        IndexEntry e;
+        auto it = word_index_.find(key);
+        if (it != word_index_.end()) e = it->second;
+        else e.word = w;
+        size_t i = 0;
+        for (const auto& s : segments_) {
+            if (!s.first->find(key, i)) continue;
+            e.frequency += s.first->frequency(i);
+            if (std::find(e.dictionary_ids.begin(), e.dictionary_ids.end(), s.second) == e.dictionary_ids.end())
+                e.dictionary_ids.push_back(s.second);
+        }
+        write(e);
+        return true;
+    });
     return true;
 }
 
@@ -196,7 +332,7 @@ bool IndexEngineStd::load_index(const std::string& file_path) {
     std::ifstream in(file_path, std::ios::binary);
     if (!in) return false;
     word_index_.clear();
-    dict_.clear();
+    segments_.clear();
     std::string line;
     while (std::getline(in, line)) {
         std::istringstream iss(line);
@@ -204,19 +340,32 @@ bool IndexEngineStd::load_index(const std::string& file_path) {
         if (!std::getline(iss, word, '\t')) continue;
         std::string freq_s; if (!std::getline(iss, freq_s, '\t')) continue; freq = std::stoi(freq_s);
         std::getline(iss, dicts);
-        IndexEntry e; e.word = word; e.normalized_word = normalize(word); e.frequency = freq;
+        IndexEntry e; e.word = word; e.frequency = freq;
         std::istringstream ds(dicts);
         std::string id;
         while (std::getline(ds, id, '|')) {
-            if (!id.empty()) { e.dictionary_ids.push_back(id); dict_[id].insert(word); }
+            if (!id.empty()) e.dictionary_ids.push_back(id);
         }
-        word_index_[e.normalized_word] = std::move(e);
+        word_index_[normalize(word)] = std::move(e);
     }
     build_index();
     return true;
 }
 
-std::string IndexEngineStd::normalize(const std::string& s) { return trim(lcase(s)); }
+std::string IndexEngineStd::normalize(std::string_view s) {
+    std::string out;
+    normalize_into(s, out);
+    return out;
+}
+
+void IndexEngineStd::normalize_into(std::string_view s, std::string& out) {
+    // trim(lcase(s)) without the intermediate copies
+    size_t b = 0, e = s.size();
+    while (b < e && std::isspace((unsigned char)s[b])) ++b;
+    while (e > b && std::isspace((unsigned char)s[e-1])) --e;
+    out.clear();
+    for (size_t i = b; i < e; ++i) out.push_back((char)std::tolower((unsigned char)s[i]));
+}
 
 int IndexEngineStd::edit_distance(const std::string& a, const std::string& b) {
     const int n = (int)a.size(), m = (int)b.size();
@@ -6,15 +6,17 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "headword_view_std.h"
+
 namespace UnidictCoreStd {
 
 struct IndexEntry {
-    std::string word;
-    std::string normalized_word;
+    std::string word; // first spelling seen; the map key holds the normalized form
     std::vector<std::string> dictionary_ids;
     int frequency = 0;
 };
@@ -28,6 +30,28 @@ public:
     void collect(const std::string& prefix, std::vector<std::string>& out, int& count, int max_results) const;
 };
 
+// Immutable word list of one dictionary, normalized and sorted. Several engines
+// (e.g. managers sharing a DictionaryRegistryStd) can reference one segment
+// instead of each copying the dictionary's words.
+class IndexSegmentStd {
+public:
+    // aliases (e.g. StarDict synonyms) are indexed like words.
+    explicit IndexSegmentStd(const HeadwordViewStd& words, const HeadwordViewStd& aliases = {});
+
+    size_t size() const { return entries_.size(); }
+    // Position of a normalized word.
+    bool find(std::string_view norm, size_t& i) const;
+    // [first, last) of the normalized words starting with prefix.
+    std::pair<size_t, size_t> prefix_range(std::string_view prefix) const;
+    const std::string& key(size_t i) const { return entries_[i].key; }
+    const std::string& word(size_t i) const { return entries_[i].word; } // first spelling
+    int frequency(size_t i) const { return entries_[i].frequency; }
+
+private:
+    struct Entry { std::string key; std::string word; int frequency = 0; };
+    std::vector<Entry> entries_; // sorted by key
+};
+
 class IndexEngineStd {
 public:
     IndexEngineStd();
@@ -35,7 +59,14 @@ public:
 
     // Mutations
     void add_word(const std::string& word, const std::string& dictionary_id);
+    // Bulk variants reading the words in place (no per-word string copies).
+    void add_words(const HeadwordViewStd& words, const std::string& dictionary_id);
     void remove_word(const std::string& word, const std::string& dictionary_id);
+    void remove_words(const HeadwordViewStd& words, const std::string& dictionary_id);
+    // Reference a shared segment instead of copying its words; remove_segment
+    // drops the first reference to seg registered under dictionary_id (false if none).
+    void add_segment(std::shared_ptr<const IndexSegmentStd> seg, const std::string& dictionary_id);
+    bool remove_segment(const IndexSegmentStd* seg, const std::string& dictionary_id);
     void clear_dictionary(const std::string& dictionary_id);
     void clear();
     void build_index();
@@ -56,13 +87,21 @@ public:
     bool load_index(const std::string& file_path);
 
 private:
-    static std::string normalize(const std::string& s);
+    // Visit each distinct word once (own words, then segments in order); stop when fn returns false.
+    template <typename Fn> void for_each_word(Fn fn) const;
+    // True if an earlier source (own words or segments before seg) already holds key.
+    bool seen_before(const std::string& key, size_t seg) const;
+
+    static std::string normalize(std::string_view s);
+    static void normalize_into(std::string_view s, std::string& out);
+    void add_one(std::string_view word, const std::string& dictionary_id, std::string& norm);
+    void remove_one(std::string_view word, const std::string& dictionary_id, std::string& norm);
     static int edit_distance(const std::string& a, const std::string& b);
     static bool wildcard_match(const std::string& word, const std::string& pattern);
 
     std::unique_ptr<TrieNode> trie_;
     std::unordered_map<std::string, IndexEntry> word_index_;                  // normalized -> entry
-    std::unordered_map<std::string, std::unordered_set<std::string>> dict_;   // dictId -> set(words)
+    std::vector<std::pair<std::shared_ptr<const IndexSegmentStd>, std::string>> segments_; // (segment, dictionary id)
     bool built_ = false;
 };
 
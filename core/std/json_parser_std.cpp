@@ -74,6 +74,29 @@ bool JsonParserStd::load_dictionary(const std::string& file_path) {
     return loaded_;
 }
 
+bool JsonParserStd::read_header(const std::string& file_path, std::string& name, std::string& description) {
+    std::ifstream in(file_path, std::ios::binary);
+    if (!in) return false;
+    std::string s(64 * 1024, '\0');
+    in.read(s.data(), (std::streamsize)s.size());
+    s.resize((size_t)in.gcount());
+    // Same tolerant scan as load_dictionary, stopping before the entries array
+    size_t limit = s.find("\"entries\"");
+    if (limit != std::string::npos) s.resize(limit);
+    auto find_str_val = [&](const std::string& key) -> std::string {
+        const std::string pat = '"' + key + '"';
+        size_t p = s.find(pat); if (p == std::string::npos) return {};
+        p = s.find(':', p); if (p == std::string::npos) return {};
+        size_t q = s.find('"', p); if (q == std::string::npos) return {};
+        size_t r = s.find('"', q + 1); if (r == std::string::npos) return {};
+        return s.substr(q + 1, r - q - 1);
+    };
+    name = find_str_val("name");
+    description = find_str_val("description");
+    if (name.empty()) name = "JSON Dictionary";
+    return true;
+}
+
 bool JsonParserStd::is_loaded() const { return loaded_; }
 std::string JsonParserStd::name() const { return name_.empty() ? std::string("JSON Dictionary") : name_; }
 std::string JsonParserStd::description() const { return desc_; }
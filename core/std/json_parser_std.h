@@ -7,6 +7,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "headword_view_std.h"
+
 namespace UnidictCoreStd {
 
 class JsonParserStd {
@@ -15,6 +17,8 @@ public:
 
     bool load_dictionary(const std::string& file_path);
     bool is_loaded() const;
+    // Read only "name"/"description" from the start of the file.
+    static bool read_header(const std::string& file_path, std::string& name, std::string& description);
 
     std::string name() const;
     std::string description() const;
@@ -23,6 +27,8 @@ public:
     std::string lookup(const std::string& word) const; // returns empty if not found
     std::vector<std::string> find_similar(const std::string& word, int max_results) const;
     std::vector<std::string> all_words() const;
+    // Non-owning view of the same list; valid while the parser is alive and not reloaded.
+    HeadwordViewStd headwords() const { return HeadwordViewStd(words_); }
 
 private:
     bool loaded_ = false;
@@ -0,0 +1,112 @@
+// Small bounded LRU cache (std-only, header-only). Not thread-safe; callers
+// serialize access. Bounded by entry count and by a caller-supplied cost
+// (typically bytes), whichever is hit first.
+
+#ifndef UNIDICT_LRU_CACHE_STD_H
+#define UNIDICT_LRU_CACHE_STD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace UnidictCoreStd {
+
+template <typename K, typename V, typename Hash = std::hash<K>>
+class LruCacheStd {
+public:
+    explicit LruCacheStd(size_t max_entries = 128, size_t max_cost = SIZE_MAX)
+        : max_entries_(max_entries ? max_entries : 1), max_cost_(max_cost) {}
+
+    // Returns a pointer to the cached value (valid until the next mutation) and
+    // marks it most recently used; nullptr on miss.
+    const V* get(const K& key) {
+        auto it = map_.find(key);
+        if (it == map_.end()) { ++misses_; return nullptr; }
+        order_.splice(order_.begin(), order_, it->second);
+        ++hits_;
+        return &it->second->value;
+    }
+
+    bool contains(const K& key) const { return map_.find(key) != map_.end(); }
+
+    void put(const K& key, V value, size_t cost = 1) {
+        auto it = map_.find(key);
+        if (it != map_.end()) {
+            cost_ -= it->second->cost;
+            order_.erase(it->second);
+            map_.erase(it);
+        }
+        if (cost > max_cost_) return; // would never fit
+        order_.push_front(Node{key, std::move(value), cost});
+        map_.emplace(key, order_.begin());
+        cost_ += cost;
+        evict();
+    }
+
+    bool erase(const K& key) {
+        auto it = map_.find(key);
+        if (it == map_.end()) return false;
+        cost_ -= it->second->cost;
+        order_.erase(it->second);
+        map_.erase(it);
+        return true;
+    }
+
+    // Drop every entry for which pred(key) is true.
+    template <typename Pred>
+    size_t erase_if(Pred pred) {
+        size_t n = 0;
+        for (auto it = order_.begin(); it != order_.end();) {
+            if (pred(it->key)) {
+                cost_ -= it->cost;
+                map_.erase(it->key);
+                it = order_.erase(it);
+                ++n;
+            } else {
+                ++it;
+            }
+        }
+        return n;
+    }
+
+    void clear() { order_.clear(); map_.clear(); cost_ = 0; }
+
+    size_t size() const { return map_.size(); }
+    size_t cost() const { return cost_; }
+    size_t max_entries() const { return max_entries_; }
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+
+    void set_limits(size_t max_entries, size_t max_cost = SIZE_MAX) {
+        max_entries_ = max_entries ? max_entries : 1;
+        max_cost_ = max_cost;
+        evict();
+    }
+
+private:
+    struct Node { K key; V value; size_t cost; };
+
+    void evict() {
+        while (!order_.empty() && (map_.size() > max_entries_ || cost_ > max_cost_)) {
+            auto& last = order_.back();
+            cost_ -= last.cost;
+            map_.erase(last.key);
+            order_.pop_back();
+        }
+    }
+
+    size_t max_entries_;
+    size_t max_cost_;
+    size_t cost_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    std::list<Node> order_;
+    std::unordered_map<K, typename std::list<Node>::iterator, Hash> map_;
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_LRU_CACHE_STD_H
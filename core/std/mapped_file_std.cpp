@@ -0,0 +1,130 @@
+#include "mapped_file_std.h"
+
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace UnidictCoreStd {
+
+MappedFileStd::~MappedFileStd() { close(); }
+
+MappedFileStd::MappedFileStd(MappedFileStd&& other) noexcept { move_from(other); }
+
+MappedFileStd& MappedFileStd::operator=(MappedFileStd&& other) noexcept {
+    if (this != &other) { close(); move_from(other); }
+    return *this;
+}
+
+void MappedFileStd::move_from(MappedFileStd& other) noexcept {
+    size_ = other.size_; open_ = other.open_; mapped_ = other.mapped_;
+    fallback_ = std::move(other.fallback_);
+    data_ = mapped_ ? other.data_ : fallback_.data();
+#ifdef _WIN32
+    file_ = other.file_; mapping_ = other.mapping_;
+    other.file_ = nullptr; other.mapping_ = nullptr;
+#endif
+    other.data_ = nullptr; other.size_ = 0; other.open_ = false; other.mapped_ = false;
+}
+
+bool MappedFileStd::open(const std::string& path, bool private_copy) {
+    close();
+    if (!private_copy) {
+#ifdef _WIN32
+        HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (f != INVALID_HANDLE_VALUE) {
+            LARGE_INTEGER sz;
+            if (GetFileSizeEx(f, &sz)) {
+                if (sz.QuadPart == 0) { CloseHandle(f); open_ = true; data_ = fallback_.data(); return true; }
+                HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (m) {
+                    void* p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+                    if (p) {
+                        file_ = f; mapping_ = m;
+                        data_ = static_cast<const char*>(p); size_ = (size_t)sz.QuadPart;
+                        open_ = mapped_ = true;
+                        return true;
+                    }
+                    CloseHandle(m);
+                }
+            }
+            CloseHandle(f);
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            struct stat st;
+            if (::fstat(fd, &st) == 0) {
+                if (st.st_size == 0) { ::close(fd); open_ = true; data_ = fallback_.data(); return true; }
+                void* p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                ::close(fd); // the mapping keeps its own reference
+                if (p != MAP_FAILED) {
+                    data_ = static_cast<const char*>(p); size_ = (size_t)st.st_size;
+                    open_ = mapped_ = true;
+                    return true;
+                }
+            } else {
+                ::close(fd);
+            }
+        }
+#endif
+    }
+    // Fallback (or private copy): plain read
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    const std::streamoff n = in.tellg();
+    if (n < 0) return false;
+    fallback_.resize((size_t)n);
+    in.seekg(0);
+    if (n > 0 && !in.read(&fallback_[0], n)) { fallback_.clear(); return false; }
+    data_ = fallback_.data(); size_ = fallback_.size();
+    open_ = true; mapped_ = false;
+    return true;
+}
+
+void MappedFileStd::advise(Access access, size_t offset, size_t length) const {
+#ifndef _WIN32
+    if (!mapped_ || offset >= size_) return;
+    if (length == 0 || length > size_ - offset) length = size_ - offset;
+    // madvise wants a page-aligned start
+    static const size_t page = (size_t)::sysconf(_SC_PAGESIZE);
+    const size_t start = offset - offset % page;
+    int advice = MADV_NORMAL;
+    switch (access) {
+    case Access::Normal: advice = MADV_NORMAL; break;
+    case Access::Random: advice = MADV_RANDOM; break;
+    case Access::Sequential: advice = MADV_SEQUENTIAL; break;
+    case Access::WillNeed: advice = MADV_WILLNEED; break;
+    }
+    ::madvise(const_cast<char*>(data_) + start, length + (offset - start), advice);
+#else
+    (void)access; (void)offset; (void)length;
+#endif
+}
+
+void MappedFileStd::close() {
+    if (mapped_) {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle((HANDLE)mapping_);
+        if (file_) CloseHandle((HANDLE)file_);
+        mapping_ = nullptr; file_ = nullptr;
+#else
+        ::munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+    fallback_.clear();
+    data_ = nullptr; size_ = 0; open_ = false; mapped_ = false;
+}
+
+} // namespace UnidictCoreStd
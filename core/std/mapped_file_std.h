@@ -0,0 +1,55 @@
+// Read-only memory-mapped file (std-only wrapper over mmap / MapViewOfFile).
+// Falls back to reading the file into memory where mapping is unavailable, or
+// on request for files that may be rewritten in place while open.
+
+#ifndef UNIDICT_MAPPED_FILE_STD_H
+#define UNIDICT_MAPPED_FILE_STD_H
+
+#include <cstddef>
+#include <string>
+
+namespace UnidictCoreStd {
+
+class MappedFileStd {
+public:
+    MappedFileStd() = default;
+    ~MappedFileStd();
+    MappedFileStd(const MappedFileStd&) = delete;
+    MappedFileStd& operator=(const MappedFileStd&) = delete;
+    MappedFileStd(MappedFileStd&& other) noexcept;
+    MappedFileStd& operator=(MappedFileStd&& other) noexcept;
+
+    // Map the whole file read-only. Returns false if it cannot be opened.
+    // private_copy reads it into memory instead: a mapping faults (SIGBUS) once
+    // another process truncates the file under it, e.g. `cp new.dict old.dict`.
+    bool open(const std::string& path, bool private_copy = false);
+    void close();
+
+    bool is_open() const { return open_; }
+    // True when backed by an OS mapping rather than the in-memory fallback.
+    bool is_mapped() const { return mapped_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Paging hint for [offset, offset + length) (length 0: to the end), passed to
+    // madvise. A no-op for the in-memory fallback and on Windows.
+    enum class Access { Normal, Random, Sequential, WillNeed };
+    void advise(Access access, size_t offset = 0, size_t length = 0) const;
+
+private:
+    void move_from(MappedFileStd& other) noexcept;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+    bool mapped_ = false;
+    std::string fallback_;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_MAPPED_FILE_STD_H
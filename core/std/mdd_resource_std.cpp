@@ -1,6 +1,8 @@
 // MDict .mdd resource file parser implementation (std-only).
 
 #include "mdd_resource_std.h"
+#include "block_decoder_std.h"
+#include "mdx_file_std.h"
 #include "path_utils_std.h"
 #include <fstream>
 #include <sstream>
@@ -8,6 +10,7 @@
 #include <cstring>
 #include <filesystem>
 #include <ctime>
+#include <cstdlib>
 
 #ifdef __GNUC__
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -50,51 +53,19 @@ namespace {
                (uint64_t)p[6] << 8 | p[7];
     }
 
-    // Simple decompression using zlib
+    // Maximum size of a decoded block
+    const size_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+    // Blocks that are not zlib streams are taken as stored
     bool decompress_zlib(const uint8_t* input, size_t input_len,
                         std::vector<uint8_t>& output) {
-#ifdef USE_ZLIB
-        z_stream stream = {};
-        if (inflateInit2(&stream, 15 + 32) != Z_OK) {
-            return false;
-        }
-
-        stream.avail_in = static_cast<uInt>(input_len);
-        stream.next_in = const_cast<uint8_t*>(input);
-
-        // Estimate output size (start with 2x input)
-        output.resize(std::max(input_len * 2, size_t(1024)));
-        size_t output_pos = 0;
-
-        int ret;
-        do {
-            stream.avail_out = static_cast<uInt>(output.size() - output_pos);
-            stream.next_out = output.data() + output_pos;
-
-            ret = inflate(&stream, Z_NO_FLUSH);
-
-            if (ret == Z_OK || ret == Z_STREAM_END) {
-                output_pos = stream.total_out;
-                if (ret == Z_OK && stream.avail_out == 0) {
-                    // Need more output space
-                    output.resize(output.size() * 2);
-                }
-            }
-        } while (ret == Z_OK);
-
-        inflateEnd(&stream);
-
-        if (ret != Z_STREAM_END) {
-            return false;
+        std::string out;
+        if (BlockDecoderStd::inflate(input, input_len, MAX_BLOCK_SIZE, out)) {
+            output.assign(out.begin(), out.end());
+        } else {
+            output.assign(input, input + input_len);
         }
-
-        output.resize(stream.total_out);
-        return true;
-#else
-        // Fallback: copy input to output (assuming uncompressed)
-        output.assign(input, input + input_len);
         return true;
-#endif
     }
 }
 
@@ -105,6 +76,25 @@ bool MddResourceParser::load(const std::string& mdd_path) {
     unload();
 
     mdd_path_ = mdd_path;
+    auto container = std::make_unique<MdxFileStd>();
+    if (container->open(mdd_path)) {
+        for (size_t i = 0; i < container->size(); ++i) {
+            MddResourceEntry entry;
+            entry.key = normalize_key(std::string(container->key(i)));
+            entry.offset = i;
+            entry.size = container->record_size(i);
+            entry.is_compressed = true;
+            if (resources_.emplace(entry.key, entry).second) resource_keys_.push_back(entry.key);
+        }
+        header_ = {};
+        header_.magic = "MDict";
+        header_.version = (uint32_t)std::atoi(container->attribute("generatedbyengineversion").c_str());
+        header_.total_size = fs::file_size(mdd_path);
+        container_ = std::move(container);
+        loaded_ = true;
+        return true;
+    }
+
     file_ = std::fopen(mdd_path.c_str(), "rb");
     if (!file_) {
         return false;
@@ -136,6 +126,7 @@ void MddResourceParser::unload() {
         std::fclose(file_);
         file_ = nullptr;
     }
+    container_.reset();
     resources_.clear();
     resource_keys_.clear();
     loaded_ = false;
@@ -511,6 +502,12 @@ std::vector<uint8_t> MddResourceParser::get_resource(const std::string& key) con
         return result;
     }
 
+    if (container_) {
+        std::string record;
+        if (container_->record(entry.offset, record)) result.assign(record.begin(), record.end());
+        return result;
+    }
+
     // Read raw data
     std::vector<uint8_t> data;
     if (!read_bytes(entry.offset, entry.size, data)) {
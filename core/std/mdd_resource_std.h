@@ -1,6 +1,7 @@
 // MDict .mdd resource file parser (std-only).
 // Handles extraction and caching of resources (images, audio, etc.)
-// from MDict resource files (.mdd) for dictionary rendering.
+// from MDict resource files (.mdd) for dictionary rendering. Real MDict
+// containers are read through MdxFileStd, one record block at a time.
 
 #ifndef UNIDICT_MDD_RESOURCE_STD_H
 #define UNIDICT_MDD_RESOURCE_STD_H
@@ -10,13 +11,16 @@
 #include <vector>
 #include <memory>
 #include <cstdint>
+#include <cstdio>
 
 namespace UnidictCoreStd {
 
+class MdxFileStd;
+
 // Resource entry in .mdd file
 struct MddResourceEntry {
     std::string key;            // normalized resource key (e.g., "images/hello.png")
-    uint64_t offset = 0;        // offset in .mdd file
+    uint64_t offset = 0;        // offset in .mdd file (entry number in an MDict container)
     uint64_t size = 0;          // compressed size
     uint64_t uncompressed_size = 0;  // uncompressed size (0 if not compressed)
     uint32_t block_id = 0;      // block ID (for multi-block .mdd files)
@@ -108,6 +112,8 @@ private:
 
     // File handle
     mutable std::FILE* file_ = nullptr;
+    // Set when the file is a real MDict container
+    std::unique_ptr<MdxFileStd> container_;
 };
 
 // Resource cache manager
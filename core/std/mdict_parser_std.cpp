@@ -1,13 +1,16 @@
 #include "mdict_parser_std.h"
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <sstream>
 #include <string_view>
-#include <zlib.h>
 
+#include "block_decoder_std.h"
+#include "parallel_for_std.h"
 #include "path_utils_std.h"
 
 namespace fs = std::filesystem;
@@ -139,19 +142,38 @@ static inline uint32_t be32u(const unsigned char* p) {
 static constexpr uint32_t MAX_UNCOMP_BLOCK = 16u * 1024u * 1024u; // 16MB per block
 static constexpr uint32_t MAX_COMP_BLOCK = 16u * 1024u * 1024u;   // 16MB compressed cap
 
+// A zlib stream at the start of in (trailing bytes allowed), at most max_out decoded
+static bool inflate_prefix(const char* in, size_t len, size_t max_out, std::string& out) {
+    out.resize(max_out);
+    size_t produced = 0;
+    if (!BlockDecoderStd::backend(BlockDecoderStd::Zlib)->decompress((const unsigned char*)in, len, (unsigned char*)out.data(), max_out, &produced)) {
+        out.clear();
+        return false;
+    }
+    out.resize(produced);
+    return true;
+}
+
 static bool safe_inflate(const unsigned char* in, uint32_t clen, uint32_t ulen, std::string& out) {
     if (clen == 0 || ulen == 0) return false;
     if (clen > MAX_COMP_BLOCK || ulen > MAX_UNCOMP_BLOCK) return false;
-    z_stream strm{}; strm.next_in = (Bytef*)in; strm.avail_in = clen;
-    if (inflateInit(&strm) != Z_OK) return false;
-    out.resize(ulen);
-    strm.next_out = (Bytef*)out.data(); strm.avail_out = (uInt)out.size();
-    int rc = inflate(&strm, Z_FINISH);
-    inflateEnd(&strm);
-    if (rc != Z_STREAM_END) return false;
-    size_t produced = out.size() - strm.avail_out; 
-    out.resize(produced);
-    return true;
+    return inflate_prefix((const char*)in, clen, ulen, out);
+}
+
+// Below this much compressed data, starting threads costs more than it saves
+static constexpr uint64_t PARALLEL_INFLATE_BYTES = 1u << 20;
+
+struct ZBlock { const unsigned char* data; uint32_t clen; uint32_t ulen; };
+
+// Inflate independent zlib blocks, in parallel once there is enough data;
+// outs[i] is block i. False if any block fails.
+static bool inflate_blocks(const std::vector<ZBlock>& blocks, std::vector<std::string>& outs) {
+    outs.assign(blocks.size(), std::string());
+    uint64_t total = 0;
+    for (const auto& b : blocks) total += b.clen;
+    return parallel_for(blocks.size(), total >= PARALLEL_INFLATE_BYTES ? 0 : 1, [&](size_t i) {
+        return safe_inflate(blocks[i].data, blocks[i].clen, blocks[i].ulen, outs[i]);
+    });
 }
 
 static bool parse_simple_kv(const std::string& buf, std::unordered_map<std::string,std::string>& entries, std::vector<std::string>& words) {
@@ -301,7 +323,8 @@ static bool parse_kbix_multirb(const std::string& buf, std::unordered_map<std::s
     rb += 4;
     if (rb + 4 > end) return false;
     uint32_t blocks = be32u((const unsigned char*)rb); rb += 4;
-    std::vector<std::string> bdec; bdec.reserve(blocks);
+    // Locate every block first, then inflate them independently
+    std::vector<ZBlock> zb;
     for (uint32_t i = 0; i < blocks; ++i) {
         if (rb + 4 > end) return false;
         if (memcmp(rb, "RBLK", 4) != 0) return false;
@@ -309,13 +332,11 @@ static bool parse_kbix_multirb(const std::string& buf, std::unordered_map<std::s
         if (rb + 4 > end) return false;
         uint32_t comp_len = be32u((const unsigned char*)rb); rb += 4;
         if (rb + comp_len > end) return false;
-        {
-            std::string out;
-            if (!safe_inflate((const unsigned char*)rb, comp_len, 1024u * 1024u, out)) return false;
-            bdec.push_back(std::move(out));
-        }
+        zb.push_back({(const unsigned char*)rb, comp_len, 1024u * 1024u});
         rb += comp_len;
     }
+    std::vector<std::string> bdec;
+    if (!inflate_blocks(zb, bdec)) return false;
     for (auto& it : items) {
         if (it.bid < bdec.size()) {
             const auto& s = bdec[it.bid];
@@ -342,41 +363,51 @@ static bool parse_mdxk_mdxr(const std::string& buf, std::unordered_map<std::stri
     const unsigned char* u = (const unsigned char*)mk + 4;
     if (u + 4 > (const unsigned char*)end) return false;
     uint32_t kblocks = be32u(u); u += 4;
-    struct KItem { std::string w; uint32_t off; uint32_t len; };
-    std::vector<KItem> keys;
+    std::vector<ZBlock> zk;
     for (uint32_t bi = 0; bi < kblocks; ++bi) {
         if (u + 8 > (const unsigned char*)end) return false;
         uint32_t clen = be32u(u); u += 4; uint32_t ulen = be32u(u); u += 4;
         if (u + clen > (const unsigned char*)end) return false;
-        std::string out;
-        if (!safe_inflate((const unsigned char*)u, clen, ulen, out)) return false;
-        const unsigned char* ku = (const unsigned char*)out.data();
-        const unsigned char* kend = ku + out.size();
-        while (ku + 2 <= kend) {
-            uint16_t wl = be16(ku); ku += 2; if (ku + wl > kend) break;
-            std::string w((const char*)ku, wl); ku += wl;
-            if (ku + 8 > kend) break;
-            uint32_t off = be32u(ku); ku += 4; uint32_t len = be32u(ku); ku += 4;
-            keys.push_back({w, off, len});
-        }
+        zk.push_back({u, clen, ulen});
         u += clen;
     }
-    // parse MDXR rec blocks
+    // parse MDXR rec block headers
     const unsigned char* ru = (const unsigned char*)mr + 4;
     if (ru + 4 > (const unsigned char*)end) return false;
     uint32_t rblocks = be32u(ru); ru += 4;
-    std::string rec_concat;
+    std::vector<ZBlock> zr;
     for (uint32_t i = 0; i < rblocks; ++i) {
         if (ru + 8 > (const unsigned char*)end) return false;
         uint32_t clen = be32u(ru); ru += 4; uint32_t ulen = be32u(ru); ru += 4;
         if (ru + clen > (const unsigned char*)end) return false;
-        {
-            std::string out;
-            if (!safe_inflate((const unsigned char*)ru, clen, ulen, out)) return false;
-            rec_concat.append(out);
-        }
+        zr.push_back({ru, clen, ulen});
         ru += clen;
     }
+    // Key and record blocks inflate together, then are assembled in order
+    std::vector<ZBlock> all(zk);
+    all.insert(all.end(), zr.begin(), zr.end());
+    std::vector<std::string> outs;
+    if (!inflate_blocks(all, outs)) return false;
+
+    struct KItem { std::string w; uint32_t off; uint32_t len; };
+    std::vector<KItem> keys;
+    for (size_t bi = 0; bi < zk.size(); ++bi) {
+        const std::string& out = outs[bi];
+        const unsigned char* ku = (const unsigned char*)out.data();
+        const unsigned char* kend = ku + out.size();
+        while (ku + 2 <= kend) {
+            uint16_t wl = be16(ku); ku += 2; if (ku + wl > kend) break;
+            std::string w((const char*)ku, wl); ku += wl;
+            if (ku + 8 > kend) break;
+            uint32_t off = be32u(ku); ku += 4; uint32_t len = be32u(ku); ku += 4;
+            keys.push_back({w, off, len});
+        }
+    }
+    size_t rec_total = 0;
+    for (size_t i = zk.size(); i < outs.size(); ++i) rec_total += outs[i].size();
+    std::string rec_concat;
+    rec_concat.reserve(rec_total);
+    for (size_t i = zk.size(); i < outs.size(); ++i) { rec_concat.append(outs[i]); std::string().swap(outs[i]); }
     if (rec_concat.empty() || keys.empty()) return false;
     for (auto& it : keys) {
         if ((size_t)it.off + (size_t)it.len <= rec_concat.size()) {
@@ -389,20 +420,33 @@ static bool parse_mdxk_mdxr(const std::string& buf, std::unordered_map<std::stri
 
 static std::vector<std::string> decompress_all_zlib_blocks(const std::string& data, int max_blocks, int max_out) {
     std::vector<std::string> outs;
-    for (size_t off = 0; off + 2 < data.size() && (int)outs.size() < max_blocks; ++off) {
+    // Offsets with a plausible zlib header; each is tried on its own, so a wave
+    // of them can inflate at once while results stay in offset order.
+    std::vector<size_t> cand;
+    for (size_t off = 0; off + 2 < data.size(); ++off) {
         unsigned char cmf = (unsigned char)data[off];
         unsigned char flg = (unsigned char)data[off + 1];
         unsigned int hdr = (static_cast<unsigned int>(cmf) << 8) | static_cast<unsigned int>(flg);
         if ((cmf & 0x0F) != 8 || (hdr % 31) != 0) continue;
-        z_stream strm{}; strm.next_in = (Bytef*)data.data() + off; strm.avail_in = (uInt)(data.size() - off);
-        if (inflateInit(&strm) != Z_OK) continue;
-        std::string out; out.resize(max_out);
-        strm.next_out = (Bytef*)out.data(); strm.avail_out = (uInt)out.size();
-        int rc = inflate(&strm, Z_FINISH);
-        inflateEnd(&strm);
-        if (rc == Z_STREAM_END) {
-            size_t produced = out.size() - strm.avail_out; out.resize(produced);
-            if (!out.empty()) outs.push_back(out);
+        cand.push_back(off);
+    }
+    const int threads = data.size() >= PARALLEL_INFLATE_BYTES ? 0 : 1;
+    const size_t wave = threads == 1 ? 1 : 64;
+    std::vector<std::string> got;
+    for (size_t first = 0; first < cand.size() && (int)outs.size() < max_blocks; first += wave) {
+        const size_t count = std::min(wave, cand.size() - first);
+        got.assign(count, std::string());
+        parallel_for(count, threads, [&](size_t i) {
+            const size_t off = cand[first + i];
+            std::string out;
+            if (inflate_prefix(data.data() + off, data.size() - off, (size_t)max_out, out)) {
+                out.shrink_to_fit(); // a wave holds many results; drop the max_out slack
+                got[i] = std::move(out);
+            }
+            return true;
+        });
+        for (size_t i = 0; i < count && (int)outs.size() < max_blocks; ++i) {
+            if (!got[i].empty()) outs.push_back(std::move(got[i]));
         }
     }
     return outs;
@@ -470,6 +514,30 @@ static std::string extract_attr(const std::string& s, const char* key) {
     return s.substr(p + k.size(), q - (p + k.size()));
 }
 
+// Real containers put placeholder text in empty attributes
+static std::string mdx_title(const std::string& title, const fs::path& path) {
+    if (title.empty() || title.rfind("Title (No HTML", 0) == 0) return path.stem().string();
+    return title;
+}
+
+bool MdictParserStd::read_header(const std::string& mdx_path, std::string& title, std::string& description) {
+    title.clear(); description.clear();
+    std::unordered_map<std::string, std::string> attrs;
+    if (MdxFileStd::read_attributes(mdx_path, attrs)) {
+        title = mdx_title(attrs["title"], fs::path(mdx_path));
+        description = attrs["description"];
+        return true;
+    }
+    std::string head = read_head(mdx_path, 64 * 1024);
+    if (head.empty()) return false;
+    std::string h2 = utf16_to_utf8_ascii_only(head);
+    if (!h2.empty()) head = std::move(h2);
+    title = extract_attr(head, "title");
+    description = extract_attr(head, "description");
+    if (title.empty()) title = fs::path(mdx_path).stem().string();
+    return true;
+}
+
 static const char* get_mdict_password_env() {
     if (const char* pw = std::getenv("UNIDICT_MDICT_PASSWORD"); pw && *pw) return pw;
     // Backward-compat: some docs/tools may set a generic password variable.
@@ -532,19 +600,9 @@ static bool parse_mdict_body_from_file_best_effort(const std::string& path,
         unsigned char flg = (unsigned char)body[1];
         unsigned int hdr = ((unsigned int)cmf << 8) | (unsigned int)flg;
         if ((cmf & 0x0F) == 8 && (hdr % 31) == 0) {
-            z_stream strm{};
-            strm.next_in = (Bytef*)body.data();
-            strm.avail_in = (uInt)body.size();
-            if (inflateInit(&strm) == Z_OK) {
-                std::string out; out.resize(1024 * 1024);
-                strm.next_out = (Bytef*)out.data();
-                strm.avail_out = (uInt)out.size();
-                int rc = inflate(&strm, Z_FINISH);
-                inflateEnd(&strm);
-                if (rc == Z_STREAM_END) {
-                    out.resize(out.size() - strm.avail_out);
-                    parsed = parse_simple_kv(out, entries, words);
-                }
+            std::string out;
+            if (inflate_prefix(body.data(), body.size(), 1024 * 1024, out)) {
+                parsed = parse_simple_kv(out, entries, words);
             }
         }
     }
@@ -580,8 +638,10 @@ bool MdictParserStd::extract_and_cache_resources_from_mdd(const std::string& mdd
     if (resource_cache_root_.empty()) return false;
     std::unordered_map<std::string, std::string> raw;
     std::vector<std::string> keys;
-    if (!parse_mdict_body_from_file_best_effort(mdd_path, raw, keys)) return false;
-    if (raw.empty()) return false;
+    MdxFileStd mdd;
+    const bool real = mdd.open(mdd_path);
+    if (!real && !parse_mdict_body_from_file_best_effort(mdd_path, raw, keys)) return false;
+    if (!real && raw.empty()) return false;
 
     fs::path root(resource_cache_root_);
     UnidictCoreStd::PathUtilsStd::ensure_dir(root.string());
@@ -592,21 +652,30 @@ bool MdictParserStd::extract_and_cache_resources_from_mdd(const std::string& mdd
     if (!mout) return false;
 
     resource_file_by_key_.clear();
-    for (const auto& kv : raw) {
-        const std::string rel = sanitize_relative_path(kv.first);
-        if (rel.empty()) continue;
+    auto write_one = [&](const std::string& key, const std::string& data) {
+        const std::string rel = sanitize_relative_path(key);
+        if (rel.empty()) return;
         fs::path outp = root / rel;
         std::error_code ec;
         fs::create_directories(outp.parent_path(), ec);
         std::ofstream out(outp.string(), std::ios::binary | std::ios::trunc);
-        if (!out) continue;
-        out.write(kv.second.data(), (std::streamsize)kv.second.size());
+        if (!out) return;
+        out.write(data.data(), (std::streamsize)data.size());
         out.close();
-        if (!out) continue;
+        if (!out) return;
 
-        const std::string key_norm = lcase_ascii(normalize_resource_key(kv.first));
+        const std::string key_norm = lcase_ascii(normalize_resource_key(key));
         resource_file_by_key_[key_norm] = fs::absolute(outp, ec).string();
         mout << key_norm << "\t" << rel << "\n";
+    };
+    if (real) {
+        // Streamed in record order; blocks are decoded in parallel waves
+        mdd.for_each_record([&](size_t i, const std::string& data) {
+            write_one(std::string(mdd.key(i)), data);
+            return true;
+        });
+    } else {
+        for (const auto& kv : raw) write_one(kv.first, kv.second);
     }
     mout.close();
     return !resource_file_by_key_.empty();
@@ -731,6 +800,7 @@ bool MdictParserStd::load_dictionary(const std::string& mdx_path) {
     encoding_.clear();
     compression_.clear();
     version_.clear();
+    mdx_.close();
     entries_.clear();
     words_.clear();
     name_.clear();
@@ -750,6 +820,17 @@ bool MdictParserStd::load_dictionary(const std::string& mdx_path) {
     if (!fs::exists(p)) return false;
     dict_dir_ = p.parent_path().string();
 
+    // Real container: keys and block tables now, records on lookup
+    if (mdx_.open(p.string(), nullptr, private_copy_)) {
+        name_ = mdx_title(mdx_.attribute("title"), p);
+        desc_ = mdx_.attribute("description");
+        encoding_ = mdx_.attribute("encoding");
+        version_ = mdx_.attribute("generatedbyengineversion");
+        loaded_ = true;
+        load_companion_mdd(p.string());
+        return true;
+    }
+
     // Try to parse a minimal XML-like header near the file start.
     std::string head = read_head(p.string());
     if (!head.empty()) {
@@ -863,19 +944,9 @@ bool MdictParserStd::load_dictionary(const std::string& mdx_path) {
             unsigned char flg = (unsigned char)body[1];
             unsigned int hdr = ((unsigned int)cmf << 8) | (unsigned int)flg;
             if ((cmf & 0x0F) == 8 && (hdr % 31) == 0) {
-                z_stream strm{};
-                strm.next_in = (Bytef*)body.data();
-                strm.avail_in = (uInt)body.size();
-                if (inflateInit(&strm) == Z_OK) {
-                    std::string out; out.resize(1024 * 1024);
-                    strm.next_out = (Bytef*)out.data();
-                    strm.avail_out = (uInt)out.size();
-                    int rc = inflate(&strm, Z_FINISH);
-                    inflateEnd(&strm);
-                    if (rc == Z_STREAM_END) {
-                        out.resize(out.size() - strm.avail_out);
-                        parsed = parse_simple_kv(out, entries_, words_);
-                    }
+                std::string out;
+                if (inflate_prefix(body.data(), body.size(), 1024 * 1024, out)) {
+                    parsed = parse_simple_kv(out, entries_, words_);
                 }
             }
         }
@@ -896,21 +967,8 @@ bool MdictParserStd::load_dictionary(const std::string& mdx_path) {
             if ((cmf & 0x0F) != 8) continue;
             unsigned int hdr = (static_cast<unsigned int>(cmf) << 8) | static_cast<unsigned int>(flg);
             if (hdr % 31 != 0) continue;
-            z_stream strm{};
-            strm.next_in = (Bytef*)data.data() + off;
-            strm.avail_in = (uInt)(data.size() - off);
-            if (inflateInit(&strm) != Z_OK) continue;
             std::string out;
-            out.resize(max_out);
-            strm.next_out = (Bytef*)out.data();
-            strm.avail_out = (uInt)out.size();
-            int rc = inflate(&strm, Z_FINISH);
-            inflateEnd(&strm);
-            if (rc == Z_STREAM_END) {
-                size_t produced = out.size() - strm.avail_out;
-                out.resize(produced);
-                if (!out.empty()) outs.push_back(out);
-            }
+            if (inflate_prefix(data.data() + off, data.size() - off, (size_t)max_out, out) && !out.empty()) outs.push_back(out);
         }
         return outs;
     };
@@ -987,20 +1045,44 @@ std::string MdictParserStd::dictionary_description() const {
     if (encrypted_) info += " [encrypted]";
     return info;
 }
-int MdictParserStd::word_count() const { return (int)words_.size(); }
+int MdictParserStd::word_count() const { return (int)(mdx_.is_open() ? mdx_.size() : words_.size()); }
 
 std::string MdictParserStd::lookup(const std::string& word) const {
+    if (mdx_.is_open()) {
+        size_t i = 0;
+        std::string def;
+        if (!mdx_.find(word, i) || !mdx_.text(i, def)) return {};
+        return render_entry_for_ui(word, def);
+    }
     auto it = entries_.find(word);
     if (it == entries_.end()) return {};
     return render_entry_for_ui(word, it->second);
 }
 
+std::vector<std::string> MdictParserStd::lookup_batch(const std::vector<std::string>& words) const {
+    std::vector<std::string> out(words.size());
+    if (!mdx_.is_open()) {
+        for (size_t k = 0; k < words.size(); ++k) out[k] = lookup(words[k]);
+        return out;
+    }
+    std::vector<size_t> entries, slots;
+    size_t i = 0;
+    for (size_t k = 0; k < words.size(); ++k) {
+        if (!mdx_.find(words[k], i)) continue;
+        entries.push_back(i);
+        slots.push_back(k);
+    }
+    mdx_.texts(entries, [&](size_t k, const std::string& def) { out[slots[k]] = render_entry_for_ui(words[slots[k]], def); });
+    return out;
+}
+
 std::vector<std::string> MdictParserStd::find_similar(const std::string& word, int max_results) const {
+    if (mdx_.is_open()) return mdx_.prefix(word, max_results);
     std::vector<std::string> out; out.reserve(std::min<int>((int)words_.size(), max_results));
     for (const auto& w : words_) { if ((int)out.size() >= max_results) break; if (w.rfind(word, 0) == 0) out.push_back(w); }
     return out;
 }
 
-std::vector<std::string> MdictParserStd::all_words() const { return words_; }
+std::vector<std::string> MdictParserStd::all_words() const { return headwords().to_vector(); }
 
 } // namespace UnidictCoreStd
@@ -1,5 +1,7 @@
-// Qt-free MDict parser (std-only). Supports multiple non-encrypted container
-// layouts and best-effort SimpleXOR decryption (password via env).
+// Qt-free MDict parser (std-only). Real .mdx files (format 1.2/2.0) are read
+// through MdxFileStd: only keys and block tables are loaded, and lookups decode
+// the record block they need. Other, experimental container layouts are parsed
+// into memory, with best-effort SimpleXOR decryption (password via env).
 
 #ifndef UNIDICT_MDICT_PARSER_STD_H
 #define UNIDICT_MDICT_PARSER_STD_H
@@ -9,6 +11,8 @@
 #include <vector>
 #include <memory>
 #include "mdict_decryptor_std.h"
+#include "headword_view_std.h"
+#include "mdx_file_std.h"
 
 namespace UnidictCoreStd {
 
@@ -17,15 +21,28 @@ public:
     MdictParserStd();
 
     bool load_dictionary(const std::string& mdx_path);
+    // Read a real .mdx into memory instead of mapping it, so rewriting it in place
+    // cannot fault a live parser. Applies to the next load_dictionary().
+    void set_private_copy(bool enabled) { private_copy_ = enabled; }
     bool is_loaded() const;
+    // Read only the header attributes (title falls back to the file stem) without decoding entries.
+    static bool read_header(const std::string& mdx_path, std::string& title, std::string& description);
 
     std::string dictionary_name() const;
     std::string dictionary_description() const;
     int word_count() const;
 
     std::string lookup(const std::string& word) const; // empty if not found
+    // lookup() for each word, reading records in file order so a record block
+    // shared by several words is decoded once.
+    std::vector<std::string> lookup_batch(const std::vector<std::string>& words) const;
     std::vector<std::string> find_similar(const std::string& word, int max_results) const;
     std::vector<std::string> all_words() const;
+    // Non-owning view of the same list; valid while the parser is alive and not reloaded.
+    HeadwordViewStd headwords() const { return mdx_.is_open() ? mdx_.keys() : HeadwordViewStd(words_); }
+    bool is_encrypted() const { return encrypted_; }
+    // True when entries link to resources extracted from a companion .mdd.
+    bool has_resources() const { return !resource_file_by_key_.empty(); }
 
 private:
     bool load_companion_mdd(const std::string& mdx_path);
@@ -40,6 +57,8 @@ private:
     std::string compression_;
     std::string version_;
     bool encrypted_ = false;
+    bool private_copy_ = false;
+    MdxFileStd mdx_; // open for real .mdx files; entries_/words_ hold the other layouts
     std::unordered_map<std::string, std::string> entries_;
     std::vector<std::string> words_;
 
@@ -0,0 +1,591 @@
+#include "mdx_file_std.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <zlib.h>
+
+#include "block_decoder_std.h"
+#include "parallel_for_std.h"
+
+namespace UnidictCoreStd {
+
+namespace {
+
+// Sanity caps against malformed sizes
+constexpr uint64_t kMaxHeader = 1u << 20;
+constexpr uint64_t kMaxBlock = 64u << 20;  // one decoded key or record block
+constexpr uint64_t kMaxRecord = 64u << 20;
+// Below this much compressed data, starting threads costs more than it saves
+constexpr uint64_t kParallelBytes = 1u << 20;
+
+uint32_t be32(const unsigned char* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+uint64_t be64(const unsigned char* p) { return ((uint64_t)be32(p) << 32) | be32(p + 4); }
+uint32_t le32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void put_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) { out.push_back((char)cp); }
+    else if (cp < 0x800) { out.push_back((char)(0xC0 | (cp >> 6))); out.push_back((char)(0x80 | (cp & 0x3F))); }
+    else if (cp < 0x10000) {
+        out.push_back((char)(0xE0 | (cp >> 12))); out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back((char)(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back((char)(0xF0 | (cp >> 18))); out.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back((char)(0x80 | ((cp >> 6) & 0x3F))); out.push_back((char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+// UTF-16LE to UTF-8; unpaired surrogates become U+FFFD.
+std::string utf16le_to_utf8(const char* data, size_t bytes) {
+    std::string out;
+    out.reserve(bytes / 2);
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const size_t n = bytes / 2;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t u = (uint32_t)p[2 * i] | ((uint32_t)p[2 * i + 1] << 8);
+        if (u >= 0xD800 && u < 0xDC00 && i + 1 < n) {
+            const uint32_t v = (uint32_t)p[2 * i + 2] | ((uint32_t)p[2 * i + 3] << 8);
+            if (v >= 0xDC00 && v < 0xE000) { u = 0x10000 + ((u - 0xD800) << 10) + (v - 0xDC00); ++i; }
+            else u = 0xFFFD;
+        } else if (u >= 0xD800 && u < 0xE000) {
+            u = 0xFFFD;
+        }
+        put_utf8(out, u);
+    }
+    return out;
+}
+
+std::string trim(std::string_view s) {
+    size_t b = 0, e = s.size();
+    while (b < e && std::isspace((unsigned char)s[b])) ++b;
+    while (e > b && std::isspace((unsigned char)s[e - 1])) --e;
+    return std::string(s.substr(b, e - b));
+}
+
+std::string unescape_xml(std::string s) {
+    static const std::pair<const char*, char> kEntities[] = {{"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}, {"&amp;", '&'}};
+    for (const auto& e : kEntities) {
+        const size_t len = std::strlen(e.first);
+        for (size_t p = s.find(e.first); p != std::string::npos; p = s.find(e.first, p + 1)) s.replace(p, len, 1, e.second);
+    }
+    return s;
+}
+
+// name="value" pairs of the header tag
+void parse_attributes(const std::string& tag, std::unordered_map<std::string, std::string>& out) {
+    size_t i = 0;
+    while ((i = tag.find("=\"", i)) != std::string::npos) {
+        size_t b = i;
+        while (b > 0 && (std::isalnum((unsigned char)tag[b - 1]) || tag[b - 1] == '_')) --b;
+        const size_t v = i + 2, q = tag.find('"', v);
+        if (q == std::string::npos) break;
+        std::string name = tag.substr(b, i - b);
+        for (auto& c : name) c = (char)std::tolower((unsigned char)c);
+        if (!name.empty()) out[name] = unescape_xml(tag.substr(v, q - v));
+        i = q + 1;
+    }
+}
+
+int ascii_casecmp(std::string_view a, std::string_view b) {
+    const size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; ++i) {
+        const int x = std::tolower((unsigned char)a[i]), y = std::tolower((unsigned char)b[i]);
+        if (x != y) return x < y ? -1 : 1;
+    }
+    return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+}
+
+// Block body: u32 type (LE: 0 stored, 1 LZO, 2 zlib), u32 adler32 (BE), data.
+bool decode_block(const unsigned char* p, uint64_t comp_size, uint64_t decomp_size, std::string& out) {
+    if (comp_size < 8 || decomp_size > kMaxBlock) return false;
+    return BlockDecoderStd::decode(p, (size_t)comp_size, (size_t)decomp_size, out);
+}
+
+// MDict's key-info cipher: nibble swap chained with the previous ciphertext byte.
+void fast_decrypt(unsigned char* data, size_t len, const std::array<uint8_t, 16>& key) {
+    unsigned char prev = 0x36;
+    for (size_t i = 0; i < len; ++i) {
+        const unsigned char c = data[i];
+        unsigned char t = (unsigned char)((c >> 4) | (c << 4));
+        t = (unsigned char)(t ^ prev ^ (unsigned char)(i & 0xFF) ^ key[i % key.size()]);
+        prev = c;
+        data[i] = t;
+    }
+}
+
+} // namespace
+
+std::array<uint8_t, 16> MdxFileStd::ripemd128(const void* data, size_t len) {
+    static const uint8_t r[2][64] = {
+        {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+         3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12, 1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2},
+        {5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12, 6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+         15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13, 8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14}};
+    static const uint8_t s[2][64] = {
+        {11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8, 7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+         11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5, 11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12},
+        {8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6, 9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+         9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5, 15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8}};
+    static const uint32_t k[2][4] = {{0x00000000u, 0x5A827999u, 0x6ED9EBA1u, 0x8F1BBCDCu},
+                                     {0x50A28BE6u, 0x5C4DD124u, 0x6D703EF3u, 0x00000000u}};
+    auto f = [](int j, uint32_t x, uint32_t y, uint32_t z) -> uint32_t {
+        switch (j) {
+        case 0: return x ^ y ^ z;
+        case 1: return (x & y) | (~x & z);
+        case 2: return (x | ~y) ^ z;
+        default: return (x & z) | (y & ~z);
+        }
+    };
+    auto rol = [](uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+
+    // MD4-style padding: 0x80, zeros, bit length (LE)
+    std::string msg(static_cast<const char*>(data), len);
+    msg.push_back((char)0x80);
+    while (msg.size() % 64 != 56) msg.push_back('\0');
+    const uint64_t bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; ++i) msg.push_back((char)((bits >> (8 * i)) & 0xFF));
+
+    uint32_t h[4] = {0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u};
+    for (size_t off = 0; off < msg.size(); off += 64) {
+        uint32_t x[16];
+        for (int i = 0; i < 16; ++i) x[i] = le32(reinterpret_cast<const unsigned char*>(msg.data()) + off + 4 * i);
+        uint32_t line[2][4];
+        for (int l = 0; l < 2; ++l) {
+            uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+            for (int j = 0; j < 64; ++j) {
+                const int round = j / 16;
+                const uint32_t t = rol(a + f(l == 0 ? round : 3 - round, b, c, d) + x[r[l][j]] + k[l][round], s[l][j]);
+                a = d; d = c; c = b; b = t;
+            }
+            line[l][0] = a; line[l][1] = b; line[l][2] = c; line[l][3] = d;
+        }
+        const uint32_t t = h[1] + line[0][2] + line[1][3];
+        h[1] = h[2] + line[0][3] + line[1][0];
+        h[2] = h[3] + line[0][0] + line[1][1];
+        h[3] = h[0] + line[0][1] + line[1][2];
+        h[0] = t;
+    }
+    std::array<uint8_t, 16> out{};
+    for (int i = 0; i < 16; ++i) out[i] = (uint8_t)((h[i / 4] >> (8 * (i % 4))) & 0xFF);
+    return out;
+}
+
+bool MdxFileStd::read_attributes(const std::string& path, std::unordered_map<std::string, std::string>& out) {
+    out.clear();
+    std::ifstream in(path, std::ios::binary);
+    unsigned char len[4];
+    if (!in.read(reinterpret_cast<char*>(len), 4)) return false;
+    const uint32_t n = be32(len);
+    // The header is a UTF-16LE XML tag: '<' then NUL
+    if (n < 4 || n > kMaxHeader || n % 2 != 0) return false;
+    std::string bytes(n, '\0');
+    if (!in.read(bytes.data(), n) || bytes[0] != '<' || bytes[1] != '\0') return false;
+    unsigned char sum[4];
+    if (!in.read(reinterpret_cast<char*>(sum), 4)) return false;
+    if (le32(sum) != (uint32_t)adler32(adler32(0, nullptr, 0), reinterpret_cast<const Bytef*>(bytes.data()), n)) return false;
+    parse_attributes(utf16le_to_utf8(bytes.data(), bytes.size()), out);
+    return true;
+}
+
+void MdxFileStd::close() {
+    std::lock_guard<std::mutex> lk(mu_);
+    file_.close();
+    attrs_.clear();
+    utf16_ = false;
+    keys_.clear(); keys_.shrink_to_fit();
+    key_starts_.clear(); key_starts_.shrink_to_fit();
+    rec_offs_.clear(); rec_offs_.shrink_to_fit();
+    sorted_.clear(); sorted_.shrink_to_fit();
+    blocks_.clear(); blocks_.shrink_to_fit();
+    rec_total_ = 0;
+    count_ = 0;
+    cache_.clear();
+    stats_ = {};
+}
+
+bool MdxFileStd::open(const std::string& path, std::string* error, bool private_copy) {
+    close();
+    auto fail = [&](const char* why) {
+        if (error) *error = why;
+        close();
+        return false;
+    };
+    if (!read_attributes(path, attrs_)) return fail("not an MDict container");
+    if (!file_.open(path, private_copy)) return fail("cannot open file");
+    std::string ext = path.size() >= 4 ? path.substr(path.size() - 4) : std::string();
+    for (auto& c : ext) c = (char)std::tolower((unsigned char)c);
+    std::string enc = attribute("encoding");
+    for (auto& c : enc) c = (char)std::toupper((unsigned char)c);
+    // .mdd keys are always UTF-16
+    utf16_ = ext == ".mdd" || enc == "UTF-16" || enc == "UTF16";
+    if (!parse(error)) {
+        const std::string why = error ? *error : std::string();
+        close();
+        if (error) *error = why;
+        return false;
+    }
+    return true;
+}
+
+bool MdxFileStd::parse(std::string* error) {
+    auto fail = [&](const char* why) { if (error) *error = why; return false; };
+    const double version = std::atof(attribute("generatedbyengineversion").c_str());
+    if (version >= 3.0) return fail("MDict 3.x is not supported");
+    const bool v2 = version >= 2.0;
+    const size_t nw = v2 ? 8 : 4; // width of numbers
+    std::string enc_attr = attribute("encrypted");
+    for (auto& c : enc_attr) c = (char)std::tolower((unsigned char)c);
+    const int encrypted = enc_attr.empty() || enc_attr == "no" ? 0 : (enc_attr == "yes" ? 1 : std::atoi(enc_attr.c_str()));
+    if (encrypted & 1) return fail("record encryption is not supported");
+
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(file_.data());
+    const uint64_t size = file_.size();
+    uint64_t pos = 4 + (uint64_t)be32(base) + 4;
+    auto have = [&](uint64_t n) { return pos <= size && n <= size - pos; };
+    auto number = [&](const unsigned char* p) { return nw == 8 ? be64(p) : (uint64_t)be32(p); };
+
+    // Key section header
+    const size_t hdr_len = v2 ? 5 * 8 : 4 * 4;
+    if (!have(hdr_len + (v2 ? 4 : 0))) return fail("truncated key section");
+    const unsigned char* kh = base + pos;
+    const uint64_t num_key_blocks = number(kh);
+    const uint64_t num_entries = number(kh + nw);
+    const uint64_t info_size = number(kh + (v2 ? 3 : 2) * nw);
+    const uint64_t key_blocks_size = number(kh + (v2 ? 4 : 3) * nw);
+    if (v2 && be32(kh + hdr_len) != (uint32_t)adler32(adler32(0, nullptr, 0), kh, (uInt)hdr_len)) return fail("bad key section checksum");
+    pos += hdr_len + (v2 ? 4 : 0);
+    if (num_entries == 0 || num_entries > UINT32_MAX || !have(info_size)) return fail("bad key section");
+
+    // Key-block info: per block entry count, first/last key, compressed and decompressed size
+    std::string info;
+    if (v2) {
+        if (info_size < 8) return fail("bad key block info");
+        std::string raw(reinterpret_cast<const char*>(base + pos), (size_t)info_size);
+        if (encrypted & 2) {
+            unsigned char seed[8];
+            std::memcpy(seed, base + pos + 4, 4);
+            const uint32_t salt = 0x3695;
+            for (int i = 0; i < 4; ++i) seed[4 + i] = (unsigned char)((salt >> (8 * i)) & 0xFF);
+            fast_decrypt(reinterpret_cast<unsigned char*>(raw.data()) + 8, raw.size() - 8, ripemd128(seed, sizeof(seed)));
+        }
+        if (!decode_block(reinterpret_cast<const unsigned char*>(raw.data()), raw.size(), number(kh + 2 * nw), info)) return fail("bad key block info");
+    } else {
+        info.assign(reinterpret_cast<const char*>(base + pos), (size_t)info_size);
+    }
+    pos += info_size;
+    struct KeyBlock { uint64_t comp, decomp; };
+    std::vector<KeyBlock> kblocks;
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(info.data());
+        const unsigned char* end = p + info.size();
+        const size_t sw = v2 ? 2 : 1;       // width of a key length
+        const size_t term = v2 ? 1 : 0;     // first/last keys are NUL-terminated in 2.0
+        const size_t unit = utf16_ ? 2 : 1; // bytes per key length unit
+        while (p < end && kblocks.size() < num_key_blocks) {
+            if ((size_t)(end - p) < nw + sw) return fail("bad key block info");
+            p += nw;
+            for (int edge = 0; edge < 2; ++edge) {
+                if ((size_t)(end - p) < sw) return fail("bad key block info");
+                const size_t n = (sw == 2 ? ((size_t)p[0] << 8 | p[1]) : p[0]);
+                p += sw;
+                if ((size_t)(end - p) < (n + term) * unit) return fail("bad key block info");
+                p += (n + term) * unit;
+            }
+            if ((size_t)(end - p) < 2 * nw) return fail("bad key block info");
+            kblocks.push_back({number(p), number(p + nw)});
+            p += 2 * nw;
+        }
+        if (kblocks.size() != num_key_blocks) return fail("bad key block info");
+    }
+
+    // Key blocks: per key, record offset then NUL-terminated text. Blocks are
+    // independent, so they are decoded and split on several threads and then
+    // appended in file order.
+    if (!have(key_blocks_size)) return fail("truncated key blocks");
+    const uint64_t kb_end = pos + key_blocks_size;
+    struct KeyChunk {
+        uint64_t file_off = 0;
+        std::string keys;
+        std::vector<uint32_t> starts;
+        std::vector<uint64_t> offs;
+        const char* error = nullptr;
+    };
+    std::vector<KeyChunk> chunks(kblocks.size());
+    for (size_t b = 0; b < kblocks.size(); ++b) {
+        if (kblocks[b].comp > kb_end - pos) return fail("truncated key blocks");
+        chunks[b].file_off = pos;
+        pos += kblocks[b].comp;
+    }
+    const bool utf16 = utf16_;
+    auto split = [&](size_t b) {
+        KeyChunk& c = chunks[b];
+        std::string block_data;
+        if (!decode_block(base + c.file_off, kblocks[b].comp, kblocks[b].decomp, block_data)) { c.error = "undecodable key block"; return false; }
+        const char* p = block_data.data();
+        const char* end = p + block_data.size();
+        while ((size_t)(end - p) >= nw) {
+            const uint64_t off = number(reinterpret_cast<const unsigned char*>(p));
+            p += nw;
+            const char* t = p;
+            if (utf16) {
+                while (end - t >= 2 && (t[0] != 0 || t[1] != 0)) t += 2;
+                if (end - t < 2) { c.error = "bad key block"; return false; }
+            } else {
+                t = static_cast<const char*>(std::memchr(p, 0, (size_t)(end - p)));
+                if (!t) { c.error = "bad key block"; return false; }
+            }
+            c.starts.push_back((uint32_t)c.keys.size());
+            c.keys += trim(utf16 ? utf16le_to_utf8(p, (size_t)(t - p)) : std::string_view(p, (size_t)(t - p)));
+            if (c.keys.size() > UINT32_MAX) { c.error = "key blocks too large"; return false; }
+            c.offs.push_back(off);
+            p = t + (utf16 ? 2 : 1);
+        }
+        return true;
+    };
+    if (!parallel_for(chunks.size(), key_blocks_size >= kParallelBytes ? 0 : 1, split)) {
+        for (const auto& c : chunks) if (c.error) return fail(c.error);
+        return fail("undecodable key block");
+    }
+    size_t key_bytes = 0, keys_n = 0;
+    for (const auto& c : chunks) { key_bytes += c.keys.size(); keys_n += c.offs.size(); }
+    if (keys_n != num_entries) return fail("key count mismatch");
+    if (key_bytes > UINT32_MAX) return fail("key blocks too large");
+    keys_.reserve(key_bytes);
+    key_starts_.reserve(keys_n + 1);
+    rec_offs_.reserve(keys_n);
+    for (auto& c : chunks) {
+        const uint32_t base_start = (uint32_t)keys_.size();
+        for (uint32_t st : c.starts) key_starts_.push_back(base_start + st);
+        keys_ += c.keys;
+        rec_offs_.insert(rec_offs_.end(), c.offs.begin(), c.offs.end());
+        c = KeyChunk{};
+    }
+    pos = kb_end;
+    count_ = rec_offs_.size();
+    key_starts_.push_back((uint32_t)keys_.size());
+
+    // Record section header and block table
+    if (!have(4 * nw)) return fail("truncated record section");
+    const uint64_t num_rec_blocks = number(base + pos);
+    const uint64_t rec_entries = number(base + pos + nw);
+    const uint64_t rec_info_size = number(base + pos + 2 * nw);
+    const uint64_t rec_blocks_size = number(base + pos + 3 * nw);
+    pos += 4 * nw;
+    // Count checked against the size first: num_rec_blocks * 2 * nw can wrap
+    if (rec_entries != num_entries || num_rec_blocks > rec_info_size / (2 * nw) ||
+        rec_info_size != num_rec_blocks * 2 * nw || !have(rec_info_size))
+        return fail("bad record section");
+    const unsigned char* ri = base + pos;
+    pos += rec_info_size;
+    if (!have(rec_blocks_size)) return fail("truncated record blocks");
+    blocks_.reserve((size_t)num_rec_blocks);
+    uint64_t file_off = pos, decomp_off = 0;
+    for (uint64_t b = 0; b < num_rec_blocks; ++b) {
+        Block blk;
+        blk.comp_size = number(ri + b * 2 * nw);
+        blk.decomp_size = number(ri + b * 2 * nw + nw);
+        if (blk.comp_size < 8 || blk.comp_size > pos + rec_blocks_size - file_off || blk.decomp_size > kMaxBlock) return fail("bad record block info");
+        blk.file_off = file_off;
+        blk.decomp_off = decomp_off;
+        file_off += blk.comp_size;
+        decomp_off += blk.decomp_size;
+        blocks_.push_back(blk);
+    }
+    rec_total_ = decomp_off;
+    for (size_t i = 0; i < count_; ++i) {
+        if (rec_offs_[i] > rec_total_ || (i > 0 && rec_offs_[i] < rec_offs_[i - 1])) return fail("bad record offsets");
+    }
+
+    sorted_.resize(count_);
+    for (size_t i = 0; i < count_; ++i) sorted_[i] = (uint32_t)i;
+    std::stable_sort(sorted_.begin(), sorted_.end(), [this](uint32_t a, uint32_t b) {
+        const std::string_view x = key(a), y = key(b);
+        const int c = ascii_casecmp(x, y);
+        return c != 0 ? c < 0 : x < y;
+    });
+    return true;
+}
+
+std::string MdxFileStd::attribute(const std::string& name) const {
+    auto it = attrs_.find(name);
+    return it == attrs_.end() ? std::string() : it->second;
+}
+
+std::string_view MdxFileStd::key_at(const void* self, size_t i) {
+    return static_cast<const MdxFileStd*>(self)->key(i);
+}
+
+std::string_view MdxFileStd::key(size_t i) const {
+    return std::string_view(keys_).substr(key_starts_[i], key_starts_[i + 1] - key_starts_[i]);
+}
+
+bool MdxFileStd::find(std::string_view k, size_t& i) const {
+    auto lo = std::lower_bound(sorted_.begin(), sorted_.end(), k,
+                               [this](uint32_t e, std::string_view v) { return ascii_casecmp(key(e), v) < 0; });
+    if (lo == sorted_.end() || ascii_casecmp(key(*lo), k) != 0) return false;
+    i = *lo;
+    for (auto it = lo; it != sorted_.end() && ascii_casecmp(key(*it), k) == 0; ++it) {
+        if (key(*it) == k) { i = *it; break; }
+    }
+    return true;
+}
+
+std::vector<std::string> MdxFileStd::prefix(std::string_view pre, int max_results) const {
+    std::vector<std::string> out;
+    if (max_results <= 0) return out;
+    auto head = [&](uint32_t e) {
+        const std::string_view k = key(e);
+        return ascii_casecmp(k.substr(0, std::min(k.size(), pre.size())), pre);
+    };
+    auto it = std::lower_bound(sorted_.begin(), sorted_.end(), pre, [&](uint32_t e, std::string_view) { return head(e) < 0; });
+    for (; it != sorted_.end() && (int)out.size() < max_results && head(*it) == 0; ++it) {
+        if (key(*it).substr(0, pre.size()) == pre) out.emplace_back(key(*it));
+    }
+    return out;
+}
+
+std::shared_ptr<const std::string> MdxFileStd::block(size_t b) const {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (const auto* hit = cache_.get(b)) {
+            ++stats_.cache_hits;
+            return *hit;
+        }
+    }
+    // Decoded without the lock so readers of other blocks are not held up; two
+    // readers missing the same block may both decode it.
+    const Block& blk = blocks_[b];
+    auto out = std::make_shared<std::string>();
+    if (!decode_block(reinterpret_cast<const unsigned char*>(file_.data()) + blk.file_off, blk.comp_size, blk.decomp_size, *out)) return nullptr;
+    std::shared_ptr<const std::string> c = std::move(out);
+    std::lock_guard<std::mutex> lk(mu_);
+    ++stats_.decoded;
+    cache_.put(b, c);
+    return c;
+}
+
+uint64_t MdxFileStd::record_size(size_t i) const {
+    if (i >= count_) return 0;
+    // A record runs to the next key's offset (keys are in record order)
+    return (i + 1 < count_ ? rec_offs_[i + 1] : rec_total_) - rec_offs_[i];
+}
+
+bool MdxFileStd::record(size_t i, std::string& out) const {
+    return read_record(i, out, nullptr);
+}
+
+bool MdxFileStd::read_record(size_t i, std::string& out, HeldBlock* held) const {
+    out.clear();
+    if (i >= count_) return false;
+    const uint64_t begin = rec_offs_[i];
+    const uint64_t end = begin + record_size(i);
+    if (end - begin > kMaxRecord) return false;
+    auto it = std::upper_bound(blocks_.begin(), blocks_.end(), begin, [](uint64_t v, const Block& blk) { return v < blk.decomp_off; });
+    if (it == blocks_.begin()) return false;
+    for (size_t b = (size_t)(it - blocks_.begin()) - 1; b < blocks_.size() && out.size() < end - begin; ++b) {
+        std::shared_ptr<const std::string> data = held && held->index == b ? held->data : block(b);
+        if (!data) return false;
+        if (held) { held->index = b; held->data = data; }
+        const uint64_t from = std::max(begin, blocks_[b].decomp_off) - blocks_[b].decomp_off;
+        const uint64_t to = std::min<uint64_t>(end - blocks_[b].decomp_off, data->size());
+        if (from < to) out.append(*data, (size_t)from, (size_t)(to - from));
+    }
+    return out.size() == end - begin;
+}
+
+bool MdxFileStd::for_each_record(const std::function<bool(size_t, const std::string&)>& fn) const {
+    uint64_t comp_total = 0;
+    for (const auto& b : blocks_) comp_total += b.comp_size;
+    int threads = 1;
+    if (comp_total >= kParallelBytes) {
+        unsigned int hc = std::thread::hardware_concurrency();
+        threads = (hc == 0) ? 1 : (int)hc;
+    }
+    // A wave of blocks is decoded at once; memory stays bounded by one wave
+    // plus a record straddling its end.
+    const size_t wave = (size_t)threads * 2;
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(file_.data());
+    std::vector<std::string> got;
+    std::string stream, rec;
+    uint64_t stream_off = 0; // record-stream offset of stream[0]
+    size_t i = 0;
+    for (size_t first = 0; first < blocks_.size() && i < count_; first += wave) {
+        const size_t count = std::min(wave, blocks_.size() - first);
+        got.assign(count, std::string());
+        if (!parallel_for(count, threads, [&](size_t k) {
+                const Block& b = blocks_[first + k];
+                return decode_block(base + b.file_off, b.comp_size, b.decomp_size, got[k]);
+            }))
+            return false;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stats_.decoded += count;
+        }
+        size_t add = 0;
+        for (const auto& g : got) add += g.size();
+        stream.reserve(stream.size() + add);
+        for (auto& g : got) { stream += g; std::string().swap(g); }
+        const uint64_t avail = stream_off + stream.size();
+        for (; i < count_; ++i) {
+            const uint64_t begin = rec_offs_[i];
+            const uint64_t end = i + 1 < count_ ? rec_offs_[i + 1] : rec_total_;
+            if (end > avail) break;
+            if (end - begin > kMaxRecord) continue;
+            rec.assign(stream, (size_t)(begin - stream_off), (size_t)(end - begin));
+            if (!fn(i, rec)) return false;
+        }
+        const uint64_t keep = i < count_ ? rec_offs_[i] : avail;
+        stream.erase(0, (size_t)(keep - stream_off));
+        stream_off = keep;
+    }
+    return i == count_;
+}
+
+void MdxFileStd::to_text(std::string& out) const {
+    if (utf16_) {
+        size_t n = out.size() & ~size_t(1);
+        while (n >= 2 && out[n - 1] == 0 && out[n - 2] == 0) n -= 2;
+        out = utf16le_to_utf8(out.data(), n);
+    } else {
+        while (!out.empty() && out.back() == '\0') out.pop_back();
+    }
+}
+
+bool MdxFileStd::text(size_t i, std::string& out) const {
+    if (!record(i, out)) return false;
+    to_text(out);
+    return true;
+}
+
+void MdxFileStd::texts(const std::vector<size_t>& entries, const std::function<void(size_t, const std::string&)>& fn) const {
+    // Keys are in record order, so entry order is record order
+    std::vector<size_t> order(entries.size());
+    for (size_t k = 0; k < order.size(); ++k) order[k] = k;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return entries[a] < entries[b]; });
+    HeldBlock held;
+    std::string rec;
+    for (size_t k : order) {
+        if (!read_record(entries[k], rec, &held)) continue;
+        to_text(rec);
+        fn(k, rec);
+    }
+}
+
+void MdxFileStd::set_cache_blocks(size_t n) {
+    std::lock_guard<std::mutex> lk(mu_);
+    cache_.set_limits(n);
+}
+
+MdxFileStd::Stats MdxFileStd::stats() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return stats_;
+}
+
+} // namespace UnidictCoreStd
@@ -0,0 +1,123 @@
+// Reader for the MDict container itself (.mdx/.mdd, format 1.2 and 2.0), std-only.
+// open() parses the header, key-block info, key blocks and record-block info and
+// keeps only the keys, each key's record offset and one (file offset, compressed
+// size, decompressed offset and size) row per record block. A record is decoded
+// on demand by inflating just the block holding it; recently decoded blocks stay
+// in a bounded LRU. Memory and open time grow with the headword count, not with
+// the size of the definitions. Large files decode their key blocks in parallel.
+// Blocks are decoded by BlockDecoderStd (stored, LZO, zlib); encrypted key-block
+// info (Encrypted="2") is handled. Record encryption (Encrypted="1", needs a
+// registration key) is not supported: open() fails so callers can fall back.
+
+#ifndef UNIDICT_MDX_FILE_STD_H
+#define UNIDICT_MDX_FILE_STD_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "headword_view_std.h"
+#include "lru_cache_std.h"
+#include "mapped_file_std.h"
+
+namespace UnidictCoreStd {
+
+class MdxFileStd {
+public:
+    MdxFileStd() = default;
+    MdxFileStd(const MdxFileStd&) = delete;
+    MdxFileStd& operator=(const MdxFileStd&) = delete;
+
+    // Header attributes (names lowercased: title, description, encoding, encrypted,
+    // generatedbyengineversion, ...). False if the file is not in this layout.
+    static bool read_attributes(const std::string& path, std::unordered_map<std::string, std::string>& out);
+
+    // False (and *error) if the file is not a supported MDict container.
+    // private_copy reads the file into memory instead of mapping it (see MappedFileStd).
+    bool open(const std::string& path, std::string* error = nullptr, bool private_copy = false);
+    void close();
+    bool is_open() const { return count_ > 0; }
+    std::string attribute(const std::string& name) const;
+    // Keys (and .mdx records) are UTF-16LE in the file; key() returns them as UTF-8.
+    bool utf16() const { return utf16_; }
+
+    size_t size() const { return count_; }
+    std::string_view key(size_t i) const; // file order
+    HeadwordViewStd keys() const { return HeadwordViewStd(this, count_, &key_at); }
+    // Entry of a key: the exact spelling, else the first ASCII case-insensitive match.
+    bool find(std::string_view key, size_t& i) const;
+    // Keys starting with prefix (case-sensitive), in ASCII case-insensitive order.
+    std::vector<std::string> prefix(std::string_view prefix, int max_results) const;
+
+    // Record of entry i as stored (e.g. resource bytes of an .mdd).
+    bool record(size_t i, std::string& out) const;
+    uint64_t record_size(size_t i) const;
+    // Record of entry i as UTF-8 text, without the trailing NUL terminator.
+    bool text(size_t i, std::string& out) const;
+    // Text of several entries: fn(k, text) for each entries[k] that can be read.
+    // Entries are visited in record order, so a block holding several of them is
+    // decoded once however small the cache.
+    void texts(const std::vector<size_t>& entries, const std::function<void(size_t, const std::string&)>& fn) const;
+    // Every record as stored, in entry order, for bulk export (e.g. unpacking an
+    // .mdd). Blocks are decoded a few at a time on several threads, bypassing
+    // the cache. False if a block cannot be decoded or fn returns false.
+    bool for_each_record(const std::function<bool(size_t, const std::string&)>& fn) const;
+
+    // Decoded record blocks kept (default 16).
+    void set_cache_blocks(size_t n);
+    struct Stats {
+        uint64_t decoded = 0;    // record blocks decompressed
+        uint64_t cache_hits = 0; // record blocks served from the LRU
+    };
+    Stats stats() const;
+
+    // RIPEMD-128 digest; MDict derives the key-info decryption key with it.
+    static std::array<uint8_t, 16> ripemd128(const void* data, size_t len);
+
+private:
+    struct Block {
+        uint64_t file_off = 0;   // start of the block (type, checksum, data) in the file
+        uint64_t comp_size = 0;
+        uint64_t decomp_off = 0; // offset of its first byte in the record stream
+        uint64_t decomp_size = 0;
+    };
+
+    // Last block a run of reads used, so the next read in it skips the LRU
+    struct HeldBlock {
+        size_t index = SIZE_MAX;
+        std::shared_ptr<const std::string> data;
+    };
+
+    static std::string_view key_at(const void* self, size_t i);
+    bool parse(std::string* error);
+    // Decoded block b, from the LRU or decoded outside mu_ and then cached.
+    std::shared_ptr<const std::string> block(size_t b) const;
+    bool read_record(size_t i, std::string& out, HeldBlock* held) const;
+    void to_text(std::string& record) const;
+
+    MappedFileStd file_;
+    std::unordered_map<std::string, std::string> attrs_;
+    bool utf16_ = false;
+    std::string keys_;                 // all keys, UTF-8, back to back
+    std::vector<uint32_t> key_starts_; // start of each key in keys_, plus the end of the last
+    std::vector<uint64_t> rec_offs_;   // record offset of each key in the record stream
+    std::vector<uint32_t> sorted_;     // entries by (ASCII case-insensitive, bytewise) key
+    std::vector<Block> blocks_;
+    uint64_t rec_total_ = 0;
+    size_t count_ = 0;
+
+    mutable std::mutex mu_;
+    mutable LruCacheStd<size_t, std::shared_ptr<const std::string>> cache_{16};
+    mutable Stats stats_;
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_MDX_FILE_STD_H
@@ -0,0 +1,45 @@
+// One-shot parallel loop (std-only): runs fn(i) for every i in [0, n) on
+// short-lived threads that claim indices in turn, the calling thread included.
+// Meant for bulk work finished before returning (decoding the blocks of a file
+// at load); long-running background work belongs on ThreadPoolStd.
+
+#ifndef UNIDICT_PARALLEL_FOR_STD_H
+#define UNIDICT_PARALLEL_FOR_STD_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace UnidictCoreStd {
+
+// threads <= 0: hardware concurrency. fn returns false to fail the loop; the
+// remaining indices are then skipped. False if any call failed or threw.
+template <class Fn>
+bool parallel_for(size_t n, int threads, Fn&& fn) {
+    if (n == 0) return true;
+    if (threads <= 0) {
+        unsigned int hc = std::thread::hardware_concurrency();
+        threads = (hc == 0) ? 1 : (int)hc;
+    }
+    if ((size_t)threads > n) threads = (int)n;
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> ok{true};
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < n && ok.load(std::memory_order_relaxed); i = next.fetch_add(1)) {
+            bool r = false;
+            try { r = fn(i); } catch (...) { r = false; }
+            if (!r) ok.store(false);
+        }
+    };
+    std::vector<std::thread> pool; pool.reserve(threads > 1 ? threads - 1 : 0);
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+    return ok.load();
+}
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_PARALLEL_FOR_STD_H
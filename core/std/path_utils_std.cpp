@@ -1,5 +1,6 @@
 #include "path_utils_std.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <filesystem>
 #include <string>
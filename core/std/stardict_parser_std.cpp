@@ -2,7 +2,11 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <sstream>
 #include <zlib.h>
 #include "path_utils_std.h"
@@ -18,12 +22,16 @@ static inline std::string read_file_to_string(const std::string& path) {
     return ss.str();
 }
 
-StarDictParserStd::StarDictParserStd() = default;
-StarDictParserStd::~StarDictParserStd() { if (dict_stream_.is_open()) dict_stream_.close(); }
+StarDictParserStd::StarDictParserStd() {
+    const char* v = std::getenv("UNIDICT_DICTZIP_DECOMPRESS");
+    dictzip_decompress_ = v && *v && std::string(v) != "0";
+}
+
+StarDictParserStd::~StarDictParserStd() = default;
 
 bool StarDictParserStd::ends_with(const std::string& s, const std::string& suf) {
     if (s.size() < suf.size()) return false;
-    return std::equal(suf.rbegin(), suf.rend(), s.rbegin(), s.rend(), [](char a, char b){ return std::tolower((unsigned char)a) == std::tolower((unsigned char)b); });
+    return std::equal(suf.rbegin(), suf.rend(), s.rbegin(), [](char a, char b){ return std::tolower((unsigned char)a) == std::tolower((unsigned char)b); });
 }
 
 std::string StarDictParserStd::dirname(const std::string& path) {
@@ -46,8 +54,50 @@ std::string StarDictParserStd::lcase(const std::string& s) {
     std::string t; t.reserve(s.size()); for (unsigned char c : s) t.push_back((char)std::tolower(c)); return t;
 }
 
+std::string_view StarDictParserStd::word_at(const void* self, size_t i) {
+    return static_cast<const StarDictParserStd*>(self)->word(i);
+}
+
+std::string_view StarDictParserStd::word(size_t i) const {
+    const size_t tail = header_.idx_offset_bits == 64 ? 12 : 8;
+    return std::string_view(idx_.data() + starts_[i], starts_[i + 1] - starts_[i] - 1 - tail);
+}
+
+void StarDictParserStd::location(size_t i, uint64_t& offset, uint32_t& size) const {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(idx_.data()) + starts_[i] + word(i).size() + 1;
+    if (header_.idx_offset_bits == 64) { offset = be64(p); size = be32(p + 8); }
+    else { offset = be32(p); size = be32(p + 4); }
+}
+
+bool StarDictParserStd::find(std::string_view w, size_t& i) const {
+    // Upper bound, then step back: the last of repeated headwords wins
+    size_t lo = 0, hi = count_;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (StarDictSynonymsStd::collate(word(entry(mid)), w) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == 0 || word(entry(lo - 1)) != w) return false;
+    i = entry(lo - 1);
+    return true;
+}
+
+bool StarDictParserStd::resolve(std::string_view w, size_t& i) const {
+    if (find(w, i)) return true;
+    uint32_t e = 0;
+    if (!syn_.find(w, e)) return false;
+    i = e;
+    return true;
+}
+
 bool StarDictParserStd::load_ifo(const std::string& ifo_path) {
-    std::string txt = read_file_to_string(ifo_path);
+    return read_header(ifo_path, header_);
+}
+
+bool StarDictParserStd::read_header(const std::string& any_path, StarDictHeaderStd& out) {
+    out = {};
+    std::string ifo = ends_with(any_path, ".ifo") ? any_path : base_without_ext(any_path) + ".ifo";
+    std::string txt = read_file_to_string(ifo);
     if (txt.empty()) return false;
     std::istringstream is(txt);
     std::string line;
@@ -56,39 +106,53 @@ bool StarDictParserStd::load_ifo(const std::string& ifo_path) {
         if (eq == std::string::npos) continue;
         std::string key = lcase(line.substr(0, eq));
         std::string val = line.substr(eq + 1);
-        if (key == "bookname") header_.book_name = val;
-        else if (key == "wordcount") header_.word_count = std::atoi(val.c_str());
-        else if (key == "idxfilesize") header_.index_file_size = std::atoi(val.c_str());
-        else if (key == "idxoffsetbits") header_.idx_offset_bits = std::atoi(val.c_str());
-        else if (key == "description") header_.description = val;
-        else if (key == "version") header_.version = val;
+        if (key == "bookname") out.book_name = val;
+        else if (key == "wordcount") out.word_count = std::atoi(val.c_str());
+        else if (key == "idxfilesize") out.index_file_size = std::atoi(val.c_str());
+        else if (key == "idxoffsetbits") out.idx_offset_bits = std::atoi(val.c_str());
+        else if (key == "synwordcount") out.syn_word_count = std::atoi(val.c_str());
+        else if (key == "description") out.description = val;
+        else if (key == "version") out.version = val;
     }
     return true;
 }
 
 bool StarDictParserStd::load_idx(const std::string& idx_path) {
-    std::string buf = read_file_to_string(idx_path);
-    if (buf.empty()) return false;
-    const unsigned char* p = reinterpret_cast<const unsigned char*>(buf.data());
-    const unsigned char* end = p + buf.size();
+    if (!idx_.open(idx_path, private_copy_) || idx_.size() == 0) return false;
+    // Entry starts are 32-bit; no real .idx comes close to 4 GiB
+    if (idx_.size() > UINT32_MAX) return false;
+    const size_t tail = header_.idx_offset_bits == 64 ? 12 : 8;
+    const char* base = idx_.data();
+    const size_t end = idx_.size();
+    if (header_.word_count > 0) starts_.reserve((size_t)header_.word_count + 1);
+    // Entries: word, NUL, big-endian offset (32/64 bits), big-endian size
+    bool sorted = true;
+    std::string_view prev;
+    size_t p = 0;
     while (p < end) {
-        // parse word (null-terminated)
-        const unsigned char* s = p;
-        while (p < end && *p) ++p;
-        if (p >= end) break;
-        std::string word(reinterpret_cast<const char*>(s), reinterpret_cast<const char*>(p));
-        ++p; // skip null
-        if (header_.idx_offset_bits == 64) {
-            if (p + 8 + 4 > end) break;
-            uint64_t off = be64(p); p += 8; uint32_t sz = be32(p); p += 4;
-            index_[word] = {off, sz}; words_.push_back(word);
-        } else {
-            if (p + 4 + 4 > end) break;
-            uint64_t off = be32(p); p += 4; uint32_t sz = be32(p); p += 4;
-            index_[word] = {off, sz}; words_.push_back(word);
-        }
+        const char* nul = static_cast<const char*>(std::memchr(base + p, 0, end - p));
+        if (!nul) break;
+        const size_t next = (size_t)(nul - base) + 1 + tail;
+        if (next > end) break;
+        const std::string_view w(base + p, (size_t)(nul - base) - p);
+        if (sorted && !starts_.empty() && StarDictSynonymsStd::collate(prev, w) > 0) sorted = false;
+        starts_.push_back((uint32_t)p);
+        prev = w;
+        p = next;
     }
-    return !index_.empty();
+    count_ = starts_.size();
+    if (count_ == 0) return false;
+    starts_.push_back((uint32_t)p);
+    starts_.shrink_to_fit();
+    if (!sorted) {
+        // Not in StarDict order (hand-made or broken files): search a sorted permutation.
+        // Stable, so the last of repeated headwords stays last.
+        sorted_.resize(count_);
+        for (size_t i = 0; i < count_; ++i) sorted_[i] = (uint32_t)i;
+        std::stable_sort(sorted_.begin(), sorted_.end(),
+                         [this](uint32_t a, uint32_t b) { return StarDictSynonymsStd::collate(word(a), word(b)) < 0; });
+    }
+    return true;
 }
 
 static inline uint64_t fnv1a64(const void* data, size_t len) {
@@ -99,13 +163,22 @@ static inline uint64_t fnv1a64(const void* data, size_t len) {
 }
 
 bool StarDictParserStd::open_dict(const std::string& dict_path) {
-    dict_stream_.close();
+    dict_.close();
+    dz_.close();
     // Plain .dict
     if (!ends_with(dict_path, ".dz")) {
-        dict_stream_.open(dict_path, std::ios::binary);
-        return (bool)dict_stream_;
+        data_path_ = dict_path;
+        return map_dict(dict_path, private_copy_);
     }
-    // .dict.dz: decompress to cache with hashed file signature to avoid collisions
+    // dictzip: random access in place
+    if (!dictzip_decompress_ && dz_.open(dict_path)) {
+        if (dz_.random_access()) {
+            data_path_ = dict_path;
+            return true;
+        }
+        dz_.close();
+    }
+    // Plain gzip (or decompress mode): decompress to cache with hashed file signature to avoid collisions
     std::error_code ec;
     fs::path src(dict_path);
     auto sz = fs::file_size(src, ec);
@@ -129,12 +202,19 @@ bool StarDictParserStd::open_dict(const std::string& dict_path) {
         gzclose(gz);
         out.close();
     }
-    dict_stream_.open(outpath.string(), std::ios::binary);
-    return (bool)dict_stream_;
+    data_path_ = outpath.string();
+    return map_dict(data_path_, false);
+}
+
+bool StarDictParserStd::map_dict(const std::string& path, bool private_copy) {
+    if (!dict_.open(path, private_copy)) return false;
+    // Lookups jump around the file; readahead would mostly fetch unused pages
+    dict_.advise(MappedFileStd::Access::Random);
+    return true;
 }
 
 bool StarDictParserStd::load_dictionary(const std::string& any_path) {
-    loaded_ = false; index_.clear(); words_.clear(); if (dict_stream_.is_open()) dict_stream_.close(); header_ = {};
+    loaded_ = false; dz_.close(); idx_.close(); starts_.clear(); sorted_.clear(); count_ = 0; dict_.close(); syn_.close(); syn_path_.clear(); header_ = {}; data_path_.clear();
     fs::path p(any_path);
     std::string ext = p.extension().string();
     std::string base = base_without_ext(any_path);
@@ -145,6 +225,9 @@ bool StarDictParserStd::load_dictionary(const std::string& any_path) {
     std::string idx = base_without_ext(ifo) + ".idx";
     if (!fs::exists(idx)) return false;
     if (!load_idx(idx)) return false;
+    // Optional; a missing or unusable .syn only loses the synonyms
+    std::string syn = base_without_ext(ifo) + ".syn";
+    if (fs::exists(syn) && syn_.open(syn, count_, private_copy_)) syn_path_ = syn;
     std::string dict = base_without_ext(ifo) + ".dict";
     if (!fs::exists(dict)) {
         // try .dict.dz
@@ -161,30 +244,107 @@ bool StarDictParserStd::load_dictionary(const std::string& any_path) {
 bool StarDictParserStd::is_loaded() const { return loaded_; }
 std::string StarDictParserStd::dictionary_name() const { return header_.book_name.empty() ? std::string("StarDict") : header_.book_name; }
 std::string StarDictParserStd::dictionary_description() const { return header_.description; }
-int StarDictParserStd::word_count() const { return (int)words_.size(); }
+int StarDictParserStd::word_count() const { return (int)count_; }
 
 std::string StarDictParserStd::lookup(const std::string& word) const {
     if (!loaded_) return {};
-    auto it = index_.find(word);
-    if (it == index_.end()) return {};
-    uint64_t off = it->second.first; uint32_t sz = it->second.second;
-    dict_stream_.seekg((std::streamoff)off, std::ios::beg);
-    if (!dict_stream_) return {};
-    std::string out; out.resize(sz);
-    dict_stream_.read(out.data(), sz);
+    size_t i = 0;
+    if (!resolve(word, i)) return {};
+    uint64_t off = 0; uint32_t sz = 0;
+    location(i, off, sz);
+    if (dz_.is_open()) {
+        std::string out;
+        if (!dz_.read(off, sz, out)) return {};
+        return out;
+    }
+    return std::string(slice(off, sz));
+}
+
+std::string_view StarDictParserStd::lookup_view(const std::string& word) const {
+    if (!loaded_ || dz_.is_open()) return {};
+    size_t i = 0;
+    if (!resolve(word, i)) return {};
+    uint64_t off = 0; uint32_t sz = 0;
+    location(i, off, sz);
+    return slice(off, sz);
+}
+
+std::string_view StarDictParserStd::slice(uint64_t offset, uint64_t size) const {
+    if (offset > dict_.size() || size > dict_.size() - offset) return {};
+    return std::string_view(dict_.data() + offset, (size_t)size);
+}
+
+std::vector<std::string> StarDictParserStd::lookup_batch(const std::vector<std::string>& words) const {
+    // Neighbours closer than kMaxGap share a read, up to kMaxRange bytes per read
+    constexpr uint64_t kMaxGap = 16 * 1024;
+    constexpr uint64_t kMaxRange = 1024 * 1024;
+    std::vector<std::string> out(words.size());
+    if (!loaded_) return out;
+    struct Loc { uint64_t off; uint32_t size; size_t slot; };
+    std::vector<Loc> locs;
+    locs.reserve(words.size());
+    size_t e = 0;
+    for (size_t i = 0; i < words.size(); ++i) {
+        if (!resolve(words[i], e)) continue;
+        Loc l{0, 0, i};
+        location(e, l.off, l.size);
+        locs.push_back(l);
+    }
+    std::sort(locs.begin(), locs.end(), [](const Loc& a, const Loc& b) { return a.off < b.off; });
+    std::string buf;
+    for (size_t i = 0; i < locs.size();) {
+        const uint64_t begin = locs[i].off;
+        uint64_t end = begin + locs[i].size;
+        size_t j = i + 1;
+        while (j < locs.size() && locs[j].off <= end + kMaxGap &&
+               std::max(end, locs[j].off + locs[j].size) - begin <= kMaxRange) {
+            end = std::max(end, locs[j].off + locs[j].size);
+            ++j;
+        }
+        if (dz_.is_open()) {
+            // Chunks shared by neighbours are inflated once
+            const uint64_t got = dz_.read(begin, (size_t)(end - begin), buf) ? buf.size() : 0;
+            for (size_t k = i; k < j; ++k) {
+                const uint64_t rel = locs[k].off - begin;
+                if (rel + locs[k].size <= got) out[locs[k].slot].assign(buf, (size_t)rel, locs[k].size);
+            }
+        } else {
+            // The .dict is advised random; ask for each range up front instead
+            dict_.advise(MappedFileStd::Access::WillNeed, (size_t)begin, (size_t)(end - begin));
+            for (size_t k = i; k < j; ++k) out[locs[k].slot] = std::string(slice(locs[k].off, locs[k].size));
+        }
+        i = j;
+    }
     return out;
 }
 
+bool StarDictParserStd::entry_location(const std::string& word, uint64_t& offset, uint32_t& size) const {
+    size_t i = 0;
+    if (!resolve(word, i)) return false;
+    location(i, offset, size);
+    return true;
+}
+
 std::vector<std::string> StarDictParserStd::find_similar(const std::string& word, int max_results) const {
-    std::vector<std::string> out; out.reserve(std::min<int>((int)words_.size(), max_results));
-    std::string lw = lcase(word);
-    for (const auto& w : words_) {
-        if ((int)out.size() >= max_results) break;
-        if (lcase(w).rfind(lw, 0) == 0) out.push_back(w);
+    std::vector<std::string> out;
+    if (max_results <= 0) return out;
+    // Case-insensitive order comes first, so the matches are one contiguous range
+    auto head = [&](size_t rank) {
+        const std::string_view w = this->word(entry(rank));
+        return StarDictSynonymsStd::ascii_casecmp(w.substr(0, std::min(w.size(), word.size())), word);
+    };
+    size_t lo = 0, hi = count_;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (head(mid) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    for (size_t r = lo; r < count_ && (int)out.size() < max_results && head(r) == 0; ++r) {
+        out.emplace_back(this->word(entry(r)));
     }
     return out;
 }
 
-std::vector<std::string> StarDictParserStd::all_words() const { return words_; }
+std::vector<std::string> StarDictParserStd::all_words() const { return headwords().to_vector(); }
 
 } // namespace UnidictCoreStd
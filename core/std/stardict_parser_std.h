@@ -1,14 +1,28 @@
-// Qt-free minimal StarDict parser: supports .ifo/.idx/.dict and .dict.dz (decompressed to cache).
+// Qt-free minimal StarDict parser: supports .ifo/.idx/.syn/.dict and .dict.dz. A dictzip
+// .dict.dz is read in place, inflating only the chunks a lookup needs; plain gzip
+// (or the optional decompress mode) is decompressed once into the cache.
+// The .idx is mapped, not copied: the parser keeps one offset per entry and
+// binary-searches in StarDict order (ASCII case-insensitive, then byte order).
+// The .dict (or its decompressed copy) is mapped too, so a lookup is a bounds-checked
+// slice and concurrent lookups share no lock. Like any mapping, it expects dictionary
+// updates to replace the files (new file, rename) rather than truncate and rewrite
+// them under a live parser; set_private_copy() reads them into memory for sources
+// that may be rewritten in place. A .syn next to the .ifo resolves synonyms ("went",
+// alternate spellings) to the entry they point at.
 
 #ifndef UNIDICT_STARDICT_PARSER_STD_H
 #define UNIDICT_STARDICT_PARSER_STD_H
 
 #include <cstdint>
-#include <fstream>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
+#include "dictzip_reader_std.h"
+#include "headword_view_std.h"
+#include "mapped_file_std.h"
+#include "stardict_synonyms_std.h"
+
 namespace UnidictCoreStd {
 
 struct StarDictHeaderStd {
@@ -17,6 +31,7 @@ struct StarDictHeaderStd {
     int word_count = 0;
     int index_file_size = 0;
     int idx_offset_bits = 32; // 32 or 64
+    int syn_word_count = 0;
     std::string description;
 };
 
@@ -26,20 +41,54 @@ public:
     ~StarDictParserStd();
 
     bool load_dictionary(const std::string& any_path);
+    // Decompress a dictzip .dict.dz into the cache instead of reading it in place:
+    // faster lookups for disk space and a slower first load. Applies to the next
+    // load_dictionary(); the default comes from UNIDICT_DICTZIP_DECOMPRESS=1.
+    void set_dictzip_decompress(bool enabled) { dictzip_decompress_ = enabled; }
+    // Read the .idx, .syn and plain .dict into memory instead of mapping them, so
+    // rewriting them in place cannot fault a live parser. Applies to the next
+    // load_dictionary(); a decompressed cache copy is still mapped.
+    void set_private_copy(bool enabled) { private_copy_ = enabled; }
     bool is_loaded() const;
+    // Read only the .ifo header (book name, word count, description) without loading the index.
+    static bool read_header(const std::string& any_path, StarDictHeaderStd& out);
 
     std::string dictionary_name() const;
     std::string dictionary_description() const;
     int word_count() const;
 
-    std::string lookup(const std::string& word) const; // empty if not found
+    // Definition of a headword or synonym; empty if neither.
+    std::string lookup(const std::string& word) const;
+    // Definition (as lookup()) as a view into the mapped .dict, for callers that only render or
+    // tokenize it; valid while the parser is alive and not reloaded. Empty if not
+    // found, and always empty for a dictzip read in place (use lookup() there).
+    std::string_view lookup_view(const std::string& word) const;
+    // Definitions of many words, in the order given. Visits the .dict in offset order,
+    // prefetching (or, for dictzip, inflating) neighbouring definitions as one range.
+    std::vector<std::string> lookup_batch(const std::vector<std::string>& words) const;
+    // Headwords starting with word (ASCII case-insensitive), in StarDict order.
     std::vector<std::string> find_similar(const std::string& word, int max_results) const;
     std::vector<std::string> all_words() const;
+    // Non-owning view of the same list; valid while the parser is alive and not reloaded.
+    HeadwordViewStd headwords() const { return HeadwordViewStd(this, count_, &word_at); }
+    // File the definition offsets refer to: the .dict, a dictzip .dict.dz read in
+    // place, or the decompressed copy of a .dict.dz.
+    const std::string& data_path() const { return data_path_; }
+    // Synonyms from the .syn (empty without one), as a view like headwords(). Lookups
+    // resolve them; they are not headwords, so all_words() and find_similar() skip them.
+    HeadwordViewStd synonyms() const { return syn_.words(); }
+    // The .syn in use; empty if the dictionary has none.
+    const std::string& syn_path() const { return syn_path_; }
+    // Exact (offset, size) of a headword's (or synonym's) definition in data_path().
+    bool entry_location(const std::string& word, uint64_t& offset, uint32_t& size) const;
 
 private:
     bool load_ifo(const std::string& ifo_path);
     bool load_idx(const std::string& idx_path);
     bool open_dict(const std::string& dict_path);
+    bool map_dict(const std::string& path, bool private_copy);
+    // [offset, offset + size) of the mapped .dict; empty if out of bounds.
+    std::string_view slice(uint64_t offset, uint64_t size) const;
 
     static std::string base_without_ext(const std::string& path);
     static std::string dirname(const std::string& path);
@@ -47,11 +96,29 @@ private:
     static uint32_t be32(const unsigned char* p);
     static uint64_t be64(const unsigned char* p);
     static std::string lcase(const std::string& s);
+    static std::string_view word_at(const void* self, size_t i);
+
+    std::string_view word(size_t i) const; // file order
+    size_t entry(size_t rank) const { return sorted_.empty() ? rank : sorted_[rank]; }
+    // Entry of an exact headword (the last one if the .idx repeats it).
+    bool find(std::string_view word, size_t& i) const;
+    // find(), then the entry a synonym points at.
+    bool resolve(std::string_view word, size_t& i) const;
+    void location(size_t i, uint64_t& offset, uint32_t& size) const;
 
     StarDictHeaderStd header_;
-    std::unordered_map<std::string, std::pair<uint64_t, uint32_t>> index_; // word -> (offset, size)
-    std::vector<std::string> words_;
-    mutable std::ifstream dict_stream_;
+    MappedFileStd idx_;
+    // Start of each entry in idx_, plus the end of the last one (entries fit in 4 GiB)
+    std::vector<uint32_t> starts_;
+    std::vector<uint32_t> sorted_; // entries in collation order; empty when the file already is
+    size_t count_ = 0;
+    MappedFileStd dict_;
+    DictzipReaderStd dz_; // open instead of dict_ when reading a .dict.dz in place
+    StarDictSynonymsStd syn_;
+    std::string syn_path_;
+    bool dictzip_decompress_ = false;
+    bool private_copy_ = false;
+    std::string data_path_;
     bool loaded_ = false;
 };
 
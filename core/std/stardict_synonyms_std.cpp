@@ -0,0 +1,93 @@
+#include "stardict_synonyms_std.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace UnidictCoreStd {
+
+int StarDictSynonymsStd::ascii_casecmp(std::string_view a, std::string_view b) {
+    const size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char x = (unsigned char)a[i], y = (unsigned char)b[i];
+        if (x >= 'A' && x <= 'Z') x = (unsigned char)(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = (unsigned char)(y - 'A' + 'a');
+        if (x != y) return x < y ? -1 : 1;
+    }
+    return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+}
+
+int StarDictSynonymsStd::collate(std::string_view a, std::string_view b) {
+    const int c = ascii_casecmp(a, b);
+    return c != 0 ? c : a.compare(b);
+}
+
+std::string_view StarDictSynonymsStd::word_at(const void* self, size_t i) {
+    return static_cast<const StarDictSynonymsStd*>(self)->word(i);
+}
+
+std::string_view StarDictSynonymsStd::word(size_t i) const {
+    return std::string_view(file_.data() + starts_[i]);
+}
+
+uint32_t StarDictSynonymsStd::target(size_t i) const {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(file_.data()) + starts_[i] + word(i).size() + 1;
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+void StarDictSynonymsStd::close() {
+    file_.close();
+    starts_.clear();
+    sorted_.clear();
+    count_ = 0;
+}
+
+bool StarDictSynonymsStd::open(const std::string& path, size_t entry_count, bool private_copy) {
+    close();
+    if (!file_.open(path, private_copy) || file_.size() == 0 || file_.size() > UINT32_MAX) { file_.close(); return false; }
+    const char* base = file_.data();
+    const size_t end = file_.size();
+    // Entries: word, NUL, big-endian 32-bit .idx entry number
+    bool sorted = true;
+    std::string_view prev;
+    size_t p = 0;
+    while (p < end) {
+        const char* nul = static_cast<const char*>(std::memchr(base + p, 0, end - p));
+        if (!nul) break;
+        const size_t next = (size_t)(nul - base) + 1 + 4;
+        if (next > end) break;
+        const std::string_view w(base + p, (size_t)(nul - base) - p);
+        starts_.push_back((uint32_t)p);
+        if (w.empty() || target(starts_.size() - 1) >= entry_count) {
+            starts_.pop_back();
+        } else {
+            if (sorted && starts_.size() > 1 && collate(prev, w) > 0) sorted = false;
+            prev = w;
+        }
+        p = next;
+    }
+    count_ = starts_.size();
+    if (count_ == 0) { close(); return false; }
+    starts_.shrink_to_fit();
+    if (!sorted) {
+        // Stable, so the first of repeated synonyms stays first
+        sorted_.resize(count_);
+        for (size_t i = 0; i < count_; ++i) sorted_[i] = (uint32_t)i;
+        std::stable_sort(sorted_.begin(), sorted_.end(),
+                         [this](uint32_t a, uint32_t b) { return collate(word(a), word(b)) < 0; });
+    }
+    return true;
+}
+
+bool StarDictSynonymsStd::find(std::string_view w, uint32_t& entry_no) const {
+    size_t lo = 0, hi = count_;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (collate(word(entry(mid)), w) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == count_ || word(entry(lo)) != w) return false;
+    entry_no = target(entry(lo));
+    return true;
+}
+
+} // namespace UnidictCoreStd
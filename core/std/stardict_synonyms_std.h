@@ -0,0 +1,54 @@
+// StarDict .syn synonym index (std-only): alternate forms ("went", other
+// spellings) each naming the .idx entry, in file order, that defines them.
+// The file is mapped and searched in place: one 32-bit offset per synonym, no
+// string copies. Also home to StarDict collation, shared with the .idx reader.
+
+#ifndef UNIDICT_STARDICT_SYNONYMS_STD_H
+#define UNIDICT_STARDICT_SYNONYMS_STD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "headword_view_std.h"
+#include "mapped_file_std.h"
+
+namespace UnidictCoreStd {
+
+class StarDictSynonymsStd {
+public:
+    // Map a .syn (or read it into memory, see MappedFileStd::open); synonyms naming
+    // an entry >= entry_count are skipped. False if the file is missing or holds no
+    // usable synonym.
+    bool open(const std::string& path, size_t entry_count, bool private_copy = false);
+    void close();
+    bool is_open() const { return count_ > 0; }
+    size_t size() const { return count_; }
+
+    std::string_view word(size_t i) const; // file order
+    uint32_t target(size_t i) const;       // .idx entry number (file order)
+    // Target of an exact synonym (the first one if it is listed more than once).
+    bool find(std::string_view word, uint32_t& entry) const;
+    // Synonyms in file order; valid while this object is alive and not reopened.
+    HeadwordViewStd words() const { return HeadwordViewStd(this, count_, &word_at); }
+
+    // StarDict collation (stardict_strcmp): g_ascii_strcasecmp, ties broken bytewise.
+    static int ascii_casecmp(std::string_view a, std::string_view b);
+    static int collate(std::string_view a, std::string_view b);
+
+private:
+    static std::string_view word_at(const void* self, size_t i);
+    size_t entry(size_t rank) const { return sorted_.empty() ? rank : sorted_[rank]; }
+
+    MappedFileStd file_;
+    // Start of each usable synonym in file_ (each is NUL-terminated there)
+    std::vector<uint32_t> starts_;
+    std::vector<uint32_t> sorted_; // synonyms in collation order; empty when the file already is
+    size_t count_ = 0;
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_STARDICT_SYNONYMS_STD_H
@@ -0,0 +1,86 @@
+#include "thread_pool_std.h"
+
+namespace UnidictCoreStd {
+
+// Pool and deque of the calling worker, so nested submits stay local.
+static thread_local const ThreadPoolStd* tl_pool = nullptr;
+static thread_local size_t tl_worker = 0;
+
+ThreadPoolStd::ThreadPoolStd(int threads, size_t max_queued) : max_queued_(max_queued) {
+    size_t n = threads > 0 ? (size_t)threads : (size_t)std::thread::hardware_concurrency();
+    if (n == 0) n = 2;
+    workers_.reserve(n);
+    for (size_t i = 0; i < n; ++i) workers_.emplace_back(new Worker());
+    for (size_t i = 0; i < n; ++i) workers_[i]->thread = std::thread(&ThreadPoolStd::run, this, i);
+}
+
+ThreadPoolStd::~ThreadPoolStd() {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& w : workers_) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+}
+
+bool ThreadPoolStd::submit(Task task) {
+    if (!task) return false;
+    {
+        // Reserve the slot under mu_ so a sleeping worker cannot miss it
+        std::lock_guard<std::mutex> lk(mu_);
+        if (stop_) return false;
+        if (max_queued_ && queued_.load() >= max_queued_) return false;
+        ++queued_;
+    }
+    const size_t i = tl_pool == this ? tl_worker : next_.fetch_add(1) % workers_.size();
+    {
+        std::lock_guard<std::mutex> lk(workers_[i]->mu);
+        workers_[i]->tasks.push_back(std::move(task));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+bool ThreadPoolStd::pop(size_t self, Task& out) {
+    {
+        Worker& w = *workers_[self];
+        std::lock_guard<std::mutex> lk(w.mu);
+        if (!w.tasks.empty()) {
+            out = std::move(w.tasks.back());
+            w.tasks.pop_back();
+            --queued_;
+            return true;
+        }
+    }
+    for (size_t k = 1; k < workers_.size(); ++k) {
+        Worker& v = *workers_[(self + k) % workers_.size()];
+        std::lock_guard<std::mutex> lk(v.mu);
+        if (v.tasks.empty()) continue;
+        out = std::move(v.tasks.front());
+        v.tasks.pop_front();
+        --queued_;
+        ++steals_;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPoolStd::run(size_t self) {
+    tl_pool = this;
+    tl_worker = self;
+    for (;;) {
+        Task t;
+        if (pop(self, t)) {
+            t();
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(mu_);
+        cv_.wait(lk, [this]() { return stop_ || queued_.load() > 0; });
+        // Drain what is left before exiting
+        if (stop_ && queued_.load() == 0) return;
+    }
+}
+
+} // namespace UnidictCoreStd
@@ -0,0 +1,62 @@
+// Fixed-size work-stealing thread pool (std-only).
+// Each worker owns a deque: tasks submitted from a worker go to its own deque and
+// are run newest first, tasks from other threads are spread round-robin, and an
+// idle worker steals the oldest task of a busy one.
+
+#ifndef UNIDICT_THREAD_POOL_STD_H
+#define UNIDICT_THREAD_POOL_STD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace UnidictCoreStd {
+
+class ThreadPoolStd {
+public:
+    using Task = std::function<void()>;
+
+    // threads <= 0: hardware concurrency. max_queued bounds the tasks waiting to
+    // run (0: unbounded); submit() refuses work beyond it instead of blocking.
+    explicit ThreadPoolStd(int threads = 0, size_t max_queued = 0);
+    // Runs the tasks still queued, then joins the workers.
+    ~ThreadPoolStd();
+    ThreadPoolStd(const ThreadPoolStd&) = delete;
+    ThreadPoolStd& operator=(const ThreadPoolStd&) = delete;
+
+    // False when the queue is full or the pool is shutting down.
+    bool submit(Task task);
+
+    size_t size() const { return workers_.size(); }
+    size_t queued() const { return queued_.load(); }
+    uint64_t steals() const { return steals_.load(); }
+
+private:
+    struct Worker {
+        std::mutex mu;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+    void run(size_t self);
+    bool pop(size_t self, Task& out);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    size_t max_queued_ = 0;
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> next_{0};
+    std::atomic<uint64_t> steals_{0};
+    std::mutex mu_; // sleeping and shutdown
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
+
+} // namespace UnidictCoreStd
+
+#endif // UNIDICT_THREAD_POOL_STD_H
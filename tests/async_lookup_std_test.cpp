@@ -0,0 +1,200 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "std/async_lookup_std.h"
+#include "std/thread_pool_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "async_lookup";
+
+static std::string write_json(const std::string& name, int words) {
+    fs::path p = kDir / (name + ".json");
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out << "{\n  \"name\": \"" << name << "\",\n  \"entries\": [\n";
+    for (int i = 0; i < words; ++i) {
+        out << "    {\"word\":\"" << name << "_w" << i << "\",\"definition\":\"async text " << i << "\"}";
+        if (i + 1 < words) out << ",";
+        out << "\n";
+    }
+    out << "  ]\n}\n";
+    return p.string();
+}
+
+// Occupies one pool worker until released.
+struct Blocker {
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+    void park(ThreadPoolStd& pool) {
+        assert(pool.submit([this]() {
+            started = true;
+            while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }));
+        while (!started) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+};
+
+static void pool_unit() {
+    // Nested submits run on the submitting worker's deque; idle workers steal them
+    {
+        ThreadPoolStd pool(4);
+        assert(pool.size() == 4);
+        std::atomic<int> ran{0};
+        std::atomic<bool> spawned{false};
+        assert(pool.submit([&]() {
+            for (int i = 0; i < 2000; ++i) {
+                assert(pool.submit([&]() {
+                    ++ran;
+                    std::this_thread::sleep_for(std::chrono::microseconds(20));
+                }));
+            }
+            spawned = true;
+        }));
+        while (!spawned || ran < 2000) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        assert(pool.steals() > 0);
+    }
+    // Bounded queue refuses instead of blocking; the destructor drains what was accepted
+    std::atomic<int> ran{0};
+    {
+        ThreadPoolStd pool(1, 2);
+        Blocker b;
+        b.park(pool);
+        assert(pool.submit([&]() { ++ran; }));
+        assert(pool.submit([&]() { ++ran; }));
+        assert(!pool.submit([&]() { ++ran; }));
+        assert(pool.queued() == 2);
+        b.release = true;
+    }
+    assert(ran == 2);
+}
+
+int main() {
+    pool_unit();
+
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    DictionaryManagerStd mgr;
+    assert(mgr.add_dictionary(write_json("north", 200)));
+    assert(mgr.add_dictionary(write_json("south", 50)));
+    mgr.build_index();
+
+    auto pool = std::make_shared<ThreadPoolStd>(1);
+    AsyncLookupStd async(mgr, pool);
+
+    // Futures and callbacks carry the same results as the synchronous calls
+    {
+        std::atomic<int> calls{0};
+        auto f = async.submit_lookup("north_w3", {}, [&](const AsyncLookupStd::Entries& r) {
+            assert(r.size() == 1 && r[0].definition == "async text 3");
+            ++calls;
+        });
+        assert(f.get().size() == 1 && f.get()[0].dict_name == "north");
+        assert(async.submit_prefix("south_w1", 5).get() == mgr.prefix_search("south_w1", 5));
+        auto ft = async.submit_fulltext("async text", 7).get();
+        assert(ft.size() == 7);
+        while (calls == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        assert(calls == 1);
+    }
+
+    // A burst of identical type-ahead requests runs once
+    {
+        Blocker b;
+        b.park(*pool);
+        const auto before = async.stats();
+        std::atomic<int> calls{0};
+        std::vector<std::shared_future<AsyncLookupStd::Words>> futures;
+        for (int i = 0; i < 50; ++i)
+            futures.push_back(async.submit_prefix("north_w1", 10, {}, [&](const AsyncLookupStd::Words&) { ++calls; }));
+        auto other = async.submit_prefix("north_w1", 20); // different limit: separate query
+        assert(async.in_flight() == 2);
+        b.release = true;
+        for (auto& f : futures) assert(f.get().size() == 10);
+        assert(other.get().size() > 10);
+        while (calls < 50) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const auto after = async.stats();
+        assert(after.submitted - before.submitted == 51);
+        assert(after.coalesced - before.coalesced == 49);
+        assert(after.executed - before.executed == 2);
+        assert(async.in_flight() == 0);
+    }
+
+    // Cancellation: a query nobody still wants is skipped, a shared one still runs
+    {
+        Blocker b;
+        b.park(*pool);
+        const auto before = async.stats();
+        CancelTokenStd lone, shared_a, shared_b;
+        std::atomic<int> calls{0};
+        auto skipped = async.submit_lookup("north_w9", lone, [&](const AsyncLookupStd::Entries&) { ++calls; });
+        auto a = async.submit_lookup("south_w9", shared_a, [&](const AsyncLookupStd::Entries&) { calls += 10; });
+        auto c = async.submit_lookup("south_w9", shared_b, [&](const AsyncLookupStd::Entries&) { calls += 100; });
+        lone.cancel();
+        shared_a.cancel();
+        assert(lone.cancelled() && !shared_b.cancelled());
+        b.release = true;
+        assert(skipped.get().empty());
+        assert(c.get().size() == 1 && a.get().size() == 1);
+        while (calls < 100) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        assert(calls == 100);
+        const auto after = async.stats();
+        assert(after.skipped - before.skipped == 1);
+        assert(after.executed - before.executed == 1);
+    }
+
+    // A throwing callback neither kills the worker nor starves other waiters,
+    // and the task still counts as finished
+    {
+        Blocker b;
+        b.park(*pool);
+        std::atomic<int> calls{0};
+        {
+            AsyncLookupStd local(mgr, pool);
+            auto a = local.submit_lookup("south_w4", {}, [](const AsyncLookupStd::Entries&) { throw 7; });
+            auto c = local.submit_lookup("south_w4", {}, [&](const AsyncLookupStd::Entries&) { ++calls; });
+            b.release = true;
+            assert(a.get().size() == 1 && c.get().size() == 1);
+        } // waits for the task
+        assert(calls == 1);
+        assert(async.submit_lookup("south_w4").get().size() == 1);
+    }
+
+    // Many clients on a wider pool
+    {
+        AsyncLookupStd wide(mgr, std::make_shared<ThreadPoolStd>(4));
+        std::vector<std::shared_future<AsyncLookupStd::Entries>> futures;
+        for (int i = 0; i < 400; ++i) futures.push_back(wide.submit_lookup("north_w" + std::to_string(i % 200)));
+        for (int i = 0; i < 400; ++i) {
+            const auto& r = futures[i].get();
+            assert(r.size() == 1 && r[0].definition == "async text " + std::to_string(i % 200));
+        }
+        assert(wide.stats().executed + wide.stats().coalesced == 400);
+    }
+
+    // Destroying the facade drops queued requests and waits for its tasks
+    {
+        Blocker b;
+        b.park(*pool);
+        std::shared_future<AsyncLookupStd::Entries> pending;
+        {
+            auto tmp = std::make_unique<AsyncLookupStd>(mgr, pool);
+            pending = tmp->submit_lookup("north_w1");
+            std::thread releaser([&]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                b.release = true;
+            });
+            tmp.reset();
+            releaser.join();
+        }
+        assert(pending.get().empty());
+    }
+    return 0;
+}
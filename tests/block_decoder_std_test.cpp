@@ -0,0 +1,170 @@
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <zlib.h>
+
+#include "std/block_decoder_std.h"
+
+using namespace UnidictCoreStd;
+
+static bool decode(const std::string& block, size_t size, std::string& out) {
+    return BlockDecoderStd::decode(reinterpret_cast<const unsigned char*>(block.data()), block.size(), size, out);
+}
+
+static bool round_trip(uint32_t type, const std::string& data) {
+    const std::string block = BlockDecoderStd::encode(type, data);
+    std::string out;
+    return decode(block, data.size(), out) && out == data;
+}
+
+// Wraps a raw LZO1X stream in an MDict block header for the given plaintext
+static std::string lzo_block(const std::string& stream, const std::string& plain) {
+    const uint32_t sum = (uint32_t)adler32(1, (const Bytef*)plain.data(), (uInt)plain.size());
+    std::string b = {1, 0, 0, 0, (char)(sum >> 24), (char)(sum >> 16), (char)(sum >> 8), (char)sum};
+    return b + stream;
+}
+
+static std::string bytes(std::initializer_list<int> v) {
+    std::string s;
+    for (int c : v) s.push_back((char)c);
+    return s;
+}
+
+// Counts calls, then defers to the built-in zlib backend
+class CountingBackend : public BlockDecoderStd::Backend {
+public:
+    mutable int calls = 0;
+    const char* name() const override { return "counting"; }
+    bool decompress(const unsigned char* in, size_t in_len, unsigned char* out, size_t out_cap, size_t* produced) const override {
+        ++calls;
+        return BlockDecoderStd::zlib().decompress(in, in_len, out, out_cap, produced);
+    }
+};
+
+int main() {
+    uint32_t seed = 3;
+    auto noise = [&](size_t n) {
+        std::string s(n, ' ');
+        for (auto& c : s) { seed = seed * 1664525u + 1013904223u; c = (char)(seed >> 24); }
+        return s;
+    };
+    std::string text;
+    for (int i = 0; i < 2000; ++i) text += "<li>word " + std::to_string(i % 37) + " means something</li>";
+    std::string far = noise(20000);
+    far += far.substr(0, 5000) + noise(100) + far.substr(100, 3000); // matches beyond 16 KiB
+
+    // Every type round-trips: empty, short, repetitive, long runs, random, far matches
+    for (uint32_t type : {BlockDecoderStd::Stored, BlockDecoderStd::Lzo, BlockDecoderStd::Zlib}) {
+        assert(round_trip(type, ""));
+        assert(round_trip(type, "a"));
+        assert(round_trip(type, "abc"));
+        assert(round_trip(type, text));
+        assert(round_trip(type, std::string(100000, 'x')));
+        assert(round_trip(type, noise(300) + std::string(1000, '\0') + noise(17)));
+        assert(round_trip(type, noise(70000)));
+        assert(round_trip(type, far));
+    }
+    assert(BlockDecoderStd::encode(BlockDecoderStd::Lzo, text).size() < text.size() / 4);
+    assert(std::string(BlockDecoderStd::lzo().name()) == "lzo");
+
+    // Known-answer LZO1X streams, independent of our encoder. The first is what
+    // lzo1x_1_compress emits for "abc"; the others are assembled by hand from
+    // the LZO1X format so every instruction kind lzo1x_decompress handles
+    // appears at least once.
+    {
+        std::string out;
+        const std::string abc = bytes({0x14, 'a', 'b', 'c', 0x11, 0x00, 0x00});
+        assert(decode(lzo_block(abc, "abc"), 3, out) && out == "abc");
+        assert(!decode(lzo_block(abc.substr(0, 5), "abc"), 3, out)); // no end marker
+
+        // Initial run of 4, M2 (len 4, dist 4) + 2 trailing literals, M1 (len 2,
+        // dist 2), a 300-byte literal run with a 255 extension byte, M3 (len 40,
+        // dist 300, extended length) + 1 trailing literal, end marker.
+        std::string run;
+        for (int i = 0; i < 300; ++i) run.push_back((char)(32 + (i * 7) % 95));
+        const std::string s1 = bytes({0x15, 'a', 'b', 'c', 'd', 0x6E, 0x00, 'X', 'Y', 0x04, 0x00, 0x00, 0x00, 0x1B}) + run +
+                               bytes({0x20, 0x07, 0xAD, 0x04, 'Z', 0x11, 0x00, 0x00});
+        std::string p1 = "abcdabcdXYXY" + run;
+        p1 += p1.substr(12, 40) + "Z";
+        assert(decode(lzo_block(s1, p1), p1.size(), out) && out == p1);
+        assert(!decode(lzo_block(s1, p1), p1.size() - 1, out));
+
+        // A 16400-byte literal run (64 extension bytes), the 3-byte M1 form
+        // that follows a literal run (dist 2072), M4 (len 10, dist 16390,
+        // extended length), end marker.
+        std::string lit;
+        for (int i = 0; i < 16400; ++i) lit.push_back((char)((i * 131 + i / 7) % 251));
+        const std::string s2 = bytes({0x00}) + std::string(64, '\0') + bytes({62}) + lit +
+                               bytes({0x0C, 0x05, 0x10, 0x01, 0x18, 0x00, 0x11, 0x00, 0x00});
+        const std::string p2 = lit + lit.substr(14328, 3) + lit.substr(13, 10);
+        assert(decode(lzo_block(s2, p2), p2.size(), out) && out == p2);
+        // A distance reaching before the start of the output is rejected
+        std::string bad = s2;
+        bad[bad.size() - 5] = 0x00;
+        bad[bad.size() - 4] = 0x01; // dist 16384 + 64 * 256 > output so far
+        assert(!decode(lzo_block(bad, p2), p2.size(), out));
+    }
+
+    // The block's checksum is verified unless switched off
+    {
+        std::string block = BlockDecoderStd::encode(BlockDecoderStd::Lzo, text);
+        block[7] ^= 1;
+        std::string out;
+        assert(BlockDecoderStd::verify_checksums());
+        assert(!decode(block, text.size(), out));
+        BlockDecoderStd::set_verify_checksums(false);
+        assert(decode(block, text.size(), out) && out == text);
+        BlockDecoderStd::set_verify_checksums(true);
+
+        std::string stored = BlockDecoderStd::encode(BlockDecoderStd::Stored, "plain");
+        stored.back() = 'X';
+        assert(!decode(stored, 5, out));
+    }
+
+    // Damaged or mis-sized input fails cleanly
+    {
+        const std::string block = BlockDecoderStd::encode(BlockDecoderStd::Lzo, text);
+        std::string out;
+        assert(!decode(block.substr(0, block.size() / 2), text.size(), out));
+        assert(!decode(block, text.size() - 1, out));
+        assert(!decode(block, text.size() + 1, out));
+        assert(!decode(block.substr(0, 6), 0, out));
+        for (int i = 0; i < 200; ++i) {
+            std::string junk = block.substr(0, 8) + noise(1 + i * 13);
+            decode(junk, 1000, out); // must not crash or overrun
+        }
+        std::string zl = BlockDecoderStd::encode(BlockDecoderStd::Zlib, text);
+        zl[zl.size() - 1] ^= 0x55;
+        assert(!decode(zl, text.size(), out));
+        std::string unknown = block;
+        unknown[0] = 5;
+        assert(!decode(unknown, text.size(), out));
+    }
+
+    // Backends can be replaced per type and restored
+    {
+        CountingBackend counting;
+        BlockDecoderStd::set_backend(BlockDecoderStd::Zlib, &counting);
+        assert(BlockDecoderStd::backend(BlockDecoderStd::Zlib) == &counting);
+        assert(round_trip(BlockDecoderStd::Zlib, text) && counting.calls == 1);
+        BlockDecoderStd::set_backend(BlockDecoderStd::Zlib, nullptr);
+        assert(round_trip(BlockDecoderStd::Zlib, text) && counting.calls == 1);
+        const BlockDecoderStd::Backend* zb = BlockDecoderStd::backend(BlockDecoderStd::Zlib);
+        assert(zb == BlockDecoderStd::libdeflate() || zb == &BlockDecoderStd::zlib());
+        assert(BlockDecoderStd::backend(9) == nullptr);
+    }
+
+    // inflate() for streams of unknown size, bounded by max_out
+    {
+        const std::string big(3u << 20, 'q');
+        uLongf n = compressBound((uLong)big.size());
+        std::string z(n, '\0');
+        assert(compress2((Bytef*)z.data(), &n, (const Bytef*)big.data(), (uLong)big.size(), 6) == Z_OK);
+        z.resize(n);
+        std::string out;
+        assert(BlockDecoderStd::inflate((const unsigned char*)z.data(), z.size(), 8u << 20, out) && out == big);
+        assert(!BlockDecoderStd::inflate((const unsigned char*)z.data(), z.size(), 1u << 20, out));
+        assert(!BlockDecoderStd::inflate((const unsigned char*)"nope", 4, 1024, out));
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "std/definition_cache_std.h"
+#include "std/dictionary_manager_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "definition_cache";
+
+static std::string write_json(const std::string& name, int words, const std::string& tag) {
+    fs::path p = kDir / (name + ".json");
+    fs::path tmp = p; tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out << "{\n  \"name\": \"" << name << "\",\n  \"entries\": [\n";
+        for (int i = 0; i < words; ++i) {
+            out << "    {\"word\":\"" << name << "_w" << i << "\",\"definition\":\"" << tag << " meaning " << i << "\"}";
+            if (i + 1 < words) out << ",";
+            out << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+    static auto stamp = fs::file_time_type::clock::now();
+    stamp += std::chrono::seconds(2);
+    fs::last_write_time(tmp, stamp);
+    fs::rename(tmp, p);
+    return p.string();
+}
+
+static void cache_unit() {
+    // Frequently used entries survive a scan of one-off entries
+    DefinitionCacheStd c(64 * 1024, 1);
+    const std::string def(200, 'x');
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 40; ++i) {
+            const std::string w = "hot" + std::to_string(i);
+            if (!c.get(1, w, nullptr)) c.put(1, w, def);
+        }
+    }
+    c.reset_stats();
+    for (int i = 0; i < 5000; ++i) {
+        const std::string w = "scan" + std::to_string(i);
+        if (!c.get(2, w, nullptr)) c.put(2, w, def);
+    }
+    for (int i = 0; i < 40; ++i) assert(c.get(1, "hot" + std::to_string(i), nullptr));
+    auto s = c.stats();
+    assert(s.rejections > 4000);
+    assert(s.bytes <= 64 * 1024);
+
+    // Values round-trip; invalidation is per dictionary
+    std::string out;
+    c.put(3, "apple", "a fruit");
+    assert(c.get(3, "apple", &out) && out == "a fruit");
+    c.put(3, "apple", "a red fruit");
+    assert(c.get(3, "apple", &out) && out == "a red fruit");
+    assert(c.invalidate_dictionary(1) == 40);
+    assert(!c.get(1, "hot0", nullptr));
+    assert(c.get(3, "apple", nullptr));
+
+    // Entries larger than a shard are never stored; 0 disables
+    c.put(4, "huge", std::string(128 * 1024, 'y'));
+    assert(!c.get(4, "huge", nullptr));
+    c.set_capacity(0);
+    assert(c.stats().entries == 0 && !c.get(3, "apple", nullptr));
+    c.put(3, "apple", "a fruit");
+    assert(!c.get(3, "apple", nullptr));
+
+    // Shrinking evicts at once
+    DefinitionCacheStd d(1024 * 1024, 4);
+    for (int i = 0; i < 2000; ++i) d.put(7, "w" + std::to_string(i), def);
+    d.set_capacity(32 * 1024);
+    assert(d.stats().bytes <= 32 * 1024);
+}
+
+int main() {
+    cache_unit();
+
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    const std::string a = write_json("alpha", 300, "v1");
+    const std::string b = write_json("beta", 300, "other");
+
+    DictionaryManagerStd mgr;
+    assert(mgr.add_dictionary(a) && mgr.add_dictionary(b));
+    mgr.build_index();
+
+    // Repeat lookups are served from the cache without probing the parser
+    assert(mgr.search_word("alpha_w5") == "v1 meaning 5");
+    mgr.reset_lookup_stats();
+    mgr.reset_definition_cache_stats();
+    for (int i = 0; i < 10; ++i) {
+        assert(mgr.search_word("alpha_w5") == "v1 meaning 5");
+        auto all = mgr.search_all("beta_w7");
+        assert(all.size() == 1 && all[0].definition == "other meaning 7");
+    }
+    assert(mgr.lookup_stats().probes == 1);
+    auto s = mgr.definition_cache_stats();
+    assert(s.hits == 19 && s.misses == 1 && s.hit_rate > 0.9);
+
+    // Full-text materialization shares the cache
+    auto first = mgr.full_text_search("meaning", 20);
+    assert(first.size() == 20);
+    mgr.set_fulltext_result_cache_limits(0, 0);
+    mgr.reset_definition_cache_stats();
+    auto again = mgr.full_text_search("meaning", 20);
+    assert(again.size() == first.size());
+    for (size_t i = 0; i < again.size(); ++i) assert(again[i].definition == first[i].definition);
+    assert(mgr.definition_cache_stats().hits >= 20);
+
+    // Reloading a dictionary drops its cached definitions only
+    write_json("alpha", 300, "v2");
+    assert(mgr.reload_changed_dictionaries() == std::vector<std::string>{"alpha"});
+    mgr.reset_lookup_stats();
+    assert(mgr.search_word("alpha_w5") == "v2 meaning 5");
+    assert(mgr.search_all("beta_w7").size() == 1);
+    assert(mgr.lookup_stats().probes == 1);
+
+    // Removal and clearing never serve stale definitions
+    assert(mgr.remove_dictionary("alpha"));
+    assert(mgr.search_word("alpha_w5").empty());
+    assert(mgr.add_dictionary(write_json("alpha", 10, "v3")));
+    assert(mgr.search_word("alpha_w5") == "v3 meaning 5");
+    mgr.clear_dictionaries();
+    assert(mgr.definition_cache_stats().entries == 0);
+
+    // Disabled cache: every lookup probes
+    assert(mgr.add_dictionary(b));
+    mgr.set_definition_cache_limit(0);
+    mgr.reset_lookup_stats();
+    for (int i = 0; i < 3; ++i) assert(mgr.search_word("beta_w1") == "other meaning 1");
+    assert(mgr.lookup_stats().probes == 3);
+
+    // Concurrent readers through the shared shards
+    mgr.set_definition_cache_limit(256 * 1024);
+    std::vector<std::thread> pool;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < 4; ++t) {
+        pool.emplace_back([&, t]() {
+            for (int i = 0; i < 2000; ++i) {
+                const int w = (i * 13 + t) % 300;
+                if (mgr.search_word("beta_w" + std::to_string(w)) != "other meaning " + std::to_string(w)) ++failures;
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    assert(failures == 0);
+    assert(mgr.definition_cache_stats().hits > 0);
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "manager_concurrency";
+
+static void be32(std::ofstream& out, uint32_t v) {
+    unsigned char b[4] = { (unsigned char)((v>>24)&0xFF), (unsigned char)((v>>16)&0xFF), (unsigned char)((v>>8)&0xFF), (unsigned char)(v&0xFF) };
+    out.write((const char*)b, 4);
+}
+
+static std::string write_json(const std::string& name, int words) {
+    fs::path p = kDir / (name + ".json");
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out << "{\n  \"name\": \"" << name << "\",\n  \"entries\": [\n";
+    for (int i = 0; i < words; ++i) {
+        out << "    {\"word\":\"" << name << "_w" << i << "\",\"definition\":\"shared text " << i << " of " << name << "\"}";
+        if (i + 1 < words) out << ",";
+        out << "\n";
+    }
+    out << "  ]\n}\n";
+    return p.string();
+}
+
+static std::string write_stardict() {
+    fs::path base = kDir / "greek";
+    const std::vector<std::pair<std::string, std::string>> entries = {{"alpha", "first letter"}, {"beta", "second letter"}, {"omega", "last letter"}};
+    std::ofstream dict(base.string() + ".dict", std::ios::binary | std::ios::trunc);
+    std::ofstream idx(base.string() + ".idx", std::ios::binary | std::ios::trunc);
+    uint32_t off = 0, idx_size = 0;
+    for (const auto& e : entries) {
+        dict.write(e.second.data(), (std::streamsize)e.second.size());
+        idx.write(e.first.c_str(), (std::streamsize)e.first.size()); idx.put('\0');
+        be32(idx, off); be32(idx, (uint32_t)e.second.size());
+        off += (uint32_t)e.second.size();
+        idx_size += (uint32_t)e.first.size() + 9;
+    }
+    dict.close(); idx.close();
+    std::ofstream ifo(base.string() + ".ifo", std::ios::binary | std::ios::trunc);
+    ifo << "bookname=Greek\nwordcount=3\nidxfilesize=" << idx_size << "\nidxoffsetbits=32\n";
+    return base.string() + ".ifo";
+}
+
+int main() {
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    const std::string core = write_json("core", 200);
+    const std::string greek = write_stardict();
+    const std::string churn = write_json("churn", 50);
+    const std::string extra = write_json("extra", 30);
+    const std::string lazy = write_json("lazy", 30);
+    const int kReaders = 6;
+
+    // Concurrent first full-text queries share a single lazy build
+    {
+        DictionaryManagerStd mgr;
+        assert(mgr.add_dictionary(core));
+        assert(mgr.add_dictionary(greek));
+        std::atomic<bool> go{false};
+        std::vector<std::vector<DictEntryStd>> results(kReaders);
+        std::vector<std::thread> pool;
+        for (int t = 0; t < kReaders; ++t) {
+            pool.emplace_back([&, t]() {
+                while (!go) std::this_thread::yield();
+                results[t] = mgr.full_text_search("shared text", 5);
+            });
+        }
+        go = true;
+        for (auto& th : pool) th.join();
+        assert(mgr.fulltext_stats().index_builds == 1);
+        for (const auto& r : results) {
+            assert(r.size() == 5);
+            assert(r.size() == results[0].size());
+            for (size_t i = 0; i < r.size(); ++i) assert(r[i].word == results[0][i].word);
+        }
+    }
+
+    // Readers against a writer that adds, removes, registers and toggles dictionaries
+    DictionaryManagerStd mgr;
+    assert(mgr.add_dictionary(core));
+    assert(mgr.add_dictionary(greek));
+    assert(mgr.add_dictionary(churn));
+    mgr.build_index();
+
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < kReaders; ++t) {
+        readers.emplace_back([&, t]() {
+            for (int i = 0; !done || i < 200; ++i) {
+                const int w = (i * 7 + t) % 200;
+                const std::string word = "core_w" + std::to_string(w);
+                if (mgr.search_word(word) != "shared text " + std::to_string(w) + " of core") ++failures;
+                if (mgr.search_word("beta") != "second letter") ++failures;
+                auto all = mgr.search_all("omega");
+                if (all.size() != 1 || all[0].definition != "last letter") ++failures;
+                if (mgr.prefix_search("core_w19", 20).empty()) ++failures;
+                if (mgr.exact_search(word).empty()) ++failures;
+                if ((i % 16) == 0) {
+                    bool found = false;
+                    for (const auto& e : mgr.full_text_search("shared core", 300)) {
+                        if (e.dict_name != "core" && e.dict_name != "churn" && e.dict_name != "extra" && e.dict_name != "lazy") ++failures;
+                        if (e.word == word) found = true;
+                    }
+                    if (!found) ++failures;
+                    mgr.dictionaries_meta();
+                    mgr.lookup_stats();
+                }
+                // Writer-owned dictionaries come and go; only check they never return garbage
+                const std::string c = mgr.search_word("churn_w3");
+                if (!c.empty() && c != "shared text 3 of churn") ++failures;
+                const std::string l = mgr.search_word("lazy_w4");
+                if (!l.empty() && l != "shared text 4 of lazy") ++failures;
+            }
+        });
+    }
+
+    for (int round = 0; round < 40; ++round) {
+        mgr.set_dictionary_enabled("churn", (round % 2) == 1);
+        if (round % 3 == 0) {
+            assert(mgr.add_dictionary(extra));
+        } else if (round % 3 == 1) {
+            assert(mgr.register_dictionary(lazy));
+        } else {
+            mgr.remove_dictionary("extra");
+            mgr.remove_dictionary("lazy");
+        }
+        if (round % 5 == 0) mgr.build_index();
+        std::this_thread::yield();
+    }
+    done = true;
+    for (auto& th : readers) th.join();
+    assert(failures == 0);
+
+    // Final state is what the writer left behind: churn enabled, no extra/lazy
+    mgr.remove_dictionary("extra");
+    mgr.remove_dictionary("lazy");
+    assert(mgr.is_dictionary_enabled("churn"));
+    assert(mgr.loaded_dictionaries() == (std::vector<std::string>{"core", "Greek", "churn"}));
+    assert(mgr.search_word("churn_w3") == "shared text 3 of churn");
+    const auto stats = mgr.lookup_stats();
+    assert(stats.lookups >= (uint64_t)kReaders * 200 * 4);
+    return 0;
+}
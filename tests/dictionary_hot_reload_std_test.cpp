@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+#include "std/dictionary_registry_std.h"
+#include "std/mapped_file_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "hot_reload";
+
+// Version v of the "hot" dictionary: words 0..n-1, every definition tagged with v.
+// Files are written next to the target and renamed over it, as editors and sync tools do.
+static void write_hot(const fs::path& p, int version, int n) {
+    fs::path tmp = p; tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out << "{\n  \"name\": \"hot\",\n  \"entries\": [\n";
+        for (int i = 0; i < n; ++i) {
+            out << "    {\"word\":\"hot_w" << i << "\",\"definition\":\"release" << version << " text " << i << "\"}";
+            if (i + 1 < n) out << ",";
+            out << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+    // Make sure the mtime moves even on coarse-grained filesystems
+    static auto stamp = fs::file_time_type::clock::now();
+    stamp += std::chrono::seconds(2);
+    fs::last_write_time(tmp, stamp);
+    fs::rename(tmp, p);
+}
+
+static std::string write_stable() {
+    fs::path p = kDir / "stable.json";
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out << "{\n  \"name\": \"stable\",\n  \"entries\": [\n"
+        << "    {\"word\":\"anchor\",\"definition\":\"never changes release1\"},\n"
+        << "    {\"word\":\"buoy\",\"definition\":\"floats\"}\n  ]\n}\n";
+    return p.string();
+}
+
+static std::vector<std::string> ft_words(const DictionaryManagerStd& m, const std::string& q) {
+    std::vector<std::string> out;
+    for (const auto& e : m.full_text_search(q, 1000)) out.push_back(e.dict_name + "/" + e.word);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// StarDict "inplace" at version v with n entries, written straight over the old
+// files (truncate and rewrite, as `cp new.dict old.dict` does) instead of renamed.
+static std::string write_inplace(int version, int n) {
+    const fs::path base = kDir / "inplace";
+    std::string dict, idx;
+    for (int i = 0; i < n; ++i) {
+        char w[16];
+        std::snprintf(w, sizeof(w), "sd_w%03d", i);
+        const std::string d = "edition" + std::to_string(version) + " entry " + std::to_string(i) + std::string((size_t)(n * 40), '.');
+        idx += w; idx.push_back('\0');
+        for (uint32_t v : {(uint32_t)dict.size(), (uint32_t)d.size()})
+            for (int k = 3; k >= 0; --k) idx.push_back((char)((v >> (8 * k)) & 0xFF));
+        dict += d;
+    }
+    static auto stamp = fs::file_time_type::clock::now() + std::chrono::hours(1);
+    stamp += std::chrono::seconds(2);
+    for (const auto& [ext, bytes] : {std::pair<std::string, std::string>{".dict", dict}, {".idx", idx}}) {
+        std::ofstream(base.string() + ext, std::ios::binary | std::ios::trunc).write(bytes.data(), (std::streamsize)bytes.size());
+        fs::last_write_time(base.string() + ext, stamp);
+    }
+    std::ofstream(base.string() + ".ifo", std::ios::binary | std::ios::trunc)
+        << "StarDict's dict ifo file\nversion=2.4.2\nbookname=inplace\nwordcount=" << n
+        << "\nidxfilesize=" << idx.size() << "\nidxoffsetbits=32\n";
+    fs::last_write_time(base.string() + ".ifo", stamp);
+    return base.string() + ".ifo";
+}
+
+static bool wait_until(const std::function<bool()>& pred) {
+    for (int i = 0; i < 500; ++i) {
+        if (pred()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+int main() {
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    const fs::path hot = kDir / "hot.json";
+    write_hot(hot, 1, 40);
+    const std::string stable = write_stable();
+
+    DictionaryManagerStd mgr;
+    assert(mgr.add_dictionary(stable));
+    assert(mgr.add_dictionary(hot.string()));
+    mgr.build_index();
+    assert(ft_words(mgr, "release1").size() == 41);
+    assert(mgr.fulltext_stats().index_builds == 1);
+    assert(mgr.reload_changed_dictionaries().empty());
+
+    // Replace the file: some words go away, definitions change
+    write_hot(hot, 2, 30);
+    assert(mgr.reload_changed_dictionaries() == std::vector<std::string>{"hot"});
+    assert(mgr.reload_changed_dictionaries().empty());
+    assert(mgr.search_word("hot_w3") == "release2 text 3");
+    assert(mgr.search_word("hot_w35").empty());
+    assert(mgr.exact_search("hot_w35").empty());
+    assert(mgr.prefix_search("hot_w3", 50).size() == 1);
+    assert(mgr.loaded_dictionaries() == (std::vector<std::string>{"stable", "hot"}));
+
+    // The full-text index was patched, not rebuilt, and matches a fresh load
+    assert(mgr.fulltext_stats().index_builds == 1);
+    assert(ft_words(mgr, "release1") == std::vector<std::string>{"stable/anchor"});
+    {
+        DictionaryManagerStd fresh;
+        assert(fresh.add_dictionary(stable) && fresh.add_dictionary(hot.string()));
+        assert(ft_words(mgr, "release2") == ft_words(fresh, "release2"));
+        assert(ft_words(mgr, "release2 OR floats") == ft_words(fresh, "release2 OR floats"));
+        assert(ft_words(mgr, "text -release2") == ft_words(fresh, "text -release2"));
+        assert(ft_words(mgr, "release2").size() == 30);
+    }
+
+    // A broken replacement keeps the old contents and is not retried until it changes again
+    {
+        fs::path tmp = hot; tmp += ".tmp";
+        { std::ofstream out(tmp, std::ios::binary | std::ios::trunc); out << "{ \"name\": \"hot\", \"entries\": [ {\"word\": "; }
+        fs::last_write_time(tmp, fs::file_time_type::clock::now() + std::chrono::seconds(60));
+        fs::rename(tmp, hot);
+    }
+    assert(mgr.reload_changed_dictionaries().empty());
+    assert(mgr.search_word("hot_w3") == "release2 text 3");
+    assert(!mgr.reload_dictionary("hot"));
+    assert(!mgr.reload_dictionary("missing"));
+
+    // Readers never see a half-loaded dictionary while versions are swapped in
+    {
+        std::atomic<bool> done{false};
+        std::atomic<int> failures{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&]() {
+                while (!done) {
+                    const std::string d = mgr.search_word("hot_w7");
+                    if (d.size() < 8 || d.compare(0, 7, "release") != 0 || d.substr(d.size() - 7) != " text 7") ++failures;
+                    if (mgr.search_word("anchor") != "never changes release1") ++failures;
+                    if (ft_words(mgr, "text").size() < 10) ++failures;
+                }
+            });
+        }
+        for (int v = 3; v < 13; ++v) {
+            write_hot(hot, v, 20 + v);
+            assert(mgr.reload_changed_dictionaries().size() == 1);
+        }
+        done = true;
+        for (auto& th : readers) th.join();
+        assert(failures == 0);
+        assert(mgr.search_word("hot_w7") == "release12 text 7");
+    }
+
+    // Watcher-driven reloads: polling, then the native backend where available
+    for (int pass = 0; pass < 2; ++pass) {
+        assert(mgr.start_watching(20, pass == 0));
+        assert(!mgr.start_watching());
+        const int v = 20 + pass;
+        write_hot(hot, v, 15);
+        const std::string want = "release" + std::to_string(v) + " text 5";
+        assert(wait_until([&]() { return mgr.search_word("hot_w5") == want; }));
+        assert(mgr.search_word("hot_w20").empty());
+        mgr.stop_watching();
+    }
+    assert(mgr.fulltext_stats().index_builds == 1);
+
+    // With a registry, reloads while watching (private copies) pick up each new version
+    {
+        const fs::path shared = kDir / "shared.json";
+        write_hot(shared, 1, 10);
+        DictionaryManagerStd reg(std::make_shared<DictionaryRegistryStd>());
+        assert(reg.add_dictionary(shared.string()));
+        assert(reg.start_watching(60000, true));
+        for (int v = 2; v < 4; ++v) {
+            write_hot(shared, v, 10);
+            assert(reg.reload_dictionary("hot"));
+            assert(reg.search_word("hot_w5") == "release" + std::to_string(v) + " text 5");
+        }
+        reg.stop_watching();
+    }
+
+    // Files rewritten in place: while watching, StarDict files are private copies,
+    // so readers never touch a mapping whose file shrank under it
+    {
+        const std::string ifo = write_inplace(1, 200);
+        {
+            MappedFileStd copy;
+            assert(copy.open(ifo, true) && !copy.is_mapped() && copy.size() > 0);
+        }
+        DictionaryManagerStd sd;
+        assert(sd.add_dictionary(ifo));
+        assert(sd.search_word("sd_w007").compare(0, 17, "edition1 entry 7.") == 0);
+        assert(sd.start_watching(20, true)); // swaps the mapped files for copies
+        // A reload may catch the files half-written, so only survival is checked here
+        std::atomic<bool> done{false};
+        std::atomic<size_t> reads{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&]() {
+                while (!done) {
+                    for (int i = 0; i < 200; i += 3) {
+                        char w[16];
+                        std::snprintf(w, sizeof(w), "sd_w%03d", i);
+                        reads += sd.search_word(w).size();
+                    }
+                }
+            });
+        }
+        for (int v = 2; v < 8; ++v) {
+            write_inplace(v, 200 - v * 20); // shorter every time
+            const std::string want = "edition" + std::to_string(v) + " entry 7.";
+            assert(wait_until([&]() { return sd.search_word("sd_w007").compare(0, want.size(), want) == 0; }));
+        }
+        done = true;
+        for (auto& th : readers) th.join();
+        assert(reads > 0);
+        sd.stop_watching();
+    }
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "lazy_activation";
+
+static void be32(std::ofstream& out, uint32_t v) {
+    unsigned char b[4] = { (unsigned char)((v>>24)&0xFF), (unsigned char)((v>>16)&0xFF), (unsigned char)((v>>8)&0xFF), (unsigned char)(v&0xFF) };
+    out.write((const char*)b, 4);
+}
+
+static std::string write_json(const std::string& name, int words) {
+    fs::path p = kDir / (name + ".json");
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out << "{\n  \"name\": \"" << name << "\",\n  \"description\": \"about " << name << "\",\n  \"entries\": [\n";
+    for (int i = 0; i < words; ++i) {
+        out << "    {\"word\":\"" << name << "_w" << i << "\",\"definition\":\"def " << i << " of " << name << "\"}";
+        if (i + 1 < words) out << ",";
+        out << "\n";
+    }
+    out << "  ]\n}\n";
+    return p.string();
+}
+
+static std::string write_stardict() {
+    fs::path base = kDir / "lazysd";
+    const std::vector<std::pair<std::string, std::string>> entries = {{"alpha", "first letter"}, {"omega", "last letter"}};
+    std::ofstream dict(base.string() + ".dict", std::ios::binary | std::ios::trunc);
+    std::ofstream idx(base.string() + ".idx", std::ios::binary | std::ios::trunc);
+    uint32_t off = 0, idx_size = 0;
+    for (const auto& e : entries) {
+        dict.write(e.second.data(), (std::streamsize)e.second.size());
+        idx.write(e.first.c_str(), (std::streamsize)e.first.size()); idx.put('\0');
+        be32(idx, off); be32(idx, (uint32_t)e.second.size());
+        off += (uint32_t)e.second.size();
+        idx_size += (uint32_t)e.first.size() + 9;
+    }
+    dict.close(); idx.close();
+    std::ofstream ifo(base.string() + ".ifo", std::ios::binary | std::ios::trunc);
+    ifo << "bookname=Lazy StarDict\nwordcount=2\nidxfilesize=" << idx_size << "\nidxoffsetbits=32\ndescription=greek letters\n";
+    return base.string() + ".ifo";
+}
+
+static std::string write_dsl() {
+    fs::path p = kDir / "lazy.dsl";
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out << "#NAME \"Lazy DSL\"\n#INDEX_LANGUAGE \"English\"\n\nhello\nA greeting.\n\nworld\nThe earth.\n";
+    return p.string();
+}
+
+static std::vector<std::string> sorted(std::vector<std::string> v) { std::sort(v.begin(), v.end()); return v; }
+
+int main() {
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    std::vector<std::string> paths = {write_json("lazyA", 40), write_stardict(), write_dsl(), write_json("lazyB", 25)};
+
+    DictionaryManagerStd eager;
+    for (const auto& p : paths) assert(eager.add_dictionary(p));
+    eager.build_index();
+
+    // Registration reads headers only; listing and metadata work immediately
+    DictionaryManagerStd lazy;
+    for (const auto& p : paths) assert(lazy.register_dictionary(p));
+    assert(!lazy.register_dictionary((kDir / "missing.json").string()));
+    assert(!lazy.register_dictionary((kDir / "notes.xyz").string()));
+    assert(lazy.pending_dictionary_count() == 4);
+    assert(lazy.loaded_dictionaries() == eager.loaded_dictionaries());
+    auto meta = lazy.dictionaries_meta();
+    assert(meta.size() == 4);
+    assert(meta[0].name == "lazyA" && meta[0].description == "about lazyA" && meta[0].word_count == -1);
+    assert(meta[1].name == "Lazy StarDict" && meta[1].word_count == 2 && meta[1].description == "greek letters");
+    assert(meta[2].name == "Lazy DSL");
+    assert(!lazy.is_dictionary_active("lazyA"));
+
+    // Explicit warmup of one dictionary
+    auto rep = lazy.warmup_dictionaries({"lazyB"});
+    assert(rep.size() == 1 && rep[0].ok && rep[0].word_count == 25);
+    assert(lazy.is_dictionary_active("lazyB") && lazy.pending_dictionary_count() == 3);
+
+    // Disabled dictionaries stay dormant through ordinary lookups
+    assert(lazy.set_dictionary_enabled("Lazy DSL", false));
+    assert(lazy.search_word("alpha") == "first letter");
+    assert(lazy.pending_dictionary_count() == 1 && !lazy.is_dictionary_active("Lazy DSL"));
+    assert(lazy.search_all("hello", true).size() == 1);
+    assert(lazy.pending_dictionary_count() == 0);
+    assert(lazy.set_dictionary_enabled("Lazy DSL", true));
+
+    // Once active, observable state matches an eager load
+    assert(lazy.fulltext_signature() == eager.fulltext_signature());
+    assert(lazy.indexed_word_count() == eager.indexed_word_count());
+    assert(sorted(lazy.prefix_search("lazya_w1", 50)) == sorted(eager.prefix_search("lazya_w1", 50)));
+    assert(lazy.search_word("lazyA_w7") == eager.search_word("lazyA_w7"));
+    assert(lazy.full_text_search("earth", 5).size() == 1);
+    meta = lazy.dictionaries_meta();
+    assert(meta[0].word_count == 40);
+
+    // First index query activates everything pending
+    DictionaryManagerStd first;
+    for (const auto& p : paths) first.register_dictionary(p);
+    assert(sorted(first.prefix_search("lazyb_w2", 50)) == sorted(eager.prefix_search("lazyb_w2", 50)));
+    assert(first.pending_dictionary_count() == 0);
+
+    // Activation parses outside the manager lock: while the first query parses a
+    // large dictionary, other calls still answer (the dictionary is still pending)
+    {
+        const std::string big = write_json("lazyBig", 20000);
+        DictionaryManagerStd slow;
+        assert(slow.register_dictionary(big) && slow.register_dictionary(paths[0]));
+        assert(slow.warmup_dictionaries({"lazyA"}).size() == 1);
+        std::atomic<bool> done{false};
+        std::thread q([&] { assert(slow.search_word("lazyBig_w19999") == "def 19999 of lazyBig"); done = true; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const size_t pending = slow.pending_dictionary_count();
+        const bool still_parsing = !done;
+        q.join();
+        assert(!still_parsing || pending == 1);
+        assert(slow.pending_dictionary_count() == 0 && slow.search_word("lazyA_w3") == "def 3 of lazyA");
+
+        // Concurrent first queries share one activation
+        DictionaryManagerStd many;
+        for (const auto& p : paths) many.register_dictionary(p);
+        std::vector<std::thread> ts;
+        std::atomic<int> ok{0};
+        for (int t = 0; t < 4; ++t) ts.emplace_back([&] { if (many.search_word("omega") == "last letter") ++ok; });
+        for (auto& t : ts) t.join();
+        assert(ok == 4 && many.indexed_word_count() == eager.indexed_word_count());
+    }
+
+    // A file whose header reads but whose body does not stays listed without entries
+    fs::path broken = kDir / "broken.json";
+    { std::ofstream out(broken, std::ios::binary | std::ios::trunc); out << "{\"name\": \"Broken\"}"; }
+    DictionaryManagerStd bad;
+    assert(bad.register_dictionary(broken.string()) && bad.register_dictionary(paths[0]));
+    auto br = bad.warmup_dictionaries();
+    assert(br.size() == 2 && !br[0].ok && br[1].ok);
+    assert(bad.loaded_dictionaries().size() == 2 && bad.pending_dictionary_count() == 0);
+    assert(bad.search_word("lazyA_w1") == "def 1 of lazyA");
+
+    // Background warmup is adopted by queries; stopping or destroying mid-flight is safe
+    DictionaryManagerStd bg;
+    for (const auto& p : paths) bg.register_dictionary(p);
+    bg.start_background_warmup();
+    bg.stop_background_warmup();
+    assert(bg.search_word("omega") == "last letter");
+    assert(bg.pending_dictionary_count() == 0);
+    {
+        DictionaryManagerStd quit;
+        for (const auto& p : paths) quit.register_dictionary(p);
+        quit.start_background_warmup();
+    }
+    DictionaryManagerStd cleared;
+    for (const auto& p : paths) cleared.register_dictionary(p);
+    cleared.start_background_warmup();
+    cleared.clear_dictionaries();
+    assert(cleared.loaded_dictionaries().empty());
+    return 0;
+}
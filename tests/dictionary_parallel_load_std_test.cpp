@@ -0,0 +1,64 @@
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static std::string write_json(const std::string& name, int words) {
+    fs::path p = fs::current_path() / "build-local" / "parallel_load" / (name + ".json");
+    fs::create_directories(p.parent_path());
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out << "{\n  \"name\": \"" << name << "\",\n  \"entries\": [\n";
+    for (int i = 0; i < words; ++i) {
+        out << "    {\"word\":\"" << name << "_w" << i << "\",\"definition\":\"def " << i << " of " << name << "\"}";
+        if (i + 1 < words) out << ",";
+        out << "\n";
+    }
+    out << "  ]\n}\n";
+    return p.string();
+}
+
+int main() {
+    std::vector<std::string> paths;
+    for (int d = 0; d < 12; ++d) paths.push_back(write_json("pdict" + std::to_string(d), 50 + d * 7));
+    // Failures in the middle must not disturb ordering of the rest
+    paths.insert(paths.begin() + 3, (fs::current_path() / "build-local" / "parallel_load" / "missing.json").string());
+    paths.insert(paths.begin() + 7, (fs::current_path() / "build-local" / "parallel_load" / "notes.xyz").string());
+
+    DictionaryManagerStd seq;
+    for (const auto& p : paths) seq.add_dictionary(p);
+
+    DictionaryManagerStd par;
+    auto reports = par.add_dictionaries(paths, 4);
+    assert(reports.size() == paths.size());
+    int ok = 0;
+    for (size_t i = 0; i < reports.size(); ++i) {
+        assert(reports[i].path == paths[i]);
+        if (reports[i].ok) {
+            ++ok;
+            assert(!reports[i].name.empty() && reports[i].word_count > 0 && reports[i].millis >= 0.0);
+        } else {
+            assert(!reports[i].error.empty());
+        }
+    }
+    assert(ok == 12);
+    assert(!reports[3].ok && !reports[7].ok);
+
+    // Same observable state as a sequential load
+    assert(par.loaded_dictionaries() == seq.loaded_dictionaries());
+    assert(par.fulltext_signature() == seq.fulltext_signature());
+    assert(par.indexed_word_count() == seq.indexed_word_count());
+    auto hits = par.search_all("pdict5_w3");
+    assert(hits.size() == 1 && hits[0].dict_name == "pdict5");
+
+    // Single-threaded and empty batches
+    DictionaryManagerStd one;
+    assert(one.add_dictionaries({paths[0]}, 1).at(0).ok);
+    assert(DictionaryManagerStd().add_dictionaries({}).empty());
+    return 0;
+}
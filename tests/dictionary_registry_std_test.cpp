@@ -0,0 +1,165 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+#include "std/dictionary_registry_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "dictionary_registry";
+
+static std::string write_json(const std::string& name, const std::string& text) {
+    fs::path p = kDir / (name + ".json");
+    {
+        std::ofstream out(p, std::ios::binary | std::ios::trunc);
+        out << "{\n  \"name\": \"" << name << "\",\n  \"entries\": [\n"
+            << "    {\"word\":\"shared\",\"definition\":\"" << text << " one\"},\n"
+            << "    {\"word\":\"" << name << "_only\",\"definition\":\"" << text << " two\"},\n"
+            << "    {\"word\":\"Shared\",\"definition\":\"" << text << " three\"}\n  ]\n}\n";
+    }
+    static auto stamp = fs::file_time_type::clock::now();
+    stamp += std::chrono::seconds(2);
+    fs::last_write_time(p, stamp);
+    return p.string();
+}
+
+int main() {
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    const std::string a = write_json("alpha", "alpha text");
+    const std::string b = write_json("beta", "beta text");
+
+    // Segment unit: normalized, sorted, first spelling kept, duplicates counted
+    {
+        std::vector<std::string> words{"Beta", "alpha", " ALPHA ", "alphabet", "", "gamma"};
+        IndexSegmentStd seg{HeadwordViewStd(words)};
+        assert(seg.size() == 4);
+        size_t i = 0;
+        assert(seg.find("alpha", i) && seg.word(i) == "alpha" && seg.frequency(i) == 2);
+        assert(!seg.find("Alpha", i));
+        auto r = seg.prefix_range("alp");
+        assert(r.second - r.first == 2 && seg.key(r.first) == "alpha" && seg.key(r.first + 1) == "alphabet");
+        r = seg.prefix_range("zz");
+        assert(r.first == r.second);
+    }
+
+    auto registry = std::make_shared<DictionaryRegistryStd>();
+    {
+        DictionaryManagerStd plain;
+        assert(plain.add_dictionary(a) && plain.add_dictionary(b));
+        plain.build_index();
+
+        DictionaryManagerStd first(registry), second(registry);
+        assert(first.add_dictionary(a) && first.add_dictionary(b));
+        auto reports = second.add_dictionaries({b, (kDir / "." / "alpha.json").string(), (kDir / "missing.json").string()});
+        assert(reports[0].ok && reports[1].ok && !reports[2].ok);
+        auto st = registry->stats();
+        assert(st.loads == 2 && st.reuses == 2 && st.live == 2);
+        first.build_index();
+        second.build_index();
+
+        // Shared segments answer exactly like a private index
+        for (const auto* m : {&first, &second}) {
+            assert(m->indexed_word_count() == plain.indexed_word_count());
+            assert(m->exact_search("SHARED") == plain.exact_search("SHARED"));
+            assert(m->prefix_search("al", 10).size() == 1 && m->prefix_search("al", 10)[0] == "alpha_only");
+            assert(m->prefix_search("", 100).size() == 3);
+            assert(m->fuzzy_search("sharde", 10).size() == 1);
+            assert(m->wildcard_search("*_only", 10).size() == 2);
+            assert(m->regex_search("^beta", 10).size() == 1);
+            assert(m->all_indexed_words().size() == 3);
+            assert(m->dictionaries_for_word("shared").size() == 2);
+        }
+
+        // Order and enabled flags are per view
+        assert(first.search_all("shared")[0].dict_name == "alpha");
+        assert(second.search_all("shared")[0].dict_name == "beta");
+        assert(first.set_dictionary_order({"beta"}));
+        assert(first.loaded_dictionaries() == std::vector<std::string>({"beta", "alpha"}));
+        assert(first.search_all("shared")[0].dict_name == "beta");
+        assert(!first.set_dictionary_order({"nowhere"}));
+        assert(first.set_dictionary_enabled("alpha", false));
+        assert(first.search_all("shared").size() == 1);
+        assert(second.search_all("shared").size() == 2);
+        assert(first.full_text_search("alpha", 10).empty());
+        assert(!second.full_text_search("alpha", 10).empty());
+
+        // Persisted word index folds the segments in and loads back into a plain index
+        const std::string idx = (kDir / "words.index").string();
+        assert(second.save_index(idx));
+        DictionaryManagerStd loaded;
+        assert(loaded.load_index(idx));
+        assert(loaded.indexed_word_count() == 3 && loaded.dictionaries_for_word("shared").size() == 2);
+
+        // Removing from one view leaves the others alone
+        assert(second.remove_dictionary("alpha"));
+        assert(second.indexed_word_count() == 2 && second.prefix_search("al", 10).empty());
+        assert(first.indexed_word_count() == 3);
+        assert(registry->stats().live == 2);
+
+        // A changed file is a new entry; untouched views keep the old version
+        write_json("beta", "beta edited");
+        assert(first.reload_changed_dictionaries() == std::vector<std::string>({"beta"}));
+        assert(first.search_word("beta_only", true) == "beta edited two");
+        assert(second.search_word("beta_only") == "beta text two");
+        assert(registry->stats().loads == 3 && registry->stats().live == 3);
+        assert(second.reload_changed_dictionaries().size() == 1);
+        assert(second.search_word("beta_only") == "beta edited two");
+        st = registry->stats();
+        assert(st.loads == 3 && st.live == 2);
+    }
+    // The last view gone, the entries go too
+    assert(registry->stats().live == 0);
+
+    // Concurrent first loads of one file parse it once
+    {
+        const int n = 8;
+        std::vector<std::unique_ptr<DictionaryManagerStd>> views;
+        for (int i = 0; i < n; ++i) views.push_back(std::make_unique<DictionaryManagerStd>(registry));
+        std::atomic<int> ok{0};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < n; ++i) threads.emplace_back([&, i]() { if (views[i]->add_dictionary(a)) ++ok; });
+        for (auto& t : threads) t.join();
+        assert(ok == n);
+        const auto st = registry->stats();
+        assert(st.loads == 4 && st.live == 1);
+        for (auto& v : views) assert(v->search_word("alpha_only") == "alpha text two");
+    }
+
+    // Entries expiring while others acquire the same key are reloaded, never
+    // waited on without a pending load
+    {
+        auto reg = std::make_shared<DictionaryRegistryStd>();
+        std::atomic<int> failures{0};
+        auto churn = [&]() {
+            for (int i = 0; i < 10000; ++i) {
+                auto e = reg->acquire("churn", "fp", [](SharedDictionaryStd& out, std::string*) {
+                    out.name = "churn";
+                    return true;
+                }, nullptr, nullptr);
+                if (!e || e->name != "churn") ++failures;
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) threads.emplace_back(churn);
+        for (auto& t : threads) t.join();
+        assert(failures == 0 && reg->stats().live == 0);
+    }
+
+    // The process-wide registry is one instance
+    assert(DictionaryRegistryStd::global() == DictionaryRegistryStd::global());
+    {
+        DictionaryManagerStd x(DictionaryRegistryStd::global()), y(DictionaryRegistryStd::global());
+        assert(x.add_dictionary(a) && y.add_dictionary(a));
+        assert(DictionaryRegistryStd::global()->stats().reuses >= 1);
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static std::string write_json(const std::string& name, const std::vector<std::string>& words) {
+    fs::path p = fs::current_path() / "build-local" / "routed_lookup" / (name + ".json");
+    fs::create_directories(p.parent_path());
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out << "{\n  \"name\": \"" << name << "\",\n  \"entries\": [\n";
+    for (size_t i = 0; i < words.size(); ++i) {
+        out << "    {\"word\":\"" << words[i] << "\",\"definition\":\"" << name << " says " << words[i] << "\"}";
+        if (i + 1 < words.size()) out << ",";
+        out << "\n";
+    }
+    out << "  ]\n}\n";
+    return p.string();
+}
+
+int main() {
+    DictionaryManagerStd mgr;
+    std::vector<std::string> paths;
+    for (int d = 0; d < 20; ++d) {
+        std::vector<std::string> w = {"shared", "only" + std::to_string(d)};
+        if (d % 5 == 0) w.push_back("fifth");
+        paths.push_back(write_json("route" + std::to_string(d), w));
+    }
+    for (auto& p : paths) assert(mgr.add_dictionary(p));
+    mgr.build_index();
+
+    // A miss touches no dictionary
+    mgr.reset_lookup_stats();
+    assert(mgr.search_all("nothing-here").empty());
+    assert(mgr.search_word("nothing-here").empty());
+    auto s = mgr.lookup_stats();
+    assert(s.routed && s.lookups == 2 && s.probes == 0);
+
+    // Only holders containing the word are probed; order is load order
+    mgr.reset_lookup_stats();
+    auto one = mgr.search_all("only7");
+    assert(one.size() == 1 && one[0].dict_name == "route7");
+    auto fifth = mgr.search_all("fifth");
+    assert(fifth.size() == 4 && fifth[0].dict_name == "route0" && fifth[3].dict_name == "route15");
+    s = mgr.lookup_stats();
+    assert(s.probes == 5);
+    assert(mgr.search_all("shared").size() == 20);
+
+    // Disabled dictionaries are skipped without probing
+    assert(mgr.set_dictionary_enabled("route7", false));
+    mgr.reset_lookup_stats();
+    assert(mgr.search_all("only7").empty());
+    assert(mgr.lookup_stats().probes == 0);
+    assert(mgr.search_all("only7", true).size() == 1);
+    assert(mgr.set_dictionary_enabled("route7", true));
+
+    // Removal keeps routing consistent
+    assert(mgr.remove_dictionary("route0"));
+    fifth = mgr.search_all("fifth");
+    assert(fifth.size() == 3 && fifth[0].dict_name == "route5");
+    assert(mgr.search_word("only19") == "route19 says only19");
+
+    // After loading a persisted word index, lookups fall back to probing everything
+    fs::path idx = fs::current_path() / "build-local" / "routed_lookup" / "words.index";
+    assert(mgr.save_index(idx.string()));
+    assert(mgr.load_index(idx.string()));
+    mgr.reset_lookup_stats();
+    assert(mgr.search_all("only3").size() == 1);
+    s = mgr.lookup_stats();
+    assert(!s.routed && s.probes == 19);
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+#include "std/dict_snapshot_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "dict_snapshot";
+
+static void be32(std::ofstream& out, uint32_t v) {
+    unsigned char b[4] = { (unsigned char)((v>>24)&0xFF), (unsigned char)((v>>16)&0xFF), (unsigned char)((v>>8)&0xFF), (unsigned char)(v&0xFF) };
+    out.write((const char*)b, 4);
+}
+
+static std::string write_json(int words, const std::string& suffix) {
+    fs::path p = kDir / "snapjson.json";
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out << "{\n  \"name\": \"SnapJson\",\n  \"description\": \"json sample\",\n  \"entries\": [\n";
+    for (int i = 0; i < words; ++i) {
+        out << "    {\"word\":\"word" << i << "\",\"definition\":\"meaning " << i << suffix << "\"}";
+        if (i + 1 < words) out << ",";
+        out << "\n";
+    }
+    out << "  ]\n}\n";
+    return p.string();
+}
+
+static std::string write_csv() {
+    fs::path p = kDir / "snapcsv.csv";
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out << "Apple,a red fruit\nbanana,a yellow fruit\ncherry,\"a small, round fruit\"\n";
+    return p.string();
+}
+
+static std::string write_stardict() {
+    fs::path base = kDir / "snapsd";
+    const std::vector<std::pair<std::string, std::string>> entries = {
+        {"alpha", "first letter"}, {"beta", "second letter"}, {"gamma", "third letter"}};
+    std::ofstream dict(base.string() + ".dict", std::ios::binary | std::ios::trunc);
+    std::ofstream idx(base.string() + ".idx", std::ios::binary | std::ios::trunc);
+    uint32_t off = 0, idx_size = 0;
+    for (const auto& e : entries) {
+        dict.write(e.second.data(), (std::streamsize)e.second.size());
+        idx.write(e.first.c_str(), (std::streamsize)e.first.size()); idx.put('\0');
+        be32(idx, off); be32(idx, (uint32_t)e.second.size());
+        off += (uint32_t)e.second.size();
+        idx_size += (uint32_t)e.first.size() + 9;
+    }
+    dict.close(); idx.close();
+    std::ofstream ifo(base.string() + ".ifo", std::ios::binary | std::ios::trunc);
+    ifo << "bookname=SnapSD\nwordcount=" << entries.size() << "\nidxfilesize=" << idx_size << "\nidxoffsetbits=32\ndescription=greek\n";
+    return base.string() + ".ifo";
+}
+
+static void check_same(const DictionaryManagerStd& a, const DictionaryManagerStd& b, const std::vector<std::string>& words) {
+    assert(a.loaded_dictionaries() == b.loaded_dictionaries());
+    assert(a.fulltext_signature() == b.fulltext_signature());
+    assert(a.indexed_word_count() == b.indexed_word_count());
+    assert(a.all_indexed_words() == b.all_indexed_words());
+    auto ma = a.dictionaries_meta(), mb = b.dictionaries_meta();
+    assert(ma.size() == mb.size());
+    for (size_t i = 0; i < ma.size(); ++i) {
+        assert(ma[i].name == mb[i].name && ma[i].word_count == mb[i].word_count && ma[i].description == mb[i].description);
+    }
+    for (const auto& w : words) {
+        auto ha = a.search_all(w), hb = b.search_all(w);
+        assert(ha.size() == hb.size());
+        for (size_t i = 0; i < ha.size(); ++i) assert(ha[i].dict_name == hb[i].dict_name && ha[i].definition == hb[i].definition);
+    }
+}
+
+int main() {
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    const std::string snaps = (kDir / "snaps").string();
+    std::vector<std::string> paths = {write_json(200, ""), write_csv(), write_stardict()};
+    const std::vector<std::string> probes = {"word0", "word199", "apple", "Apple", "BANANA", "cherry", "alpha", "gamma", "missing"};
+
+    DictionaryManagerStd plain;
+    for (const auto& r : plain.add_dictionaries(paths, 1)) assert(r.ok && !r.from_snapshot);
+    plain.build_index();
+
+    // Cold load parses and writes snapshots
+    DictionaryManagerStd cold;
+    assert(!cold.load_snapshots_enabled());
+    cold.set_load_snapshots(true, snaps);
+    assert(cold.load_snapshots_enabled());
+    for (const auto& r : cold.add_dictionaries(paths, 2)) assert(r.ok && !r.from_snapshot);
+    cold.build_index();
+    for (const auto& p : paths) assert(fs::exists(DictSnapshotStd::snapshot_path(snaps, p)));
+    check_same(plain, cold, probes);
+
+    // Warm load attaches every snapshot and answers identically
+    DictionaryManagerStd warm;
+    warm.set_load_snapshots(true, snaps);
+    for (const auto& r : warm.add_dictionaries(paths, 2)) assert(r.ok && r.from_snapshot);
+    warm.build_index();
+    check_same(plain, warm, probes);
+    assert(warm.search_word("banana") == "a yellow fruit");
+    assert(warm.search_word("beta") == "second letter");
+    assert(warm.full_text_search("yellow", 5).size() == 1);
+    DictionaryManagerStd single;
+    single.set_load_snapshots(true, snaps);
+    assert(single.add_dictionary(paths[2]) && single.search_word("gamma") == "third letter");
+
+    // Editing a source (new size and mtime) invalidates its snapshot only
+    write_json(201, " (v2)");
+    fs::last_write_time(paths[0], fs::last_write_time(paths[0]) + std::chrono::seconds(5));
+    DictionaryManagerStd edited;
+    edited.set_load_snapshots(true, snaps);
+    auto rep = edited.add_dictionaries(paths, 2);
+    assert(rep[0].ok && !rep[0].from_snapshot && rep[0].word_count == 201);
+    assert(rep[1].from_snapshot && rep[2].from_snapshot);
+    assert(edited.search_word("word200") == "meaning 200 (v2)");
+    DictionaryManagerStd rewarm;
+    rewarm.set_load_snapshots(true, snaps);
+    assert(rewarm.add_dictionaries(paths, 1)[0].from_snapshot);
+    assert(rewarm.search_word("word3") == "meaning 3 (v2)");
+
+    // Touching a companion file invalidates too
+    fs::path dict = kDir / "snapsd.dict";
+    fs::last_write_time(dict, fs::last_write_time(dict) + std::chrono::seconds(5));
+    DictionaryManagerStd touched;
+    touched.set_load_snapshots(true, snaps);
+    assert(!touched.add_dictionaries({paths[2]}).at(0).from_snapshot);
+    assert(touched.search_word("alpha") == "first letter");
+
+    // Corrupt or mismatched snapshot files are ignored
+    const std::string csv_snap = DictSnapshotStd::snapshot_path(snaps, paths[1]);
+    DictSnapshotStd s;
+    assert(s.attach(csv_snap, DictSnapshotStd::fingerprint({paths[1]})));
+    assert(s.word_count() == 3 && s.lookup("APPLE") == "a red fruit" && s.lookup("kiwi").empty());
+    assert(!s.attach(csv_snap, "other fingerprint"));
+    fs::resize_file(csv_snap, fs::file_size(csv_snap) - 8);
+    assert(!s.attach(csv_snap, DictSnapshotStd::fingerprint({paths[1]})));
+    DictionaryManagerStd repaired;
+    repaired.set_load_snapshots(true, snaps);
+    auto rr = repaired.add_dictionaries({paths[1]});
+    assert(rr[0].ok && !rr[0].from_snapshot && repaired.search_word("cherry") == "a small, round fruit");
+    assert(s.attach(csv_snap, DictSnapshotStd::fingerprint({paths[1]})));
+
+    // Disabled by default and after opting out
+    DictionaryManagerStd off;
+    off.set_load_snapshots(true, snaps);
+    off.set_load_snapshots(false);
+    assert(!off.add_dictionaries(paths, 1)[1].from_snapshot);
+    return 0;
+}
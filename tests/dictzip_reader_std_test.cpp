@@ -0,0 +1,219 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "std/dictionary_manager_std.h"
+#include "std/dictzip_reader_std.h"
+#include "std/dsl_parser_std.h"
+#include "std/stardict_parser_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "dictzip_reader";
+
+static void le16(std::string& out, uint16_t v) { out.push_back((char)(v & 0xFF)); out.push_back((char)(v >> 8)); }
+static void le32(std::string& out, uint32_t v) { for (int i = 0; i < 4; ++i) out.push_back((char)((v >> (8 * i)) & 0xFF)); }
+
+// dictzip as dictzip(1) writes it: raw deflate fully flushed every chlen input
+// bytes, chunk sizes in the gzip "RA" extra field, plus a file name.
+static void write_dictzip(const fs::path& path, const std::string& data, uint16_t chlen) {
+    z_stream zs{};
+    int rc = deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    assert(rc == Z_OK);
+    std::string body;
+    std::vector<uint16_t> sizes;
+    for (size_t pos = 0; pos < data.size(); pos += chlen) {
+        const size_t n = std::min<size_t>(chlen, data.size() - pos);
+        const bool last = pos + n >= data.size();
+        std::string out(deflateBound(&zs, (uLong)n) + 64, '\0');
+        zs.next_in = (Bytef*)data.data() + pos; zs.avail_in = (uInt)n;
+        zs.next_out = (Bytef*)out.data(); zs.avail_out = (uInt)out.size();
+        rc = deflate(&zs, last ? Z_FINISH : Z_FULL_FLUSH);
+        assert(rc == (last ? Z_STREAM_END : Z_OK) && zs.avail_in == 0);
+        out.resize(out.size() - zs.avail_out);
+        sizes.push_back((uint16_t)out.size());
+        body += out;
+    }
+    deflateEnd(&zs);
+    std::string extra = "RA";
+    le16(extra, (uint16_t)(6 + 2 * sizes.size()));
+    le16(extra, 1); le16(extra, chlen); le16(extra, (uint16_t)sizes.size());
+    for (uint16_t s : sizes) le16(extra, s);
+    std::string file = {'\x1f', '\x8b', 8, 0x04 | 0x08, 0, 0, 0, 0, 2, 3};
+    le16(file, (uint16_t)extra.size());
+    file += extra;
+    file += path.filename().string();
+    file.push_back('\0');
+    file += body;
+    le32(file, (uint32_t)crc32(0, (const Bytef*)data.data(), (uInt)data.size()));
+    le32(file, (uint32_t)data.size());
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(file.data(), (std::streamsize)file.size());
+}
+
+static void write_gzip(const fs::path& path, const std::string& data) {
+    gzFile gz = gzopen(path.string().c_str(), "wb");
+    assert(gz);
+    gzwrite(gz, data.data(), (unsigned)data.size());
+    gzclose(gz);
+}
+
+static void be32(std::ofstream& out, uint32_t v) {
+    for (int i = 3; i >= 0; --i) out.put((char)((v >> (8 * i)) & 0xFF));
+}
+
+static std::string def_for(int i) { return "meaning " + std::to_string(i) + " " + std::string((size_t)(i % 50), '~'); }
+
+// StarDict whose .dict.dz is written by writer; returns the .ifo path.
+template <typename Writer>
+static std::string write_stardict(const std::string& name, int n, Writer writer) {
+    const fs::path base = kDir / name;
+    std::string dict;
+    std::ofstream idx(base.string() + ".idx", std::ios::binary | std::ios::trunc);
+    uint32_t idx_size = 0;
+    for (int i = 0; i < n; ++i) {
+        char w[16];
+        std::snprintf(w, sizeof(w), "w%05d", i);
+        const std::string d = def_for(i);
+        idx.write(w, 6); idx.put('\0'); be32(idx, (uint32_t)dict.size()); be32(idx, (uint32_t)d.size());
+        idx_size += 15;
+        dict += d;
+    }
+    writer(fs::path(base.string() + ".dict.dz"), dict);
+    std::ofstream ifo(base.string() + ".ifo", std::ios::binary | std::ios::trunc);
+    ifo << "StarDict's dict ifo file\nversion=2.4.2\nbookname=" << name << "\nwordcount=" << n
+        << "\nidxfilesize=" << idx_size << "\nidxoffsetbits=32\n";
+    return base.string() + ".ifo";
+}
+
+static size_t files_in(const fs::path& dir) {
+    std::error_code ec;
+    size_t n = 0;
+    for (auto it = fs::recursive_directory_iterator(dir, ec); !ec && it != fs::recursive_directory_iterator(); ++it) ++n;
+    return n;
+}
+
+int main() {
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    const fs::path cache = kDir / "cache";
+#ifdef _WIN32
+    _putenv_s("UNIDICT_CACHE_DIR", cache.string().c_str());
+#else
+    setenv("UNIDICT_CACHE_DIR", cache.string().c_str(), 1);
+#endif
+
+    std::string text;
+    for (int i = 0; text.size() < 300000; ++i) text += "line " + std::to_string(i * 7919 % 100003) + " of the sample text\n";
+
+    // Reader: random ranges inflate only the chunks they cover
+    {
+        write_dictzip(kDir / "text.dz", text, 4096);
+        DictzipReaderStd r;
+        assert(r.open((kDir / "text.dz").string()));
+        assert(r.random_access() && r.size() == text.size());
+        std::string out;
+        assert(r.read(100000, 50, out) && out == text.substr(100000, 50));
+        assert(r.stats().inflated == 2); // the last chunk (for the size) and this one
+        assert(r.read(100010, 20, out) && out == text.substr(100010, 20));
+        assert(r.stats().inflated == 2 && r.stats().cache_hits == 1);
+        assert(r.read(4090, 10000, out) && out == text.substr(4090, 10000)); // spans four chunks
+        assert(r.read(text.size() - 5, 5, out) && out == text.substr(text.size() - 5));
+        assert(r.read(0, 0, out) && out.empty());
+        assert(!r.read(text.size() - 5, 6, out));
+        assert(r.read_all(out) && out == text);
+        r.set_cache_chunks(2);
+        for (uint64_t off = 0; off + 64 < text.size(); off += 7777) {
+            assert(r.read(off, 64, out) && out == text.substr(off, 64));
+        }
+    }
+    // Plain gzip opens too, without random access
+    {
+        write_gzip(kDir / "plain.gz", text);
+        DictzipReaderStd r;
+        assert(r.open((kDir / "plain.gz").string()));
+        assert(!r.random_access() && r.size() == text.size());
+        std::string out;
+        assert(r.read(250000, 100, out) && out == text.substr(250000, 100));
+        assert(r.read(10, 100, out) && out == text.substr(10, 100));
+        std::ofstream(kDir / "junk.dz") << "not gzip at all";
+        assert(!r.open((kDir / "junk.dz").string()) && !r.is_open());
+        assert(!r.open((kDir / "missing.dz").string()));
+    }
+
+    // StarDict: dictzip is read in place, nothing is decompressed into the cache
+    const int n = 3000;
+    const std::string dz_ifo = write_stardict("zipped", n, [](const fs::path& p, const std::string& d) { write_dictzip(p, d, 8192); });
+    {
+        StarDictParserStd p;
+        assert(p.load_dictionary(dz_ifo));
+        assert(fs::path(p.data_path()).filename() == "zipped.dict.dz");
+        assert(files_in(cache) == 0);
+        for (int i = 0; i < n; i += 37) {
+            char w[16]; std::snprintf(w, sizeof(w), "w%05d", i);
+            assert(p.lookup(w) == def_for(i));
+        }
+        std::vector<std::string> words;
+        for (int i = n - 1; i >= 0; i -= 5) { char w[16]; std::snprintf(w, sizeof(w), "w%05d", i); words.push_back(w); }
+        auto got = p.lookup_batch(words);
+        for (size_t k = 0; k < words.size(); ++k) assert(got[k] == def_for(std::atoi(words[k].c_str() + 1)));
+
+        // Optional full decompression
+        StarDictParserStd full;
+        full.set_dictzip_decompress(true);
+        assert(full.load_dictionary(dz_ifo));
+        assert(fs::path(full.data_path()).extension() == ".dict" && files_in(cache) > 0);
+        assert(full.lookup("w00042") == def_for(42));
+    }
+    // Plain gzip .dict.dz keeps the decompress-to-cache path
+    {
+        const std::string gz_ifo = write_stardict("gzipped", 50, [](const fs::path& p, const std::string& d) { write_gzip(p, d); });
+        StarDictParserStd p;
+        assert(p.load_dictionary(gz_ifo));
+        assert(fs::path(p.data_path()).extension() == ".dict");
+        assert(p.lookup("w00007") == def_for(7));
+    }
+    // Load snapshots of an in-place dictzip dictionary read through the reader as well
+    {
+        const std::string snaps = (kDir / "snapshots").string();
+        DictionaryManagerStd first;
+        first.set_load_snapshots(true, snaps);
+        assert(first.add_dictionaries({dz_ifo})[0].ok);
+        DictionaryManagerStd second;
+        second.set_load_snapshots(true, snaps);
+        auto r = second.add_dictionaries({dz_ifo});
+        assert(r[0].ok && r[0].from_snapshot);
+        assert(second.search_word("w01234") == def_for(1234));
+    }
+
+    // DSL: .dsl.dz through the same reader, dictzip or plain gzip
+    {
+        std::string dsl = "#NAME \"Zipped DSL\"\n#INDEX_LANGUAGE \"English\"\n\n";
+        for (int i = 0; i < 2000; ++i) dsl += "entry" + std::to_string(i) + "\n\tdefinition " + std::to_string(i) + "\n\n";
+        write_dictzip(kDir / "lingvo.dsl.dz", dsl, 2048);
+        write_gzip(kDir / "gzip.dsl.dz", dsl);
+        for (const char* f : {"lingvo.dsl.dz", "gzip.dsl.dz"}) {
+            const std::string path = (kDir / f).string();
+            DslParserStd p;
+            assert(p.load_dictionary(path));
+            assert(p.dictionary_name() == "Zipped DSL" && p.word_count() == 2000);
+            assert(p.lookup("entry1999") == "definition 1999");
+            std::string name;
+            assert(DslParserStd::read_header(path, name) && name == "Zipped DSL");
+        }
+        DictionaryManagerStd mgr;
+        assert(mgr.add_dictionary((kDir / "lingvo.dsl.dz").string()));
+        assert(mgr.search_word("entry5") == "definition 5");
+        DictionaryManagerStd lazy;
+        assert(lazy.register_dictionary((kDir / "gzip.dsl.dz").string()));
+        assert(lazy.loaded_dictionaries() == std::vector<std::string>({"Zipped DSL"}));
+        assert(lazy.search_word("entry7") == "definition 7");
+    }
+    return 0;
+}
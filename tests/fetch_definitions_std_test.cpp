@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+#include "std/stardict_parser_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "fetch_definitions";
+
+static void be32(std::ofstream& out, uint32_t v) {
+    unsigned char b[4] = { (unsigned char)((v>>24)&0xFF), (unsigned char)((v>>16)&0xFF), (unsigned char)((v>>8)&0xFF), (unsigned char)(v&0xFF) };
+    out.write((const char*)b, 4);
+}
+
+static std::string def_for(int i) {
+    // Uneven sizes, with the occasional entry far larger than the coalescing gap
+    if (i % 97 == 0) return "long " + std::to_string(i) + " " + std::string(40000, 'x');
+    return "definition number " + std::to_string(i) + std::string((size_t)(i % 13), '.');
+}
+
+// StarDict with n entries; the .dict stores them in reverse order so file order
+// differs from headword order.
+static std::string write_stardict(int n) {
+    fs::path base = kDir / "numbers";
+    std::vector<uint32_t> offs(n), sizes(n);
+    {
+        std::ofstream dict(base.string() + ".dict", std::ios::binary | std::ios::trunc);
+        uint32_t off = 0;
+        for (int i = n - 1; i >= 0; --i) {
+            const std::string d = def_for(i);
+            dict.write(d.data(), (std::streamsize)d.size());
+            offs[i] = off; sizes[i] = (uint32_t)d.size();
+            off += (uint32_t)d.size();
+        }
+    }
+    std::vector<std::string> words;
+    for (int i = 0; i < n; ++i) words.push_back("num" + std::to_string(i));
+    std::vector<int> order(n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return words[a] < words[b]; });
+    uint32_t idx_size = 0;
+    {
+        std::ofstream idx(base.string() + ".idx", std::ios::binary | std::ios::trunc);
+        for (int i : order) {
+            idx.write(words[i].c_str(), (std::streamsize)words[i].size()); idx.put('\0');
+            be32(idx, offs[i]); be32(idx, sizes[i]);
+            idx_size += (uint32_t)words[i].size() + 9;
+        }
+    }
+    std::ofstream ifo(base.string() + ".ifo", std::ios::binary | std::ios::trunc);
+    ifo << "StarDict's dict ifo file\nversion=2.4.2\nbookname=Numbers\nwordcount=" << n
+        << "\nidxfilesize=" << idx_size << "\nidxoffsetbits=32\n";
+    return base.string() + ".ifo";
+}
+
+static std::string write_json() {
+    fs::path p = kDir / "colors.json";
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out << "{\n  \"name\": \"colors\",\n  \"entries\": [\n"
+        << "    {\"word\":\"red\",\"definition\":\"a warm color\"},\n"
+        << "    {\"word\":\"blue\",\"definition\":\"a cool color\"}\n  ]\n}\n";
+    return p.string();
+}
+
+int main() {
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    const int n = 600;
+    const std::string sd = write_stardict(n);
+    const std::string js = write_json();
+
+    // Parser level: batch equals word-by-word lookups, in the caller's order
+    {
+        StarDictParserStd p;
+        assert(p.load_dictionary(sd));
+        std::vector<std::string> words;
+        std::mt19937 rng(7);
+        for (int k = 0; k < 2000; ++k) words.push_back("num" + std::to_string(rng() % n));
+        words.push_back("missing");
+        words.push_back("num5"); words.push_back("num5");
+        auto got = p.lookup_batch(words);
+        assert(got.size() == words.size());
+        for (size_t k = 0; k < words.size(); ++k) assert(got[k] == p.lookup(words[k]));
+        assert(got[2000].empty() && got[2001] == def_for(5));
+        assert(p.lookup_batch({}).empty());
+    }
+
+    DictionaryManagerStd mgr;
+    assert(mgr.add_dictionary(sd) && mgr.add_dictionary(js));
+    mgr.build_index();
+
+    std::vector<DefinitionRefStd> refs;
+    for (int i = n - 1; i >= 0; i -= 3) refs.push_back({"Numbers", "num" + std::to_string(i)});
+    refs.push_back({"colors", "blue"});
+    refs.push_back({"colors", "green"});
+    refs.push_back({"nowhere", "red"});
+    refs.push_back({"colors", "red"});
+    refs.push_back({"Numbers", "num0"});
+
+    mgr.reset_lookup_stats();
+    auto defs = mgr.fetch_definitions(refs);
+    assert(defs.size() == refs.size());
+    const size_t tail = refs.size() - 5;
+    for (size_t k = 0; k < tail; ++k) assert(defs[k] == def_for(std::stoi(refs[k].word.substr(3))));
+    assert(defs[tail] == "a cool color");
+    assert(defs[tail + 1].empty() && defs[tail + 2].empty());
+    assert(defs[tail + 3] == "a warm color");
+    assert(defs[tail + 4] == def_for(0));
+    // Unknown dictionaries are never probed
+    assert(mgr.lookup_stats().probes == refs.size() - 1);
+
+    // A second fetch is served by the definition cache
+    mgr.reset_lookup_stats();
+    assert(mgr.fetch_definitions(refs) == defs);
+    assert(mgr.lookup_stats().probes == 0);
+    assert(mgr.fetch_definitions({}).empty());
+
+    // Full-text materialization goes through the batch path and matches search_all
+    auto ft = mgr.full_text_search("definition number", 50);
+    assert(ft.size() == 50);
+    for (const auto& e : ft) {
+        auto all = mgr.search_all(e.word);
+        assert(!all.empty() && all[0].definition == e.definition);
+    }
+    assert(mgr.full_text_search("warm", 5).size() == 1);
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+using Phase = FullTextBuildProgressStd::Phase;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "fulltext_async_build";
+
+static std::string write_json(const std::string& name, int words) {
+    fs::path p = kDir / (name + ".json");
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out << "{\n  \"name\": \"" << name << "\",\n  \"entries\": [\n";
+    for (int i = 0; i < words; ++i) {
+        out << "    {\"word\":\"" << name << "_w" << i << "\",\"definition\":\"entry " << i
+            << (i % 10 == 0 ? " mentions harbor" : " plain") << " text\"}";
+        if (i + 1 < words) out << ",";
+        out << "\n";
+    }
+    out << "  ]\n}\n";
+    return p.string();
+}
+
+// Progress callback that parks the build thread on its first report until the
+// build stops being current (cancelled or superseded) or release is set.
+struct Gate {
+    DictionaryManagerStd* mgr = nullptr;
+    std::atomic<bool> paused{false};
+    std::atomic<bool> release{false};
+    std::atomic<int> finished{0};
+    std::atomic<bool> saw_indexing{false};
+    void operator()(const FullTextBuildProgressStd& p) {
+        if (p.phase == Phase::Done || p.phase == Phase::Cancelled) { finished = p.phase == Phase::Done ? 1 : 2; return; }
+        if (p.phase == Phase::Indexing) { saw_indexing = true; return; }
+        assert(p.done <= p.total);
+        if (paused.exchange(true)) return;
+        while (!release && mgr->fulltext_state() == FullTextStateStd::Building)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+};
+
+static void wait_paused(Gate& g) {
+    while (!g.paused) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+int main() {
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    const std::string a = write_json("portA", 3000);
+    const std::string b = write_json("portB", 500);
+
+    DictionaryManagerStd sync;
+    assert(sync.add_dictionary(a) && sync.add_dictionary(b));
+    const auto expected = sync.full_text_search("harbor", 20);
+    assert(expected.size() == 20);
+
+    DictionaryManagerStd mgr;
+    assert(mgr.add_dictionary(a) && mgr.add_dictionary(b));
+    assert(mgr.fulltext_state() == FullTextStateStd::Missing);
+
+    // While the build runs, queries scan definitions instead of blocking
+    {
+        Gate g; g.mgr = &mgr;
+        auto fut = mgr.start_fulltext_build(std::ref(g), 2);
+        wait_paused(g);
+        assert(mgr.fulltext_state() == FullTextStateStd::Building);
+        auto scanned = mgr.full_text_search("harbor", 5);
+        assert(scanned.size() == 5);
+        assert(scanned[0].word == "portA_w0" && scanned[1].word == "portA_w10");
+        assert(mgr.full_text_search("harbor AND -plain dict:portB", 3).size() == 3);
+        auto hits = mgr.full_text_search_hits("harbor", 2);
+        assert(hits.size() == 2 && !hits[0].snippet.empty() && !hits[0].highlights.empty());
+        mgr.set_fulltext_scan_limit(10);
+        assert(mgr.full_text_search("harbor", 5).size() == 1); // only portA_w0 within the first 10
+        mgr.set_fulltext_scan_limit(20000);
+        assert(mgr.fulltext_stats().index_builds == 0);
+
+        // Cancellation resolves the future with false and leaves no index
+        mgr.cancel_fulltext_build();
+        assert(fut.get() == false);
+        assert(g.finished == 2);
+        assert(mgr.fulltext_state() == FullTextStateStd::Missing);
+    }
+
+    // A dictionary change supersedes a running build
+    {
+        Gate g; g.mgr = &mgr;
+        auto fut = mgr.start_fulltext_build(std::ref(g));
+        wait_paused(g);
+        assert(mgr.remove_dictionary("portB"));
+        assert(fut.get() == false);
+        assert(mgr.add_dictionary(b));
+    }
+
+    // A completed build is installed and serves ranked queries
+    {
+        Gate g; g.mgr = &mgr; g.release = true;
+        auto fut = mgr.start_fulltext_build(std::ref(g));
+        auto again = mgr.start_fulltext_build(); // joins the running build
+        assert(fut.get() == true && again.get() == true);
+        assert(g.finished == 1 && g.saw_indexing);
+        assert(mgr.fulltext_state() == FullTextStateStd::Ready);
+        assert(mgr.fulltext_stats().index_builds == 1);
+        auto got = mgr.full_text_search("harbor", 20);
+        assert(got.size() == expected.size());
+        for (size_t i = 0; i < got.size(); ++i) assert(got[i].word == expected[i].word);
+        // Nothing left to build
+        assert(mgr.start_fulltext_build().get() == true);
+        assert(mgr.fulltext_stats().index_builds == 1);
+    }
+
+    // A lazy build by the first query reports Building, and concurrent first
+    // queries share it instead of indexing twice
+    {
+        DictionaryManagerStd lazy;
+        assert(lazy.add_dictionary(a) && lazy.add_dictionary(b));
+        std::atomic<bool> done{false};
+        std::thread first([&] { assert(lazy.full_text_search("harbor", 20).size() == 20); done = true; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        const bool still_building = !done;
+        const FullTextStateStd state = lazy.fulltext_state();
+        assert(!still_building || state != FullTextStateStd::Missing);
+        auto second = lazy.full_text_search("harbor", 20);
+        first.join();
+        assert(second.size() == expected.size());
+        assert(lazy.fulltext_state() == FullTextStateStd::Ready);
+        assert(lazy.fulltext_stats().index_builds == 1);
+    }
+
+    // Destroying the manager mid-build cancels and joins the build thread
+    {
+        DictionaryManagerStd tmp;
+        assert(tmp.add_dictionary(a));
+        Gate g; g.mgr = &tmp;
+        auto fut = tmp.start_fulltext_build(std::ref(g));
+        wait_paused(g);
+        g.release = true;
+    }
+    return 0;
+}
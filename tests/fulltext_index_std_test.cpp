@@ -1,11 +1,34 @@
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <filesystem>
 #include <string>
+#include <tuple>
 #include <vector>
 #include <iostream>
 
 #include "std/fulltext_index_std.h"
 
 using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+using Docs = std::vector<std::pair<std::string, FullTextIndexStd::DocRef>>;
+
+// Dictionary d at version v: n documents mentioning their word, the version and a shared term
+static Docs dict_docs(int d, int v, int n) {
+    Docs out;
+    for (int w = 0; w < n; ++w)
+        out.push_back({"entry w" + std::to_string(w) + " release" + std::to_string(v) + (w % 3 == 0 ? " harbor" : " inland"), {d, w}});
+    return out;
+}
+
+// (dict, word, score) of every hit, independent of internal doc ids
+static std::vector<std::tuple<int,int,long>> ranked(const FullTextIndexStd& ix, const std::string& q) {
+    std::vector<std::tuple<int,int,long>> out;
+    for (const auto& h : ix.search_hits(q, 1000)) out.emplace_back(h.ref.dict, h.ref.word, std::lround(h.score * 1e6));
+    std::sort(out.begin(), out.end());
+    return out;
+}
 
 int main() {
     FullTextIndexStd ft;
@@ -33,6 +56,51 @@ int main() {
     // Top result should be doc 2 or 0 depending on IDF; assert either contains doc2 at rank 0 or among top 2
     bool found2 = false; for (size_t i=0;i<r3.size() && i<2;i++) if (r3[i].word == 2) found2 = true; assert(found2);
 
+    // Replacing a dictionary over and over keeps the id space bounded and ranks
+    // exactly like an index built from the live documents
+    {
+        FullTextIndexStd ix;
+        Docs all = dict_docs(0, 1, 120);
+        for (const auto& d : dict_docs(1, 1, 12)) all.push_back(d);
+        ix.build_from_documents(all, 2);
+        for (int v = 2; v < 40; ++v) {
+            ix.replace_documents([](const FullTextIndexStd::DocRef& r) { return r.dict == 1; }, dict_docs(1, v, 12));
+            assert(ix.doc_count() <= 2 * 132); // 132 + 12 more per version without compaction
+        }
+        FullTextIndexStd fresh;
+        Docs live = dict_docs(0, 1, 120);
+        for (const auto& d : dict_docs(1, 39, 12)) live.push_back(d);
+        fresh.build_from_documents(live, 2);
+        for (const char* q : {"harbor", "release39", "release1", "release5", "inland w3"})
+            assert(ranked(ix, q) == ranked(fresh, q));
+    }
+
+    // A replace on a loaded index leaves lists it does not extend compressed
+    {
+        const fs::path dir = fs::current_path() / "build-local" / "fulltext_index";
+        fs::create_directories(dir);
+        const std::string path = (dir / "replace.udft").string();
+        FullTextIndexStd built;
+        Docs all = dict_docs(0, 1, 300);
+        for (const auto& d : dict_docs(1, 1, 3)) all.push_back(d);
+        built.build_from_documents(all, 2);
+        assert(built.save(path));
+        FullTextIndexStd ix;
+        assert(ix.load(path));
+        const size_t compressed = ix.stats().compressed_terms;
+        assert(compressed > 100);
+        ix.replace_documents([](const FullTextIndexStd::DocRef& r) { return r.dict == 1; }, dict_docs(1, 2, 3));
+        assert(ix.stats().compressed_terms + 10 > compressed);
+        assert(ix.search("release2").size() == 3 && ix.search("w1").size() >= 1);
+        // Lists left compressed weigh only their live postings
+        FullTextIndexStd fresh;
+        Docs live = dict_docs(0, 1, 300);
+        for (const auto& d : dict_docs(1, 2, 3)) live.push_back(d);
+        fresh.build_from_documents(live, 2);
+        assert(ranked(ix, "release1") == ranked(fresh, "release1"));
+        fs::remove_all(dir);
+    }
+
     std::cout << "OK\n";
     return 0;
 }
@@ -28,7 +28,7 @@ int main() {
         ft.add_document("Hello world greeting.", {0,0});
         ft.add_document("Another greeting appears here.", {0,1});
         ft.finalize();
-        bool ok = ft.save(out_path().string());
+        bool ok = ft.save(out_path().string(), 3);
         assert(ok);
     }
 
@@ -0,0 +1,111 @@
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+#include "std/fulltext_index_std.h"
+#include "std/fulltext_query_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static fs::path write_json(const std::string& name, const std::vector<std::pair<std::string,std::string>>& entries) {
+    fs::path p = fs::current_path() / "build-local" / (name + ".json");
+    fs::create_directories(p.parent_path());
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out << "{\n  \"name\": \"" << name << "\",\n  \"entries\": [\n";
+    for (size_t i = 0; i < entries.size(); ++i) {
+        out << "    {\"word\":\"" << entries[i].first << "\",\"definition\":\"" << entries[i].second << "\"}";
+        if (i + 1 < entries.size()) out << ",";
+        out << "\n";
+    }
+    out << "  ]\n}\n";
+    return p;
+}
+
+static std::set<std::string> words(const std::vector<DictEntryStd>& v) {
+    std::set<std::string> s; for (auto& e : v) s.insert(e.word); return s;
+}
+
+int main() {
+    // Parser
+    assert(!FullTextQueryStd::is_advanced("small rodent"));
+    assert(FullTextQueryStd::is_advanced("small AND rodent"));
+    assert(FullTextQueryStd::is_advanced("-cat"));
+    assert(FullTextQueryStd::is_advanced("rod*"));
+    assert(FullTextQueryStd::is_advanced("dict:Foo bar"));
+    FullTextQueryStd q;
+    assert(FullTextQueryStd::parse("(small rodent OR (cat -dog)) dict:\"My Dict\"", q));
+    assert(q.to_string() == "((small AND rodent) OR (cat AND NOT dog)) dict:\"my dict\"");
+    assert(q.dict_filters.size() == 1 && q.dict_filters[0] == "My Dict");
+    assert(FullTextQueryStd::parse("\"long tail\" rod*", q));
+    assert(q.to_string() == "(\"long tail\" AND rod*)");
+    std::string err;
+    assert(!FullTextQueryStd::parse("(cat AND", q, &err) && !err.empty());
+    assert(!FullTextQueryStd::parse("cat OR", q, &err));
+    assert(!FullTextQueryStd::parse("\"open", q, &err));
+    // Negated dict: filters exclude; filters inside OR alternatives or negated groups are rejected
+    assert(FullTextQueryStd::parse("apple -dict:Foo", q));
+    assert(q.dict_filters.empty() && q.dict_excludes.size() == 1 && q.dict_excludes[0] == "Foo");
+    assert(q.to_string() == "apple -dict:\"foo\"");
+    assert(FullTextQueryStd::parse("apple NOT dict:Foo", q) && q.to_string() == "apple -dict:\"foo\"");
+    assert(!FullTextQueryStd::parse("apple OR (pear dict:Foo)", q, &err) && !err.empty());
+    assert(!FullTextQueryStd::parse("apple OR pear dict:Foo", q, &err));
+    assert(!FullTextQueryStd::parse("apple OR pear -dict:Foo", q, &err));
+    assert(!FullTextQueryStd::parse("apple -(pear dict:Foo)", q, &err));
+    assert(!FullTextQueryStd::parse("apple NOT NOT dict:Foo", q, &err));
+
+    // Execution through the manager
+    auto a = write_json("ftq_animals", {
+        {"mouse", "A small rodent with a long tail."},
+        {"rat", "A larger rodent with a tail."},
+        {"cat", "A small carnivore that hunts rodents."},
+        {"tail", "The hindmost part of an animal, long or short."}});
+    auto b = write_json("ftq_devices", {{"mouse", "A small pointing device."}});
+    DictionaryManagerStd mgr;
+    assert(mgr.add_dictionary(a.string()));
+    assert(mgr.add_dictionary(b.string()));
+
+    // Legacy OR for plain queries
+    assert(words(mgr.full_text_search("carnivore device", 10)) == (std::set<std::string>{"cat", "mouse"}));
+    // AND / NOT
+    assert(words(mgr.full_text_search("small AND rodent", 10)) == (std::set<std::string>{"mouse"}));
+    assert(words(mgr.full_text_search("rodent -small", 10)) == (std::set<std::string>{"rat"}));
+    assert(words(mgr.full_text_search("long NOT (small OR larger)", 10)) == (std::set<std::string>{"tail"}));
+    // Prefix
+    assert(words(mgr.full_text_search("rodent* hunts", 10)) == (std::set<std::string>{"cat"}));
+    // Phrase is verified against the definition text
+    assert(words(mgr.full_text_search("\"long tail\"", 10)) == (std::set<std::string>{"mouse"}));
+    assert(words(mgr.full_text_search("\"tail long\"", 10)).empty());
+    // dict: filter
+    auto dev = mgr.full_text_search("small dict:ftq_devices", 10);
+    assert(dev.size() == 1 && dev[0].dict_name == "ftq_devices");
+    assert(mgr.full_text_search("small dict:nope", 10).empty());
+    auto not_dev = mgr.full_text_search("small -dict:ftq_devices", 10);
+    assert(words(not_dev) == (std::set<std::string>{"mouse", "cat"}));
+    for (auto& e : not_dev) assert(e.dict_name == "ftq_animals");
+    assert(words(mgr.full_text_search("pointing NOT dict:FTQ_Devices", 10)).empty());
+    assert(mgr.full_text_search_hits("small -dict:ftq_animals", 10).size() == 1);
+    // OR of conjunctions
+    assert(words(mgr.full_text_search("(small pointing) OR larger", 10)) == (std::set<std::string>{"mouse", "rat"}));
+
+    // Galloping intersection agrees with brute force on a larger corpus
+    std::vector<std::pair<std::string, FullTextIndexStd::DocRef>> docs;
+    for (int i = 0; i < 3000; ++i) {
+        std::string t = "w" + std::to_string(i % 7) + " v" + std::to_string(i % 13);
+        if (i % 97 == 0) t += " rare";
+        docs.push_back({t, {0, i}});
+    }
+    FullTextIndexStd ix;
+    ix.build_from_documents(docs, 3);
+    assert(FullTextQueryStd::parse("rare w3 -v5", q));
+    auto hits = ix.search_query(q, 1000);
+    std::set<int> got, want;
+    for (auto& h : hits) got.insert(h.ref.word);
+    for (int i = 0; i < 3000; ++i) if (i % 97 == 0 && i % 7 == 3 && i % 13 != 5) want.insert(i);
+    assert(!want.empty() && got == want);
+    return 0;
+}
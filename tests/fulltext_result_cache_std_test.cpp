@@ -0,0 +1,72 @@
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static fs::path write_json(const std::string& name, const std::vector<std::pair<std::string,std::string>>& entries) {
+    fs::path p = fs::current_path()/"build-local"/(name+".json");
+    fs::create_directories(p.parent_path());
+    std::ofstream out(p, std::ios::binary|std::ios::trunc);
+    out << "{\n  \"name\": \""<<name<<"\",\n  \"entries\": [\n";
+    for (size_t i=0;i<entries.size();++i) {
+        out << "    {\"word\":\""<<entries[i].first<<"\",\"definition\":\""<<entries[i].second<<"\"}";
+        if (i+1<entries.size()) out << ",";
+        out << "\n";
+    }
+    out << "  ]\n}\n";
+    return p;
+}
+
+// Repeated full-text queries are served from the result cache; the cache is
+// keyed by the normalized token set and flushed when the dictionary set changes.
+int main() {
+    auto a = write_json("ftcache_a", {{"hello","A greeting and goodwill."},{"mouse","A small rodent and device."}});
+    auto b = write_json("ftcache_b", {{"rat","A larger rodent."}});
+
+    DictionaryManagerStd mgr;
+    assert(mgr.add_dictionary(a.string()));
+
+    auto r1 = mgr.full_text_search("rodent small", 10);
+    assert(!r1.empty());
+    auto s = mgr.fulltext_stats();
+    assert(s.result_cache_misses == 1 && s.result_cache_hits == 0);
+
+    // Same token set in a different order/case hits the cache
+    auto r2 = mgr.full_text_search("SMALL rodent rodent", 10);
+    s = mgr.fulltext_stats();
+    assert(s.result_cache_hits == 1);
+    assert(r2.size() == r1.size());
+    for (size_t i = 0; i < r1.size(); ++i) assert(r1[i].word == r2[i].word && r1[i].definition == r2[i].definition);
+
+    // A different limit is a different key
+    mgr.full_text_search("rodent small", 1);
+    s = mgr.fulltext_stats();
+    assert(s.result_cache_misses == 2);
+
+    // Changing the dictionary set changes the signature: cached results must not leak
+    assert(mgr.add_dictionary(b.string()));
+    auto r3 = mgr.full_text_search("rodent", 10);
+    bool has_rat = false;
+    for (auto& e : r3) if (e.word == "rat") has_rat = true;
+    assert(has_rat);
+    s = mgr.fulltext_stats();
+    assert(s.result_cache_entries == 1);
+
+    // Toggling a dictionary changes the enabled mask
+    assert(mgr.set_dictionary_enabled("ftcache_b", false));
+    auto r4 = mgr.full_text_search("rodent", 10);
+    for (auto& e : r4) assert(e.word != "rat");
+
+    // Disabling the cache keeps results identical
+    mgr.set_fulltext_result_cache_limits(0, 0);
+    auto r5 = mgr.full_text_search("rodent", 10);
+    assert(r5.size() == r4.size());
+    assert(mgr.fulltext_stats().result_cache_entries == 0);
+    return 0;
+}
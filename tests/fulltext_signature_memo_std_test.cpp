@@ -0,0 +1,89 @@
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "std/dictionary_manager_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "signature_memo";
+
+static std::string write_json(const std::string& name, const std::string& extra) {
+    fs::path p = kDir / (name + ".json");
+    {
+        std::ofstream out(p, std::ios::binary | std::ios::trunc);
+        out << "{\n  \"name\": \"" << name << "\",\n  \"entries\": [\n"
+            << "    {\"word\":\"" << name << "_a\",\"definition\":\"first entry" << extra << "\"},\n"
+            << "    {\"word\":\"" << name << "_b\",\"definition\":\"second entry\"}\n  ]\n}\n";
+    }
+    static auto stamp = fs::file_time_type::clock::now();
+    stamp += std::chrono::seconds(2);
+    fs::last_write_time(p, stamp);
+    return p.string();
+}
+
+static std::string hash_part(const std::string& sig) { return sig.substr(0, sig.find('|')); }
+
+int main() {
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    const std::string a = write_json("alpha", "");
+    const std::string b = write_json("beta", "");
+
+    DictionaryManagerStd mgr;
+    assert(mgr.add_dictionary(a));
+    const std::string s1 = mgr.fulltext_signature();
+    // 128-bit hash, then the readable payload
+    assert(hash_part(s1).size() == 32);
+    assert(s1.find("alpha|2|alpha_a|alpha_b|") != std::string::npos);
+    assert(mgr.fulltext_signature() == s1);
+    assert(mgr.fulltext_signature(true) == s1);
+
+    // Dictionary changes invalidate the memo at once
+    assert(mgr.add_dictionary(b));
+    const std::string s2 = mgr.fulltext_signature();
+    assert(s2 != s1 && hash_part(s2) != hash_part(s1));
+    assert(mgr.remove_dictionary("beta"));
+    assert(mgr.fulltext_signature() == s1);
+
+    // Files changed behind the manager's back: the fast path keeps the memo,
+    // verification re-reads the metadata and refreshes it
+    write_json("alpha", " edited");
+    assert(mgr.fulltext_signature() == s1);
+    const std::string s3 = mgr.fulltext_signature(true);
+    assert(s3 != s1);
+    assert(mgr.fulltext_signature() == s3);
+
+    // A reload (here explicit; the watcher does the same) refreshes it as well
+    write_json("alpha", " edited again");
+    assert(mgr.reload_changed_dictionaries().size() == 1);
+    const std::string s4 = mgr.fulltext_signature();
+    assert(s4 != s3 && s4 == mgr.fulltext_signature(true));
+
+    // Strict index loads always verify against the files on disk
+    const std::string idx = (kDir / "ft.index").string();
+    assert(!mgr.full_text_search("entry", 5).empty());
+    assert(mgr.save_fulltext_index(idx));
+    assert(mgr.load_fulltext_index(idx));
+    {
+        DictionaryManagerStd other;
+        assert(other.add_dictionary(a));
+        assert(other.fulltext_signature() == s4);
+        write_json("alpha", " edited again"); // same contents, newer mtime
+        assert(!other.load_fulltext_index(idx));
+    }
+
+    // Equal dictionary sets give equal signatures across managers
+    {
+        DictionaryManagerStd x, y;
+        assert(x.add_dictionary(a) && x.add_dictionary(b));
+        assert(y.add_dictionary(a) && y.add_dictionary(b));
+        assert(x.fulltext_signature() == y.fulltext_signature());
+        x.clear_dictionaries();
+        assert(x.fulltext_signature() != y.fulltext_signature());
+    }
+    return 0;
+}
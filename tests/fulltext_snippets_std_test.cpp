@@ -0,0 +1,96 @@
+#include <cassert>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "std/dictionary_manager_std.h"
+#include "std/fulltext_index_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static bool highlighted(const FullTextHitStd& h, const std::string& word) {
+    for (auto& r : h.highlights) {
+        std::string s = h.snippet.substr(r.first, r.second);
+        for (auto& c : s) c = (char)std::tolower((unsigned char)c);
+        if (s == word) return true;
+    }
+    return false;
+}
+
+int main() {
+    // Excerpts strip markup and respect the byte budget
+    std::string ex = FullTextIndexStd::make_excerpt("<b>Quick</b>   brown&amp;fox <i>jumps</i>", 64);
+    assert(ex == "Quick brown&fox jumps");
+    std::string long_text;
+    for (int i = 0; i < 100; ++i) long_text += "word ";
+    std::string cut = FullTextIndexStd::make_excerpt(long_text, 40);
+    assert(cut.size() <= 43 && cut.substr(cut.size() - 3) == "...");
+    // With terms the window moves to the first match
+    std::string far_text = "<p>" + long_text + "the <b>needle</b> is here " + long_text + "</p>";
+    std::string around = FullTextIndexStd::make_excerpt(far_text, 60, {"needle"});
+    assert(around.compare(0, 3, "...") == 0 && around.size() <= 63);
+    assert(around.find("needle") != std::string::npos && around.find('<') == std::string::npos);
+    assert(FullTextIndexStd::make_excerpt("alpha needle", 60, {"needle"}) == "alpha needle");
+    assert(FullTextIndexStd::make_excerpt(long_text, 40, {"absent"}) == cut);
+
+    fs::path base = fs::current_path() / "build-local";
+    fs::create_directories(base);
+    fs::path dict = base / "ft_snippets.json";
+    {
+        std::ofstream out(dict, std::ios::binary | std::ios::trunc);
+        out << "{\n  \"name\": \"Snip\",\n  \"entries\": [\n"
+            << "    {\"word\":\"mouse\",\"definition\":\"<p>A small <b>rodent</b> with a long tail.</p>\"},\n"
+            << "    {\"word\":\"rat\",\"definition\":\"A larger rodent.\"},\n"
+            << "    {\"word\":\"vole\",\"definition\":\"" << long_text << long_text << "a burrowing herbivore\"}\n"
+            << "  ]\n}\n";
+    }
+
+    // The snippet store is off by default; previews are cut from the definitions
+    {
+        DictionaryManagerStd plain_mgr;
+        assert(plain_mgr.add_dictionary(dict.string()));
+        auto h = plain_mgr.full_text_search_hits("burrowing", 10);
+        assert(h.size() == 1 && h[0].word == "vole" && highlighted(h[0], "burrowing"));
+        assert(plain_mgr.fulltext_stats().snippet_bytes == 0);
+    }
+
+    DictionaryManagerStd mgr;
+    mgr.set_fulltext_snippet_length(FullTextIndexStd::kDefaultSnippetLength);
+    assert(mgr.add_dictionary(dict.string()));
+    auto hits = mgr.full_text_search_hits("rodent", 10);
+    assert(hits.size() == 2);
+    for (auto& h : hits) {
+        assert(h.dict_name == "Snip");
+        assert(h.score > 0.0);
+        assert(h.snippet.find('<') == std::string::npos);
+        assert(highlighted(h, "rodent"));
+    }
+
+    // Snippets survive a save/load round trip
+    fs::path idx = base / "ft_snippets.index";
+    assert(mgr.save_fulltext_index(idx.string()));
+    DictionaryManagerStd mgr2;
+    assert(mgr2.add_dictionary(dict.string()));
+    assert(mgr2.load_fulltext_index(idx.string()));
+    assert(mgr2.fulltext_stats().snippet_bytes > 0);
+    auto hits2 = mgr2.full_text_search_hits("tail", 10);
+    assert(hits2.size() == 1 && hits2[0].word == "mouse");
+    assert(hits2[0].snippet == "A small rodent with a long tail.");
+    assert(highlighted(hits2[0], "tail"));
+    // A match past the stored excerpt still gets a highlighted preview
+    auto hits3 = mgr2.full_text_search_hits("herbivore", 10);
+    assert(hits3.size() == 1 && highlighted(hits3[0], "herbivore"));
+
+    // Index without a snippet store still answers, falling back to the definition
+    FullTextIndexStd plain;
+    plain.set_snippet_length(0);
+    plain.build_from_documents({{"alpha beta", {0, 0}}}, 1);
+    assert(!plain.has_snippets());
+    std::vector<std::string> terms;
+    auto h = plain.search_hits("beta", 5, &terms);
+    assert(h.size() == 1 && h[0].doc == 0 && terms.size() == 1 && terms[0] == "beta");
+    assert(plain.snippet(0, terms).text.empty());
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "std/fulltext_index_std.h"
+
+using namespace UnidictCoreStd;
+
+// Reference optimal string alignment distance
+static int osa(const std::string& a, const std::string& b) {
+    std::vector<std::vector<int>> d(a.size() + 1, std::vector<int>(b.size() + 1));
+    for (size_t i = 0; i <= a.size(); ++i) d[i][0] = (int)i;
+    for (size_t j = 0; j <= b.size(); ++j) d[0][j] = (int)j;
+    for (size_t i = 1; i <= a.size(); ++i)
+        for (size_t j = 1; j <= b.size(); ++j) {
+            int c = a[i-1] == b[j-1] ? 0 : 1;
+            d[i][j] = std::min({d[i-1][j] + 1, d[i][j-1] + 1, d[i-1][j-1] + c});
+            if (i > 1 && j > 1 && a[i-1] == b[j-2] && a[i-2] == b[j-1]) d[i][j] = std::min(d[i][j], d[i-2][j-2] + 1);
+        }
+    return d[a.size()][b.size()];
+}
+
+int main() {
+    FullTextIndexStd ix;
+    ix.build_from_documents({
+        {"To receive a letter.", {0, 0}},
+        {"Believe it or not.", {0, 1}},
+        {"Relieve the pain.", {0, 2}},
+        {"Recipe for soup.", {0, 3}},
+        {"They recieve gifts (sic).", {0, 4}},
+    }, 1);
+
+    // Transposed letters count as one edit
+    auto c = ix.typo_candidates("recieve", 1, 10);
+    assert(!c.empty() && c[0].first == "receive" && c[0].second == 1);
+
+    // A misspelled word finds the intended entry
+    auto r = ix.search("beleive", 10);
+    assert(!r.empty() && r[0].word == 1);
+
+    // Indexed tokens are never expanded
+    auto r2 = ix.search("recieve", 10);
+    assert(r2.size() == 1 && r2[0].word == 4);
+
+    // Exact matches outrank typo expansions
+    auto r3 = ix.search("beleive relieve", 10);
+    assert(r3.size() == 2 && r3[0].word == 2 && r3[1].word == 1);
+
+    // Short tokens are not expanded; disabling turns expansion off
+    assert(ix.typo_candidates("sop", FullTextIndexStd::typo_max_edits(3), 10).empty());
+    ix.set_typo_tolerance(0);
+    assert(ix.search("beleive", 10).empty());
+
+    // Automaton walk agrees with brute force on a random vocabulary
+    std::mt19937 rng(7);
+    std::vector<std::pair<std::string, FullTextIndexStd::DocRef>> docs;
+    std::set<std::string> vocab;
+    for (int i = 0; i < 4000; ++i) {
+        std::string w;
+        int len = 3 + (int)(rng() % 7);
+        for (int k = 0; k < len; ++k) w.push_back((char)('a' + rng() % 6));
+        vocab.insert(w);
+        docs.push_back({w, {0, i}});
+    }
+    FullTextIndexStd big;
+    big.build_from_documents(docs, 2);
+    for (const char* q : {"abcdef", "fedcba", "aabbcc", "cafebabe", "bead"}) {
+        for (int k = 1; k <= 2; ++k) {
+            std::set<std::string> want;
+            for (auto& w : vocab) { int d = osa(q, w); if (d > 0 && d <= k) want.insert(w); }
+            std::set<std::string> got;
+            for (auto& p : big.typo_candidates(q, k, 100000)) { got.insert(p.first); assert(p.second == osa(q, p.first)); }
+            assert(got == want);
+        }
+    }
+    // Cap keeps the closest candidates
+    auto capped = big.typo_candidates("abcdef", 2, 3);
+    assert(capped.size() <= 3);
+    for (size_t i = 1; i < capped.size(); ++i) assert(capped[i-1].second <= capped[i].second);
+    return 0;
+}
@@ -16,10 +16,10 @@ int main() {
     for (auto p : cands) if (mgr.add_dictionary(p)) { ok = true; break; }
     assert(ok);
 
-    // Save full-text index
+    // Save full-text index in the legacy UDFT3 layout (UDFT4 is the default)
     fs::path out = fs::current_path()/"build-local"/"udft3.index";
     fs::create_directories(out.parent_path());
-    ok = mgr.save_fulltext_index(out.string());
+    ok = mgr.save_fulltext_index(out.string(), 3);
     assert(ok);
     // Check magic header
     std::ifstream in(out, std::ios::binary);
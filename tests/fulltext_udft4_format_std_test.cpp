@@ -0,0 +1,103 @@
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "std/fulltext_index_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static std::string slurp(const fs::path& p) {
+    std::ifstream in(p, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void put_le(std::string& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back((char)((v >> (8 * i)) & 0xFF));
+}
+static void write_bytes(const fs::path& p, const std::string& s) {
+    std::ofstream out(p, std::ios::binary | std::ios::trunc);
+    out.write(s.data(), (std::streamsize)s.size());
+}
+
+int main() {
+    fs::path dir = fs::current_path() / "build-local";
+    fs::create_directories(dir);
+    fs::path a = dir / "udft4_a.index", b = dir / "udft4_b.index", c = dir / "udft4_c.index";
+
+    // Enough distinct terms to span several postings blocks
+    std::vector<std::pair<std::string, FullTextIndexStd::DocRef>> docs;
+    for (int i = 0; i < 6000; ++i) {
+        std::string t = "term" + std::to_string(i) + " shared common" + std::to_string(i % 5);
+        docs.push_back({t, {i % 3, i}});
+    }
+    FullTextIndexStd ix;
+    ix.build_from_documents(docs, 2);
+    ix.set_signature("SIG-UDFT4");
+
+    // Default writer emits UDFT4; output is independent of the thread count
+    ix.set_save_threads(1);
+    assert(ix.save(a.string()));
+    ix.set_save_threads(4);
+    assert(ix.save(b.string()));
+    const std::string bytes = slurp(a);
+    assert(bytes.compare(0, 5, "UDFT4") == 0);
+    assert(bytes == slurp(b));
+    assert(!fs::exists(a.string() + ".tmp"));
+    std::string err;
+    assert(FullTextIndexStd::verify_file(a.string(), &err));
+
+    // Round trip
+    FullTextIndexStd ld;
+    assert(ld.load(a.string()));
+    assert(ld.version() == 4);
+    assert(ld.signature() == "SIG-UDFT4");
+    assert(ld.stats().docs == 6000);
+    auto r = ld.search("term4242", 5);
+    assert(r.size() == 1 && r[0].word == 4242 && r[0].dict == 4242 % 3);
+    auto r2 = ld.search("common3", 5000);
+    assert(r2.size() == 1200);
+
+    // Re-saving still-compressed postings reproduces the same file
+    FullTextIndexStd again;
+    assert(again.load(a.string()));
+    assert(again.save(c.string()));
+    assert(slurp(c) == bytes);
+
+    // Corrupt one byte inside the postings: load and verify both fail
+    std::string bad = bytes;
+    bad[bad.size() / 2] ^= 0x5A;
+    { std::ofstream out(c, std::ios::binary | std::ios::trunc); out.write(bad.data(), (std::streamsize)bad.size()); }
+    FullTextIndexStd broken;
+    assert(!broken.load(c.string()));
+    assert(broken.last_error().find("checksum") != std::string::npos);
+    assert(!FullTextIndexStd::verify_file(c.string(), &err));
+
+    // Truncated file is rejected
+    { std::ofstream out(c, std::ios::binary | std::ios::trunc); out.write(bytes.data(), (std::streamsize)(bytes.size() - 3)); }
+    assert(!broken.load(c.string()));
+
+    // A section length past the end of the file (the header is outside the CRC) is
+    // reported as corruption rather than allocated
+    bad = bytes;
+    bad[5 + 4 + 4 + 7] ^= 0x40; // top byte of the first section's u64 length
+    write_bytes(c, bad);
+    assert(!FullTextIndexStd::verify_file(c.string(), &err) && err.find("corrupt") != std::string::npos);
+    assert(!broken.load(c.string()) && broken.last_error().find("corrupt") != std::string::npos);
+
+    // A checksummed DOCS section whose count exceeds its payload is rejected
+    std::string payload;
+    put_le(payload, 0xFFFFFFFFu, 4);
+    put_le(payload, 0, 8);
+    std::string forged = "UDFT4DOCS";
+    put_le(forged, crc32(crc32(0L, Z_NULL, 0), (const Bytef*)payload.data(), (uInt)payload.size()), 4);
+    put_le(forged, payload.size(), 8);
+    forged += payload;
+    write_bytes(c, forged);
+    assert(!broken.load(c.string()) && broken.last_error() == "bad DOCS section");
+    return 0;
+}
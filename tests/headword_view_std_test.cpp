@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+#include "std/headword_view_std.h"
+#include "std/index_engine_std.h"
+#include "std/json_parser_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static std::vector<std::string> sorted(std::vector<std::string> v) { std::sort(v.begin(), v.end()); return v; }
+
+int main() {
+    // Vector-backed view aliases the owner's storage
+    std::vector<std::string> words = {"Apple", " banana ", "cherry"};
+    HeadwordViewStd v(words);
+    assert(v.size() == 3 && !v.empty());
+    assert(v[1].data() == words[1].data());
+    assert(v.front() == "Apple" && v.back() == "cherry");
+    size_t n = 0;
+    for (std::string_view w : v) { assert(w == words[n]); ++n; }
+    assert(n == 3 && v.to_vector() == words);
+    words.push_back("date"); // the view follows the vector
+    assert(v.size() == 4 && v.back() == "date");
+    assert(HeadwordViewStd().empty() && HeadwordViewStd().begin() == HeadwordViewStd().end());
+
+    // Accessor-backed view
+    static const char* kRaw[] = {"one", "two"};
+    HeadwordViewStd acc(kRaw, 2, [](const void* o, size_t i) { return std::string_view(static_cast<const char* const*>(o)[i]); });
+    assert(acc.to_vector() == std::vector<std::string>({"one", "two"}));
+
+    // Bulk index insertion matches word-by-word insertion
+    IndexEngineStd bulk, single;
+    bulk.add_words(v, "D1");
+    bulk.add_words(acc, "D2");
+    for (const auto& w : words) single.add_word(w, "D1");
+    single.add_word("one", "D2"); single.add_word("two", "D2");
+    bulk.build_index(); single.build_index();
+    assert(sorted(bulk.all_words()) == sorted(single.all_words()));
+    assert(bulk.dictionaries_for_word("BANANA") == std::vector<std::string>({"D1"}));
+    assert(bulk.prefix_search("ch", 10) == std::vector<std::string>({"cherry"}));
+    bulk.remove_words(acc, "D2");
+    assert(bulk.word_count() == 4 && bulk.exact_match("one").empty());
+    bulk.clear_dictionary("D1");
+    assert(bulk.word_count() == 0);
+
+    // Parsers expose their list without copying; the manager indexes it in place
+    fs::path p = fs::current_path() / "build-local" / "headword_view" / "hv.json";
+    fs::create_directories(p.parent_path());
+    {
+        std::ofstream out(p, std::ios::binary | std::ios::trunc);
+        out << "{\"name\":\"HV\",\"entries\":[{\"word\":\"kiwi\",\"definition\":\"green fruit\"},{\"word\":\"lime\",\"definition\":\"sour fruit\"}]}";
+    }
+    JsonParserStd jp;
+    assert(jp.load_dictionary(p.string()));
+    auto hw = jp.headwords();
+    assert(hw.size() == 2 && hw[0] == "kiwi" && hw.to_vector() == jp.all_words());
+    assert(hw[0].data() == jp.headwords()[0].data());
+
+    DictionaryManagerStd mgr;
+    assert(mgr.add_dictionary(p.string()));
+    mgr.build_index();
+    assert(mgr.search_word("lime") == "sour fruit");
+    assert(mgr.dictionaries_for_word("KIWI") == std::vector<std::string>({"HV"}));
+    assert(mgr.dictionaries_meta().at(0).word_count == 2);
+    assert(mgr.remove_dictionary("HV") && mgr.indexed_word_count() == 0);
+    return 0;
+}
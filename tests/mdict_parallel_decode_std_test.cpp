@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "std/mdict_parser_std.h"
+#include "std/parallel_for_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static void be16w(std::string& v, uint16_t x) { v.push_back((char)(x >> 8)); v.push_back((char)(x & 0xFF)); }
+static void be32w(std::string& v, uint32_t x) { for (int i = 3; i >= 0; --i) v.push_back((char)((x >> (8 * i)) & 0xFF)); }
+
+static std::string zlib_compress(const std::string& in) {
+    uLongf n = compressBound((uLong)in.size());
+    std::string out(n, '\0');
+    int rc = compress2((Bytef*)out.data(), &n, (const Bytef*)in.data(), (uLong)in.size(), 6);
+    assert(rc == Z_OK);
+    out.resize(n);
+    return out;
+}
+
+// Poorly compressible text, so a few thousand entries exceed the 1 MiB threshold
+static std::string noise(uint32_t& seed, size_t n) {
+    static const char kAlpha[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ";
+    std::string s(n, ' ');
+    for (auto& c : s) { seed = seed * 1664525u + 1013904223u; c = kAlpha[(seed >> 16) % (sizeof(kAlpha) - 1)]; }
+    return s;
+}
+
+static void write_file(const fs::path& path, const std::string& header, const std::string& body) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(header.data(), (std::streamsize)header.size());
+    out.write(body.data(), (std::streamsize)body.size());
+}
+
+int main() {
+    const fs::path dir = fs::current_path() / "build-local" / "mdict_parallel_decode";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    // parallel_for covers every index once and reports failures
+    {
+        std::vector<std::atomic<int>> hits(1000);
+        assert(parallel_for(hits.size(), 4, [&](size_t i) { hits[i].fetch_add(1); return true; }));
+        for (auto& h : hits) assert(h.load() == 1);
+        assert(parallel_for(0, 4, [](size_t) { return false; }));
+        assert(!parallel_for(100, 4, [](size_t i) { return i != 37; }));
+        assert(!parallel_for(10, 1, [](size_t i) -> bool { if (i == 3) throw std::runtime_error("x"); return true; }));
+    }
+
+    uint32_t seed = 7;
+    std::vector<std::string> words, defs;
+    for (int i = 0; i < 3000; ++i) {
+        words.push_back("w" + std::to_string(100000 + i));
+        defs.push_back(noise(seed, 600));
+    }
+
+    // MDXK/MDXR: many key and record blocks, well over the parallel threshold
+    {
+        std::string body = "MDXK";
+        const size_t kPer = 300, rPer = 50;
+        be32w(body, (uint32_t)((words.size() + kPer - 1) / kPer));
+        uint32_t off = 0;
+        for (size_t b = 0; b < words.size(); b += kPer) {
+            std::string kb;
+            for (size_t i = b; i < std::min(words.size(), b + kPer); ++i) {
+                be16w(kb, (uint16_t)words[i].size()); kb += words[i];
+                be32w(kb, off); be32w(kb, (uint32_t)defs[i].size());
+                off += (uint32_t)defs[i].size();
+            }
+            const std::string c = zlib_compress(kb);
+            be32w(body, (uint32_t)c.size()); be32w(body, (uint32_t)kb.size()); body += c;
+        }
+        body += "MDXR";
+        be32w(body, (uint32_t)((defs.size() + rPer - 1) / rPer));
+        for (size_t b = 0; b < defs.size(); b += rPer) {
+            std::string rb;
+            for (size_t i = b; i < std::min(defs.size(), b + rPer); ++i) rb += defs[i];
+            const std::string c = zlib_compress(rb);
+            be32w(body, (uint32_t)c.size()); be32w(body, (uint32_t)rb.size()); body += c;
+        }
+        assert(body.size() > (1u << 20));
+        const fs::path mdx = dir / "mdxkr.mdx";
+        write_file(mdx, "<Dictionary title=\"Parallel\" description=\"mdxkr\"/>\n", body);
+        MdictParserStd p;
+        assert(p.load_dictionary(mdx.string()));
+        assert(p.word_count() == (int)words.size());
+        assert(p.all_words().front() == words.front() && p.all_words().back() == words.back());
+        for (size_t i = 0; i < words.size(); i += 97) assert(p.lookup(words[i]) == defs[i]);
+        assert(p.lookup(words.back()) == defs.back());
+    }
+
+    // KBIX with many RBLK blocks
+    {
+        std::string body = "KBIX";
+        const size_t rPer = 40;
+        be32w(body, (uint32_t)words.size());
+        for (size_t i = 0; i < words.size(); ++i) {
+            be16w(body, (uint16_t)words[i].size()); body += words[i];
+            be32w(body, (uint32_t)(i / rPer));
+            be32w(body, (uint32_t)((i % rPer) * 600));
+            be32w(body, 600);
+        }
+        body += "RBCT";
+        be32w(body, (uint32_t)((defs.size() + rPer - 1) / rPer));
+        for (size_t b = 0; b < defs.size(); b += rPer) {
+            std::string rb;
+            for (size_t i = b; i < std::min(defs.size(), b + rPer); ++i) rb += defs[i];
+            const std::string c = zlib_compress(rb);
+            body += "RBLK"; be32w(body, (uint32_t)c.size()); body += c;
+        }
+        const fs::path mdx = dir / "kbix.mdx";
+        write_file(mdx, "<Dictionary title=\"ParallelKbix\" description=\"kbix\"/>\n", body);
+        MdictParserStd p;
+        assert(p.load_dictionary(mdx.string()));
+        assert(p.word_count() == (int)words.size());
+        for (size_t i = 3; i < words.size(); i += 101) assert(p.lookup(words[i]) == defs[i]);
+    }
+    return 0;
+}
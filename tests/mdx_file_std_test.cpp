@@ -0,0 +1,411 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <zlib.h>
+
+#include "std/block_decoder_std.h"
+#include "std/dictionary_manager_std.h"
+#include "std/mdd_resource_std.h"
+#include "std/mdict_parser_std.h"
+#include "std/mdx_file_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "mdx_file";
+
+struct Options {
+    bool v2 = true;
+    bool utf16 = false;
+    bool encrypt_info = false; // Encrypted="2"
+    bool zlib = true;
+    bool lzo = false; // LZO1X data blocks (takes precedence over zlib)
+    size_t keys_per_block = 100;
+    size_t record_block_bytes = 1000; // the record stream is cut every this many bytes
+    std::string title = "Demo";
+};
+
+static void be(std::string& out, uint64_t v, size_t width) {
+    for (size_t i = width; i-- > 0;) out.push_back((char)((v >> (8 * i)) & 0xFF));
+}
+static void le32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back((char)((v >> (8 * i)) & 0xFF));
+}
+static uint32_t adler(const std::string& s) {
+    return (uint32_t)adler32(adler32(0, nullptr, 0), (const Bytef*)s.data(), (uInt)s.size());
+}
+
+// ASCII and Latin-1 range only, which is all the tests need
+static std::string utf16le(const std::string& utf8) {
+    std::string out;
+    for (size_t i = 0; i < utf8.size(); ++i) {
+        unsigned char c = (unsigned char)utf8[i];
+        uint32_t cp = c;
+        if (c >= 0xC0) { cp = ((c & 0x1F) << 6) | ((unsigned char)utf8[i + 1] & 0x3F); ++i; }
+        out.push_back((char)(cp & 0xFF));
+        out.push_back((char)(cp >> 8));
+    }
+    return out;
+}
+
+// type, checksum, payload
+static std::string block(const std::string& data, bool zlib, bool lzo = false) {
+    if (lzo) return BlockDecoderStd::encode(BlockDecoderStd::Lzo, data);
+    std::string out;
+    le32(out, zlib ? 2 : 0);
+    be(out, adler(data), 4);
+    if (!zlib) return out + data;
+    uLongf n = compressBound((uLong)data.size());
+    std::string z(n, '\0');
+    compress2((Bytef*)z.data(), &n, (const Bytef*)data.data(), (uLong)data.size(), 6);
+    z.resize(n);
+    return out + z;
+}
+
+// Entries must be in key order; records are stored in the same order.
+static void write_mdx(const fs::path& path, const std::vector<std::pair<std::string, std::string>>& entries, const Options& o,
+                      bool binary_records = false) {
+    const size_t nw = o.v2 ? 8 : 4;
+    const std::string term = o.utf16 ? std::string(2, '\0') : std::string(1, '\0');
+    auto text = [&](const std::string& s) { return o.utf16 ? utf16le(s) : s; };
+
+    std::string header = "<Dictionary GeneratedByEngineVersion=\"" + std::string(o.v2 ? "2.0" : "1.2") +
+        "\" RequiredEngineVersion=\"2.0\" Encrypted=\"" + (o.encrypt_info ? "2" : "No") + "\" Encoding=\"" +
+        (o.utf16 ? "UTF-16" : "UTF-8") + "\" Format=\"Html\" Title=\"" + o.title +
+        "\" Description=\"A &lt;b&gt;demo&lt;/b&gt; dictionary\"/>\r\n";
+    std::string hbytes = utf16le(header) + std::string(2, '\0');
+    std::string file;
+    be(file, hbytes.size(), 4);
+    file += hbytes;
+    le32(file, adler(hbytes));
+
+    // Record stream and offsets
+    std::string records;
+    std::vector<uint64_t> offs;
+    for (const auto& e : entries) {
+        offs.push_back(records.size());
+        records += binary_records ? e.second : text(e.second) + term;
+    }
+
+    // Key blocks and their info
+    std::string info, key_blocks;
+    size_t nblocks = 0;
+    for (size_t b = 0; b < entries.size(); b += o.keys_per_block) {
+        const size_t e = std::min(entries.size(), b + o.keys_per_block);
+        std::string data;
+        for (size_t i = b; i < e; ++i) { be(data, offs[i], nw); data += text(entries[i].first) + term; }
+        const std::string comp = block(data, o.zlib, o.lzo);
+        be(info, e - b, nw);
+        for (const std::string* k : {&entries[b].first, &entries[e - 1].first}) {
+            const std::string t = text(*k);
+            be(info, t.size() / (o.utf16 ? 2 : 1), o.v2 ? 2 : 1);
+            info += t + (o.v2 ? term : std::string());
+        }
+        be(info, comp.size(), nw);
+        be(info, data.size(), nw);
+        key_blocks += comp;
+        ++nblocks;
+    }
+    std::string info_stored = info;
+    if (o.v2) {
+        info_stored = block(info, true);
+        if (o.encrypt_info) {
+            std::string seed = info_stored.substr(4, 4);
+            le32(seed, 0x3695);
+            const auto key = MdxFileStd::ripemd128(seed.data(), seed.size());
+            unsigned char prev = 0x36;
+            for (size_t i = 8; i < info_stored.size(); ++i) {
+                const size_t j = i - 8;
+                unsigned char t = (unsigned char)((unsigned char)info_stored[i] ^ prev ^ (unsigned char)(j & 0xFF) ^ key[j % 16]);
+                t = (unsigned char)((t >> 4) | (t << 4));
+                info_stored[i] = (char)t;
+                prev = t;
+            }
+        }
+    }
+    std::string kh;
+    be(kh, nblocks, nw);
+    be(kh, entries.size(), nw);
+    if (o.v2) be(kh, info.size(), nw);
+    be(kh, info_stored.size(), nw);
+    be(kh, key_blocks.size(), nw);
+    file += kh;
+    if (o.v2) be(file, adler(kh), 4);
+    file += info_stored + key_blocks;
+
+    // Record blocks cut at fixed sizes, so records may straddle two blocks
+    std::string rinfo, rblocks;
+    size_t nrec = 0;
+    for (size_t p = 0; p < records.size(); p += o.record_block_bytes) {
+        const std::string data = records.substr(p, o.record_block_bytes);
+        const std::string comp = block(data, o.zlib, o.lzo);
+        be(rinfo, comp.size(), nw);
+        be(rinfo, data.size(), nw);
+        rblocks += comp;
+        ++nrec;
+    }
+    be(file, nrec, nw);
+    be(file, entries.size(), nw);
+    be(file, rinfo.size(), nw);
+    be(file, rblocks.size(), nw);
+    file += rinfo + rblocks;
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(file.data(), (std::streamsize)file.size());
+}
+
+static std::string hex(const std::array<uint8_t, 16>& d) {
+    std::string out;
+    char buf[3];
+    for (uint8_t b : d) { std::snprintf(buf, sizeof(buf), "%02x", b); out += buf; }
+    return out;
+}
+
+int main() {
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    const fs::path cache = kDir / "cache";
+#ifdef _WIN32
+    _putenv_s("UNIDICT_CACHE_DIR", cache.string().c_str());
+#else
+    setenv("UNIDICT_CACHE_DIR", cache.string().c_str(), 1);
+#endif
+
+    // Published RIPEMD-128 test vectors
+    assert(hex(MdxFileStd::ripemd128("", 0)) == "cdf26213a150dc3ecb610f18f6b38b46");
+    assert(hex(MdxFileStd::ripemd128("abc", 3)) == "c14a12199c66e4ba84636b0f69144c77");
+    const std::string alpha = "abcdefghijklmnopqrstuvwxyz";
+    assert(hex(MdxFileStd::ripemd128(alpha.data(), alpha.size())) == "fd2aa607f71dc8f510714922b371834e");
+
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (int i = 0; i < 3000; ++i) {
+        char w[16];
+        std::snprintf(w, sizeof(w), "word%04d", i);
+        entries.push_back({w, "<b>" + std::string(w) + "</b> meaning " + std::to_string(i * 7)});
+    }
+    entries.insert(entries.begin(), {"Apple", "fruit"});
+
+    // 2.0, UTF-8, zlib, encrypted key-block info
+    {
+        Options o;
+        o.encrypt_info = true;
+        const fs::path mdx = kDir / "v2.mdx";
+        write_mdx(mdx, entries, o);
+
+        MdxFileStd f;
+        std::string err;
+        assert(f.open(mdx.string(), &err));
+        assert(f.size() == entries.size() && f.key(0) == "Apple" && f.key(3000) == "word2999");
+        assert(f.attribute("title") == "Demo" && f.attribute("description") == "A <b>demo</b> dictionary");
+        assert(f.stats().decoded == 0); // nothing decoded at open
+        size_t i = 0;
+        std::string def;
+        assert(f.find("word1234", i) && i == 1235 && f.text(i, def) && def == entries[1235].second);
+        assert(f.stats().decoded >= 1 && f.stats().decoded <= 2);
+        const auto decoded = f.stats().decoded;
+        assert(f.text(i, def) && f.stats().decoded == decoded && f.stats().cache_hits >= 1);
+        assert(f.find("APPLE", i) && i == 0 && f.find("apple", i) && i == 0);
+        assert(!f.find("word99999", i));
+        assert(f.prefix("word12", 5).size() == 5 && f.prefix("word12", 5)[0] == "word1200");
+        // Every record, including those straddling a block boundary
+        f.set_cache_blocks(2);
+        for (size_t k = 0; k < entries.size(); k += 7) assert(f.text(k, def) && def == entries[k].second);
+        // A batch decodes each block it needs once, whatever order it asks in
+        {
+            f.set_cache_blocks(1);
+            const std::vector<size_t> want{2001, 11, 2002, 12, 2003, 0};
+            std::vector<std::string> got(want.size());
+            const auto before = f.stats().decoded;
+            f.texts(want, [&](size_t k, const std::string& text) { got[k] = text; });
+            assert(f.stats().decoded - before <= 3);
+            for (size_t k = 0; k < want.size(); ++k) assert(got[k] == entries[want[k]].second);
+            size_t calls = 0;
+            f.texts({entries.size(), 5}, [&](size_t k, const std::string&) { assert(k == 1); ++calls; });
+            assert(calls == 1);
+        }
+        // Readers decode concurrently and share the cache
+        {
+            f.set_cache_blocks(4);
+            std::vector<std::thread> readers;
+            for (size_t t = 0; t < 4; ++t) {
+                readers.emplace_back([&, t] {
+                    std::string d;
+                    for (size_t k = t; k < entries.size(); k += 13) assert(f.text(k, d) && d == entries[k].second);
+                });
+            }
+            for (auto& r : readers) r.join();
+        }
+
+        MdictParserStd p;
+        assert(p.load_dictionary(mdx.string()));
+        assert(p.dictionary_name() == "Demo" && p.word_count() == (int)entries.size());
+        assert(p.lookup("word0042") == entries[43].second);
+        assert(p.lookup("Apple") == "fruit" && p.lookup("nothing").empty());
+        assert(p.find_similar("word000", 3) == std::vector<std::string>({"word0000", "word0001", "word0002"}));
+        assert(p.headwords().size() == entries.size() && p.all_words()[1] == "word0000");
+        std::string title, desc;
+        assert(MdictParserStd::read_header(mdx.string(), title, desc) && title == "Demo" && desc == "A <b>demo</b> dictionary");
+
+        DictionaryManagerStd mgr;
+        assert(mgr.add_dictionary(mdx.string()));
+        assert(mgr.search_word("word2999") == entries[3000].second);
+        assert(mgr.exact_search("word0007").size() == 1);
+        const std::vector<std::string> words{"word2999", "Apple", "nothing", "word0042"};
+        const auto batch = p.lookup_batch(words);
+        assert(batch.size() == 4 && batch[2].empty());
+        for (size_t k = 0; k < words.size(); ++k) assert(batch[k] == p.lookup(words[k]));
+        const auto defs = mgr.fetch_definitions({{"Demo", "word0042"}, {"Demo", "word2999"}, {"Demo", "nothing"}});
+        assert(defs.size() == 3 && defs[0] == entries[43].second && defs[1] == entries[3000].second && defs[2].empty());
+
+        // A truncated copy is rejected, and the parser falls back to its other layouts
+        std::string bytes;
+        {
+            std::ifstream in(mdx, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        std::ofstream(kDir / "cut.mdx", std::ios::binary | std::ios::trunc).write(bytes.data(), (std::streamsize)(bytes.size() / 2));
+        MdxFileStd cut;
+        assert(!cut.open((kDir / "cut.mdx").string(), &err) && !err.empty() && !cut.is_open());
+
+        // A record block count whose info size wraps to 0 (2^60 * 16) is rejected, not reserved
+        size_t rec = bytes.size();
+        auto field = [&](size_t at) { uint64_t v = 0; for (size_t k = 0; k < 8; ++k) v = v << 8 | (unsigned char)bytes[at + k]; return v; };
+        for (size_t at = 0; at + 32 <= bytes.size(); ++at) {
+            if (field(at + 8) == entries.size() && field(at + 16) == 16 * field(at) &&
+                at + 32 + field(at + 16) + field(at + 24) == bytes.size()) { rec = at; break; }
+        }
+        assert(rec < bytes.size());
+        std::string wrap = bytes;
+        for (size_t k = 0; k < 8; ++k) {
+            wrap[rec + k] = (char)(((uint64_t)1 << 60) >> (8 * (7 - k)) & 0xFF);
+            wrap[rec + 16 + k] = 0;
+        }
+        std::ofstream(kDir / "wrap.mdx", std::ios::binary | std::ios::trunc).write(wrap.data(), (std::streamsize)wrap.size());
+        MdxFileStd wrapped;
+        assert(!wrapped.open((kDir / "wrap.mdx").string(), &err) && err.find("record section") != std::string::npos);
+    }
+
+    // 1.2, UTF-16, stored blocks; non-ASCII keys come back as UTF-8
+    {
+        Options o;
+        o.v2 = false;
+        o.utf16 = true;
+        o.zlib = false;
+        o.keys_per_block = 7;
+        o.record_block_bytes = 333;
+        std::vector<std::pair<std::string, std::string>> latin{{"caf\xc3\xa9", "coffee house"}, {"na\xc3\xafve", "innocent"}, {"zebra", "animal"}};
+        for (int i = 0; i < 40; ++i) latin.push_back({"zz" + std::to_string(100 + i), "filler " + std::to_string(i)});
+        const fs::path mdx = kDir / "v1.mdx";
+        write_mdx(mdx, latin, o);
+        MdictParserStd p;
+        assert(p.load_dictionary(mdx.string()));
+        assert(p.word_count() == (int)latin.size());
+        assert(p.lookup("caf\xc3\xa9") == "coffee house" && p.lookup("na\xc3\xafve") == "innocent");
+        assert(p.lookup("zz139") == "filler 39");
+    }
+
+    // LZO key and record blocks; a .mdd with LZO blocks read by MddResourceParser
+    {
+        Options o;
+        o.lzo = true;
+        o.keys_per_block = 9;
+        o.record_block_bytes = 700;
+        std::vector<std::pair<std::string, std::string>> lz;
+        for (int i = 0; i < 120; ++i) lz.push_back({"lz" + std::to_string(1000 + i), "<p>entry " + std::to_string(i) + " entry entry entry</p>"});
+        const fs::path mdx = kDir / "lzo.mdx";
+        write_mdx(mdx, lz, o);
+        MdictParserStd p;
+        assert(p.load_dictionary(mdx.string()));
+        assert(p.word_count() == (int)lz.size());
+        for (size_t i = 0; i < lz.size(); i += 7) assert(p.lookup(lz[i].first) == lz[i].second);
+
+        const std::string png = std::string("\x89PNG\r\n\x1a\n", 8) + std::string(3000, '\x07') + "tail";
+        o.utf16 = true;
+        write_mdx(kDir / "lzo.mdd", {{"\\img\\a.png", png}, {"\\snd\\b.mp3", std::string("ID3\0\0\1", 6)}}, o, true);
+        MddResourceParser mdd;
+        assert(mdd.load((kDir / "lzo.mdd").string()));
+        assert(mdd.has_resource("img/a.png") && mdd.has_resource("snd/b.mp3"));
+        const auto bytes = mdd.get_resource("img/a.png");
+        assert(std::string(bytes.begin(), bytes.end()) == png);
+        assert(mdd.get_resource_as_string("snd/b.mp3") == std::string("ID3\0\0\1", 6));
+        assert(mdd.get_resource("img/none.png").empty());
+    }
+
+    // A real .mdd next to the .mdx supplies resources
+    {
+        Options o;
+        o.title = "Pictures";
+        const fs::path mdx = kDir / "pics.mdx";
+        write_mdx(mdx, {{"dot", "<img src=\"img/dot.png\">"}}, o);
+        Options r;
+        r.utf16 = true;
+        write_mdx(kDir / "pics.mdd", {{"\\img\\dot.png", std::string("\x89PNG\0data", 9)}}, r, true);
+        MdictParserStd p;
+        assert(p.load_dictionary(mdx.string()));
+        assert(p.has_resources());
+        const std::string html = p.lookup("dot");
+        assert(html.find("file://") != std::string::npos && html.find("dot.png") != std::string::npos);
+    }
+
+    // Large files: key blocks split on several threads, .mdd records exported in waves
+    {
+        uint32_t seed = 11;
+        auto noise = [&](size_t n, bool text) {
+            std::string s(n, ' ');
+            for (auto& c : s) {
+                seed = seed * 1664525u + 1013904223u;
+                c = text ? (char)('a' + (seed >> 16) % 26) : (char)(seed >> 24);
+            }
+            return s;
+        };
+        std::vector<std::pair<std::string, std::string>> many;
+        for (int i = 0; i < 40000; ++i) many.push_back({noise(40, true) + std::to_string(i), "def " + std::to_string(i)});
+        const fs::path mdx = kDir / "many.mdx";
+        write_mdx(mdx, many, Options{});
+        MdxFileStd f;
+        assert(f.open(mdx.string()));
+        assert(f.size() == many.size());
+        for (size_t i = 0; i < many.size(); i += 999) {
+            size_t at = 0;
+            std::string def;
+            assert(f.key(i) == many[i].first && f.find(many[i].first, at) && at == i && f.text(at, def) && def == many[i].second);
+        }
+
+        std::vector<std::pair<std::string, std::string>> res;
+        for (int i = 0; i < 2000; ++i) res.push_back({"\\r\\" + std::to_string(1000 + i) + ".bin", noise(1000, false)});
+        Options r;
+        r.utf16 = true;
+        r.record_block_bytes = 20000;
+        write_mdx(kDir / "many.mdd", res, r, true);
+        MdxFileStd mdd;
+        assert(mdd.open((kDir / "many.mdd").string()));
+        size_t seen = 0;
+        assert(mdd.for_each_record([&](size_t i, const std::string& data) {
+            assert(i == seen && data == res[i].second);
+            ++seen;
+            return true;
+        }));
+        assert(seen == res.size() && mdd.stats().decoded == 100);
+        assert(!mdd.for_each_record([](size_t i, const std::string&) { return i < 5; }));
+
+        MdictParserStd p;
+        assert(p.load_dictionary(mdx.string()));
+        assert(p.has_resources());
+        bool found = false;
+        for (const auto& e : fs::recursive_directory_iterator(cache)) {
+            if (e.path().filename() == "2999.bin") {
+                std::ifstream in(e.path(), std::ios::binary);
+                const std::string got((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+                found = got == res.back().second;
+            }
+        }
+        assert(found);
+    }
+    return 0;
+}
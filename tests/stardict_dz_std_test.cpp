@@ -45,7 +45,7 @@ int main() {
     assert(ok);
     auto a = sp.lookup("alpha");
     auto b = sp.lookup("beta");
-    assert(a.size() == def1.size());
-    assert(b.size() == def2.size());
+    assert(a == def1);
+    assert(b == def2);
     return 0;
 }
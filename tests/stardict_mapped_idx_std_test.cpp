@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "std/stardict_parser_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "stardict_mapped_idx";
+
+static void be(std::ofstream& out, uint64_t v, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) out.put((char)((v >> (8 * i)) & 0xFF));
+}
+
+// Entries are written in the order given.
+static std::string write_dict(const std::string& name, const std::vector<std::pair<std::string, std::string>>& entries, int bits) {
+    fs::path base = kDir / name;
+    std::ofstream dict(base.string() + ".dict", std::ios::binary | std::ios::trunc);
+    std::ofstream idx(base.string() + ".idx", std::ios::binary | std::ios::trunc);
+    uint64_t off = 0, idx_size = 0;
+    for (const auto& e : entries) {
+        dict.write(e.second.data(), (std::streamsize)e.second.size());
+        idx.write(e.first.c_str(), (std::streamsize)e.first.size()); idx.put('\0');
+        be(idx, off, bits / 8); be(idx, e.second.size(), 4);
+        off += e.second.size();
+        idx_size += e.first.size() + 1 + bits / 8 + 4;
+    }
+    std::ofstream ifo(base.string() + ".ifo", std::ios::binary | std::ios::trunc);
+    ifo << "StarDict's dict ifo file\nversion=3.0.0\nbookname=" << name << "\nwordcount=" << entries.size()
+        << "\nidxfilesize=" << idx_size << "\nidxoffsetbits=" << bits << "\n";
+    return base.string() + ".ifo";
+}
+
+static std::string lower(std::string s) { for (auto& c : s) c = (char)std::tolower((unsigned char)c); return s; }
+
+// stardict_strcmp
+static bool collate_less(const std::string& a, const std::string& b) {
+    const std::string la = lower(a), lb = lower(b);
+    return la != lb ? la < lb : a < b;
+}
+
+int main() {
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+
+    // Case variants sort together; each spelling keeps its own definition
+    for (int bits : {32, 64}) {
+        std::vector<std::pair<std::string, std::string>> entries{
+            {"APPLE", "upper"}, {"Apple", "title"}, {"apple", "lower"}, {"application", "app"},
+            {"banana", "fruit"}, {"Zebra", "animal"}};
+        StarDictParserStd p;
+        assert(p.load_dictionary(write_dict("cases" + std::to_string(bits), entries, bits)));
+        assert(p.word_count() == 6);
+        assert(p.lookup("APPLE") == "upper" && p.lookup("Apple") == "title" && p.lookup("apple") == "lower");
+        assert(p.lookup("aPPle").empty() && p.lookup("zebra").empty() && p.lookup("Zebra") == "animal");
+        assert(p.lookup("").empty() && p.lookup("zzz").empty() && p.lookup("a").empty());
+        auto sim = p.find_similar("APP", 10);
+        assert(sim == std::vector<std::string>({"APPLE", "Apple", "apple", "application"}));
+        assert(p.find_similar("app", 2).size() == 2);
+        assert(p.find_similar("ze", 10) == std::vector<std::string>({"Zebra"}));
+        assert(p.find_similar("q", 10).empty());
+        uint64_t off = 0; uint32_t sz = 0;
+        assert(p.entry_location("banana", off, sz) && sz == 5);
+        auto hw = p.headwords();
+        assert(hw.size() == 6 && hw[0] == "APPLE" && hw[5] == "Zebra");
+        assert(p.all_words().size() == 6);
+    }
+
+    // Files out of StarDict order still resolve; a repeated headword keeps the last entry
+    {
+        std::vector<std::pair<std::string, std::string>> entries{
+            {"pear", "one"}, {"fig", "two"}, {"Pear", "three"}, {"fig", "four"}, {"apricot", "five"}};
+        StarDictParserStd p;
+        assert(p.load_dictionary(write_dict("unsorted", entries, 32)));
+        assert(p.lookup("fig") == "four" && p.lookup("pear") == "one" && p.lookup("Pear") == "three");
+        assert(p.lookup("apricot") == "five");
+        assert(p.find_similar("P", 10) == std::vector<std::string>({"Pear", "pear"}));
+        // Headwords stay in file order
+        assert(p.headwords()[0] == "pear" && p.headwords()[4] == "apricot");
+    }
+
+    // Larger random dictionary against a reference map
+    {
+        std::mt19937 rng(11);
+        std::map<std::string, std::string> ref;
+        const char* alpha = "abcdeFGHij";
+        while (ref.size() < 20000) {
+            std::string w;
+            const int len = 1 + (int)(rng() % 7);
+            for (int i = 0; i < len; ++i) w.push_back(alpha[rng() % 10]);
+            ref[w] = "def of " + w;
+        }
+        std::vector<std::pair<std::string, std::string>> entries(ref.begin(), ref.end());
+        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return collate_less(a.first, b.first); });
+        StarDictParserStd p;
+        assert(p.load_dictionary(write_dict("random", entries, 32)));
+        for (const auto& e : entries) assert(p.lookup(e.first) == e.second);
+        std::vector<std::string> queries{"ab", "AB", "fg", "j", "hij", "x"};
+        for (int k = 0; k < 50; ++k) queries.push_back(entries[rng() % entries.size()].first.substr(0, 2));
+        for (const auto& q : queries) {
+            std::vector<std::string> expect;
+            for (const auto& e : entries) {
+                if ((int)expect.size() >= 25) break;
+                if (lower(e.first).rfind(lower(q), 0) == 0) expect.push_back(e.first);
+            }
+            assert(p.find_similar(q, 25) == expect);
+        }
+        std::vector<std::string> batch;
+        for (int k = 0; k < 500; ++k) batch.push_back(entries[rng() % entries.size()].first);
+        auto got = p.lookup_batch(batch);
+        for (size_t k = 0; k < batch.size(); ++k) assert(got[k] == ref[batch[k]]);
+
+        // Definitions are slices of the mapped .dict: views, and lock-free concurrent lookups
+        assert(p.lookup_view(entries[7].first) == entries[7].second);
+        assert(p.lookup_view("nope").empty());
+        const char* first = p.lookup_view(entries[0].first).data();
+        assert(p.lookup_view(entries[1].first).data() == first + entries[0].second.size());
+        std::vector<std::thread> threads;
+        std::vector<int> bad(8, 0);
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&, t]() {
+                for (size_t k = (size_t)t; k < entries.size(); k += 8) {
+                    if (p.lookup(entries[k].first) != entries[k].second) ++bad[t];
+                    if (p.lookup_view(entries[k].first) != std::string_view(entries[k].second)) ++bad[t];
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        for (int b : bad) assert(b == 0);
+    }
+    return 0;
+}
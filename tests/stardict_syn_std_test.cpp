@@ -0,0 +1,132 @@
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "std/dictionary_manager_std.h"
+#include "std/dictionary_registry_std.h"
+#include "std/stardict_parser_std.h"
+
+using namespace UnidictCoreStd;
+namespace fs = std::filesystem;
+
+static const fs::path kDir = fs::current_path() / "build-local" / "stardict_syn";
+
+static void be32(std::ofstream& out, uint32_t v) {
+    for (int i = 3; i >= 0; --i) out.put((char)((v >> (8 * i)) & 0xFF));
+}
+
+// Entries and synonyms are written in the order given; synonyms name entries by position.
+static std::string write_dict(const std::string& name, const std::vector<std::pair<std::string, std::string>>& entries,
+                              const std::vector<std::pair<std::string, uint32_t>>& syns) {
+    const fs::path base = kDir / name;
+    std::ofstream dict(base.string() + ".dict", std::ios::binary | std::ios::trunc);
+    std::ofstream idx(base.string() + ".idx", std::ios::binary | std::ios::trunc);
+    uint32_t off = 0, idx_size = 0;
+    for (const auto& e : entries) {
+        dict.write(e.second.data(), (std::streamsize)e.second.size());
+        idx.write(e.first.c_str(), (std::streamsize)e.first.size()); idx.put('\0');
+        be32(idx, off); be32(idx, (uint32_t)e.second.size());
+        off += (uint32_t)e.second.size();
+        idx_size += (uint32_t)e.first.size() + 9;
+    }
+    if (!syns.empty()) {
+        std::ofstream syn(base.string() + ".syn", std::ios::binary | std::ios::trunc);
+        for (const auto& s : syns) { syn.write(s.first.c_str(), (std::streamsize)s.first.size()); syn.put('\0'); be32(syn, s.second); }
+    }
+    std::ofstream ifo(base.string() + ".ifo", std::ios::binary | std::ios::trunc);
+    ifo << "StarDict's dict ifo file\nversion=3.0.0\nbookname=" << name << "\nwordcount=" << entries.size()
+        << "\nsynwordcount=" << syns.size() << "\nidxfilesize=" << idx_size << "\nidxoffsetbits=32\n";
+    return base.string() + ".ifo";
+}
+
+int main() {
+    fs::remove_all(kDir);
+    fs::create_directories(kDir);
+    const std::vector<std::pair<std::string, std::string>> entries{
+        {"be", "to exist"}, {"colour", "a hue"}, {"go", "to move"}, {"mouse", "a rodent"}};
+
+    // Synonyms resolve to their entry; headwords are unchanged
+    const std::string ifo = write_dict("verbs", entries,
+        {{"am", 0}, {"color", 1}, {"gone", 2}, {"mice", 3}, {"was", 0}, {"went", 2}, {"broken", 99}});
+    {
+        StarDictParserStd p;
+        assert(p.load_dictionary(ifo));
+        assert(p.word_count() == 4 && p.all_words().size() == 4);
+        assert(p.synonyms().size() == 6); // the one naming entry 99 is dropped
+        assert(p.lookup("went") == "to move" && p.lookup("was") == "to exist" && p.lookup("color") == "a hue");
+        assert(p.lookup("go") == "to move");
+        assert(p.lookup("Went").empty() && p.lookup("broken").empty() && p.lookup("wen").empty());
+        assert(p.lookup_view("mice") == "a rodent");
+        auto got = p.lookup_batch({"gone", "mouse", "nope", "am"});
+        assert(got == std::vector<std::string>({"to move", "a rodent", "", "to exist"}));
+        uint64_t off = 0; uint32_t sz = 0;
+        assert(p.entry_location("went", off, sz) && sz == 7);
+        assert(p.find_similar("w", 10).empty());
+    }
+    // Out of StarDict order still searches; a repeated synonym keeps its first target
+    {
+        StarDictParserStd p;
+        assert(p.load_dictionary(write_dict("unsorted", entries, {{"went", 2}, {"Am", 0}, {"color", 1}, {"went", 3}})));
+        assert(p.lookup("went") == "to move" && p.lookup("Am") == "to exist" && p.lookup("color") == "a hue");
+        assert(p.lookup("am").empty());
+    }
+    // No .syn: nothing changes
+    {
+        StarDictParserStd p;
+        assert(p.load_dictionary(write_dict("plain", entries, {})));
+        assert(p.synonyms().empty() && p.syn_path().empty() && p.lookup("went").empty());
+    }
+
+    // The manager indexes synonyms as keys of the same dictionary
+    {
+        DictionaryManagerStd mgr;
+        assert(mgr.add_dictionary(ifo));
+        mgr.build_index();
+        assert(mgr.search_word("went") == "to move");
+        assert(mgr.exact_search("WENT").size() == 1);
+        assert(mgr.prefix_search("go", 10).size() == 2);
+        assert(mgr.dictionaries_for_word("mice") == std::vector<std::string>({"verbs"}));
+        assert(mgr.indexed_word_count() == 10);
+        assert(mgr.remove_dictionary("verbs"));
+        assert(mgr.indexed_word_count() == 0);
+    }
+    {
+        auto registry = std::make_shared<DictionaryRegistryStd>();
+        DictionaryManagerStd a(registry), b(registry);
+        assert(a.add_dictionary(ifo) && b.add_dictionary(ifo));
+        assert(b.exact_search("mice").size() == 1 && b.search_word("mice") == "a rodent");
+        assert(b.indexed_word_count() == 10);
+    }
+    // Snapshots map the .syn again and serve synonyms on a warm start
+    {
+        const std::string snaps = (kDir / "snapshots").string();
+        DictionaryManagerStd first;
+        first.set_load_snapshots(true, snaps);
+        assert(first.add_dictionaries({ifo})[0].ok);
+        DictionaryManagerStd second;
+        second.set_load_snapshots(true, snaps);
+        auto r = second.add_dictionaries({ifo});
+        assert(r[0].ok && r[0].from_snapshot);
+        assert(second.search_word("went") == "to move" && second.exact_search("gone").size() == 1);
+        assert(second.indexed_word_count() == 10);
+
+        // A changed .syn is part of the fingerprint: the snapshot is rebuilt
+        {
+            std::ofstream syn(kDir / "verbs.syn", std::ios::binary | std::ios::app);
+            syn.write("walked", 6); syn.put('\0'); be32(syn, 2);
+        }
+        fs::last_write_time(kDir / "verbs.syn", fs::file_time_type::clock::now() + std::chrono::seconds(5));
+        DictionaryManagerStd third;
+        third.set_load_snapshots(true, snaps);
+        r = third.add_dictionaries({ifo});
+        assert(r[0].ok && !r[0].from_snapshot);
+        assert(third.search_word("walked") == "to move");
+    }
+    return 0;
+}